@@ -0,0 +1,54 @@
+# runs the sprite half of a scene headless on graphics::NullDevice and reports the cost of a frame, see
+# tools/rubus-bench. the short run registered with ctest keeps the headless path building and drawing
+add_executable(rubus-bench "")
+
+set_property(TARGET rubus-bench PROPERTY CXX_STANDARD 20)
+use_sanitizer(rubus-bench)
+
+target_sources(
+  rubus-bench
+  PRIVATE
+    tools/rubus-bench/main.cpp
+)
+
+target_compile_options(
+  rubus-bench
+  PRIVATE
+    -Wall
+    -Wextra
+)
+
+target_link_libraries(
+  rubus-bench
+  PRIVATE
+    rubus-engine-core
+)
+
+add_test(
+  NAME rubus-bench-headless
+  COMMAND rubus-bench --sprites 2000 --frames 8
+  WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+)
+add_test(
+  NAME rubus-bench-headless-opaque-pass
+  COMMAND rubus-bench --sprites 2000 --frames 8 --opaque-pass
+  WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+)
+add_test(
+  NAME rubus-bench-headless-gpu-culling
+  COMMAND rubus-bench --sprites 2000 --frames 8 --spread 4 --gpu-culling
+  WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+)
+# the offscreen vulkan backend, mesa's lavapipe stands in when there is no gpu
+if (RUBUS_VULKAN)
+  add_test(
+    NAME rubus-bench-vulkan-offscreen
+    COMMAND rubus-bench --sprites 2000 --frames 8 --backend vulkan
+    WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+  )
+endif()
+add_test(
+  NAME rubus-bench-soft
+  COMMAND rubus-bench --sprites 2000 --frames 8 --backend soft
+  WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+)
@@ -0,0 +1,58 @@
+# cooks the images of assets/ into ${CMAKE_CURRENT_BINARY_DIR}/cooked for the asset pack, see tools/rubus-cook.
+# images under RUBUS_COMPRESSED_TEXTURE_DIRS (none by default, e.g. "assets/bg") also get block compressed variants,
+# loaded with TextureOptions::compressed. compression is lossy, nearest filtered pixel art stays lossless
+set(RUBUS_COMPRESSED_TEXTURE_DIRS "" CACHE STRING "Asset directories whose images are also block compressed")
+set(RUBUS_TEXTURE_COMPRESSIONS "bc7;bc3;etc2" CACHE STRING "Block compressions cooked for those images")
+
+add_executable(rubus-cook "")
+
+set_property(TARGET rubus-cook PROPERTY EXCLUDE_FROM_ALL true)
+set_property(TARGET rubus-cook PROPERTY CXX_STANDARD 20)
+use_sanitizer(rubus-cook)
+
+target_sources(
+  rubus-cook
+  PRIVATE
+    tools/rubus-cook/main.cpp
+)
+
+target_compile_options(
+  rubus-cook
+  PRIVATE
+    -Wall
+    -Wextra
+)
+
+target_link_libraries(
+  rubus-cook
+  PRIVATE
+    rubus-engine-core
+)
+
+# one command per image, so only changed images are cooked again
+file(GLOB_RECURSE cook_inputs CONFIGURE_DEPENDS RELATIVE "${CMAKE_CURRENT_SOURCE_DIR}"
+  "${CMAKE_CURRENT_SOURCE_DIR}/assets/*.png"
+)
+set(cooked_textures "")
+list(JOIN RUBUS_TEXTURE_COMPRESSIONS "," compress_formats)
+foreach(image ${cook_inputs})
+  string(REGEX REPLACE "\\.png$" "" cooked_base "${CMAKE_CURRENT_BINARY_DIR}/cooked/${image}")
+  set(cooked "${cooked_base}.rtex")
+  set(compress_args "")
+  foreach(dir ${RUBUS_COMPRESSED_TEXTURE_DIRS})
+    if(image MATCHES "^${dir}/")
+      set(compress_args --compress "${compress_formats}")
+      foreach(format ${RUBUS_TEXTURE_COMPRESSIONS})
+        list(APPEND cooked "${cooked_base}.${format}.ktx2")
+      endforeach()
+    endif()
+  endforeach()
+  add_custom_command(
+    OUTPUT ${cooked}
+    COMMAND
+      rubus-cook "${CMAKE_CURRENT_BINARY_DIR}/cooked" --base "${CMAKE_CURRENT_SOURCE_DIR}" ${compress_args} "${image}"
+    DEPENDS rubus-cook "${CMAKE_CURRENT_SOURCE_DIR}/${image}"
+    VERBATIM
+  )
+  list(APPEND cooked_textures ${cooked})
+endforeach()
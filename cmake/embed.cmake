@@ -0,0 +1,38 @@
+# embeds files into a generated c++ source at build time
+#
+#   embed_files(target
+#     NAME embedded_shaders
+#     BASE_DIR ${CMAKE_CURRENT_SOURCE_DIR}
+#     FILES shaders/sprite/vert.glsl ...)
+#
+# generates `auto graphics::<NAME>() -> std::span<const graphics::EmbeddedFile>`
+# declared in rubus-engine/graphics/embedded.hpp, keyed by the path relative to BASE_DIR.
+
+set(EMBED_SCRIPT "${CMAKE_CURRENT_LIST_DIR}/embed_files.cmake")
+
+function(embed_files target)
+  cmake_parse_arguments(PARSE_ARGV 1 arg "" "NAME;BASE_DIR" "FILES")
+
+  set(output "${CMAKE_CURRENT_BINARY_DIR}/generated/${arg_NAME}.cpp")
+  set(inputs "")
+  foreach(file ${arg_FILES})
+    list(APPEND inputs "${arg_BASE_DIR}/${file}")
+  endforeach()
+  string(REPLACE ";" "," files_arg "${arg_FILES}")
+
+  add_custom_command(
+    OUTPUT "${output}"
+    COMMAND
+      ${CMAKE_COMMAND}
+        -DNAME=${arg_NAME}
+        -DBASE_DIR=${arg_BASE_DIR}
+        -DFILES=${files_arg}
+        -DOUTPUT=${output}
+        -P "${EMBED_SCRIPT}"
+    DEPENDS ${inputs} "${EMBED_SCRIPT}"
+    COMMENT "Embedding ${arg_NAME}"
+    VERBATIM
+  )
+
+  target_sources(${target} PRIVATE "${output}")
+endfunction()
@@ -0,0 +1,31 @@
+# script mode helper of embed.cmake
+# cmake -DNAME=... -DBASE_DIR=... -DFILES=a,b,c -DOUTPUT=... -P embed_files.cmake
+
+string(REPLACE "," ";" files "${FILES}")
+
+set(content "// generated by cmake/embed_files.cmake, do not edit\n\n")
+string(APPEND content "#include <array>\n\n")
+string(APPEND content "#include <rubus-engine/graphics/embedded.hpp>\n\n")
+string(APPEND content "namespace graphics {\n\n")
+
+set(index 0)
+set(table "")
+foreach(file ${files})
+  file(READ "${BASE_DIR}/${file}" hex HEX)
+  string(LENGTH "${hex}" hex_length)
+  math(EXPR size "${hex_length} / 2")
+  string(REGEX REPLACE "([0-9a-f][0-9a-f])" "'\\\\x\\1'," bytes "${hex}")
+  string(APPEND content "static constexpr char ${NAME}_${index}[] = {${bytes}'\\0'};\n")
+  string(APPEND table "    EmbeddedFile{\"${file}\", {${NAME}_${index}, ${size}}},\n")
+  math(EXPR index "${index} + 1")
+endforeach()
+
+string(APPEND content "\nauto ${NAME}() -> std::span<const EmbeddedFile> {\n")
+string(APPEND content "  static constexpr auto files = std::array{\n${table}  };\n")
+string(APPEND content "  return files;\n")
+string(APPEND content "}\n\n")
+string(APPEND content "} // namespace graphics\n")
+
+file(WRITE "${OUTPUT}.tmp" "${content}")
+file(COPY_FILE "${OUTPUT}.tmp" "${OUTPUT}" ONLY_IF_DIFFERENT)
+file(REMOVE "${OUTPUT}.tmp")
@@ -25,3 +25,6 @@ target_link_libraries(
   PRIVATE
     rubus-engine
 )
+
+# the example mounts assets.rpak when it is next to the executable
+add_dependencies(rubus-engine-example-game rubus-assets)
@@ -0,0 +1,42 @@
+# compares the gl sprite path (headless egl, mesa) with graphics::SoftSpriteRenderer on one fixed scene, see
+# tools/rubus-golden
+find_package(OpenGL COMPONENTS EGL)
+if (NOT OpenGL_EGL_FOUND)
+  return()
+endif()
+
+add_executable(rubus-golden "")
+
+set_property(TARGET rubus-golden PROPERTY CXX_STANDARD 20)
+use_sanitizer(rubus-golden)
+
+target_sources(
+  rubus-golden
+  PRIVATE
+    tools/rubus-golden/main.cpp
+)
+
+target_compile_options(
+  rubus-golden
+  PRIVATE
+    -Wall
+    -Wextra
+)
+
+target_link_libraries(
+  rubus-golden
+  PRIVATE
+    OpenGL::EGL
+    rubus-engine-core
+)
+
+add_test(
+  NAME rubus-golden-soft
+  COMMAND rubus-golden
+  WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+)
+add_test(
+  NAME rubus-golden-soft-opaque-pass
+  COMMAND rubus-golden --opaque-pass
+  WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+)
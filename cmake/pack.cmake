@@ -0,0 +1,43 @@
+# packs assets/, shaders/ and the cooked textures into assets.rpak for utils::Vfs, see tools/rubus-pack
+add_executable(rubus-pack "")
+
+set_property(TARGET rubus-pack PROPERTY EXCLUDE_FROM_ALL true)
+set_property(TARGET rubus-pack PROPERTY CXX_STANDARD 20)
+use_sanitizer(rubus-pack)
+
+target_sources(
+  rubus-pack
+  PRIVATE
+    tools/rubus-pack/main.cpp
+    src/rubus-engine/utils/vfs.cpp
+)
+
+target_include_directories(
+  rubus-pack
+  PRIVATE
+    src
+)
+
+target_compile_options(
+  rubus-pack
+  PRIVATE
+    -Wall
+    -Wextra
+)
+
+file(GLOB_RECURSE pack_inputs CONFIGURE_DEPENDS
+  "${CMAKE_CURRENT_SOURCE_DIR}/assets/*"
+  "${CMAKE_CURRENT_SOURCE_DIR}/shaders/*"
+)
+
+add_custom_command(
+  OUTPUT "${CMAKE_CURRENT_BINARY_DIR}/assets.rpak"
+  COMMAND
+    rubus-pack "${CMAKE_CURRENT_BINARY_DIR}/assets.rpak" --base "${CMAKE_CURRENT_SOURCE_DIR}" assets shaders
+      --base "${CMAKE_CURRENT_BINARY_DIR}/cooked" assets
+  DEPENDS rubus-pack ${pack_inputs} ${cooked_textures}
+  COMMENT "Packing assets.rpak"
+  VERBATIM
+)
+
+add_custom_target(rubus-assets DEPENDS "${CMAKE_CURRENT_BINARY_DIR}/assets.rpak")
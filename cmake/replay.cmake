@@ -0,0 +1,40 @@
+# replays traces of graphics::CaptureDevice on a headless egl context (mesa), see tools/rubus-replay
+find_package(OpenGL COMPONENTS EGL)
+if (NOT OpenGL_EGL_FOUND)
+  return()
+endif()
+
+add_executable(rubus-replay "")
+
+set_property(TARGET rubus-replay PROPERTY EXCLUDE_FROM_ALL true)
+set_property(TARGET rubus-replay PROPERTY CXX_STANDARD 20)
+use_sanitizer(rubus-replay)
+
+target_sources(
+  rubus-replay
+  PRIVATE
+    tools/rubus-replay/main.cpp
+    src/rubus-engine/graphics/device.cpp
+    src/rubus-engine/graphics/gl_device.cpp
+    src/rubus-engine/graphics/trace.cpp
+)
+
+target_include_directories(
+  rubus-replay
+  PRIVATE
+    src
+)
+
+target_compile_options(
+  rubus-replay
+  PRIVATE
+    -Wall
+    -Wextra
+)
+
+target_link_libraries(
+  rubus-replay
+  PRIVATE
+    OpenGL::EGL
+    glad
+)
@@ -0,0 +1,51 @@
+# unit tests of the gpu free code, see tests/main.cpp. one ctest per suite
+add_executable(rubus-tests "")
+
+set_property(TARGET rubus-tests PROPERTY CXX_STANDARD 20)
+use_sanitizer(rubus-tests)
+
+target_sources(
+  rubus-tests
+  PRIVATE
+    tests/main.cpp
+    tests/block_compression.cpp
+    tests/cached_layer.cpp
+    tests/cooked_texture.cpp
+    tests/palette.cpp
+    tests/render_queue.cpp
+    tests/sprite_batch.cpp
+    tests/sprite_transform.cpp
+    tests/texture_atlas.cpp
+    tests/vfs.cpp
+)
+
+target_compile_options(
+  rubus-tests
+  PRIVATE
+    -Wall
+    -Wextra
+)
+
+target_link_libraries(
+  rubus-tests
+  PRIVATE
+    rubus-engine-core
+)
+
+set(test_suites
+  block_compression
+  cached_layer
+  cooked_texture
+  palette
+  render_queue
+  sprite_batch
+  sprite_transform
+  texture_atlas
+  vfs
+)
+foreach(suite ${test_suites})
+  add_test(
+    NAME rubus-tests-${suite}
+    COMMAND rubus-tests ${suite}
+  )
+endforeach()
@@ -8,9 +8,19 @@
 #include <unordered_map>
 #include <string>
 
+#include <rubus-engine/utils/vfs.hpp>
+
 struct CharacterComponent;
 struct MonsterComponent;
 
+// encoded image for skia, a view into the mounted asset pack or the loose file
+inline auto load_asset_data(const char *path) -> sk_sp<SkData> {
+  if (auto packed = utils::Vfs::find(path); packed.has_value()) {
+    return SkData::MakeWithoutCopy(packed->data(), packed->size());
+  }
+  return SkData::MakeFromFileName(path);
+}
+
 struct SkillData {
   std::string id;
   std::string name;
@@ -47,59 +57,59 @@ struct GameData {
     skimg_skills = {
       {
         "attack_sword",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/attack_sword.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/attack_sword.png")),
       },
       {
         "skill_shield_bash",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_shield_bash.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_shield_bash.png")),
       },
       {
         "skill_shields_up",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_shields_up.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_shields_up.png")),
       },
       {
         "attack_magic",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/attack_magic.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/attack_magic.png")),
       },
       {
         "skill_gods_blessing",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_gods_blessing.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_gods_blessing.png")),
       },
       {
         "skill_heal",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_heal.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_heal.png")),
       },
       {
         "attack_arrow",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/attack_arrow.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/attack_arrow.png")),
       },
       {
         "skill_snipe",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_snipe.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_snipe.png")),
       },
       {
         "skill_rain_of_arrows",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_rain_of_arrows.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_rain_of_arrows.png")),
       },
       {
         "skill_meteorite",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_meteorite.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_meteorite.png")),
       },
       {
         "skill_sharp_wind",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_sharp_wind.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_sharp_wind.png")),
       },
       {
         "attack_dagger",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/attack_dagger.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/attack_dagger.png")),
       },
       {
         "skill_poison_strike",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_poison_strike.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_poison_strike.png")),
       },
       {
         "skill_vital_strike",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/skill/skill_vital_strike.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/skill/skill_vital_strike.png")),
       },
     };
 
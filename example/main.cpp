@@ -1,4 +1,7 @@
 #include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string_view>
 
 #include "game/data.hpp"
 
@@ -7,15 +10,44 @@
 #include "scenes/game.hpp"
 
 #include <rubus-engine/app/app.hpp>
+#include <rubus-engine/graphics/capture_device.hpp>
+#include <rubus-engine/utils/vfs.hpp>
+#if defined(RUBUS_VULKAN)
+#include <rubus-engine/graphics/vk_sprite_renderer.hpp>
+#endif
 
 auto WINAPI wWinMain(HINSTANCE, HINSTANCE, PWSTR, int) -> int {
   ruapp::attach_console();
   ruapp::Window::init();
 
+  // the pack of the rubus-assets target stands in for the loose assets and shaders when it is next to the game
+  if (std::filesystem::exists("assets.rpak")) {
+    utils::Vfs::mount("assets.rpak");
+  }
+
   const auto window = ruapp::Window::create("Hello world", 900, 600);
   window->init_context();
   window->make_context_current();
 
+  // RUBUS_CAPTURE=<frames> traces the engine's graphics calls of the first frames for rubus-replay
+  auto capture = std::unique_ptr<graphics::CaptureDevice>{};
+  if (const auto frames = std::getenv("RUBUS_CAPTURE"); frames != nullptr) {
+    capture = std::make_unique<graphics::CaptureDevice>(graphics::Device::current(), "capture.rbtrace",
+                                                        (uint32_t)std::atoi(frames));
+    graphics::Device::set_current(capture.get());
+  }
+
+#if defined(RUBUS_VULKAN)
+  // RUBUS_BACKEND=vulkan draws the sprites with vulkan, the gl context stays for the gui setup
+  auto vulkan = graphics::VkSpriteRenderer{};
+  const auto backend = std::getenv("RUBUS_BACKEND");
+  if (backend != nullptr and std::string_view{backend} == "vulkan") {
+    if (vulkan.init(window->hWnd, (uint32_t)window->width, (uint32_t)window->height)) {
+      graphics::SpriteBackend::active = &vulkan;
+    }
+  }
+#endif
+
   auto game_data = GameData{};
   game_data.init();
 
@@ -30,6 +62,9 @@ auto WINAPI wWinMain(HINSTANCE, HINSTANCE, PWSTR, int) -> int {
   });
 
   scene_manager.deinit(window);
+#if defined(RUBUS_VULKAN)
+  vulkan.deinit();
+#endif
   ruapp::Window::destroy(window);
   return EXIT_SUCCESS;
 }
@@ -49,23 +49,23 @@ inline auto new_character_selection_menu_scene(GameData *game_data) -> rugame::S
     auto skimg_characters = std::unordered_map<std::string, sk_sp<SkImage>>{
       {
         "human_warrior",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/character/human_warrior.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/character/human_warrior.png")),
       },
       {
         "human_priest",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/character/human_priest.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/character/human_priest.png")),
       },
       {
         "elf_archer",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/character/elf_archer.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/character/elf_archer.png")),
       },
       {
         "elf_mage",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/character/elf_mage.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/character/elf_mage.png")),
       },
       {
         "darkelf_assassin",
-        SkImages::DeferredFromEncodedData(SkData::MakeFromFileName("assets/character/darkelf_assassin.png")),
+        SkImages::DeferredFromEncodedData(load_asset_data("assets/character/darkelf_assassin.png")),
       },
     };
 
@@ -1,14 +1,14 @@
 #pragma once
 
-#include <glm/ext/matrix_transform.hpp>
-
 #include <rubus-engine/game/scene.hpp>
 #include <rubus-engine/game/resource.hpp>
 
 #include "../game/data.hpp"
 #include "../game/components.hpp"
 
+#include <cstdlib>
 #include <random>
+#include <string_view>
 
 enum struct GameState {
   Ready,
@@ -65,40 +65,46 @@ struct GameScene : public rugame::Scene {
 inline auto new_game_scene(GameData *game_data) -> rugame::Scene * {
   auto scene = new GameScene{};
 
-  scene->fn_on_init = [](rugame::Scene *) {
+  scene->fn_on_init = [](rugame::Scene *scene) {
+    // opaque sprites front to back with depth writes, RUBUS_GPU_CULLING=1 culls and draws them on the gpu
+    scene->opaque_pass = true;
+    if (const auto gpu_culling = std::getenv("RUBUS_GPU_CULLING"); gpu_culling != nullptr) {
+      scene->gpu_culling = std::string_view{gpu_culling} == "1";
+    }
+
     // texture: backgrounds
-    rugame::ResourceManager::load_texture2d_pixel("bg.plains-sheet1", "assets/bg/plains-sheet1.png");
-    rugame::ResourceManager::load_texture2d_pixel("bg.plains-sheet2", "assets/bg/plains-sheet2.png");
-    rugame::ResourceManager::load_texture2d_pixel("bg.plains-sheet3", "assets/bg/plains-sheet3.png");
-    rugame::ResourceManager::load_texture2d_pixel("bg.plains-sheet4", "assets/bg/plains-sheet4.png");
+    rugame::ResourceManager::load_texture2d_async("bg.plains-sheet1", "assets/bg/plains-sheet1.png");
+    rugame::ResourceManager::load_texture2d_async("bg.plains-sheet2", "assets/bg/plains-sheet2.png");
+    rugame::ResourceManager::load_texture2d_async("bg.plains-sheet3", "assets/bg/plains-sheet3.png");
+    rugame::ResourceManager::load_texture2d_async("bg.plains-sheet4", "assets/bg/plains-sheet4.png");
 
     // texture: characters
-    rugame::ResourceManager::load_texture2d_pixel("character.human_warrior", "assets/character/human_warrior.png");
-    rugame::ResourceManager::load_texture2d_pixel("character.human_priest", "assets/character/human_priest.png");
-    rugame::ResourceManager::load_texture2d_pixel("character.elf_archer", "assets/character/elf_archer.png");
-    rugame::ResourceManager::load_texture2d_pixel("character.elf_mage", "assets/character/elf_mage.png");
-    rugame::ResourceManager::load_texture2d_pixel("character.darkelf_assassin",
+    rugame::ResourceManager::load_texture2d_async("character.human_warrior", "assets/character/human_warrior.png");
+    rugame::ResourceManager::load_texture2d_async("character.human_priest", "assets/character/human_priest.png");
+    rugame::ResourceManager::load_texture2d_async("character.elf_archer", "assets/character/elf_archer.png");
+    rugame::ResourceManager::load_texture2d_async("character.elf_mage", "assets/character/elf_mage.png");
+    rugame::ResourceManager::load_texture2d_async("character.darkelf_assassin",
                                                   "assets/character/darkelf_assassin.png");
 
     // texture: skills
-    rugame::ResourceManager::load_texture2d_pixel("attack.sword", "assets/skill/attack_sword.png");
-    rugame::ResourceManager::load_texture2d_pixel("attack.magic", "assets/skill/attack_magic.png");
-    rugame::ResourceManager::load_texture2d_pixel("attack.arrow", "assets/skill/attack_arrow.png");
-    rugame::ResourceManager::load_texture2d_pixel("attack.dagger", "assets/skill/attack_dagger.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.shield_bash", "assets/skill/skill_shield_bash.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.shields_up", "assets/skill/skill_shields_up.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.gods_blessing", "assets/skill/skill_gods_blessing.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.heal", "assets/skill/skill_heal.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.snipe", "assets/skill/skill_snipe.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.rain_of_arrows", "assets/skill/skill_rain_of_arrows.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.meteorite", "assets/skill/skill_meteorite.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.sharp_wind", "assets/skill/skill_sharp_wind.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.poison_strike", "assets/skill/skill_poison_strike.png");
-    rugame::ResourceManager::load_texture2d_pixel("skill.vital_strike", "assets/skill/skill_vital_strike.png");
+    rugame::ResourceManager::load_texture2d_async("attack.sword", "assets/skill/attack_sword.png");
+    rugame::ResourceManager::load_texture2d_async("attack.magic", "assets/skill/attack_magic.png");
+    rugame::ResourceManager::load_texture2d_async("attack.arrow", "assets/skill/attack_arrow.png");
+    rugame::ResourceManager::load_texture2d_async("attack.dagger", "assets/skill/attack_dagger.png");
+    rugame::ResourceManager::load_texture2d_async("skill.shield_bash", "assets/skill/skill_shield_bash.png");
+    rugame::ResourceManager::load_texture2d_async("skill.shields_up", "assets/skill/skill_shields_up.png");
+    rugame::ResourceManager::load_texture2d_async("skill.gods_blessing", "assets/skill/skill_gods_blessing.png");
+    rugame::ResourceManager::load_texture2d_async("skill.heal", "assets/skill/skill_heal.png");
+    rugame::ResourceManager::load_texture2d_async("skill.snipe", "assets/skill/skill_snipe.png");
+    rugame::ResourceManager::load_texture2d_async("skill.rain_of_arrows", "assets/skill/skill_rain_of_arrows.png");
+    rugame::ResourceManager::load_texture2d_async("skill.meteorite", "assets/skill/skill_meteorite.png");
+    rugame::ResourceManager::load_texture2d_async("skill.sharp_wind", "assets/skill/skill_sharp_wind.png");
+    rugame::ResourceManager::load_texture2d_async("skill.poison_strike", "assets/skill/skill_poison_strike.png");
+    rugame::ResourceManager::load_texture2d_async("skill.vital_strike", "assets/skill/skill_vital_strike.png");
 
     // texture: monsters
-    rugame::ResourceManager::load_texture2d_pixel("monster.green_dragon", "assets/monster/green_dragon.png");
-    rugame::ResourceManager::load_texture2d_pixel("monster.red_dragon", "assets/monster/red_dragon.png");
+    rugame::ResourceManager::load_texture2d_async("monster.green_dragon", "assets/monster/green_dragon.png");
+    rugame::ResourceManager::load_texture2d_async("monster.red_dragon", "assets/monster/red_dragon.png");
 
     // material: sprite
     rugame::SpriteMaterial::init();
@@ -126,9 +132,11 @@ inline auto new_game_scene(GameData *game_data) -> rugame::Scene * {
         auto texture_id = std::format("bg.plains-sheet{}", i);
         auto sprite = new rugame::Sprite{{0.5f, 0.5f}, w, h, rugame::SpriteMaterial{texture_id}};
         sprite->zorder = -5 + i;
+        sprite->is_static = true;
         entity.add_component<TransformComponent>(position);
         entity.add_component<SpriteComponent>(sprite);
       }
+      scene->add_cached_layer(-4, -1);
     }
 
     // spawn characters
@@ -323,6 +331,9 @@ inline auto new_game_scene(GameData *game_data) -> rugame::Scene * {
     static auto query_skill_timer = ruecs::Query{&scene->arch_storage}.with<TransformComponent, SkillComponent>();
     static auto query_render = ruecs::Query{&scene->arch_storage}.with<TransformComponent, SpriteComponent>();
 
+    // one conversion per frame, shared by every click test below
+    const auto mouse_world_pos = scene->camera.screen_to_world_space({window->mouse_x, window->mouse_y});
+
     if (this_scene->state == GameState::Ready) {
       // character click
       for_each_entities(&scene->arch_storage, &scene->command, query_character) {
@@ -330,7 +341,6 @@ inline auto new_game_scene(GameData *game_data) -> rugame::Scene * {
         auto character = entity.get_component<CharacterComponent>();
 
         if (window->is_mouse_just_down(rugui::MouseButton::Left)) {
-          auto mouse_world_pos = scene->camera.screen_to_world_space({window->mouse_x, window->mouse_y});
           if (glm::distance(transform->position, {mouse_world_pos, 0}) <= 24.f) {
             this_scene->acting_entity_id = entity.id;
 
@@ -359,7 +369,6 @@ inline auto new_game_scene(GameData *game_data) -> rugame::Scene * {
         auto character = entity.get_component<CharacterComponent>();
 
         if (window->is_mouse_just_down(rugui::MouseButton::Left)) {
-          auto mouse_world_pos = scene->camera.screen_to_world_space({window->mouse_x, window->mouse_y});
           if (glm::distance(transform->position, {mouse_world_pos, 0}) <= 24.f) {
             this_scene->target_entity_id = entity.id;
             this_scene->target_entity_pos = transform->position;
@@ -377,7 +386,6 @@ inline auto new_game_scene(GameData *game_data) -> rugame::Scene * {
         auto monster = entity.get_component<MonsterComponent>();
 
         if (window->is_mouse_just_down(rugui::MouseButton::Left)) {
-          auto mouse_world_pos = scene->camera.screen_to_world_space({window->mouse_x, window->mouse_y});
           if (glm::distance(transform->position, {mouse_world_pos, 0}) <= 24.f) {
             this_scene->target_entity_id = entity.id;
             this_scene->target_entity_pos = transform->position;
@@ -545,7 +553,8 @@ inline auto new_game_scene(GameData *game_data) -> rugame::Scene * {
       auto transform = entity.get_component<TransformComponent>();
       auto sprite_component = entity.get_component<SpriteComponent>();
       auto sprite = sprite_component->sprite;
-      sprite->transform = glm::translate(glm::mat4{1}, transform->position);
+      sprite->transform = rugame::Affine2d::translate(glm::vec2{transform->position});
+      sprite->z = transform->position.z;
       scene->sprites.push_back(sprite);
     }
   };
@@ -0,0 +1,67 @@
+#version 450 core
+
+layout (local_size_x = 64) in;
+
+// same layout as graphics::SpriteInstance
+struct SpriteInstance {
+    vec4 axes;
+    vec4 center;
+    vec4 uv_rect;
+    vec4 params;
+};
+
+// same layout as graphics::DrawElementsIndirectCommand
+struct DrawCommand {
+    uint count;
+    uint instance_count;
+    uint first_index;
+    int base_vertex;
+    uint base_instance;
+};
+
+layout (std430, binding = 0) readonly buffer InputInstances {
+    SpriteInstance input_instances[];
+};
+
+layout (std430, binding = 1) writeonly buffer OutputInstances {
+    SpriteInstance output_instances[];
+};
+
+layout (std430, binding = 2) buffer DrawCommands {
+    DrawCommand commands[];
+};
+
+layout (std140, binding = 0) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    mat4 view_projection;
+};
+
+uniform uint instance_count;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= instance_count) {
+        return;
+    }
+    SpriteInstance instance = input_instances[index];
+
+    // clip space bounds of the full quad, same corners as the vertex shader
+    vec2 center = instance.center.xy;
+    vec2 axis_x = instance.axes.xy;
+    vec2 axis_y = instance.axes.zw;
+    vec4 c0 = view_projection * vec4(center - axis_x - axis_y, 0, 1);
+    vec4 c1 = view_projection * vec4(center + axis_x - axis_y, 0, 1);
+    vec4 c2 = view_projection * vec4(center - axis_x + axis_y, 0, 1);
+    vec4 c3 = view_projection * vec4(center + axis_x + axis_y, 0, 1);
+    vec2 lo = min(min(c0.xy / c0.w, c1.xy / c1.w), min(c2.xy / c2.w, c3.xy / c3.w));
+    vec2 hi = max(max(c0.xy / c0.w, c1.xy / c1.w), max(c2.xy / c2.w, c3.xy / c3.w));
+    if (any(greaterThan(lo, vec2(1))) || any(lessThan(hi, vec2(-1)))) {
+        return;
+    }
+
+    // compact into the instance range of the draw command
+    uint command = uint(instance.params.z);
+    uint slot = atomicAdd(commands[command].instance_count, 1u);
+    output_instances[commands[command].base_instance + slot] = instance;
+}
@@ -1,6 +1,7 @@
-#version 460 core
+#version 450 core
 
 in vec2 uv;
+flat in float alpha_cutoff;
 
 uniform sampler2D sprite_texture;
 
@@ -8,4 +9,7 @@ out vec4 color;
 
 void main() {
     color = texture(sprite_texture, uv);
+    if (color.a < alpha_cutoff) {
+        discard;
+    }
 }
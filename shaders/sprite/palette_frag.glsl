@@ -0,0 +1,20 @@
+#version 450 core
+
+in vec2 uv;
+flat in float alpha_cutoff;
+flat in float palette_row;
+
+// r8 palette indices, nearest filtered
+uniform sampler2D sprite_texture;
+// one palette per row, see rugame::PaletteTable
+layout (binding = 1) uniform sampler2D palette_texture;
+
+out vec4 color;
+
+void main() {
+    int index = int(texture(sprite_texture, uv).r * 255.0 + 0.5);
+    color = texelFetch(palette_texture, ivec2(index, int(palette_row)), 0);
+    if (color.a < alpha_cutoff) {
+        discard;
+    }
+}
@@ -0,0 +1,20 @@
+#version 450 core
+
+in vec2 uv;
+flat in float alpha_cutoff;
+flat in vec4 tint;
+
+uniform sampler2D sprite_texture;
+
+out vec4 color;
+
+void main() {
+    // 0.5 on the outline, the edge is blended over about one pixel at any scale
+    float distance = texture(sprite_texture, uv).r;
+    float width = max(fwidth(distance) * 0.7, 1e-4);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    color = vec4(tint.rgb, tint.a * alpha);
+    if (color.a < alpha_cutoff) {
+        discard;
+    }
+}
@@ -1,13 +1,34 @@
-#version 460 core
+#version 450 core
 
 layout (location = 0) in vec3 in_position;
 layout (location = 1) in vec2 in_uv;
 
-uniform mat4 mvp;
+// per instance
+layout (location = 2) in vec4 in_axes;
+layout (location = 3) in vec4 in_center;
+layout (location = 4) in vec4 in_uv_rect;
+layout (location = 5) in vec4 in_params;
+
+layout (std140, binding = 0) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    mat4 view_projection;
+};
 
 out vec2 uv;
+flat out float alpha_cutoff;
+flat out vec4 tint;
+flat out float palette_row;
 
 void main() {
-    gl_Position = mvp * vec4(in_position, 1);
-    uv = in_uv;
+    vec2 world_position = in_center.xy + in_position.x * in_axes.xy + in_position.y * in_axes.zw;
+    gl_Position = view_projection * vec4(world_position, 0, 1);
+    // depth comes from the draw order, not from the transform
+    gl_Position.z = in_params.x * gl_Position.w;
+    uv = mix(in_uv_rect.xy, in_uv_rect.zw, in_uv);
+    alpha_cutoff = in_params.y;
+    // rg and ba packed as 16 bit integers
+    uvec2 color = uvec2(in_center.zw);
+    tint = vec4(color.x & 0xffu, color.x >> 8, color.y & 0xffu, color.y >> 8) / 255.0;
+    palette_row = in_params.w;
 }
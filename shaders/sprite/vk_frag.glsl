@@ -0,0 +1,19 @@
+#version 450 core
+#extension GL_EXT_nonuniform_qualifier : require
+
+// frag.glsl for the vulkan backend, the texture comes from the instance instead of a binding
+
+layout (location = 0) in vec2 uv;
+layout (location = 1) flat in float alpha_cutoff;
+layout (location = 2) flat in uint texture_index;
+
+layout (set = 0, binding = 0) uniform sampler2D textures[];
+
+layout (location = 0) out vec4 color;
+
+void main() {
+    color = texture(textures[nonuniformEXT(texture_index)], uv);
+    if (color.a < alpha_cutoff) {
+        discard;
+    }
+}
@@ -0,0 +1,31 @@
+#version 450 core
+
+// vert.glsl for the vulkan backend, compiled to spir-v at build time
+
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec2 in_uv;
+
+// per instance
+layout (location = 2) in vec4 in_axes;
+layout (location = 3) in vec4 in_center;
+layout (location = 4) in vec4 in_uv_rect;
+layout (location = 5) in vec4 in_params;
+
+layout (std140, set = 1, binding = 0) uniform Camera {
+    mat4 view_projection;
+};
+
+layout (location = 0) out vec2 uv;
+layout (location = 1) flat out float alpha_cutoff;
+layout (location = 2) flat out uint texture_index;
+
+void main() {
+    vec2 world_position = in_center.xy + in_position.x * in_axes.xy + in_position.y * in_axes.zw;
+    gl_Position = view_projection * vec4(world_position, 0, 1);
+    // vulkan clip space has y down and z in [0, 1]
+    gl_Position.y = -gl_Position.y;
+    gl_Position.z = (in_params.x * 0.5 + 0.5) * gl_Position.w;
+    uv = mix(in_uv_rect.xy, in_uv_rect.zw, in_uv);
+    alpha_cutoff = in_params.y;
+    texture_index = uint(in_params.w);
+}
@@ -0,0 +1,68 @@
+#include "affine2d.hpp"
+
+#include <cmath>
+
+namespace rugame {
+
+auto Affine2d::translate(glm::vec2 translation) -> Affine2d {
+  return {.translation = translation};
+}
+
+auto Affine2d::make(glm::vec2 translation, float rotation, glm::vec2 scale) -> Affine2d {
+  const auto s = std::sin(rotation);
+  const auto c = std::cos(rotation);
+  return {
+    .x_axis = glm::vec2{c, s} * scale.x,
+    .y_axis = glm::vec2{-s, c} * scale.y,
+    .translation = translation,
+  };
+}
+
+auto Affine2d::apply(glm::vec2 point) const -> glm::vec2 {
+  return x_axis * point.x + y_axis * point.y + translation;
+}
+
+auto Affine2d::apply_vector(glm::vec2 vector) const -> glm::vec2 {
+  return x_axis * vector.x + y_axis * vector.y;
+}
+
+auto Affine2d::inverse() const -> Affine2d {
+  const auto det = x_axis.x * y_axis.y - y_axis.x * x_axis.y;
+  if (det == 0.f) {
+    return {};
+  }
+  const auto inv = 1.f / det;
+  auto result = Affine2d{
+    .x_axis = glm::vec2{y_axis.y, -x_axis.y} * inv,
+    .y_axis = glm::vec2{-y_axis.x, x_axis.x} * inv,
+  };
+  result.translation = -result.apply_vector(translation);
+  return result;
+}
+
+auto Affine2d::to_mat3() const -> glm::mat3 {
+  return {
+    glm::vec3{x_axis, 0.f},
+    glm::vec3{y_axis, 0.f},
+    glm::vec3{translation, 1.f},
+  };
+}
+
+auto Affine2d::to_mat4(float z) const -> glm::mat4 {
+  return {
+    glm::vec4{x_axis, 0.f, 0.f},
+    glm::vec4{y_axis, 0.f, 0.f},
+    glm::vec4{0.f, 0.f, 1.f, 0.f},
+    glm::vec4{translation, z, 1.f},
+  };
+}
+
+auto Affine2d::operator*(const Affine2d &other) const -> Affine2d {
+  return {
+    .x_axis = apply_vector(other.x_axis),
+    .y_axis = apply_vector(other.y_axis),
+    .translation = apply(other.translation),
+  };
+}
+
+} // namespace rugame
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace rugame {
+
+// 2x3 affine transform of the sprite plane, p' = x_axis * p.x + y_axis * p.y + translation.
+// a quarter of a glm::mat4 and enough for everything a 2d sprite does, depth is kept apart in Sprite::z.
+struct Affine2d {
+  glm::vec2 x_axis = {1.f, 0.f};
+  glm::vec2 y_axis = {0.f, 1.f};
+  glm::vec2 translation = {0.f, 0.f};
+
+  static auto translate(glm::vec2 translation) -> Affine2d;
+  // scale, then rotate (radians, counter clockwise), then translate
+  static auto make(glm::vec2 translation, float rotation, glm::vec2 scale = {1.f, 1.f}) -> Affine2d;
+
+  auto apply(glm::vec2 point) const -> glm::vec2;
+  auto apply_vector(glm::vec2 vector) const -> glm::vec2; // without the translation
+  auto inverse() const -> Affine2d;
+  auto to_mat3() const -> glm::mat3;
+  auto to_mat4(float z = 0.f) const -> glm::mat4;
+
+  // a * b applies b first
+  auto operator*(const Affine2d &other) const -> Affine2d;
+  auto operator==(const Affine2d &) const -> bool = default;
+};
+
+} // namespace rugame
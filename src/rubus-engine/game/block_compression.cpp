@@ -0,0 +1,719 @@
+#include "block_compression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace rugame {
+
+namespace {
+
+// bc3 comes from EXT_texture_compression_s3tc, which is not core and not in every gl header
+constexpr auto gl_compressed_rgba_bptc_unorm = uint32_t{0x8E8C};
+constexpr auto gl_compressed_rgba_s3tc_dxt5 = uint32_t{0x83F3};
+constexpr auto gl_compressed_rgba8_etc2_eac = uint32_t{0x9278};
+
+using Texel = std::array<int, 4>;
+using Block = std::array<Texel, 16>; // row major, the first row is the first texel row of the level
+
+auto squared_error(const Texel &a, const Texel &b, int channels) -> int {
+  auto error = 0;
+  for (auto c = 0; c < channels; ++c) {
+    error += (a[c] - b[c]) * (a[c] - b[c]);
+  }
+  return error;
+}
+
+// lsb first, as bc blocks are laid out
+struct BitWriter {
+  uint8_t *out = nullptr;
+  int bit = 0;
+
+  auto put(uint32_t value, int bits) -> void {
+    for (auto i = 0; i < bits; ++i, ++bit) {
+      if ((value >> i) & 1) {
+        out[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+      }
+    }
+  }
+};
+
+// etc blocks are big endian 64 bit words
+auto put_big_endian(uint64_t bits, uint8_t *out) -> void {
+  for (auto i = 0; i < 8; ++i) {
+    out[i] = (uint8_t)(bits >> (56 - i * 8));
+  }
+}
+
+// the extremes of the texels along their principal axis, found by power iteration on the covariance
+auto principal_endpoints(const Block &block, int channels) -> std::pair<std::array<float, 4>, std::array<float, 4>> {
+  auto mean = std::array<float, 4>{};
+  for (const auto &texel : block) {
+    for (auto c = 0; c < channels; ++c) {
+      mean[c] += (float)texel[c] / 16.f;
+    }
+  }
+  auto covariance = std::array<std::array<float, 4>, 4>{};
+  for (const auto &texel : block) {
+    for (auto i = 0; i < channels; ++i) {
+      for (auto j = 0; j < channels; ++j) {
+        covariance[i][j] += ((float)texel[i] - mean[i]) * ((float)texel[j] - mean[j]);
+      }
+    }
+  }
+
+  auto axis = std::array<float, 4>{1.f, 1.f, 1.f, 1.f};
+  for (auto iteration = 0; iteration < 8; ++iteration) {
+    auto next = std::array<float, 4>{};
+    auto length = 0.f;
+    for (auto i = 0; i < channels; ++i) {
+      for (auto j = 0; j < channels; ++j) {
+        next[i] += covariance[i][j] * axis[j];
+      }
+      length += next[i] * next[i];
+    }
+    // flat blocks keep the diagonal, every texel projects onto the mean anyway
+    if (length < 1e-6f) {
+      break;
+    }
+    for (auto i = 0; i < channels; ++i) {
+      axis[i] = next[i] / std::sqrt(length);
+    }
+  }
+
+  auto min_t = std::numeric_limits<float>::max();
+  auto max_t = std::numeric_limits<float>::lowest();
+  for (const auto &texel : block) {
+    auto t = 0.f;
+    for (auto c = 0; c < channels; ++c) {
+      t += ((float)texel[c] - mean[c]) * axis[c];
+    }
+    min_t = std::min(min_t, t);
+    max_t = std::max(max_t, t);
+  }
+  auto low = std::array<float, 4>{};
+  auto high = std::array<float, 4>{};
+  for (auto c = 0; c < channels; ++c) {
+    low[c] = std::clamp(mean[c] + axis[c] * min_t, 0.f, 255.f);
+    high[c] = std::clamp(mean[c] + axis[c] * max_t, 0.f, 255.f);
+  }
+  return {low, high};
+}
+
+// bc7 mode 6: one subset, rgba endpoints of 7 bits and a p-bit each, 4 bit indices.
+// bc7 mode 5: rgb endpoints of 7 bits and alpha endpoints of 8 bits with their own 2 bit indices, for blocks where
+// alpha does not follow the color (cutout edges)
+
+constexpr auto bc7_weights = std::array<int, 16>{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct Bc7Endpoint {
+  Texel quantized = {}; // 7 bits
+  int p = 0;
+
+  auto expanded() const -> Texel {
+    return {quantized[0] << 1 | p, quantized[1] << 1 | p, quantized[2] << 1 | p, quantized[3] << 1 | p};
+  }
+};
+
+// the p-bit that lands closer to the endpoint, alpha 255 (odd) and 0 (even) always stay exact
+auto quantize_bc7(const std::array<float, 4> &endpoint) -> Bc7Endpoint {
+  auto best = Bc7Endpoint{};
+  auto best_error = std::numeric_limits<float>::max();
+  const auto first = endpoint[3] > 254.5f ? 1 : 0;
+  const auto last = endpoint[3] < 0.5f ? 0 : 1;
+  for (auto p = first; p <= last; ++p) {
+    auto candidate = Bc7Endpoint{.quantized = {}, .p = p};
+    auto error = 0.f;
+    for (auto c = 0; c < 4; ++c) {
+      candidate.quantized[c] = std::clamp((int)std::lround((endpoint[c] - (float)p) / 2.f), 0, 127);
+      const auto d = (float)(candidate.quantized[c] << 1 | p) - endpoint[c];
+      error += d * d;
+    }
+    if (error < best_error) {
+      best = candidate;
+      best_error = error;
+    }
+  }
+  return best;
+}
+
+auto bc7_indices(const Block &block, const Texel &e0, const Texel &e1, std::array<int, 16> &indices) -> int {
+  auto palette = std::array<Texel, 16>{};
+  for (auto i = 0; i < 16; ++i) {
+    for (auto c = 0; c < 4; ++c) {
+      palette[i][c] = ((64 - bc7_weights[i]) * e0[c] + bc7_weights[i] * e1[c] + 32) >> 6;
+    }
+  }
+  auto error = 0;
+  for (auto t = 0; t < 16; ++t) {
+    auto best = std::numeric_limits<int>::max();
+    for (auto i = 0; i < 16; ++i) {
+      if (const auto e = squared_error(block[t], palette[i], 4); e < best) {
+        best = e;
+        indices[t] = i;
+      }
+    }
+    error += best;
+  }
+  return error;
+}
+
+auto encode_bc7_mode6(const Block &block, uint8_t *out) -> int {
+  auto [low, high] = principal_endpoints(block, 4);
+
+  // the fitted endpoints, then once more with endpoints solved by least squares for the chosen weights
+  auto best_error = std::numeric_limits<int>::max();
+  auto best = std::array<Bc7Endpoint, 2>{};
+  auto best_indices = std::array<int, 16>{};
+  for (auto pass = 0; pass < 2; ++pass) {
+    const auto endpoints = std::array<Bc7Endpoint, 2>{quantize_bc7(low), quantize_bc7(high)};
+    auto indices = std::array<int, 16>{};
+    const auto error = bc7_indices(block, endpoints[0].expanded(), endpoints[1].expanded(), indices);
+    if (error < best_error) {
+      best_error = error;
+      best = endpoints;
+      best_indices = indices;
+    }
+    if (error == 0) {
+      break;
+    }
+
+    auto aa = 0.f;
+    auto ab = 0.f;
+    auto bb = 0.f;
+    for (auto t = 0; t < 16; ++t) {
+      const auto w = (float)bc7_weights[indices[t]] / 64.f;
+      aa += (1.f - w) * (1.f - w);
+      ab += (1.f - w) * w;
+      bb += w * w;
+    }
+    const auto det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6f) {
+      break;
+    }
+    for (auto c = 0; c < 4; ++c) {
+      auto x0 = 0.f;
+      auto x1 = 0.f;
+      for (auto t = 0; t < 16; ++t) {
+        const auto w = (float)bc7_weights[indices[t]] / 64.f;
+        x0 += (1.f - w) * (float)block[t][c];
+        x1 += w * (float)block[t][c];
+      }
+      low[c] = std::clamp((bb * x0 - ab * x1) / det, 0.f, 255.f);
+      high[c] = std::clamp((aa * x1 - ab * x0) / det, 0.f, 255.f);
+    }
+  }
+
+  // the msb of the first index is implied zero
+  if (best_indices[0] >= 8) {
+    std::swap(best[0], best[1]);
+    for (auto &index : best_indices) {
+      index = 15 - index;
+    }
+  }
+
+  std::fill(out, out + texture_block_size, uint8_t{});
+  auto writer = BitWriter{.out = out, .bit = 0};
+  writer.put(1 << 6, 7);
+  for (auto c = 0; c < 4; ++c) {
+    writer.put((uint32_t)best[0].quantized[c], 7);
+    writer.put((uint32_t)best[1].quantized[c], 7);
+  }
+  writer.put((uint32_t)best[0].p, 1);
+  writer.put((uint32_t)best[1].p, 1);
+  for (auto t = 0; t < 16; ++t) {
+    writer.put((uint32_t)best_indices[t], t == 0 ? 3 : 4);
+  }
+  return best_error;
+}
+
+constexpr auto bc7_weights2 = std::array<int, 4>{0, 21, 43, 64};
+
+// nearest of the four interpolated values per texel over `channels` starting at `first`, returns the error
+auto bc7_indices2(const Block &block, const Texel &e0, const Texel &e1, int first, int channels,
+                  std::array<int, 16> &indices) -> int {
+  auto palette = std::array<Texel, 4>{};
+  for (auto i = 0; i < 4; ++i) {
+    for (auto c = first; c < first + channels; ++c) {
+      palette[i][c] = ((64 - bc7_weights2[i]) * e0[c] + bc7_weights2[i] * e1[c] + 32) >> 6;
+    }
+  }
+  auto error = 0;
+  for (auto t = 0; t < 16; ++t) {
+    auto best = std::numeric_limits<int>::max();
+    for (auto i = 0; i < 4; ++i) {
+      auto e = 0;
+      for (auto c = first; c < first + channels; ++c) {
+        e += (block[t][c] - palette[i][c]) * (block[t][c] - palette[i][c]);
+      }
+      if (e < best) {
+        best = e;
+        indices[t] = i;
+      }
+    }
+    error += best;
+  }
+  return error;
+}
+
+auto encode_bc7_mode5(const Block &block, uint8_t *out) -> int {
+  const auto [low, high] = principal_endpoints(block, 3);
+  auto quantized = std::array<Texel, 2>{};
+  auto endpoints = std::array<Texel, 2>{};
+  for (auto c = 0; c < 3; ++c) {
+    quantized[0][c] = std::clamp((int)std::lround(low[c] * 127.f / 255.f), 0, 127);
+    quantized[1][c] = std::clamp((int)std::lround(high[c] * 127.f / 255.f), 0, 127);
+    endpoints[0][c] = quantized[0][c] << 1 | quantized[0][c] >> 6;
+    endpoints[1][c] = quantized[1][c] << 1 | quantized[1][c] >> 6;
+  }
+  // the alpha range is kept exactly, cutout blocks decode to 0 and 255
+  endpoints[0][3] = 255;
+  endpoints[1][3] = 0;
+  for (const auto &texel : block) {
+    endpoints[0][3] = std::min(endpoints[0][3], texel[3]);
+    endpoints[1][3] = std::max(endpoints[1][3], texel[3]);
+  }
+
+  auto color_indices = std::array<int, 16>{};
+  auto alpha_indices = std::array<int, 16>{};
+  const auto error = bc7_indices2(block, endpoints[0], endpoints[1], 0, 3, color_indices) +
+                     bc7_indices2(block, endpoints[0], endpoints[1], 3, 1, alpha_indices);
+
+  // the msb of the first index of each set is implied zero
+  if (color_indices[0] >= 2) {
+    std::swap(quantized[0], quantized[1]);
+    for (auto &index : color_indices) {
+      index = 3 - index;
+    }
+  }
+  if (alpha_indices[0] >= 2) {
+    std::swap(endpoints[0][3], endpoints[1][3]);
+    for (auto &index : alpha_indices) {
+      index = 3 - index;
+    }
+  }
+
+  std::fill(out, out + texture_block_size, uint8_t{});
+  auto writer = BitWriter{.out = out, .bit = 0};
+  writer.put(1 << 5, 6);
+  writer.put(0, 2); // no channel rotation
+  for (auto c = 0; c < 3; ++c) {
+    writer.put((uint32_t)quantized[0][c], 7);
+    writer.put((uint32_t)quantized[1][c], 7);
+  }
+  writer.put((uint32_t)endpoints[0][3], 8);
+  writer.put((uint32_t)endpoints[1][3], 8);
+  for (auto t = 0; t < 16; ++t) {
+    writer.put((uint32_t)color_indices[t], t == 0 ? 1 : 2);
+  }
+  for (auto t = 0; t < 16; ++t) {
+    writer.put((uint32_t)alpha_indices[t], t == 0 ? 1 : 2);
+  }
+  return error;
+}
+
+auto encode_bc7_block(const Block &block, uint8_t *out) -> void {
+  auto mode5 = std::array<uint8_t, texture_block_size>{};
+  if (encode_bc7_mode5(block, mode5.data()) < encode_bc7_mode6(block, out)) {
+    std::copy(mode5.begin(), mode5.end(), out);
+  }
+}
+
+// bc3: an alpha block of two 8 bit endpoints and 3 bit indices, then a bc1 color block
+
+auto alpha_palette(int a0, int a1) -> std::array<int, 8> {
+  auto palette = std::array<int, 8>{a0, a1};
+  if (a0 > a1) {
+    for (auto i = 2; i < 8; ++i) {
+      palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+    }
+  } else {
+    for (auto i = 2; i < 6; ++i) {
+      palette[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+  return palette;
+}
+
+auto encode_bc3_alpha(const Block &block, uint8_t *out) -> void {
+  // eight interpolated values across the range, or six across the partial texels plus exact 0 and 255
+  auto min = 255;
+  auto max = 0;
+  auto partial_min = 255;
+  auto partial_max = 0;
+  for (const auto &texel : block) {
+    min = std::min(min, texel[3]);
+    max = std::max(max, texel[3]);
+    if (texel[3] != 0 and texel[3] != 255) {
+      partial_min = std::min(partial_min, texel[3]);
+      partial_max = std::max(partial_max, texel[3]);
+    }
+  }
+  if (partial_min > partial_max) {
+    partial_min = partial_max = 0;
+  }
+
+  auto best_error = std::numeric_limits<int>::max();
+  auto best_endpoints = std::pair<int, int>{};
+  auto best_indices = std::array<int, 16>{};
+  for (const auto &[a0, a1] : {std::pair{max, min}, std::pair{partial_min, partial_max}}) {
+    const auto palette = alpha_palette(a0, a1);
+    auto indices = std::array<int, 16>{};
+    auto error = 0;
+    for (auto t = 0; t < 16; ++t) {
+      auto best = std::numeric_limits<int>::max();
+      for (auto i = 0; i < 8; ++i) {
+        if (const auto e = std::abs(block[t][3] - palette[i]); e < best) {
+          best = e;
+          indices[t] = i;
+        }
+      }
+      error += best * best;
+    }
+    if (error < best_error) {
+      best_error = error;
+      best_endpoints = {a0, a1};
+      best_indices = indices;
+    }
+  }
+
+  std::fill(out, out + 8, uint8_t{});
+  auto writer = BitWriter{.out = out, .bit = 0};
+  writer.put((uint32_t)best_endpoints.first, 8);
+  writer.put((uint32_t)best_endpoints.second, 8);
+  for (const auto index : best_indices) {
+    writer.put((uint32_t)index, 3);
+  }
+}
+
+auto to_rgb565(const std::array<float, 4> &color) -> uint16_t {
+  const auto r = (uint32_t)std::lround(color[0] * 31.f / 255.f);
+  const auto g = (uint32_t)std::lround(color[1] * 63.f / 255.f);
+  const auto b = (uint32_t)std::lround(color[2] * 31.f / 255.f);
+  return (uint16_t)(r << 11 | g << 5 | b);
+}
+
+auto from_rgb565(uint16_t color) -> Texel {
+  const auto r = (color >> 11) & 31;
+  const auto g = (color >> 5) & 63;
+  const auto b = color & 31;
+  return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2, 255};
+}
+
+auto encode_bc1_color(const Block &block, uint8_t *out) -> void {
+  const auto [low, high] = principal_endpoints(block, 3);
+  auto c0 = to_rgb565(high);
+  auto c1 = to_rgb565(low);
+  // four color mode needs c0 > c1, equal endpoints decode index 0 as c0 in either mode
+  if (c0 < c1) {
+    std::swap(c0, c1);
+  }
+
+  auto indices = std::array<int, 16>{};
+  if (c0 != c1) {
+    const auto e0 = from_rgb565(c0);
+    const auto e1 = from_rgb565(c1);
+    auto palette = std::array<Texel, 4>{e0, e1};
+    for (auto c = 0; c < 3; ++c) {
+      palette[2][c] = (2 * e0[c] + e1[c]) / 3;
+      palette[3][c] = (e0[c] + 2 * e1[c]) / 3;
+    }
+    for (auto t = 0; t < 16; ++t) {
+      auto best = std::numeric_limits<int>::max();
+      for (auto i = 0; i < 4; ++i) {
+        if (const auto e = squared_error(block[t], palette[i], 3); e < best) {
+          best = e;
+          indices[t] = i;
+        }
+      }
+    }
+  }
+
+  std::fill(out, out + 8, uint8_t{});
+  auto writer = BitWriter{.out = out, .bit = 0};
+  writer.put(c0, 16);
+  writer.put(c1, 16);
+  for (const auto index : indices) {
+    writer.put((uint32_t)index, 2);
+  }
+}
+
+// etc2 rgba8: an eac alpha block, then an etc color block in the etc1 compatible individual or differential
+// modes. etc texels are indexed column major
+
+constexpr auto eac_modifiers = std::array<std::array<int, 8>, 16>{{
+  {-3, -6, -9, -15, 2, 5, 8, 14},
+  {-3, -7, -10, -13, 2, 6, 9, 12},
+  {-2, -5, -8, -13, 1, 4, 7, 12},
+  {-2, -4, -6, -13, 1, 3, 5, 12},
+  {-3, -6, -8, -12, 2, 5, 7, 11},
+  {-3, -7, -9, -11, 2, 6, 8, 10},
+  {-4, -7, -8, -11, 3, 6, 7, 10},
+  {-3, -5, -8, -11, 2, 4, 7, 10},
+  {-2, -6, -8, -10, 1, 5, 7, 9},
+  {-2, -5, -8, -10, 1, 4, 7, 9},
+  {-2, -4, -8, -10, 1, 3, 7, 9},
+  {-2, -5, -7, -10, 1, 4, 6, 9},
+  {-3, -4, -7, -10, 2, 3, 6, 9},
+  {-1, -2, -3, -10, 0, 1, 2, 9},
+  {-4, -6, -8, -9, 3, 5, 7, 8},
+  {-3, -5, -7, -9, 2, 4, 6, 8},
+}};
+
+constexpr auto etc_modifiers = std::array<std::array<int, 2>, 8>{{
+  {2, 8},
+  {5, 17},
+  {9, 29},
+  {13, 42},
+  {18, 60},
+  {24, 80},
+  {33, 106},
+  {47, 183},
+}};
+
+auto etc_index(int texel) -> int {
+  return (texel % 4) * 4 + texel / 4;
+}
+
+auto encode_eac_alpha(const Block &block, uint8_t *out) -> void {
+  auto min = 255;
+  auto max = 0;
+  for (const auto &texel : block) {
+    min = std::min(min, texel[3]);
+    max = std::max(max, texel[3]);
+  }
+
+  // every table with the multipliers around the one that spans the range, based so the range is centered
+  auto best_error = std::numeric_limits<int>::max();
+  auto best_bits = uint64_t{};
+  for (auto table = 0; table < 16 and best_error > 0; ++table) {
+    const auto &modifiers = eac_modifiers[table];
+    const auto span = modifiers[7] - modifiers[3];
+    const auto guess = std::clamp((int)std::lround((float)(max - min) / (float)span), 1, 15);
+    for (auto multiplier = std::max(guess - 1, 1); multiplier <= std::min(guess + 1, 15); ++multiplier) {
+      const auto center = (float)(min - multiplier * modifiers[3] + max - multiplier * modifiers[7]) / 2.f;
+      const auto base = std::clamp((int)std::lround(center), 0, 255);
+      auto bits = (uint64_t)base << 56 | (uint64_t)multiplier << 52 | (uint64_t)table << 48;
+      auto error = 0;
+      for (auto t = 0; t < 16 and error < best_error; ++t) {
+        auto best = std::numeric_limits<int>::max();
+        auto best_index = 0;
+        for (auto i = 0; i < 8; ++i) {
+          const auto value = std::clamp(base + modifiers[i] * multiplier, 0, 255);
+          if (const auto e = std::abs(block[t][3] - value); e < best) {
+            best = e;
+            best_index = i;
+          }
+        }
+        error += best * best;
+        bits |= (uint64_t)best_index << (45 - 3 * etc_index(t));
+      }
+      if (error < best_error) {
+        best_error = error;
+        best_bits = bits;
+      }
+    }
+  }
+  put_big_endian(best_bits, out);
+}
+
+// best table of a sub-block around its base color, selectors 0..3 are +small, +large, -small, -large
+auto fit_etc_subblock(const Block &block, const std::array<int, 8> &texels, const Texel &base, int &table,
+                      std::array<int, 8> &selectors) -> int {
+  auto best_error = std::numeric_limits<int>::max();
+  for (auto candidate = 0; candidate < 8; ++candidate) {
+    const auto [small, large] = etc_modifiers[candidate];
+    const auto offsets = std::array<int, 4>{small, large, -small, -large};
+    auto candidate_selectors = std::array<int, 8>{};
+    auto error = 0;
+    for (auto k = 0; k < 8 and error < best_error; ++k) {
+      auto best = std::numeric_limits<int>::max();
+      for (auto s = 0; s < 4; ++s) {
+        auto color = Texel{};
+        for (auto c = 0; c < 3; ++c) {
+          color[c] = std::clamp(base[c] + offsets[s], 0, 255);
+        }
+        if (const auto e = squared_error(block[texels[k]], color, 3); e < best) {
+          best = e;
+          candidate_selectors[k] = s;
+        }
+      }
+      error += best;
+    }
+    if (error < best_error) {
+      best_error = error;
+      table = candidate;
+      selectors = candidate_selectors;
+    }
+  }
+  return best_error;
+}
+
+auto encode_etc_color(const Block &block, uint8_t *out) -> void {
+  auto best_error = std::numeric_limits<int>::max();
+  auto best_bits = uint64_t{};
+  for (auto flip = 0; flip < 2; ++flip) {
+    // not flipped: left and right 2x4 halves, flipped: top and bottom 4x2 halves
+    auto texels = std::array<std::array<int, 8>, 2>{};
+    auto average = std::array<std::array<float, 3>, 2>{};
+    auto count = std::array<int, 2>{};
+    for (auto t = 0; t < 16; ++t) {
+      const auto sub = flip ? (t / 4 >= 2) : (t % 4 >= 2);
+      texels[sub][count[sub]++] = t;
+      for (auto c = 0; c < 3; ++c) {
+        average[sub][c] += (float)block[t][c] / 8.f;
+      }
+    }
+
+    // differential (5 bit bases, the second within -4..3 of the first) when the averages allow, individual
+    // (4 bit bases) always
+    auto q5 = std::array<Texel, 2>{};
+    auto q4 = std::array<Texel, 2>{};
+    auto differential = true;
+    for (auto sub = 0; sub < 2; ++sub) {
+      for (auto c = 0; c < 3; ++c) {
+        q5[sub][c] = std::clamp((int)std::lround(average[sub][c] * 31.f / 255.f), 0, 31);
+        q4[sub][c] = std::clamp((int)std::lround(average[sub][c] * 15.f / 255.f), 0, 15);
+      }
+    }
+    for (auto c = 0; c < 3; ++c) {
+      const auto delta = q5[1][c] - q5[0][c];
+      differential = differential and delta >= -4 and delta <= 3;
+    }
+
+    for (auto mode = differential ? 0 : 1; mode < 2; ++mode) {
+      auto bits = uint64_t{};
+      auto bases = std::array<Texel, 2>{};
+      if (mode == 0) {
+        for (auto sub = 0; sub < 2; ++sub) {
+          for (auto c = 0; c < 3; ++c) {
+            bases[sub][c] = q5[sub][c] << 3 | q5[sub][c] >> 2;
+          }
+        }
+        for (auto c = 0; c < 3; ++c) {
+          const auto delta = (uint64_t)((q5[1][c] - q5[0][c]) & 7);
+          bits |= (uint64_t)q5[0][c] << (59 - c * 8) | delta << (56 - c * 8);
+        }
+        bits |= uint64_t{1} << 33;
+      } else {
+        for (auto sub = 0; sub < 2; ++sub) {
+          for (auto c = 0; c < 3; ++c) {
+            bases[sub][c] = q4[sub][c] * 17;
+          }
+        }
+        for (auto c = 0; c < 3; ++c) {
+          bits |= (uint64_t)q4[0][c] << (60 - c * 8) | (uint64_t)q4[1][c] << (56 - c * 8);
+        }
+      }
+      bits |= (uint64_t)flip << 32;
+
+      auto error = 0;
+      for (auto sub = 0; sub < 2; ++sub) {
+        auto table = 0;
+        auto selectors = std::array<int, 8>{};
+        error += fit_etc_subblock(block, texels[sub], bases[sub], table, selectors);
+        bits |= (uint64_t)table << (sub == 0 ? 37 : 34);
+        for (auto k = 0; k < 8; ++k) {
+          const auto i = etc_index(texels[sub][k]);
+          bits |= (uint64_t)(selectors[k] >> 1) << (16 + i) | (uint64_t)(selectors[k] & 1) << i;
+        }
+      }
+      if (error < best_error) {
+        best_error = error;
+        best_bits = bits;
+      }
+    }
+  }
+  put_big_endian(best_bits, out);
+}
+
+} // namespace
+
+auto texture_compression_name(TextureCompression compression) -> std::string_view {
+  switch (compression) {
+  case TextureCompression::Bc7:
+    return "bc7";
+  case TextureCompression::Bc3:
+    return "bc3";
+  case TextureCompression::Etc2:
+    return "etc2";
+  default:
+    return "none";
+  }
+}
+
+auto parse_texture_compression(std::string_view name) -> TextureCompression {
+  for (const auto compression : {TextureCompression::Bc7, TextureCompression::Bc3, TextureCompression::Etc2}) {
+    if (name == texture_compression_name(compression)) {
+      return compression;
+    }
+  }
+  return TextureCompression::None;
+}
+
+auto texture_compression_gl_format(TextureCompression compression) -> uint32_t {
+  switch (compression) {
+  case TextureCompression::Bc7:
+    return gl_compressed_rgba_bptc_unorm;
+  case TextureCompression::Bc3:
+    return gl_compressed_rgba_s3tc_dxt5;
+  case TextureCompression::Etc2:
+    return gl_compressed_rgba8_etc2_eac;
+  default:
+    return 0;
+  }
+}
+
+auto compressed_level_size(int width, int height) -> size_t {
+  return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * texture_block_size;
+}
+
+auto compress_texture_level(TextureCompression compression, const uint8_t *rgba, int width, int height)
+  -> std::vector<std::byte> {
+  auto out = std::vector<std::byte>(compressed_level_size(width, height));
+  auto block_out = (uint8_t *)out.data();
+  for (auto by = 0; by < height; by += 4) {
+    for (auto bx = 0; bx < width; bx += 4) {
+      auto block = Block{};
+      auto visible = Texel{};
+      for (auto t = 0; t < 16; ++t) {
+        const auto x = std::min(bx + t % 4, width - 1);
+        const auto y = std::min(by + t / 4, height - 1);
+        const auto texel = rgba + ((size_t)y * width + x) * 4;
+        block[t] = {texel[0], texel[1], texel[2], texel[3]};
+        if (texel[3] > 0) {
+          visible = {visible[0] + texel[0], visible[1] + texel[1], visible[2] + texel[2], visible[3] + 1};
+        }
+      }
+      // the color of fully transparent texels is free, the mean of the visible ones keeps it off the endpoints
+      for (auto &texel : block) {
+        if (texel[3] == 0 and visible[3] > 0) {
+          texel = {visible[0] / visible[3], visible[1] / visible[3], visible[2] / visible[3], 0};
+        }
+      }
+      switch (compression) {
+      case TextureCompression::Bc7:
+        encode_bc7_block(block, block_out);
+        break;
+      case TextureCompression::Bc3:
+        encode_bc3_alpha(block, block_out);
+        encode_bc1_color(block, block_out + 8);
+        break;
+      case TextureCompression::Etc2:
+        encode_eac_alpha(block, block_out);
+        encode_etc_color(block, block_out + 8);
+        break;
+      default:
+        return {};
+      }
+      block_out += texture_block_size;
+    }
+  }
+  return out;
+}
+
+} // namespace rugame
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace rugame {
+
+// block compressed rgba formats, each stores a 4x4 texel block in 16 bytes (a quarter of rgba8).
+// the engine samples them raw like its rgba8 textures, so the srgb variants are read as unorm too
+enum struct TextureCompression : uint8_t {
+  None,
+  Bc7,  // bptc, one subset of rgba endpoints (mode 6), the best quality
+  Bc3,  // s3tc dxt5, rgb565 endpoints and a separate alpha block, for contexts without bptc
+  Etc2, // rgba8 etc2 with eac alpha, what gles class hardware samples natively
+};
+
+constexpr auto texture_block_size = size_t{16}; // bytes of one 4x4 block
+
+// lowercase name ("bc7"), also the infix of cooked files (assets/bg/plains.bc7.ktx2)
+auto texture_compression_name(TextureCompression compression) -> std::string_view;
+// None for unknown names
+auto parse_texture_compression(std::string_view name) -> TextureCompression;
+auto texture_compression_gl_format(TextureCompression compression) -> uint32_t;
+
+// bytes of a level, sizes round up to whole blocks
+auto compressed_level_size(int width, int height) -> size_t;
+
+// encodes rgba8 texels into rows of blocks in the order of the texel rows. the texels past the edge of sizes that
+// are not a multiple of 4 repeat the last column and row
+auto compress_texture_level(TextureCompression compression, const uint8_t *rgba, int width, int height)
+  -> std::vector<std::byte>;
+
+} // namespace rugame
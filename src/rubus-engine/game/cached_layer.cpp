@@ -0,0 +1,76 @@
+#include "cached_layer.hpp"
+
+#include <span>
+
+#include "sprite_batch.hpp"
+
+namespace rugame {
+
+namespace {
+
+auto fnv1a(std::span<const std::byte> data, uint64_t hash) -> uint64_t {
+  for (auto b : data) {
+    hash ^= (uint8_t)b;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+template <typename T>
+auto fnv1a(const T &value, uint64_t hash) -> uint64_t {
+  return fnv1a(std::as_bytes(std::span{&value, 1}), hash);
+}
+
+} // namespace
+
+CachedLayer::CachedLayer(int32_t zorder_min, int32_t zorder_max) : zorder_min{zorder_min}, zorder_max{zorder_max} {}
+
+auto CachedLayer::contains(const Sprite *sprite) const -> bool {
+  return sprite->is_static and sprite->zorder >= zorder_min and sprite->zorder <= zorder_max;
+}
+
+auto CachedLayer::invalidate() -> void {
+  valid = false;
+}
+
+auto CachedLayer::deinit() -> void {
+  target.delete_buffers();
+  target = {};
+  valid = false;
+}
+
+auto CachedLayer::needs_redraw(Camera2d *camera, uint64_t hash) -> bool {
+  const auto width = (int)camera->screen->render_width();
+  const auto height = (int)camera->screen->render_height();
+  return not valid or hash != members_hash or camera->view_projection != view_projection or
+         target.width != width or target.height != height;
+}
+
+auto CachedLayer::prepare_target(int width, int height) -> void {
+  if (target.width != width or target.height != height) {
+    target.delete_buffers();
+    target = graphics::make_render_target(width, height, false);
+  }
+}
+
+auto CachedLayer::texture() const -> TextureResource {
+  auto texture = TextureResource{};
+  texture.handle = target.color;
+  texture.width = target.width;
+  texture.height = target.height;
+  return texture;
+}
+
+auto CachedLayer::hash_member(uint64_t hash, const Sprite *sprite, const TextureResource *texture) -> uint64_t {
+  // the instance covers the transform, size, pivot, color, uv rect and palette row. the texture changes under the
+  // sprite when an async load finishes or a palette swap is loaded
+  hash = fnv1a(sprite, hash);
+  hash = fnv1a(make_sprite_instance(sprite, *texture, {}), hash);
+  hash = fnv1a(sprite->z, hash);
+  hash = fnv1a(sprite->material.program_handle(*texture), hash);
+  hash = fnv1a(texture->handle, hash);
+  hash = fnv1a(texture->mesh, hash);
+  return hash;
+}
+
+} // namespace rugame
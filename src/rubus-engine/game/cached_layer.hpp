@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <rubus-engine/graphics/graphics.hpp>
+#include "game.hpp"
+#include "resource.hpp"
+
+namespace rugame {
+
+// static sprites (Sprite::is_static) inside a zorder range are drawn once into an offscreen target
+// and composited as one screen sized quad. the cache is redrawn only when a member or its texture changes in a way
+// that shows, the members change, the camera moves, the screen is resized or a member is marked Sprite::dirty.
+// the composite replaces a run of members in the sorted order. when another sprite sorts between two members
+// (a dynamic sprite inside the zorder range, say) the layer is `interleaved` and its members are drawn one by one
+// that frame, so sprites keep their order at the cost of the cache.
+struct CachedLayer {
+  int32_t zorder_min = 0;
+  int32_t zorder_max = 0;
+
+  graphics::RenderTarget target;
+  bool valid = false;
+  uint64_t members_hash = 0;
+  glm::mat4 view_projection = glm::mat4{0.f};
+
+  std::vector<uint32_t> members; // render queue payload indices of this frame
+  size_t first_rank = 0;         // render queue positions of the first and last member
+  size_t last_rank = 0;
+  bool interleaved = false;
+  Sprite quad;
+  uint32_t redraws = 0;
+
+  CachedLayer() = default;
+  CachedLayer(int32_t zorder_min, int32_t zorder_max);
+
+  auto contains(const Sprite *sprite) const -> bool;
+  auto invalidate() -> void;
+  auto deinit() -> void;
+
+  auto needs_redraw(Camera2d *camera, uint64_t hash) -> bool;
+  auto prepare_target(int width, int height) -> void;
+  auto texture() const -> TextureResource;
+
+  // identifies the member and everything about it that is drawn: its instance, sort depth, program, texture and
+  // outline
+  static auto hash_member(uint64_t hash, const Sprite *sprite, const TextureResource *texture) -> uint64_t;
+};
+
+} // namespace rugame
@@ -0,0 +1,192 @@
+#include "cooked_texture.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "ktx2.hpp"
+#include "palette.hpp"
+#include "sprite_mesh.hpp"
+
+namespace rugame {
+
+namespace {
+
+constexpr auto level_alignment = size_t{64};
+
+auto align(size_t offset) -> size_t {
+  return (offset + level_alignment - 1) / level_alignment * level_alignment;
+}
+
+// halves each side (down to 1), the texels of odd edges are reused by the last column or row
+auto downsample(const std::vector<uint8_t> &src, int width, int height) -> std::vector<uint8_t> {
+  const auto out_width = std::max(width / 2, 1);
+  const auto out_height = std::max(height / 2, 1);
+  auto out = std::vector<uint8_t>((size_t)out_width * out_height * 4);
+  for (auto y = 0; y < out_height; ++y) {
+    const auto y0 = std::min(y * 2, height - 1);
+    const auto y1 = std::min(y * 2 + 1, height - 1);
+    for (auto x = 0; x < out_width; ++x) {
+      const auto x0 = std::min(x * 2, width - 1);
+      const auto x1 = std::min(x * 2 + 1, width - 1);
+      for (auto c = 0; c < 4; ++c) {
+        const auto texel = [&](int tx, int ty) { return (uint32_t)src[((size_t)ty * width + tx) * 4 + c]; };
+        const auto sum = texel(x0, y0) + texel(x1, y0) + texel(x0, y1) + texel(x1, y1);
+        out[((size_t)y * out_width + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+      }
+    }
+  }
+  return out;
+}
+
+// flipped so the first row is the bottom one, as the loader uploads it
+auto base_level(const uint8_t *rgba, int width, int height, bool premultiply) -> std::vector<uint8_t> {
+  const auto row_size = (size_t)width * 4;
+  auto level = std::vector<uint8_t>(row_size * height);
+  for (auto y = 0; y < height; ++y) {
+    std::memcpy(level.data() + (size_t)(height - 1 - y) * row_size, rgba + (size_t)y * row_size, row_size);
+  }
+  if (premultiply) {
+    for (auto i = size_t{}; i < level.size(); i += 4) {
+      for (auto c = 0; c < 3; ++c) {
+        level[i + c] = (uint8_t)((level[i + c] * level[i + 3] + 127) / 255);
+      }
+    }
+  }
+  return level;
+}
+
+} // namespace
+
+auto classify_texture_alpha(const uint8_t *rgba, int width, int height) -> TextureAlpha {
+  auto result = TextureAlpha::Opaque;
+  const auto texels = (size_t)width * (size_t)height;
+  for (auto i = size_t{}; i < texels; ++i) {
+    const auto a = rgba[i * 4 + 3];
+    if (a == 0) {
+      result = TextureAlpha::Cutout;
+    } else if (a != 255) {
+      return TextureAlpha::Translucent;
+    }
+  }
+  return result;
+}
+
+auto CookedTexture::level_data(size_t level) const -> const uint8_t * {
+  return (const uint8_t *)data.data() + levels[level].offset;
+}
+
+auto parse_cooked_texture(std::span<const std::byte> data) -> std::optional<CookedTexture> {
+  auto texture = CookedTexture{};
+  if (data.size() < sizeof(CookedTextureHeader)) {
+    return std::nullopt;
+  }
+  std::memcpy(&texture.header, data.data(), sizeof(CookedTextureHeader));
+  const auto &header = texture.header;
+  const auto table_size = (size_t)header.level_count * sizeof(CookedTextureLevel);
+  if (header.magic != cooked_texture_magic or header.version != cooked_texture_version or header.level_count == 0 or
+      sizeof(CookedTextureHeader) + table_size > data.size()) {
+    return std::nullopt;
+  }
+
+  texture.levels = {(const CookedTextureLevel *)(data.data() + sizeof(CookedTextureHeader)), header.level_count};
+  texture.data = data;
+  for (const auto &level : texture.levels) {
+    if (level.offset + level.size > data.size() or level.size != (uint64_t)level.width * level.height * 4) {
+      return std::nullopt;
+    }
+  }
+  if (texture.levels[0].width != header.width or texture.levels[0].height != header.height) {
+    return std::nullopt;
+  }
+
+  const auto outline_size = (uint64_t)header.outline_count * sizeof(glm::vec2);
+  if (header.outline_count > 0) {
+    if (header.outline_offset % alignof(glm::vec2) != 0 or header.outline_offset + outline_size > data.size()) {
+      return std::nullopt;
+    }
+    texture.outline = {(const glm::vec2 *)(data.data() + header.outline_offset), header.outline_count};
+  }
+  const auto colors_size = (uint64_t)header.palette_count * sizeof(uint32_t);
+  const auto indices_size = (uint64_t)header.width * header.height;
+  if (header.palette_count > 0) {
+    if (header.palette_count > (uint32_t)palette_size or header.palette_offset % alignof(uint32_t) != 0 or
+        header.palette_offset + colors_size + indices_size > data.size()) {
+      return std::nullopt;
+    }
+    texture.palette = {(const uint32_t *)(data.data() + header.palette_offset), header.palette_count};
+    texture.indices = {(const uint8_t *)(data.data() + header.palette_offset + colors_size), indices_size};
+  }
+  return texture;
+}
+
+auto cook_texture(const uint8_t *rgba, int width, int height, bool premultiply, uint32_t trim_vertices)
+  -> std::vector<std::byte> {
+  auto header = CookedTextureHeader{};
+  header.width = (uint32_t)width;
+  header.height = (uint32_t)height;
+  header.level_count = (uint32_t)std::bit_width((unsigned)std::max(width, height));
+  header.alpha = classify_texture_alpha(rgba, width, height);
+  header.premultiplied = premultiply;
+
+  // derived from the stored base level, flipped and premultiplied like the loader sees it
+  auto level = base_level(rgba, width, height, premultiply);
+  auto outline = std::vector<glm::vec2>{};
+  if (trim_vertices > 0 and header.alpha != TextureAlpha::Opaque) {
+    outline = trim_sprite_outline(level.data(), width, height, trim_vertices);
+  }
+  const auto indexed = index_image(level.data(), width, height);
+  header.outline_count = (uint32_t)outline.size();
+  header.palette_count = indexed.has_value() ? (uint32_t)indexed->palette.size() : 0;
+
+  auto levels = std::vector<CookedTextureLevel>(header.level_count);
+  header.outline_offset = sizeof(CookedTextureHeader) + levels.size() * sizeof(CookedTextureLevel);
+  auto out = std::vector<std::byte>(align(header.outline_offset + outline.size() * sizeof(glm::vec2)));
+  auto level_width = width;
+  auto level_height = height;
+  for (auto i = size_t{}; i < levels.size(); ++i) {
+    if (i > 0) {
+      level = downsample(level, level_width, level_height);
+      level_width = std::max(level_width / 2, 1);
+      level_height = std::max(level_height / 2, 1);
+    }
+    levels[i] = {out.size(), level.size(), (uint32_t)level_width, (uint32_t)level_height};
+    const auto bytes = std::as_bytes(std::span{level});
+    out.insert(out.end(), bytes.begin(), bytes.end());
+    out.resize(align(out.size()));
+  }
+  if (indexed.has_value()) {
+    header.palette_offset = out.size();
+    const auto palette = std::as_bytes(std::span{indexed->palette});
+    const auto indices = std::as_bytes(std::span{indexed->indices});
+    out.insert(out.end(), palette.begin(), palette.end());
+    out.insert(out.end(), indices.begin(), indices.end());
+  }
+
+  std::memcpy(out.data(), &header, sizeof(header));
+  std::memcpy(out.data() + sizeof(header), levels.data(), levels.size() * sizeof(CookedTextureLevel));
+  if (not outline.empty()) {
+    std::memcpy(out.data() + header.outline_offset, outline.data(), outline.size() * sizeof(glm::vec2));
+  }
+  return out;
+}
+
+auto cook_compressed_texture(const uint8_t *rgba, int width, int height, bool premultiply,
+                             TextureCompression compression) -> std::vector<std::byte> {
+  auto level = base_level(rgba, width, height, premultiply);
+  auto levels = std::vector<std::vector<std::byte>>(std::bit_width((unsigned)std::max(width, height)));
+  auto level_width = width;
+  auto level_height = height;
+  for (auto i = size_t{}; i < levels.size(); ++i) {
+    if (i > 0) {
+      level = downsample(level, level_width, level_height);
+      level_width = std::max(level_width / 2, 1);
+      level_height = std::max(level_height / 2, 1);
+    }
+    levels[i] = compress_texture_level(compression, level.data(), level_width, level_height);
+  }
+  return write_ktx2(compression, (uint32_t)width, (uint32_t)height, levels, classify_texture_alpha(rgba, width, height),
+                    premultiply);
+}
+
+} // namespace rugame
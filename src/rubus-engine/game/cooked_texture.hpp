@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "block_compression.hpp"
+
+namespace rugame {
+
+enum struct TextureAlpha : uint8_t {
+  Opaque,      // every texel is fully opaque
+  Cutout,      // every texel is fully opaque or fully transparent
+  Translucent, // has partially transparent texels, needs blending
+};
+
+auto classify_texture_alpha(const uint8_t *rgba, int width, int height) -> TextureAlpha;
+
+// cooked texture (.rtex): a header, the level table, the trimmed outline, then rgba8 levels from the base level
+// down to 1x1 and the palette indices of the base level. rows are stored from the bottom like the textures the gl
+// path uploads, every level and the palette start on a 64 byte boundary.
+constexpr auto cooked_texture_magic = uint32_t{0x58455452}; // "RTEX"
+constexpr auto cooked_texture_version = uint32_t{2};
+
+struct CookedTextureHeader {
+  uint32_t magic = cooked_texture_magic;
+  uint32_t version = cooked_texture_version;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t level_count = 0;
+  TextureAlpha alpha = TextureAlpha::Translucent;
+  bool premultiplied = false; // colors are multiplied by alpha, mips were filtered that way too
+  uint16_t reserved = 0;
+  uint32_t outline_count = 0;  // vertices of the trimmed outline (see trim_sprite_outline), 0 for the full quad
+  uint32_t palette_count = 0;  // colors of an image with few colors (see index_image), 0 when it has too many
+  uint64_t outline_offset = 0; // glm::vec2 vertices
+  uint64_t palette_offset = 0; // rgba8 colors followed by width x height indices
+};
+
+struct CookedTextureLevel {
+  uint64_t offset = 0; // from the start of the file
+  uint64_t size = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+// a cooked texture read in place, the levels point into `data`
+struct CookedTexture {
+  CookedTextureHeader header;
+  std::span<const CookedTextureLevel> levels;
+  std::span<const std::byte> data;
+  std::span<const glm::vec2> outline;
+  std::span<const uint32_t> palette;
+  std::span<const uint8_t> indices; // empty without a palette
+
+  auto level_data(size_t level) const -> const uint8_t *;
+};
+
+auto parse_cooked_texture(std::span<const std::byte> data) -> std::optional<CookedTexture>;
+
+// rgba8 with the first row at the top (as image files store them), the mips are 2x2 box filtered. the outline and
+// the palette are derived from the base level like the loader does for an image file, `trim_vertices` 0 trims nothing
+auto cook_texture(const uint8_t *rgba, int width, int height, bool premultiply, uint32_t trim_vertices)
+  -> std::vector<std::byte>;
+// the same levels block compressed into a ktx2 file (see parse_ktx2), lossy, for large images like backgrounds
+auto cook_compressed_texture(const uint8_t *rgba, int width, int height, bool premultiply,
+                             TextureCompression compression) -> std::vector<std::byte>;
+
+} // namespace rugame
@@ -1,80 +1,233 @@
 #include "game.hpp"
 
+#include <algorithm>
 #include <array>
 
 #include <glm/ext.hpp>
 
-#include <rubus-engine/utils/utils.hpp>
 #include <rubus-engine/graphics/graphics.hpp>
+#include <rubus-engine/graphics/state_cache.hpp>
+#include <rubus-engine/graphics/shader_cache.hpp>
 #include "resource.hpp"
 
 namespace rugame {
 
+auto Screen::is_virtual() const -> bool {
+  return virtual_width > 0 and virtual_height > 0;
+}
+
+auto Screen::update_letterbox() -> void {
+  if (not is_virtual()) {
+    scale = 1;
+    offset = {0, 0};
+    return;
+  }
+  // largest integer scale that fits, never below 1 so a tiny window still shows the image
+  auto scale_x = (int)width / virtual_width;
+  auto scale_y = (int)height / virtual_height;
+  scale = std::max(1, std::min(scale_x, scale_y));
+  offset.x = ((int)width - virtual_width * scale) / 2;
+  offset.y = ((int)height - virtual_height * scale) / 2;
+}
+
+auto Screen::render_width() const -> float {
+  return is_virtual() ? (float)virtual_width : width;
+}
+
+auto Screen::render_height() const -> float {
+  return is_virtual() ? (float)virtual_height : height;
+}
+
+auto Screen::view_width() const -> float {
+  return is_virtual() ? (float)virtual_width * pixel_size : width;
+}
+
+auto Screen::view_height() const -> float {
+  return is_virtual() ? (float)virtual_height * pixel_size : height;
+}
+
+auto Screen::window_to_render(glm::vec2 window_pos) const -> glm::vec2 {
+  if (not is_virtual()) {
+    return window_pos;
+  }
+  return (window_pos - glm::vec2{offset}) / (float)scale;
+}
+
+auto Screen::render_to_window(glm::vec2 render_pos) const -> glm::vec2 {
+  if (not is_virtual()) {
+    return render_pos;
+  }
+  return render_pos * (float)scale + glm::vec2{offset};
+}
+
 Camera2d::Camera2d(Screen *screen, glm::vec3 position) : screen{screen}, position{position} {}
 
 auto Camera2d::update() -> void {
-  auto screen_left = -screen->width / 2.f;
-  auto screen_right = +screen->width / 2.f;
-  auto screen_bottom = -screen->height / 2.f;
-  auto screen_top = +screen->height / 2.f;
+  if (dirty or position != last_position or *screen != last_screen) {
+    rebuild();
+  }
+
+  // upload once per change, shaders read it through the "Camera" uniform block
+  if (uniform_buffer == 0) {
+    uniform_buffer = graphics::make_uniform_buffer(sizeof(CameraUniforms));
+    uploaded = nullptr;
+  }
+  if (uploaded != this) {
+    auto uniforms = CameraUniforms{projection, view, view_projection};
+    graphics::update_uniform_buffer(uniform_buffer, graphics::camera_uniform_binding,
+                                    std::as_bytes(std::span{&uniforms, 1}));
+    uploaded = this;
+  }
+}
+
+auto Camera2d::rebuild() -> void {
+  auto screen_left = -screen->view_width() / 2.f;
+  auto screen_right = +screen->view_width() / 2.f;
+  auto screen_bottom = -screen->view_height() / 2.f;
+  auto screen_top = +screen->view_height() / 2.f;
   projection = glm::ortho(screen_left, screen_right, screen_bottom, screen_top, 0.1f, 100.0f);
 
   auto camera_target = position - glm::vec3{0.f, 0.f, 1.f};
   view = glm::lookAt(position, camera_target, {0.f, 1.f, 0.f});
+  view_projection = projection * view;
+  inverse_view_projection = glm::inverse(view_projection);
+
+  // world -> ndc, z = 0 and w = 1 for an orthographic camera
+  const auto &vp = view_projection;
+  auto world_to_ndc = glm::mat3{{vp[0][0], vp[0][1], 0.f}, {vp[1][0], vp[1][1], 0.f}, {vp[3][0], vp[3][1], 1.f}};
+
+  // ndc -> render target pixels, y down
+  const auto half_width = screen->render_width() / 2.f;
+  const auto half_height = screen->render_height() / 2.f;
+  auto ndc_to_render = glm::mat3{{half_width, 0.f, 0.f}, {0.f, -half_height, 0.f}, {half_width, half_height, 1.f}};
+
+  // render target -> window, the integer upscale and letterbox of pixel perfect mode
+  auto render_to_window = glm::mat3{1.f};
+  if (screen->is_virtual()) {
+    const auto scale = (float)screen->scale;
+    render_to_window = {{scale, 0.f, 0.f}, {0.f, scale, 0.f}, {(float)screen->offset.x, (float)screen->offset.y, 1.f}};
+  }
+
+  world_to_screen = render_to_window * ndc_to_render * world_to_ndc;
+  screen_to_world = glm::inverse(world_to_screen);
+
+  dirty = false;
+  last_position = position;
+  last_screen = *screen;
+  uploaded = nullptr;
+}
+
+auto Camera2d::deinit() -> void {
+  graphics::delete_uniform_buffer(uniform_buffer);
+  uniform_buffer = 0;
+  uploaded = nullptr;
 }
 
 auto Camera2d::world_to_screen_space(glm::mat4 world_transform) -> glm::vec2 {
-  return graphics::world_to_screen_space(screen->width, screen->height, projection * view * world_transform);
+  // window coordinates, in pixel perfect mode mapped through the upscaled virtual target
+  return glm::vec2{world_to_screen * glm::vec3{world_transform[3].x, world_transform[3].y, 1.f}};
 }
 
-auto Camera2d::screen_to_world_space(glm::vec2 screen_pos) -> glm::vec2 {
-  return graphics::screen_to_world_space(screen->width, screen->height, projection * view, screen_pos);
+auto Camera2d::world_to_screen_space(const Affine2d &world_transform) -> glm::vec2 {
+  return glm::vec2{world_to_screen * glm::vec3{world_transform.translation, 1.f}};
 }
 
-SpriteMaterial::SpriteMaterial(std::string texture) : texture{std::move(texture)} {}
+auto Camera2d::screen_to_world_space(glm::vec2 screen_pos) -> glm::vec2 {
+  return glm::vec2{screen_to_world * glm::vec3{screen_pos, 1.f}};
+}
 
-auto SpriteMaterial::init() -> void {
-  auto vert_shader_str = utils::read_file("shaders/sprite/vert.glsl");
-  auto frag_shader_str = utils::read_file("shaders/sprite/frag.glsl");
+auto Camera2d::world_to_screen_space(std::span<const glm::vec2> world_pos, std::span<glm::vec2> screen_pos) -> void {
+  graphics::transform_points(world_to_screen, world_pos, screen_pos);
+}
 
-  auto vert_shader_src = std::array{vert_shader_str.c_str()};
-  auto frag_shader_src = std::array{frag_shader_str.c_str()};
+auto Camera2d::screen_to_world_space(std::span<const glm::vec2> screen_pos, std::span<glm::vec2> world_pos) -> void {
+  graphics::transform_points(screen_to_world, screen_pos, world_pos);
+}
 
-  auto vert_shader = graphics::compile_shader(GL_VERTEX_SHADER, vert_shader_src);
-  auto frag_shader = graphics::compile_shader(GL_FRAGMENT_SHADER, frag_shader_src);
+SpriteMaterial::SpriteMaterial(std::string texture) : texture{std::move(texture)} {}
 
-  shader = graphics::link_shaders({vert_shader, frag_shader});
+auto SpriteMaterial::init() -> void {
+  if (program.handle != 0) {
+    return;
+  }
+
+  // compiled once (or loaded from the binary cache) and kept for the life of the process. every sprite program,
+  // the SpriteCuller one included, goes through a single load_all so the driver compiles them in parallel
+  const auto descs = std::array{
+    graphics::ProgramDesc{
+      .name = "sprite",
+      .stages = {{GL_VERTEX_SHADER, "shaders/sprite/vert.glsl"}, {GL_FRAGMENT_SHADER, "shaders/sprite/frag.glsl"}},
+    },
+    graphics::ProgramDesc{
+      .name = "sprite_sdf",
+      .stages = {{GL_VERTEX_SHADER, "shaders/sprite/vert.glsl"},
+                 {GL_FRAGMENT_SHADER, "shaders/sprite/sdf_frag.glsl"}},
+    },
+    graphics::ProgramDesc{
+      .name = "sprite_palette",
+      .stages = {{GL_VERTEX_SHADER, "shaders/sprite/vert.glsl"},
+                 {GL_FRAGMENT_SHADER, "shaders/sprite/palette_frag.glsl"}},
+    },
+    graphics::ProgramDesc{
+      .name = "sprite_cull",
+      .stages = {{GL_COMPUTE_SHADER, "shaders/sprite/cull.glsl"}},
+    },
+  };
+  graphics::ShaderCache::load_all(descs);
+
+  auto sprite_program = graphics::ShaderCache::get("sprite");
+  auto sdf_sprite_program = graphics::ShaderCache::get("sprite_sdf");
+  auto palette_sprite_program = graphics::ShaderCache::get("sprite_palette");
+  if (sprite_program == nullptr or sdf_sprite_program == nullptr or palette_sprite_program == nullptr) {
+    return;
+  }
+  program = *sprite_program;
+  program.bind_uniform_block("Camera", graphics::camera_uniform_binding);
+  sdf_program = *sdf_sprite_program;
+  sdf_program.bind_uniform_block("Camera", graphics::camera_uniform_binding);
+  palette_program = *palette_sprite_program;
+  palette_program.bind_uniform_block("Camera", graphics::camera_uniform_binding);
 }
 
 auto SpriteMaterial::deinit() -> void {
-  glDeleteProgram(shader);
+  // the program itself is owned by graphics::ShaderCache
+  program = {};
+  sdf_program = {};
+  palette_program = {};
 }
 
-auto SpriteMaterial::bind() -> void {
-  auto texture_res = ResourceManager::texture2d.at(texture);
-  glUseProgram(shader);
-  glBindTexture(GL_TEXTURE_2D, texture_res.handle);
+auto SpriteMaterial::program_handle(const TextureResource &texture_res) const -> uint32_t {
+  if (shader == SpriteShader::Sdf) {
+    return sdf_program.handle;
+  }
+  return texture_res.palette >= 0 ? palette_program.handle : program.handle;
 }
 
-auto SpriteMaterial::unbind() -> void {
-  glUseProgram(0);
-  glBindTexture(GL_TEXTURE_2D, 0);
+auto SpriteMaterial::palette_row(const TextureResource &texture_res) const -> int32_t {
+  if (not palette.empty() and texture_res.palette >= 0) {
+    if (auto swap = ResourceManager::palette_swaps.find(palette); swap != ResourceManager::palette_swaps.end()) {
+      return swap->second;
+    }
+  }
+  return texture_res.palette;
 }
 
-Sprite::Sprite(glm::vec2 pivot, float width, float height, SpriteMaterial material) : material{std::move(material)} {
-  mesh = graphics::make_quad_mesh(pivot, width, height);
+auto SpriteMaterial::bind() -> void {
+  auto texture_res = ResourceManager::texture2d.at(texture);
+  graphics::StateCache::use_program(program_handle(texture_res));
+  graphics::StateCache::bind_texture(0, texture_res.handle);
+  if (texture_res.palette >= 0) {
+    graphics::StateCache::bind_texture(palette_texture_unit, ResourceManager::palettes.handle);
+  }
 }
 
-Sprite::~Sprite() {
-  mesh.delete_buffers();
+auto SpriteMaterial::unbind() -> void {
+  graphics::StateCache::use_program(0);
+  graphics::StateCache::bind_texture(0, 0);
+  graphics::StateCache::bind_texture(palette_texture_unit, 0);
 }
 
-auto Sprite::draw(Camera2d *camera) -> void {
-  material.bind();
-  auto mvp = camera->projection * camera->view * transform;
-  graphics::set_uniform_mat4f(material.shader, "mvp", glm::value_ptr(mvp));
-  graphics::draw_quad(mesh.vao);
-  material.unbind();
-}
+Sprite::Sprite(glm::vec2 pivot, float width, float height, SpriteMaterial material)
+    : pivot{pivot}, width{width}, height{height}, material{std::move(material)} {}
 
 } // namespace rugame
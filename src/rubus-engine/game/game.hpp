@@ -1,36 +1,106 @@
 #pragma once
 
+#include <span>
 #include <string>
 
 #include <glm/glm.hpp>
 
 #include <rubus-engine/graphics/graphics.hpp>
+#include <rubus-engine/graphics/shader_program.hpp>
+#include "affine2d.hpp"
 
 namespace rugame {
 
+struct TextureResource;
+
 struct Screen {
   float width = 0;
   float height = 0;
+
+  // pixel perfect mode, enabled when virtual_width/height are set. the sprite pass renders at the
+  // virtual resolution and is upscaled to the window by an integer factor with letterbox bars.
+  int virtual_width = 0;
+  int virtual_height = 0;
+  float pixel_size = 1.f; // world units per virtual pixel
+  int scale = 1;
+  glm::ivec2 offset = {0, 0}; // top left corner of the upscaled image in the window
+
+  auto is_virtual() const -> bool;
+  auto update_letterbox() -> void;
+
+  // size of the sprite pass target in pixels
+  auto render_width() const -> float;
+  auto render_height() const -> float;
+
+  // size of the visible world in world units
+  auto view_width() const -> float;
+  auto view_height() const -> float;
+
+  auto window_to_render(glm::vec2 window_pos) const -> glm::vec2;
+  auto render_to_window(glm::vec2 render_pos) const -> glm::vec2;
+
+  auto operator==(const Screen &) const -> bool = default;
+};
+
+// std140 layout of the "Camera" uniform block
+struct CameraUniforms {
+  glm::mat4 projection;
+  glm::mat4 view;
+  glm::mat4 view_projection;
 };
 
 struct Camera2d {
+  // shared by every camera, only rewritten when another camera was uploaded last or the matrices changed
+  inline static uint32_t uniform_buffer = 0;
+  inline static const Camera2d *uploaded = nullptr;
+
   Screen *screen;
   glm::mat4 projection;
   glm::mat4 view;
+  glm::mat4 view_projection;
+  glm::mat4 inverse_view_projection;
+
+  // 2d affine maps between the world and window pixels, through the virtual target in pixel perfect mode
+  glm::mat3 world_to_screen;
+  glm::mat3 screen_to_world;
 
   glm::vec3 position;
 
+  // the matrices are rebuilt only when the position or the screen changed since the last update
+  bool dirty = true;
+  glm::vec3 last_position = {0.f, 0.f, 0.f};
+  Screen last_screen;
+
   Camera2d() = default;
   Camera2d(Screen *screen, glm::vec3 position);
 
+  static auto deinit() -> void;
+
   auto update() -> void;
   auto world_to_screen_space(glm::mat4 world_transform) -> glm::vec2;
+  auto world_to_screen_space(const Affine2d &world_transform) -> glm::vec2;
   auto screen_to_world_space(glm::vec2 screen_pos) -> glm::vec2;
+
+  // one matrix setup for any number of points, `out` must hold as many points as `in`
+  auto world_to_screen_space(std::span<const glm::vec2> world_pos, std::span<glm::vec2> screen_pos) -> void;
+  auto screen_to_world_space(std::span<const glm::vec2> screen_pos, std::span<glm::vec2> world_pos) -> void;
+
+private:
+  auto rebuild() -> void;
+};
+
+enum struct SpriteShader : uint8_t {
+  Default, // index textures (TextureResource::palette) are looked up in their palette
+  Sdf,     // the texture is a distance field (rugame::SdfFont), drawn in the sprite color with smooth edges
 };
 
 struct SpriteMaterial {
-  inline static uint32_t shader = 0;
+  inline static graphics::ShaderProgram program;
+  inline static graphics::ShaderProgram sdf_program;
+  inline static graphics::ShaderProgram palette_program;
   std::string texture = "";
+  SpriteShader shader = SpriteShader::Default;
+  std::string palette = ""; // a ResourceManager palette swap of an index texture, its own palette if empty
 
   SpriteMaterial() = default;
   SpriteMaterial(std::string texture);
@@ -38,22 +108,30 @@ struct SpriteMaterial {
   static auto init() -> void;
   static auto deinit() -> void;
 
+  auto program_handle(const TextureResource &texture_res) const -> uint32_t;
+  auto palette_row(const TextureResource &texture_res) const -> int32_t; // -1 for rgba textures
   auto bind() -> void;
   auto unbind() -> void;
 };
 
 struct Sprite {
-  glm::mat4 transform = glm::mat4{1.f};
+  Affine2d transform;
+  float z = 0.f; // sort depth within a zorder
+  uint8_t layer = 0;
   int32_t zorder = 0;
+  bool is_static = false; // never moves, may be drawn through a rugame::CachedLayer
+  bool dirty = false;     // forces its CachedLayer to redraw and is cleared there, changes to the sprite are detected
+
+  glm::vec2 pivot = {0.5f, 0.5f};
+  float width = 0;
+  float height = 0;
+  glm::vec4 uv_rect = {0.f, 0.f, 1.f, 1.f};
+  uint32_t color = 0xffffffff; // rgba8, r in the low byte, only the sdf shader reads it
 
-  graphics::Mesh mesh;
   SpriteMaterial material;
 
   Sprite() = default;
   Sprite(glm::vec2 pivot, float width, float height, SpriteMaterial material);
-  ~Sprite();
-
-  auto draw(Camera2d *camera) -> void;
 };
 
 } // namespace rugame
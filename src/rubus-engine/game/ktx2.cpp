@@ -0,0 +1,274 @@
+#include "ktx2.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string_view>
+
+namespace rugame {
+
+namespace {
+
+constexpr auto ktx2_identifier =
+  std::array<uint8_t, 12>{0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n'};
+
+struct Ktx2Header {
+  std::array<uint8_t, 12> identifier = ktx2_identifier;
+  uint32_t vk_format = 0;
+  uint32_t type_size = 1;
+  uint32_t pixel_width = 0;
+  uint32_t pixel_height = 0;
+  uint32_t pixel_depth = 0;
+  uint32_t layer_count = 0;
+  uint32_t face_count = 1;
+  uint32_t level_count = 0;
+  uint32_t supercompression_scheme = 0;
+  uint32_t dfd_offset = 0;
+  uint32_t dfd_size = 0;
+  uint32_t kvd_offset = 0;
+  uint32_t kvd_size = 0;
+  uint64_t sgd_offset = 0;
+  uint64_t sgd_size = 0;
+};
+static_assert(sizeof(Ktx2Header) == 80);
+
+struct Ktx2LevelIndex {
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  uint64_t uncompressed_size = 0;
+};
+
+// VkFormat values, the srgb ones are sampled as unorm like every other engine texture
+constexpr auto vk_format_bc3_unorm = uint32_t{137};
+constexpr auto vk_format_bc3_srgb = uint32_t{138};
+constexpr auto vk_format_bc7_unorm = uint32_t{145};
+constexpr auto vk_format_bc7_srgb = uint32_t{146};
+constexpr auto vk_format_etc2_rgba8_unorm = uint32_t{151};
+constexpr auto vk_format_etc2_rgba8_srgb = uint32_t{152};
+
+// khr data format descriptor values for the basic descriptor block
+constexpr auto dfd_model_bc3 = uint8_t{130};
+constexpr auto dfd_model_bc7 = uint8_t{134};
+constexpr auto dfd_model_etc2 = uint8_t{161};
+constexpr auto dfd_primaries_bt709 = uint8_t{1};
+constexpr auto dfd_transfer_linear = uint8_t{1};
+constexpr auto dfd_flag_premultiplied = uint8_t{1};
+constexpr auto dfd_channel_alpha = uint8_t{15}; // bc3 and etc2 alpha
+constexpr auto dfd_channel_etc2_color = uint8_t{2};
+
+auto to_compression(uint32_t vk_format) -> TextureCompression {
+  switch (vk_format) {
+  case vk_format_bc7_unorm:
+  case vk_format_bc7_srgb:
+    return TextureCompression::Bc7;
+  case vk_format_bc3_unorm:
+  case vk_format_bc3_srgb:
+    return TextureCompression::Bc3;
+  case vk_format_etc2_rgba8_unorm:
+  case vk_format_etc2_rgba8_srgb:
+    return TextureCompression::Etc2;
+  default:
+    return TextureCompression::None;
+  }
+}
+
+auto to_vk_format(TextureCompression compression) -> uint32_t {
+  switch (compression) {
+  case TextureCompression::Bc7:
+    return vk_format_bc7_unorm;
+  case TextureCompression::Bc3:
+    return vk_format_bc3_unorm;
+  case TextureCompression::Etc2:
+    return vk_format_etc2_rgba8_unorm;
+  default:
+    return 0;
+  }
+}
+
+auto alpha_name(TextureAlpha alpha) -> std::string_view {
+  switch (alpha) {
+  case TextureAlpha::Opaque:
+    return "opaque";
+  case TextureAlpha::Cutout:
+    return "cutout";
+  default:
+    return "translucent";
+  }
+}
+
+auto align(size_t offset, size_t alignment) -> size_t {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+auto append(std::vector<std::byte> &out, const T &value) -> void {
+  const auto offset = out.size();
+  out.resize(offset + sizeof(T));
+  std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+// one basic descriptor block, a sample per 64 bit half of the block (alpha first) or one for all 128 bits
+auto data_format_descriptor(TextureCompression compression, bool premultiplied) -> std::vector<std::byte> {
+  struct Sample {
+    uint16_t bit_offset = 0;
+    uint8_t bit_length = 0; // minus one
+    uint8_t channel = 0;
+    std::array<uint8_t, 4> position = {};
+    uint32_t lower = 0;
+    uint32_t upper = 0xffffffff;
+  };
+  auto model = uint8_t{};
+  auto samples = std::vector<Sample>{};
+  switch (compression) {
+  case TextureCompression::Bc7:
+    model = dfd_model_bc7;
+    samples = {{.bit_offset = 0, .bit_length = 127, .channel = 0}};
+    break;
+  case TextureCompression::Bc3:
+    model = dfd_model_bc3;
+    samples = {{.bit_offset = 0, .bit_length = 63, .channel = dfd_channel_alpha},
+               {.bit_offset = 64, .bit_length = 63, .channel = 0}};
+    break;
+  default:
+    model = dfd_model_etc2;
+    samples = {{.bit_offset = 0, .bit_length = 63, .channel = dfd_channel_alpha},
+               {.bit_offset = 64, .bit_length = 63, .channel = dfd_channel_etc2_color}};
+    break;
+  }
+
+  const auto block_size = (uint16_t)(24 + samples.size() * sizeof(Sample));
+  auto out = std::vector<std::byte>{};
+  append(out, uint32_t{4} + block_size);
+  append(out, uint32_t{0}); // khronos vendor, basic descriptor type
+  append(out, uint16_t{2}); // version
+  append(out, block_size);
+  append(out, std::array<uint8_t, 4>{model, dfd_primaries_bt709, dfd_transfer_linear,
+                                     premultiplied ? dfd_flag_premultiplied : uint8_t{}});
+  append(out, std::array<uint8_t, 4>{3, 3, 0, 0}); // 4x4 texel blocks
+  append(out, std::array<uint8_t, 8>{(uint8_t)texture_block_size});
+  for (const auto &sample : samples) {
+    append(out, sample);
+  }
+  return out;
+}
+
+auto key_value_data(TextureAlpha alpha) -> std::vector<std::byte> {
+  // sorted by key, values are nul terminated strings
+  const auto entries = std::array<std::pair<std::string_view, std::string_view>, 3>{{
+    {"KTXorientation", "ru"},
+    {"KTXwriter", "rubus-cook"},
+    {"rubus.alpha", alpha_name(alpha)},
+  }};
+  auto out = std::vector<std::byte>{};
+  for (const auto &[key, value] : entries) {
+    append(out, (uint32_t)(key.size() + 1 + value.size() + 1));
+    for (const auto string : {key, value}) {
+      const auto bytes = std::as_bytes(std::span{string});
+      out.insert(out.end(), bytes.begin(), bytes.end());
+      out.push_back(std::byte{});
+    }
+    out.resize(align(out.size(), 4));
+  }
+  return out;
+}
+
+} // namespace
+
+auto parse_ktx2(std::span<const std::byte> data) -> std::optional<Ktx2Texture> {
+  auto header = Ktx2Header{};
+  if (data.size() < sizeof(Ktx2Header)) {
+    return std::nullopt;
+  }
+  std::memcpy(&header, data.data(), sizeof(Ktx2Header));
+  const auto level_count = std::max(header.level_count, uint32_t{1});
+  const auto index_size = (size_t)level_count * sizeof(Ktx2LevelIndex);
+  if (header.identifier != ktx2_identifier or header.pixel_width == 0 or header.pixel_height == 0 or
+      header.pixel_depth != 0 or header.layer_count > 1 or header.face_count != 1 or
+      header.supercompression_scheme != 0 or sizeof(Ktx2Header) + index_size > data.size()) {
+    return std::nullopt;
+  }
+
+  auto texture = Ktx2Texture{};
+  texture.compression = to_compression(header.vk_format);
+  texture.width = header.pixel_width;
+  texture.height = header.pixel_height;
+  if (texture.compression == TextureCompression::None) {
+    return std::nullopt;
+  }
+
+  for (auto i = uint32_t{}; i < level_count; ++i) {
+    auto index = Ktx2LevelIndex{};
+    std::memcpy(&index, data.data() + sizeof(Ktx2Header) + i * sizeof(Ktx2LevelIndex), sizeof(Ktx2LevelIndex));
+    const auto width = std::max(texture.width >> i, uint32_t{1});
+    const auto height = std::max(texture.height >> i, uint32_t{1});
+    if (index.offset + index.size > data.size() or index.size != compressed_level_size((int)width, (int)height)) {
+      return std::nullopt;
+    }
+    texture.levels.push_back({data.subspan(index.offset, index.size), width, height});
+  }
+
+  if (header.dfd_size >= 4 + 24 and (size_t)header.dfd_offset + header.dfd_size <= data.size()) {
+    const auto flags = (uint8_t)data[header.dfd_offset + 4 + 8 + 3];
+    texture.premultiplied = (flags & dfd_flag_premultiplied) != 0;
+  }
+
+  if ((size_t)header.kvd_offset + header.kvd_size <= data.size()) {
+    const auto kvd = data.subspan(header.kvd_offset, header.kvd_size);
+    for (auto offset = size_t{}; offset + 4 <= kvd.size();) {
+      auto size = uint32_t{};
+      std::memcpy(&size, kvd.data() + offset, 4);
+      if (offset + 4 + size > kvd.size()) {
+        break;
+      }
+      const auto entry = std::string_view{(const char *)kvd.data() + offset + 4, size};
+      const auto key = entry.substr(0, entry.find('\0'));
+      const auto value = entry.substr(std::min(key.size() + 1, entry.size()));
+      if (key == "KTXorientation") {
+        texture.bottom_up = value.starts_with("ru");
+      } else if (key == "rubus.alpha") {
+        for (const auto alpha : {TextureAlpha::Opaque, TextureAlpha::Cutout, TextureAlpha::Translucent}) {
+          if (value.starts_with(alpha_name(alpha))) {
+            texture.alpha = alpha;
+          }
+        }
+      }
+      offset = align(offset + 4 + size, 4);
+    }
+  }
+  return texture;
+}
+
+auto write_ktx2(TextureCompression compression, uint32_t width, uint32_t height,
+                std::span<const std::vector<std::byte>> levels, TextureAlpha alpha, bool premultiplied)
+  -> std::vector<std::byte> {
+  const auto dfd = data_format_descriptor(compression, premultiplied);
+  const auto kvd = key_value_data(alpha);
+
+  auto header = Ktx2Header{};
+  header.vk_format = to_vk_format(compression);
+  header.pixel_width = width;
+  header.pixel_height = height;
+  header.level_count = (uint32_t)levels.size();
+  header.dfd_offset = (uint32_t)(sizeof(Ktx2Header) + levels.size() * sizeof(Ktx2LevelIndex));
+  header.dfd_size = (uint32_t)dfd.size();
+  header.kvd_offset = header.dfd_offset + header.dfd_size;
+  header.kvd_size = (uint32_t)kvd.size();
+
+  auto out = std::vector<std::byte>(header.kvd_offset);
+  out.insert(out.end(), kvd.begin(), kvd.end());
+  std::copy(dfd.begin(), dfd.end(), out.begin() + header.dfd_offset);
+
+  // levels are stored from the smallest up, each aligned to the block size
+  auto index = std::vector<Ktx2LevelIndex>(levels.size());
+  for (auto i = levels.size(); i-- > 0;) {
+    out.resize(align(out.size(), texture_block_size));
+    index[i] = {out.size(), levels[i].size(), levels[i].size()};
+    out.insert(out.end(), levels[i].begin(), levels[i].end());
+  }
+
+  std::memcpy(out.data(), &header, sizeof(header));
+  std::memcpy(out.data() + sizeof(header), index.data(), index.size() * sizeof(Ktx2LevelIndex));
+  return out;
+}
+
+} // namespace rugame
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "block_compression.hpp"
+#include "cooked_texture.hpp"
+
+namespace rugame {
+
+// khronos texture 2 (.ktx2) holding one of the block compressed formats. only what the cooker writes is read:
+// a 2d texture with one layer and one face and no supercompression
+struct Ktx2Level {
+  std::span<const std::byte> data;
+  uint32_t width = 0;
+  uint32_t height = 0;
+};
+
+// a ktx2 texture read in place, the levels point into the parsed data
+struct Ktx2Texture {
+  TextureCompression compression = TextureCompression::None;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<Ktx2Level> levels; // the base level first
+  bool bottom_up = false;        // KTXorientation "ru", the first row is the bottom one as gl uploads them
+  TextureAlpha alpha = TextureAlpha::Translucent; // the "rubus.alpha" key, translucent without it
+  bool premultiplied = false;                     // the premultiplied flag of the data format descriptor
+};
+
+auto parse_ktx2(std::span<const std::byte> data) -> std::optional<Ktx2Texture>;
+
+// the compressed levels from the base down, with their rows from the bottom
+auto write_ktx2(TextureCompression compression, uint32_t width, uint32_t height,
+                std::span<const std::vector<std::byte>> levels, TextureAlpha alpha, bool premultiplied)
+  -> std::vector<std::byte>;
+
+} // namespace rugame
@@ -0,0 +1,119 @@
+#include "palette.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/state_cache.hpp>
+#include <rubus-engine/graphics/upload_ring.hpp>
+
+namespace rugame {
+
+auto index_image(const uint8_t *rgba, int width, int height) -> std::optional<IndexedImage> {
+  auto image = IndexedImage{};
+  image.indices.resize((size_t)width * height);
+  image.palette = {0};
+  auto lookup = std::unordered_map<uint32_t, uint8_t>{{0, 0}};
+  for (auto i = size_t{}; i < image.indices.size(); ++i) {
+    auto color = uint32_t{};
+    std::memcpy(&color, rgba + i * 4, 4);
+    // the color of invisible texels never shows
+    if ((color >> 24) == 0) {
+      color = 0;
+    }
+    auto [it, inserted] = lookup.try_emplace(color, (uint8_t)image.palette.size());
+    if (inserted) {
+      if (image.palette.size() == palette_size) {
+        return std::nullopt;
+      }
+      image.palette.push_back(color);
+    }
+    image.indices[i] = it->second;
+  }
+  return image;
+}
+
+auto PaletteTable::add(std::span<const uint32_t> colors) -> std::optional<int32_t> {
+  init();
+  const auto free = std::find(used.begin(), used.end(), false);
+  if (free == used.end()) {
+    std::cerr << std::format("Error: the palette table is full ({} palettes)\n", capacity);
+    return std::nullopt;
+  }
+  const auto row = (int32_t)(free - used.begin());
+  used[row] = true;
+
+  // unused entries stay transparent
+  rows[row].fill(0);
+  std::copy_n(colors.begin(), std::min(colors.size(), (size_t)palette_size), rows[row].begin());
+  upload(row);
+  return row;
+}
+
+auto PaletteTable::add_swap(int32_t row, std::span<const std::pair<uint32_t, uint32_t>> recolor)
+  -> std::optional<int32_t> {
+  if (row < 0 or (size_t)row >= used.size() or not used[row]) {
+    return std::nullopt;
+  }
+  auto colors = rows[row];
+  for (auto &color : colors) {
+    for (const auto &[from, to] : recolor) {
+      if (color == from) {
+        color = to;
+        break;
+      }
+    }
+  }
+  return add(colors);
+}
+
+auto PaletteTable::release(int32_t row) -> void {
+  if (row < 0 or (size_t)row >= used.size()) {
+    return;
+  }
+  used[row] = false;
+}
+
+auto PaletteTable::clear() -> void {
+  if (handle != 0) {
+    graphics::StateCache::forget_texture(handle);
+    graphics::Device::current().delete_texture(handle);
+    handle = 0;
+  }
+  rows.clear();
+  used.clear();
+}
+
+auto PaletteTable::row_count() const -> size_t {
+  return (size_t)std::count(used.begin(), used.end(), true);
+}
+
+auto PaletteTable::init() -> void {
+  if (handle != 0) {
+    return;
+  }
+  rows.resize(capacity);
+  used.assign(capacity, false);
+
+  // fetched by texel coordinates, never filtered
+  auto &device = graphics::Device::current();
+  handle = device.create_texture();
+  device.texture_parameter(handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  device.texture_parameter(handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  device.texture_parameter(handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  device.texture_parameter(handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  device.texture_storage(handle, 1, GL_RGBA8, palette_size, capacity);
+}
+
+auto PaletteTable::upload(int32_t row) -> void {
+  auto &device = graphics::Device::current();
+  device.pixel_store(GL_UNPACK_ALIGNMENT, 1);
+  graphics::upload_texture_sub_image(handle, 0, 0, row, palette_size, 1, GL_RGBA, GL_UNSIGNED_BYTE, rows[row].data());
+}
+
+} // namespace rugame
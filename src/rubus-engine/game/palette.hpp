@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace rugame {
+
+constexpr auto palette_size = 256;        // colors of one palette, every value of an index texel
+constexpr auto palette_texture_unit = 1u; // the sprite palette shader reads the table from this unit
+
+// an image with few colors split into one index per texel and its colors (rgba8, r in the low byte). index 0 is
+// always fully transparent and shared by every invisible texel, so cleared or border texels stay invisible
+struct IndexedImage {
+  std::vector<uint8_t> indices;
+  std::vector<uint32_t> palette;
+};
+
+// nullopt if the image has more than palette_size colors, transparent included
+auto index_image(const uint8_t *rgba, int width, int height) -> std::optional<IndexedImage>;
+
+// every palette of the index textures and their swaps as the rows of one rgba8 texture, so sprites with different
+// palettes still share a draw call. the sprite shader fetches row params.w at the column of the index texel
+struct PaletteTable {
+  int capacity = 256; // rows
+  uint32_t handle = 0;
+  std::vector<std::array<uint32_t, palette_size>> rows; // kept for swaps
+  std::vector<bool> used;
+
+  auto add(std::span<const uint32_t> colors) -> std::optional<int32_t>;
+  // a copy of `row` with every color of `recolor` (from, to) replaced
+  auto add_swap(int32_t row, std::span<const std::pair<uint32_t, uint32_t>> recolor) -> std::optional<int32_t>;
+  auto release(int32_t row) -> void;
+  auto clear() -> void;
+
+  auto row_count() const -> size_t; // live rows
+
+private:
+  auto init() -> void;
+  auto upload(int32_t row) -> void;
+};
+
+} // namespace rugame
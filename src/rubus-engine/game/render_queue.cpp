@@ -0,0 +1,124 @@
+#include "render_queue.hpp"
+
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <iostream>
+
+namespace rugame {
+
+auto RenderQueue::make_key(uint8_t layer, int32_t zorder, uint32_t shader, uint32_t texture, float depth)
+  -> uint64_t {
+  // saturated values still sort after (or before) every value in range, but tie with each other. the key is made
+  // for every sprite of every frame, so only the first one of a queue is printed
+  if (layer > max_layer or zorder < min_zorder or zorder > max_zorder) {
+    stats.clamped += 1;
+    if (not reported_clamped) {
+      std::cerr << std::format("Error: sprite layer {} or zorder {} is out of range (layer 0..{}, zorder {}..{}), "
+                               "it is clamped and may be drawn out of order\n",
+                               layer, zorder, max_layer, min_zorder, max_zorder);
+      reported_clamped = true;
+    }
+  }
+  const auto layer_clamped = (uint64_t)std::min(layer, max_layer);
+  // bias the signed zorder so negative values sort first
+  const auto zorder_biased = (uint64_t)(std::clamp(zorder, min_zorder, max_zorder) - min_zorder);
+
+  // order preserving float bits: flip every bit of negatives, only the sign bit of positives
+  auto depth_bits = std::bit_cast<uint32_t>(depth);
+  depth_bits = (depth_bits & 0x80000000u) ? ~depth_bits : (depth_bits | 0x80000000u);
+
+  auto key = uint64_t{};
+  key |= layer_clamped << 60;
+  key |= (zorder_biased & 0xFFFF) << 44;
+  key |= (uint64_t)(shader & 0xFF) << 36;
+  key |= (uint64_t)(texture & 0xFFFF) << 20;
+  key |= (uint64_t)(depth_bits >> 12);
+  return key;
+}
+
+auto RenderQueue::clear() -> void {
+  items.clear();
+  stats.clamped = 0;
+}
+
+auto RenderQueue::push(uint64_t key, uint32_t index) -> void {
+  items.push_back({key, index});
+}
+
+auto RenderQueue::sort() -> void {
+  // the keys were counted before the sort
+  stats = {.items = (uint32_t)items.size(), .clamped = stats.clamped};
+
+  if (not is_sorted(items) and not try_last_order()) {
+    radix_sort();
+  }
+
+  last_order.resize(items.size());
+  for (auto i = size_t{}; i < items.size(); ++i) {
+    last_order[i] = items[i].index;
+  }
+}
+
+auto RenderQueue::is_sorted(const std::vector<Item> &items) -> bool {
+  return std::ranges::is_sorted(items, {}, &Item::key);
+}
+
+auto RenderQueue::try_last_order() -> bool {
+  // most frames submit the same payloads in the same order, so the last permutation usually still holds
+  if (last_order.size() != items.size()) {
+    return false;
+  }
+
+  scratch.resize(items.size());
+  for (auto i = size_t{}; i < items.size(); ++i) {
+    const auto index = last_order[i];
+    if (index >= items.size() or items[index].index != index) {
+      return false;
+    }
+    scratch[i] = items[index];
+  }
+  if (not is_sorted(scratch)) {
+    return false;
+  }
+
+  items.swap(scratch);
+  stats.reused_order = true;
+  return true;
+}
+
+auto RenderQueue::radix_sort() -> void {
+  // lsd radix sort with 8 bit digits, all histograms are built in one pass
+  constexpr auto digits = sizeof(uint64_t);
+  auto histograms = std::array<std::array<uint32_t, 256>, digits>{};
+  for (const auto &item : items) {
+    for (auto d = size_t{}; d < digits; ++d) {
+      histograms[d][(item.key >> (d * 8)) & 0xFF] += 1;
+    }
+  }
+
+  scratch.resize(items.size());
+  for (auto d = size_t{}; d < digits; ++d) {
+    auto &histogram = histograms[d];
+
+    // skip digits that are the same for every item
+    if (histogram[(items.front().key >> (d * 8)) & 0xFF] == items.size()) {
+      continue;
+    }
+
+    auto offset = uint32_t{};
+    for (auto &count : histogram) {
+      const auto c = count;
+      count = offset;
+      offset += c;
+    }
+    for (const auto &item : items) {
+      scratch[histogram[(item.key >> (d * 8)) & 0xFF]++] = item;
+    }
+    items.swap(scratch);
+    stats.radix_passes += 1;
+  }
+}
+
+} // namespace rugame
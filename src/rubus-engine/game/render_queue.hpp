@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rugame {
+
+// sorts draw items by a packed 64 bit key, from the most significant bits:
+//   layer (4) | zorder (16) | shader (8) | texture (16) | depth (20)
+// so the order fixes draw order first and then groups state changes for batching.
+// layers and zorders out of range saturate, are counted every frame and reported once per queue. the shader and
+// texture only group and may alias
+struct RenderQueue {
+  static constexpr uint8_t max_layer = 15;
+  static constexpr int32_t min_zorder = -32768;
+  static constexpr int32_t max_zorder = 32767;
+
+  struct Item {
+    uint64_t key = 0;
+    uint32_t index = 0; // payload index
+  };
+
+  struct Stats {
+    uint32_t items = 0;
+    uint32_t radix_passes = 0;
+    bool reused_order = false;
+    uint32_t clamped = 0; // keys with a layer or zorder out of range
+  };
+
+  std::vector<Item> items;
+  std::vector<Item> scratch;
+  std::vector<uint32_t> last_order; // payload indices of the last frame in sorted order
+
+  Stats stats;
+  bool reported_clamped = false;
+
+  auto make_key(uint8_t layer, int32_t zorder, uint32_t shader, uint32_t texture, float depth) -> uint64_t;
+
+  // starts a frame, make_key and push come after it
+  auto clear() -> void;
+  auto push(uint64_t key, uint32_t index) -> void;
+  auto sort() -> void;
+
+private:
+  auto is_sorted(const std::vector<Item> &items) -> bool;
+  auto try_last_order() -> bool;
+  auto radix_sort() -> void;
+};
+
+} // namespace rugame
@@ -1,60 +1,525 @@
 #include "resource.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
 #include <format>
 #include <iostream>
 
 #include <stb_image.h>
 #include <glad/glad.h>
 
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/sprite_backend.hpp>
+#include <rubus-engine/graphics/state_cache.hpp>
+#include <rubus-engine/graphics/upload_ring.hpp>
+#include <rubus-engine/utils/vfs.hpp>
+
 namespace rugame {
 
-auto ResourceManager::load_texture2d_pixel(const std::string &key, const char *file_path) -> void {
+namespace {
+
+// clamped to a transparent border, nearest filtered so pixel art stays crisp
+auto create_standalone_texture() -> uint32_t {
+  auto &device = graphics::Device::current();
+  auto texture = device.create_texture();
+
+  float borderColor[] = {0.0f, 0.0f, 0.0f, 0.0f};
+  device.texture_border_color(texture, borderColor);
+  device.texture_parameter(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+  device.texture_parameter(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+  device.texture_parameter(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+  device.texture_parameter(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  return texture;
+}
+
+// only the header is read, 0x0 when the image is not a file stb knows (a cooked texture without its image)
+auto peek_image_size(const char *file_path) -> glm::ivec2 {
+  auto size = glm::ivec2{0, 0};
+  auto channels = 0;
+  if (auto packed = utils::Vfs::find(file_path); packed.has_value()) {
+    stbi_info_from_memory((const stbi_uc *)packed->data(), (int)packed->size(), &size.x, &size.y, &channels);
+  } else {
+    stbi_info(file_path, &size.x, &size.y, &channels);
+  }
+  return size;
+}
+
+} // namespace
+
+auto ResourceManager::load_texture2d_pixel(const std::string &key, const char *file_path, TextureOptions options)
+  -> void {
   if (texture2d.contains(key)) {
     std::cerr << std::format("Error: texture key \"{}\" already exists\n", key);
     return;
   }
+  auto texture = decode_texture_file(file_path, options);
+  if (not texture.has_value()) {
+    return;
+  }
+  texture2d.insert({key, create_texture2d(*texture, options)});
+}
 
-  auto texture = uint32_t{};
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
+auto ResourceManager::load_texture2d_cooked(const std::string &key, const char *file_path, TextureOptions options)
+  -> bool {
+  if (texture2d.contains(key)) {
+    std::cerr << std::format("Error: texture key \"{}\" already exists\n", key);
+    return false;
+  }
+  // the levels are uploaded straight from the mapped file
+  auto texture = decode_cooked_texture(file_path, options);
+  if (not texture.has_value()) {
+    return false;
+  }
+  texture2d.insert({key, create_texture2d(*texture, options)});
+  return true;
+}
 
-  float borderColor[] = {0.0f, 0.0f, 0.0f, 0.0f};
-  glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-  auto width = 0;
-  auto height = 0;
-  auto channels = 0;
-  stbi_set_flip_vertically_on_load(true);
-  auto data = stbi_load(file_path, &width, &height, &channels, STBI_rgb_alpha);
-  if (data != nullptr) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cerr << std::format("Error: failed to load texture file \"{}\"\n", file_path);
+auto ResourceManager::load_texture2d_ktx2(const std::string &key, const char *file_path) -> bool {
+  if (texture2d.contains(key)) {
+    std::cerr << std::format("Error: texture key \"{}\" already exists\n", key);
+    return false;
+  }
+  auto texture = decode_ktx2_texture(file_path);
+  if (not texture.has_value()) {
+    return false;
+  }
+  texture2d.insert({key, create_ktx2_texture2d(*texture->ktx2)});
+  return true;
+}
+
+auto ResourceManager::load_texture2d_async(const std::string &key, const char *file_path, TextureOptions options,
+                                           TextureLoadCallback callback) -> std::future<bool> {
+  auto promise = std::promise<bool>{};
+  auto future = promise.get_future();
+  if (texture2d.contains(key)) {
+    std::cerr << std::format("Error: texture key \"{}\" already exists\n", key);
+    promise.set_value(false);
+    return future;
+  }
+  // queried here, the workers must not be the first to touch gl
+  if (options.compressed and graphics::SpriteBackend::active == nullptr) {
+    texture_compressions();
+  }
+
+  if (not loader.placeholder.has_value()) {
+    const auto transparent = std::array<uint8_t, 4>{0, 0, 0, 0};
+    if (auto backend = graphics::SpriteBackend::active; backend != nullptr) {
+      loader.placeholder = backend->create_texture(transparent.data(), 1, 1);
+    } else {
+      auto &device = graphics::Device::current();
+      loader.placeholder = create_standalone_texture();
+      device.texture_parameter(*loader.placeholder, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      device.texture_storage(*loader.placeholder, 1, GL_RGBA8, 1, 1);
+      device.texture_sub_image(*loader.placeholder, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, transparent.data());
+    }
+  }
+  const auto size = peek_image_size(file_path);
+  texture2d.insert({key, TextureResource{
+                           .handle = *loader.placeholder,
+                           .width = size.x,
+                           .height = size.y,
+                           .alpha = TextureAlpha::Translucent,
+                           .mesh = {},
+                         }});
+
+  const auto id = ++loader.last_id;
+  loader.pending.insert({key, TextureLoader::Pending{id, std::move(promise), std::move(callback), {}}});
+  loader.submit({id, key, file_path, options});
+  return future;
+}
+
+auto ResourceManager::update_texture_loads() -> void {
+  if (loader.pending.empty()) {
+    return;
+  }
+  // the backends copy the texels on the cpu, only gl uploads go through the ring
+  const auto staged = graphics::SpriteBackend::active == nullptr;
+  if (staged) {
+    loader.upload_ring.init(loader.staging_size);
+    loader.upload_ring.begin_frame();
+  }
+
+  // at least one texture per frame, so a texture that alone takes longer than the budget still loads. the budget
+  // covers create_texture2d, an atlas add only copies the texels since the page mips are rebuilt once per frame
+  // when the sprites are drawn (TextureAtlas::update_mips)
+  const auto start = std::chrono::steady_clock::now();
+  auto uploaded = false;
+  while (not uploaded or
+         std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < loader.frame_budget) {
+    auto result = loader.poll();
+    if (not result.has_value()) {
+      break;
+    }
+    uploaded = finish_texture_load(*result) or uploaded;
+  }
+
+  if (staged) {
+    loader.upload_ring.end_frame();
+  }
+}
+
+auto ResourceManager::finish_texture_loads() -> void {
+  while (not loader.pending.empty()) {
+    loader.wait();
+    while (auto result = loader.poll()) {
+      finish_texture_load(*result);
+    }
+  }
+}
+
+auto ResourceManager::finish_texture_load(TextureLoader::Result &result) -> bool {
+  // unloaded, or unloaded and queued again, since the request
+  auto pending = loader.pending.find(result.key);
+  if (pending == loader.pending.end() or pending->second.id != result.id) {
+    return false;
+  }
+  auto load = std::move(pending->second);
+  loader.pending.erase(pending);
+
+  // a failed load keeps its placeholder, the error was printed by the worker
+  const auto loaded = result.texture.has_value();
+  if (loaded) {
+    texture2d.at(result.key) = create_texture2d(*result.texture, result.options);
+    for (const auto &swap : load.palette_swaps) {
+      load_palette_swap(swap.key, result.key, swap.recolor);
+    }
+  }
+  load.promise.set_value(loaded);
+  if (load.callback) {
+    load.callback(result.key, loaded);
+  }
+  return true;
+}
+
+auto ResourceManager::cancel_texture_load(const std::string &key) -> void {
+  if (auto pending = loader.pending.find(key); pending != loader.pending.end()) {
+    pending->second.promise.set_value(false);
+    loader.pending.erase(pending);
+  }
+}
+
+auto ResourceManager::create_texture2d(const DecodedTexture &texture, TextureOptions options) -> TextureResource {
+  if (texture.ktx2.has_value()) {
+    return create_ktx2_texture2d(*texture.ktx2);
+  }
+  const auto levels = std::span{texture.levels};
+  const auto &base = levels[0];
+  const auto width = base.width;
+  const auto height = base.height;
+
+  // sprite backends draw plain quads and bind textures per sprite (vulkan descriptor array, software sampler),
+  // an atlas would not save a draw
+  if (auto backend = graphics::SpriteBackend::active; backend != nullptr) {
+    return {
+      .handle = backend->create_texture(base.rgba, (uint32_t)width, (uint32_t)height),
+      .width = width,
+      .height = height,
+      .alpha = texture.alpha,
+      .mesh = {},
+      .premultiplied = texture.premultiplied,
+    };
+  }
+
+  // trimmed outline, fully opaque images always fill their quad
+  auto mesh = SpriteMesh{};
+  if (not texture.outline.empty()) {
+    meshes.init();
+    mesh = meshes.add(texture.outline);
+  }
+
+  // few colors, a quarter of the texels as palette indices. indices cannot be filtered into mips, the base level
+  // is drawn at every scale
+  if (texture.indexed.has_value()) {
+    if (auto row = palettes.add(texture.indexed->palette); row.has_value()) {
+      return create_index_texture2d(*texture.indexed,
+                                    TextureResource{
+                                      .width = width,
+                                      .height = height,
+                                      .alpha = texture.alpha,
+                                      .mesh = mesh,
+                                      .premultiplied = texture.premultiplied,
+                                      .palette = *row,
+                                    },
+                                    options);
+    }
+  }
+
+  // atlas, the pages build their own mips
+  if (options.atlas and not texture.standalone) {
+    auto entry = atlas.add(base.rgba, width, height);
+    if (entry.has_value()) {
+      return {
+        .handle = atlas.pages[entry->page].handle,
+        .width = width,
+        .height = height,
+        .page = entry->page,
+        .uv_rect = entry->uv_rect,
+        .alpha = texture.alpha,
+        .mesh = mesh,
+        .premultiplied = texture.premultiplied,
+      };
+    }
+  }
+
+  // standalone
+  auto &device = graphics::Device::current();
+  auto handle = create_standalone_texture();
+
+  // immutable storage with the full mip chain, generated unless every level was given
+  const auto level_count = std::bit_width((unsigned)std::max(width, height));
+  device.texture_storage(handle, level_count, GL_RGBA8, width, height);
+  device.pixel_store(GL_UNPACK_ALIGNMENT, 1);
+  for (auto i = size_t{}; i < levels.size() and i < (size_t)level_count; ++i) {
+    const auto &level = levels[i];
+    graphics::upload_texture_sub_image(handle, (int32_t)i, 0, 0, level.width, level.height, GL_RGBA,
+                                       GL_UNSIGNED_BYTE, level.rgba);
+  }
+  if (levels.size() < (size_t)level_count) {
+    device.generate_mipmap(handle);
+  }
+
+  return {
+    .handle = handle,
+    .width = width,
+    .height = height,
+    .alpha = texture.alpha,
+    .mesh = mesh,
+    .premultiplied = texture.premultiplied,
+  };
+}
+
+auto ResourceManager::create_index_texture2d(const IndexedImage &image, TextureResource texture,
+                                             TextureOptions options) -> TextureResource {
+  if (options.atlas) {
+    if (auto entry = index_atlas.add(image.indices.data(), texture.width, texture.height); entry.has_value()) {
+      texture.handle = index_atlas.pages[entry->page].handle;
+      texture.page = entry->page;
+      texture.uv_rect = entry->uv_rect;
+      return texture;
+    }
+  }
+
+  auto &device = graphics::Device::current();
+  texture.handle = create_standalone_texture();
+  device.texture_parameter(texture.handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  device.texture_storage(texture.handle, 1, GL_R8, texture.width, texture.height);
+  device.pixel_store(GL_UNPACK_ALIGNMENT, 1);
+  graphics::upload_texture_sub_image(texture.handle, 0, 0, 0, texture.width, texture.height, GL_RED,
+                                     GL_UNSIGNED_BYTE, image.indices.data());
+  return texture;
+}
+
+auto ResourceManager::create_ktx2_texture2d(const Ktx2Texture &texture) -> TextureResource {
+  // compressed storage cannot generate its mips, only the levels of the file are allocated
+  auto &device = graphics::Device::current();
+  const auto handle = create_standalone_texture();
+  const auto format = texture_compression_gl_format(texture.compression);
+  const auto width = (int)texture.width;
+  const auto height = (int)texture.height;
+  device.texture_storage(handle, (int32_t)texture.levels.size(), format, width, height);
+  for (auto i = size_t{}; i < texture.levels.size(); ++i) {
+    const auto &level = texture.levels[i];
+    graphics::upload_compressed_texture_sub_image(handle, (int32_t)i, 0, 0, (int32_t)level.width,
+                                                  (int32_t)level.height, format, level.data.size(),
+                                                  level.data.data());
+  }
+
+  // files with the top row first are sampled upside down
+  return {
+    .handle = handle,
+    .width = width,
+    .height = height,
+    .uv_rect = texture.bottom_up ? glm::vec4{0.f, 0.f, 1.f, 1.f} : glm::vec4{0.f, 1.f, 1.f, 0.f},
+    .alpha = texture.alpha,
+    .mesh = {},
+    .premultiplied = texture.premultiplied,
+  };
+}
+
+auto ResourceManager::load_sdf_font(const std::string &key, const SdfFontDesc &desc) -> void {
+  if (texture2d.contains(key)) {
+    std::cerr << std::format("Error: texture key \"{}\" already exists\n", key);
+    return;
+  }
+  // the backends take rgba8 sprites only
+  if (graphics::SpriteBackend::active != nullptr) {
+    std::cerr << std::format("Error: sdf font \"{}\" needs the gl sprite path\n", key);
+    return;
+  }
+
+  auto image = SdfFontCache::load(desc);
+  if (not image.has_value()) {
+    std::cerr << std::format("Error: failed to load sdf font \"{}\"\n", desc.face);
     return;
   }
-  stbi_image_free(data);
 
-  texture2d.insert({key, TextureResource{.handle = texture, .width = width, .height = height}});
+  // distances interpolate well, linear filtering and mips keep small text smooth
+  auto &device = graphics::Device::current();
+  auto texture = device.create_texture();
+  device.texture_parameter(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  device.texture_parameter(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  device.texture_parameter(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  device.texture_parameter(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  const auto width = (int)image->width;
+  const auto height = (int)image->height;
+  const auto levels = std::bit_width((unsigned)std::max(width, height));
+  device.texture_storage(texture, levels, GL_R8, width, height);
+  device.pixel_store(GL_UNPACK_ALIGNMENT, 1);
+  device.texture_sub_image(texture, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, image->texels.data());
+  device.generate_mipmap(texture);
+
+  texture2d.insert({key, TextureResource{
+                           .handle = texture,
+                           .width = width,
+                           .height = height,
+                           .alpha = TextureAlpha::Translucent,
+                           .mesh = {},
+                         }});
+  image->font.texture = key;
+  fonts.insert({key, std::move(image->font)});
 }
 
 auto ResourceManager::unload_texture2d(const std::string &key) -> void {
+  fonts.erase(key);
+  cancel_texture_load(key);
   if (texture2d.contains(key)) {
     auto texture_res = ResourceManager::texture2d.at(key);
-    glDeleteTextures(1, &texture_res.handle);
+    // the placeholder is shared by every pending load
+    if (texture_res.handle == loader.placeholder) {
+      texture2d.erase(key);
+      return;
+    }
+    if (auto backend = graphics::SpriteBackend::active; backend != nullptr) {
+      backend->delete_texture(texture_res.handle);
+      texture2d.erase(key);
+      return;
+    }
+    if (texture_res.palette >= 0) {
+      palettes.release(texture_res.palette);
+    }
+    meshes.release(texture_res.mesh);
+    if (texture_res.page >= 0) {
+      (texture_res.palette >= 0 ? index_atlas : atlas).release(texture_res.page);
+    } else {
+      graphics::StateCache::forget_texture(texture_res.handle);
+      graphics::Device::current().delete_texture(texture_res.handle);
+    }
     texture2d.erase(key);
   }
 }
 
 auto ResourceManager::unload_texture2d_all() -> void {
+  // the workers may still decode the cancelled loads, their results are dropped
+  while (not loader.pending.empty()) {
+    cancel_texture_load(loader.pending.begin()->first);
+  }
+  loader.discard();
+  loader.upload_ring.deinit();
+
   for (const auto &[key, texture_res] : texture2d) {
-    glDeleteTextures(1, &texture_res.handle);
+    if (texture_res.handle == loader.placeholder) {
+      continue;
+    }
+    if (auto backend = graphics::SpriteBackend::active; backend != nullptr) {
+      backend->delete_texture(texture_res.handle);
+      continue;
+    }
+    if (texture_res.page < 0) {
+      graphics::StateCache::forget_texture(texture_res.handle);
+      graphics::Device::current().delete_texture(texture_res.handle);
+    }
+  }
+  if (loader.placeholder.has_value()) {
+    if (auto backend = graphics::SpriteBackend::active; backend != nullptr) {
+      backend->delete_texture(*loader.placeholder);
+    } else {
+      graphics::StateCache::forget_texture(*loader.placeholder);
+      graphics::Device::current().delete_texture(*loader.placeholder);
+    }
+    loader.placeholder.reset();
   }
   texture2d.clear();
+  fonts.clear();
+  atlas.clear();
+  index_atlas.clear();
+  palettes.clear();
+  palette_swaps.clear();
+  meshes.clear();
+}
+
+auto ResourceManager::load_palette_swap(const std::string &key, const std::string &texture,
+                                        std::span<const std::pair<uint32_t, uint32_t>> recolor) -> bool {
+  const auto is_key = [&](const TextureLoader::PaletteSwap &swap) { return swap.key == key; };
+  auto queued = false;
+  for (const auto &pending : loader.pending) {
+    queued = queued or std::ranges::any_of(pending.second.palette_swaps, is_key);
+  }
+  if (palette_swaps.contains(key) or queued) {
+    std::cerr << std::format("Error: palette swap key \"{}\" already exists\n", key);
+    return false;
+  }
+  // the placeholder has no palette yet
+  if (auto pending = loader.pending.find(texture); pending != loader.pending.end()) {
+    pending->second.palette_swaps.push_back({key, {recolor.begin(), recolor.end()}});
+    return true;
+  }
+  auto texture_res = texture2d.find(texture);
+  if (texture_res == texture2d.end() or texture_res->second.palette < 0) {
+    std::cerr << std::format("Error: texture \"{}\" of palette swap \"{}\" is not an index texture\n", texture, key);
+    return false;
+  }
+  auto row = palettes.add_swap(texture_res->second.palette, recolor);
+  if (not row.has_value()) {
+    return false;
+  }
+  palette_swaps.insert({key, *row});
+  return true;
+}
+
+auto ResourceManager::unload_palette_swap(const std::string &key) -> void {
+  for (auto &pending : loader.pending) {
+    std::erase_if(pending.second.palette_swaps, [&](const auto &swap) { return swap.key == key; });
+  }
+  if (auto swap = palette_swaps.find(key); swap != palette_swaps.end()) {
+    palettes.release(swap->second);
+    palette_swaps.erase(swap);
+  }
+}
+
+auto ResourceManager::classify_alpha(const uint8_t *rgba, int width, int height) -> TextureAlpha {
+  return classify_texture_alpha(rgba, width, height);
+}
+
+auto ResourceManager::texture_compressions() -> std::span<const TextureCompression> {
+  // bc7 is core since gl 4.2 and etc2 since 4.3, s3tc stays an extension. desktop drivers tend to decode etc2
+  // on the cpu into rgba8, so it comes last
+  static const auto compressions = [] {
+    auto &device = graphics::Device::current();
+    const auto version = device.get_integer(GL_MAJOR_VERSION) * 10 + device.get_integer(GL_MINOR_VERSION);
+    auto supported = std::vector<TextureCompression>{};
+    if (version >= 42 or device.has_extension("GL_ARB_texture_compression_bptc")) {
+      supported.push_back(TextureCompression::Bc7);
+    }
+    if (device.has_extension("GL_EXT_texture_compression_s3tc")) {
+      supported.push_back(TextureCompression::Bc3);
+    }
+    if (version >= 43 or device.has_extension("GL_ARB_ES3_compatibility")) {
+      supported.push_back(TextureCompression::Etc2);
+    }
+    return supported;
+  }();
+  return compressions;
+}
+
+auto ResourceManager::atlas_page_count() -> size_t {
+  return atlas.page_count();
+}
+
+auto ResourceManager::atlas_efficiency() -> float {
+  return atlas.efficiency();
 }
 
 } // namespace rugame
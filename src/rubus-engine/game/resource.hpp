@@ -1,23 +1,94 @@
 #pragma once
 
 #include <cstdint>
+#include <future>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+#include "texture_atlas.hpp"
+#include "sprite_mesh.hpp"
+#include "sdf_font.hpp"
+#include "cooked_texture.hpp"
+#include "block_compression.hpp"
+#include "palette.hpp"
+#include "texture_loader.hpp"
 
 namespace rugame {
 
 struct TextureResource {
-  uint32_t handle = 0;
+  uint32_t handle = 0; // gl texture, the atlas page texture if the image lives in the atlas
   int width = 0;
   int height = 0;
+  int32_t page = -1;                        // atlas page index, -1 if the texture is standalone
+  glm::vec4 uv_rect = {0.f, 0.f, 1.f, 1.f}; // region of `handle` that holds the image
+  TextureAlpha alpha = TextureAlpha::Translucent;
+  SpriteMesh mesh;            // outline trimmed to the visible texels, the full quad by default
+  bool premultiplied = false; // blended with BlendMode::Premultiplied
+  int32_t palette = -1;       // row of ResourceManager::palettes for an r8 index texture, -1 for rgba
 };
 
 struct ResourceManager {
   inline static std::unordered_map<std::string, TextureResource> texture2d;
+  inline static TextureAtlas atlas;
+  inline static TextureAtlas index_atlas = {.indexed = true, .pages = {}};
+  inline static PaletteTable palettes;
+  inline static std::unordered_map<std::string, int32_t> palette_swaps; // rows of palettes by key
+  inline static TextureLoader loader;
+  inline static SpriteMeshPool meshes;
+  inline static std::unordered_map<std::string, SdfFont> fonts;
 
-  static auto load_texture2d_pixel(const std::string &key, const char *file_path) -> void;
+  // uses the cooked textures next to the image when there are: with `options.compressed` a block compressed one the
+  // context supports (plains.bc7.ktx2, ...), then the lossless one (plains.rtex), packed or on disk
+  static auto load_texture2d_pixel(const std::string &key, const char *file_path, TextureOptions options = {})
+    -> void;
+  // a texture of the rubus-cook tool, the levels are uploaded straight from the mapped file with the outline and
+  // the palette it cooked. its mip chain keeps it out of the atlas, unless it has few colors and is indexed
+  static auto load_texture2d_cooked(const std::string &key, const char *file_path, TextureOptions options = {})
+    -> bool;
+  // a block compressed ktx2 texture, standalone (never in the atlas) and with the full quad as its mesh
+  static auto load_texture2d_ktx2(const std::string &key, const char *file_path) -> bool;
+  // load_texture2d_pixel on the TextureLoader workers, returns at once. `key` can be drawn right away and shows a
+  // transparent placeholder until update_texture_loads uploaded the texture. the future and the callback report on
+  // the render thread whether it loaded, so never wait for the future there before the load finished
+  static auto load_texture2d_async(const std::string &key, const char *file_path, TextureOptions options = {},
+                                   TextureLoadCallback callback = {}) -> std::future<bool>;
+  // uploads decoded textures until TextureLoader::frame_budget is spent, the scene calls it once per frame
+  static auto update_texture_loads() -> void;
+  // waits for the workers and uploads every queued texture, for loading screens
+  static auto finish_texture_loads() -> void;
+  // builds (or reads from SdfFontCache) the glyph atlas, which is also added to texture2d under `key`
+  static auto load_sdf_font(const std::string &key, const SdfFontDesc &desc = {}) -> void;
   static auto unload_texture2d(const std::string &key) -> void;
   static auto unload_texture2d_all() -> void;
+  // a recolored copy of the palette of the index texture `texture`, drawn by sprites with SpriteMaterial::palette
+  // set to `key`. (from, to) pairs are rgba8 with r in the low byte. a swap of a texture that is still loading is
+  // made once it is resident and fails then if it is no index texture
+  static auto load_palette_swap(const std::string &key, const std::string &texture,
+                                std::span<const std::pair<uint32_t, uint32_t>> recolor) -> bool;
+  static auto unload_palette_swap(const std::string &key) -> void;
+
+  static auto classify_alpha(const uint8_t *rgba, int width, int height) -> TextureAlpha;
+  // the block compressions the current device samples, preferred first, queried once
+  static auto texture_compressions() -> std::span<const TextureCompression>;
+
+  static auto atlas_page_count() -> size_t;
+  static auto atlas_efficiency() -> float;
+
+private:
+  // uploads a decoded texture, one level gets its mips generated by gl
+  static auto create_texture2d(const DecodedTexture &texture, TextureOptions options) -> TextureResource;
+  // `texture` without its handle, page and uv rect
+  static auto create_index_texture2d(const IndexedImage &image, TextureResource texture, TextureOptions options)
+    -> TextureResource;
+  static auto create_ktx2_texture2d(const Ktx2Texture &texture) -> TextureResource;
+  // false if the load was cancelled meanwhile
+  static auto finish_texture_load(TextureLoader::Result &result) -> bool;
+  // fails the load of `key` if it is queued, its placeholder stays in texture2d
+  static auto cancel_texture_load(const std::string &key) -> void;
 };
 
 } // namespace game
@@ -2,22 +2,87 @@
 
 #include <iostream>
 
+#include <glm/ext.hpp>
+
+#include <rubus-engine/graphics/state_cache.hpp>
+#include <rubus-engine/graphics/shader_cache.hpp>
+#include <rubus-engine/graphics/sprite_backend.hpp>
+#include "resource.hpp"
+
 namespace rugame {
 
 Scene::Scene() : command{&arch_storage} {}
 
 auto Scene::init(ruapp::Window *window) -> void {
-  screen = Screen{(float)window->width, (float)window->height};
-  camera = Camera2d{&screen, {0.f, 0.f, 10.f}};
+  SpriteScene::init(window->width, window->height);
+  init_ui(window);
+}
+
+auto Scene::deinit(ruapp::Window *window) -> void {
+  if (fn_on_end) {
+    fn_on_end(this);
+  }
+
+  SpriteScene::deinit();
+
+  arch_storage.delete_all_archetypes();
+  command.discard();
+
+  deinit_ui(window);
+
+  if (fn_on_deinit) {
+    fn_on_deinit(this);
+  }
+}
+
+auto Scene::update(ruapp::Window *window, SceneManager *scene_manager, double delta) -> void {
+  SpriteScene::update(delta);
+
+  // scene upate
+  if (fn_on_update) {
+    fn_on_update(window, scene_manager, this, delta);
+  }
+}
+
+auto Scene::render(ruapp::Window *window, double) -> void {
+  // the backend owns the output: vulkan presents itself, the software renderer is offscreen only and keeps the
+  // image for read_pixels. the skia gui draws through gl and is skipped
+  if (graphics::SpriteBackend::active != nullptr) {
+    ResourceManager::update_texture_loads();
+    render_sprites_backend();
+    return;
+  }
+
+  // clear gui
+  ui_renderer.clear(SkColors::kTransparent);
+  ui_renderer.flush();
+
+  // skia has touched the gl state
+  graphics::StateCache::invalidate();
+  // the textures of async loads decoded since the last frame, as many as fit the upload budget
+  ResourceManager::update_texture_loads();
+  render_sprites();
 
+  // render gui
+  ui_renderer.context->resetContext();
+  ui_tree.root->layout(&ui_renderer);
+  ui_tree.root->draw_all(&ui_renderer);
+  ui_renderer.flush();
+
+  // swap buffers
+  window->swap_buffers();
+}
+
+auto Scene::init_ui(ruapp::Window *window) -> void {
   ui_screen.set_size(window->width, window->height);
   ui_renderer.init(&ui_screen);
   ui_tree.init(&ui_screen);
 
+  // skia has touched the gl state
+  graphics::StateCache::invalidate();
+
   window->on_resize = ([this](ruapp::Window *, int width, int height) {
-    glViewport(0, 0, width, height);
-    screen.width = (float)width;
-    screen.height = (float)height;
+    resize(width, height);
     ui_screen.set_size(width, height);
     ui_renderer.regenerate_surface(&ui_screen);
     ui_tree.set_size(&ui_screen);
@@ -42,16 +107,7 @@ auto Scene::init(ruapp::Window *window) -> void {
   });
 }
 
-auto Scene::deinit(ruapp::Window *window) -> void {
-  if (fn_on_end) {
-    fn_on_end(this);
-  }
-
-  sprites.clear();
-
-  arch_storage.delete_all_archetypes();
-  command.discard();
-
+auto Scene::deinit_ui(ruapp::Window *window) -> void {
   ui_nodes.clear();
   ui_tree.reset();
 
@@ -62,53 +118,6 @@ auto Scene::deinit(ruapp::Window *window) -> void {
   window->on_mouse_down = nullptr;
   window->on_mouse_up = nullptr;
   window->on_mouse_scroll = nullptr;
-
-  if (fn_on_deinit) {
-    fn_on_deinit(this);
-  }
-}
-
-auto Scene::update(ruapp::Window *window, SceneManager *scene_manager, double delta) -> void {
-  this->delta = delta;
-  camera.update();
-
-  // scene upate
-  if (fn_on_update) {
-    fn_on_update(window, scene_manager, this, delta);
-  }
-}
-
-auto Scene::render(ruapp::Window *window, double) -> void {
-  // clear gui
-  ui_renderer.clear(SkColors::kTransparent);
-  ui_renderer.flush();
-
-  // opengl settings
-  glDisable(GL_FRAMEBUFFER_SRGB);
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-  // clear
-  glClearColor(1.f, 1.f, 1.f, 1.f);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-  // render sprites
-  std::ranges::sort(sprites, [](Sprite *a, Sprite *b) {
-    return a->zorder < b->zorder;
-  });
-  for (auto sprite : sprites) {
-    sprite->draw(&camera);
-  }
-  sprites.clear();
-
-  // render gui
-  ui_renderer.context->resetContext();
-  ui_tree.root->layout(&ui_renderer);
-  ui_tree.root->draw_all(&ui_renderer);
-  ui_renderer.flush();
-
-  // swap buffers
-  window->swap_buffers();
 }
 
 auto SceneManager::deinit(ruapp::Window *window) -> void {
@@ -118,6 +127,9 @@ auto SceneManager::deinit(ruapp::Window *window) -> void {
   for (const auto &[_, scene] : scenes) {
     delete scene;
   }
+  Camera2d::deinit();
+  ResourceManager::meshes.deinit();
+  graphics::ShaderCache::deinit();
 }
 
 auto SceneManager::update(ruapp::Window *window, double delta) -> void {
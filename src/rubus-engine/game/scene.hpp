@@ -9,17 +9,14 @@
 #include <rubus-ecs/ecs.hpp>
 
 #include <rubus-engine/app/app.hpp>
-#include "game.hpp"
+#include "sprite_scene.hpp"
 
 namespace rugame {
 
 struct SceneManager;
 
-struct Scene {
-  Screen screen;
-  Camera2d camera;
-  std::vector<Sprite *> sprites;
-
+// a SpriteScene in a window, with the ecs, the gui and the scene callbacks
+struct Scene : SpriteScene {
   ruecs::ArchetypeStorage arch_storage;
   ruecs::Command command;
 
@@ -28,8 +25,6 @@ struct Scene {
   rugui::Tree ui_tree;
   std::unordered_map<std::string, rugui::Node *> ui_nodes;
 
-  double delta = 0;
-
   using Callback1 = std::function<void(Scene *scene)>;
   using Callback2 = std::function<void(ruapp::Window *window, SceneManager *scene_manager, Scene *scene)>;
   using Callback3 = std::function<void(ruapp::Window *window, SceneManager *scene_manager, Scene *scene, double delta)>;
@@ -47,6 +42,10 @@ struct Scene {
   auto deinit(ruapp::Window *window) -> void;
   auto update(ruapp::Window *window, SceneManager *scene_manager, double delta) -> void;
   auto render(ruapp::Window *window, double delta) -> void;
+
+  // the gui and the window event hooks, init and deinit call them after and before the sprite half
+  auto init_ui(ruapp::Window *window) -> void;
+  auto deinit_ui(ruapp::Window *window) -> void;
 };
 
 struct SceneManager {
@@ -0,0 +1,464 @@
+#include "sdf_font.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <span>
+
+#include "texture_atlas.hpp"
+
+namespace rugame {
+
+namespace {
+
+constexpr auto font_magic = uint32_t{0x46445352}; // "RSDF"
+constexpr auto font_version = uint32_t{1};
+
+// glyphs are rasterized at this multiple of the atlas size, the distances are averaged back down
+constexpr auto supersample = 4;
+constexpr auto far_away = 1e20f;
+constexpr auto max_atlas_size = 4096;
+
+struct FontHeader {
+  uint32_t magic = font_magic;
+  uint32_t version = font_version;
+  uint64_t hash = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t glyph_count = 0;
+  float ascent = 0.f;
+  float line_height = 0.f;
+  uint32_t reserved = 0;
+};
+
+struct GlyphRecord {
+  uint32_t codepoint = 0;
+  SdfGlyph glyph;
+};
+
+// a glyph as the os rasterized it, in pixels of the supersampled em
+struct RasterGlyph {
+  char32_t codepoint = 0;
+  int width = 0;
+  int height = 0;
+  int origin_x = 0; // left edge of the bitmap from the pen position
+  int origin_y = 0; // top edge of the bitmap above the baseline
+  int advance = 0;
+  std::vector<uint8_t> mask; // 1 inside the outline, rows from the top
+};
+
+struct RasterFont {
+  int ascent = 0;
+  int line_height = 0;
+  std::vector<RasterGlyph> glyphs;
+};
+
+auto fnv1a(std::span<const uint8_t> data, uint64_t hash = 14695981039346656037ull) -> uint64_t {
+  for (auto c : data) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+template <typename T>
+auto fnv1a_value(const T &value, uint64_t hash) -> uint64_t {
+  return fnv1a(std::span{(const uint8_t *)&value, sizeof(T)}, hash);
+}
+
+auto hash_desc(const SdfFontDesc &desc, const std::u32string &charset) -> uint64_t {
+  auto hash = fnv1a(std::span{(const uint8_t *)desc.face.data(), desc.face.size()});
+  hash = fnv1a_value(font_version, hash);
+  hash = fnv1a_value(desc.em_size, hash);
+  hash = fnv1a_value(desc.spread, hash);
+  hash = fnv1a_value(desc.bold, hash);
+  return fnv1a(std::span{(const uint8_t *)charset.data(), charset.size() * sizeof(char32_t)}, hash);
+}
+
+auto font_path(const SdfFontDesc &desc, uint64_t hash) -> std::filesystem::path {
+  return SdfFontCache::cache_dir / std::format("{}-{:016x}.sdf", desc.face, hash);
+}
+
+auto load_font(const std::filesystem::path &path, uint64_t hash) -> std::optional<SdfFontImage> {
+  auto fs = std::ifstream{path, std::ios::binary};
+  if (not fs) {
+    return std::nullopt;
+  }
+
+  auto header = FontHeader{};
+  fs.read((char *)&header, sizeof(header));
+  if (not fs or header.magic != font_magic or header.version != font_version or header.hash != hash) {
+    return std::nullopt;
+  }
+
+  // a truncated or damaged file is rebuilt, never trusted for the sizes of its arrays
+  auto ec = std::error_code{};
+  const auto file_size = (uint64_t)std::filesystem::file_size(path, ec);
+  const auto expected_size = (uint64_t)sizeof(header) + (uint64_t)header.glyph_count * sizeof(GlyphRecord) +
+                             (uint64_t)header.width * header.height;
+  if (ec or header.width == 0 or header.height == 0 or header.width > (uint32_t)max_atlas_size or
+      header.height > (uint32_t)max_atlas_size or file_size != expected_size) {
+    std::cerr << std::format("Error: font cache \"{}\" is damaged, rebuilding it\n", path.string());
+    return std::nullopt;
+  }
+
+  auto image = SdfFontImage{};
+  image.width = header.width;
+  image.height = header.height;
+  image.font.ascent = header.ascent;
+  image.font.line_height = header.line_height;
+  auto records = std::vector<GlyphRecord>(header.glyph_count);
+  fs.read((char *)records.data(), (std::streamsize)(records.size() * sizeof(GlyphRecord)));
+  image.texels.resize((size_t)image.width * image.height);
+  fs.read((char *)image.texels.data(), (std::streamsize)image.texels.size());
+  if (not fs) {
+    return std::nullopt;
+  }
+  for (const auto &record : records) {
+    image.font.glyphs.insert({(char32_t)record.codepoint, record.glyph});
+  }
+  return image;
+}
+
+auto save_font(const std::filesystem::path &path, uint64_t hash, const SdfFontImage &image) -> void {
+  auto header = FontHeader{};
+  header.hash = hash;
+  header.width = image.width;
+  header.height = image.height;
+  header.glyph_count = (uint32_t)image.font.glyphs.size();
+  header.ascent = image.font.ascent;
+  header.line_height = image.font.line_height;
+
+  auto records = std::vector<GlyphRecord>{};
+  records.reserve(image.font.glyphs.size());
+  for (const auto &[codepoint, glyph] : image.font.glyphs) {
+    records.push_back({(uint32_t)codepoint, glyph});
+  }
+
+  auto ec = std::error_code{};
+  std::filesystem::create_directories(path.parent_path(), ec);
+  auto fs = std::ofstream{path, std::ios::binary | std::ios::trunc};
+  if (not fs) {
+    std::cerr << std::format("Error: failed to write font cache \"{}\"\n", path.string());
+    return;
+  }
+  fs.write((const char *)&header, sizeof(header));
+  fs.write((const char *)records.data(), (std::streamsize)(records.size() * sizeof(GlyphRecord)));
+  fs.write((const char *)image.texels.data(), (std::streamsize)image.texels.size());
+}
+
+#if defined(_WIN32)
+auto rasterize(const SdfFontDesc &desc, const std::u32string &charset) -> std::optional<RasterFont> {
+  const auto em = (int)desc.em_size * supersample;
+
+  auto face = std::wstring{};
+  face.resize(MultiByteToWideChar(CP_UTF8, 0, desc.face.data(), (int)desc.face.size(), nullptr, 0));
+  MultiByteToWideChar(CP_UTF8, 0, desc.face.data(), (int)desc.face.size(), face.data(), (int)face.size());
+
+  // a negative height asks for the em size rather than the cell height
+  auto dc = CreateCompatibleDC(nullptr);
+  auto font = CreateFontW(-em, 0, 0, 0, desc.bold ? FW_BOLD : FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+                          OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS, ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE,
+                          face.c_str());
+  if (dc == nullptr or font == nullptr) {
+    std::cerr << std::format("Error: failed to create font \"{}\"\n", desc.face);
+    if (font != nullptr) {
+      DeleteObject(font);
+    }
+    if (dc != nullptr) {
+      DeleteDC(dc);
+    }
+    return std::nullopt;
+  }
+  auto old_font = SelectObject(dc, font);
+
+  auto metrics = TEXTMETRICW{};
+  GetTextMetricsW(dc, &metrics);
+  auto result = RasterFont{};
+  result.ascent = metrics.tmAscent;
+  result.line_height = metrics.tmHeight + metrics.tmExternalLeading;
+
+  const auto identity = MAT2{{0, 1}, {0, 0}, {0, 0}, {0, 1}};
+  auto buffer = std::vector<uint8_t>{};
+  for (auto codepoint : charset) {
+    // GetGlyphOutlineW takes utf-16 units, codepoints outside the bmp are left out
+    if (codepoint > 0xffff) {
+      continue;
+    }
+    auto glyph_metrics = GLYPHMETRICS{};
+    const auto size = GetGlyphOutlineW(dc, (UINT)codepoint, GGO_GRAY8_BITMAP, &glyph_metrics, 0, nullptr, &identity);
+    if (size == GDI_ERROR) {
+      continue;
+    }
+
+    auto glyph = RasterGlyph{};
+    glyph.codepoint = codepoint;
+    glyph.advance = glyph_metrics.gmCellIncX;
+    if (size > 0) {
+      buffer.resize(size);
+      GetGlyphOutlineW(dc, (UINT)codepoint, GGO_GRAY8_BITMAP, &glyph_metrics, size, buffer.data(), &identity);
+      glyph.width = (int)glyph_metrics.gmBlackBoxX;
+      glyph.height = (int)glyph_metrics.gmBlackBoxY;
+      glyph.origin_x = glyph_metrics.gmptGlyphOrigin.x;
+      glyph.origin_y = glyph_metrics.gmptGlyphOrigin.y;
+
+      // gray levels 0..64, rows padded to 4 bytes
+      const auto pitch = (glyph.width + 3) & ~3;
+      glyph.mask.resize((size_t)glyph.width * glyph.height);
+      for (auto y = 0; y < glyph.height; ++y) {
+        for (auto x = 0; x < glyph.width; ++x) {
+          glyph.mask[(size_t)y * glyph.width + x] = buffer[(size_t)y * pitch + x] >= 32 ? 1 : 0;
+        }
+      }
+    }
+    result.glyphs.push_back(std::move(glyph));
+  }
+
+  SelectObject(dc, old_font);
+  DeleteObject(font);
+  DeleteDC(dc);
+  return result;
+}
+#else
+auto rasterize(const SdfFontDesc &desc, const std::u32string &) -> std::optional<RasterFont> {
+  std::cerr << std::format("Error: no glyph rasterizer on this platform for font \"{}\"\n", desc.face);
+  return std::nullopt;
+}
+#endif
+
+// squared distance to the nearest zero of `f` along one line (felzenszwalb and huttenlocher)
+auto distance_transform_1d(std::span<const float> f, std::span<float> d, std::span<int> v, std::span<float> z)
+  -> void {
+  const auto n = (int)f.size();
+  auto k = 0;
+  v[0] = 0;
+  z[0] = -far_away;
+  z[1] = +far_away;
+  const auto intersection = [&](int q, int p) {
+    return ((f[q] + (float)(q * q)) - (f[p] + (float)(p * p))) / (float)(2 * q - 2 * p);
+  };
+  for (auto q = 1; q < n; ++q) {
+    // z[0] is below any intersection, so this stops at the first parabola at the latest
+    auto s = intersection(q, v[k]);
+    while (s <= z[k]) {
+      k -= 1;
+      s = intersection(q, v[k]);
+    }
+    k += 1;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = +far_away;
+  }
+  k = 0;
+  for (auto q = 0; q < n; ++q) {
+    while (z[k + 1] < (float)q) {
+      k += 1;
+    }
+    const auto p = v[k];
+    d[q] = (float)((q - p) * (q - p)) + f[p];
+  }
+}
+
+// squared euclidean distance of every pixel to the nearest pixel where `inside` equals `target`
+auto distance_transform(const std::vector<uint8_t> &inside, int width, int height, uint8_t target)
+  -> std::vector<float> {
+  auto grid = std::vector<float>(inside.size());
+  for (auto i = size_t{}; i < inside.size(); ++i) {
+    grid[i] = inside[i] == target ? 0.f : far_away;
+  }
+
+  const auto n = std::max(width, height);
+  auto f = std::vector<float>(n);
+  auto d = std::vector<float>(n);
+  auto v = std::vector<int>(n);
+  auto z = std::vector<float>(n + 1);
+
+  // columns, then rows over the column distances
+  for (auto x = 0; x < width; ++x) {
+    for (auto y = 0; y < height; ++y) {
+      f[y] = grid[(size_t)y * width + x];
+    }
+    distance_transform_1d(std::span{f}.first(height), d, v, z);
+    for (auto y = 0; y < height; ++y) {
+      grid[(size_t)y * width + x] = d[y];
+    }
+  }
+  for (auto y = 0; y < height; ++y) {
+    const auto row = std::span{grid}.subspan((size_t)y * width, width);
+    std::copy(row.begin(), row.end(), f.begin());
+    distance_transform_1d(std::span{f}.first(width), d, v, z);
+    std::copy_n(d.begin(), width, row.begin());
+  }
+  return grid;
+}
+
+struct GlyphField {
+  char32_t codepoint = 0;
+  int width = 0; // atlas texels
+  int height = 0;
+  std::vector<uint8_t> texels; // rows from the top
+  SdfGlyph glyph;
+};
+
+// the distance field of one glyph, padded by `spread` texels so the falloff outside the outline fits
+auto build_field(const RasterGlyph &raster, const SdfFontDesc &desc) -> GlyphField {
+  const auto em = (float)(desc.em_size * supersample);
+  auto field = GlyphField{};
+  field.codepoint = raster.codepoint;
+  field.glyph.advance = (float)raster.advance / em;
+  if (raster.width == 0 or raster.height == 0) {
+    return field;
+  }
+
+  // the supersampled bitmap grows to whole texels around the padding
+  const auto pad = (int)desc.spread * supersample;
+  field.width = (raster.width + 2 * pad + supersample - 1) / supersample;
+  field.height = (raster.height + 2 * pad + supersample - 1) / supersample;
+  const auto width = field.width * supersample;
+  const auto height = field.height * supersample;
+
+  auto inside = std::vector<uint8_t>((size_t)width * height, 0);
+  for (auto y = 0; y < raster.height; ++y) {
+    std::copy_n(raster.mask.begin() + (ptrdiff_t)y * raster.width, raster.width,
+                inside.begin() + (ptrdiff_t)(y + pad) * width + pad);
+  }
+  const auto to_inside = distance_transform(inside, width, height, 1);
+  const auto to_outside = distance_transform(inside, width, height, 0);
+
+  // signed distance from the pixel edge to the outline, positive inside, averaged over each texel
+  const auto scale = 1.f / (float)(supersample * supersample * supersample);
+  field.texels.resize((size_t)field.width * field.height);
+  for (auto ty = 0; ty < field.height; ++ty) {
+    for (auto tx = 0; tx < field.width; ++tx) {
+      auto sum = 0.f;
+      for (auto sy = 0; sy < supersample; ++sy) {
+        for (auto sx = 0; sx < supersample; ++sx) {
+          const auto i = (size_t)(ty * supersample + sy) * width + (size_t)(tx * supersample + sx);
+          sum += inside[i] != 0 ? std::sqrt(to_outside[i]) - 0.5f : 0.5f - std::sqrt(to_inside[i]);
+        }
+      }
+      const auto distance = sum * scale;
+      const auto value = std::clamp(0.5f + distance / (2.f * (float)desc.spread), 0.f, 1.f);
+      field.texels[(size_t)ty * field.width + tx] = (uint8_t)std::lround(value * 255.f);
+    }
+  }
+
+  field.glyph.offset = {(float)(raster.origin_x - pad) / em, (float)(raster.origin_y + pad - height) / em};
+  field.glyph.size = {(float)width / em, (float)height / em};
+  return field;
+}
+
+auto build_font(const SdfFontDesc &desc, const std::u32string &charset) -> std::optional<SdfFontImage> {
+  auto raster = rasterize(desc, charset);
+  if (not raster.has_value()) {
+    return std::nullopt;
+  }
+
+  auto fields = std::vector<GlyphField>{};
+  fields.reserve(raster->glyphs.size());
+  for (const auto &glyph : raster->glyphs) {
+    fields.push_back(build_field(glyph, desc));
+  }
+
+  // tallest first packs tighter, one texel of space around every glyph for the linear filter and the mips
+  auto order = std::vector<size_t>(fields.size());
+  std::iota(order.begin(), order.end(), size_t{});
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fields[a].height > fields[b].height; });
+
+  auto packer = SkylinePacker{};
+  auto rects = std::vector<AtlasRect>(fields.size());
+  auto packed = false;
+  for (auto size = 256; size <= max_atlas_size and not packed; size *= 2) {
+    packer.init(size, size);
+    packed = true;
+    for (auto i : order) {
+      if (fields[i].texels.empty()) {
+        continue;
+      }
+      auto rect = packer.pack(fields[i].width + 2, fields[i].height + 2);
+      if (not rect.has_value()) {
+        packed = false;
+        break;
+      }
+      rects[i] = *rect;
+    }
+  }
+  if (not packed) {
+    std::cerr << std::format("Error: glyphs of font \"{}\" do not fit a {} atlas\n", desc.face, max_atlas_size);
+    return std::nullopt;
+  }
+
+  const auto em = (float)(desc.em_size * supersample);
+  auto image = SdfFontImage{};
+  image.width = (uint32_t)packer.width;
+  image.height = (uint32_t)packer.height;
+  image.texels.resize((size_t)image.width * image.height, 0);
+  image.font.ascent = (float)raster->ascent / em;
+  image.font.line_height = (float)raster->line_height / em;
+  for (auto i = size_t{}; i < fields.size(); ++i) {
+    auto &field = fields[i];
+    if (not field.texels.empty()) {
+      // packer rows run from the top, the texture rows from the bottom
+      const auto x = rects[i].x + 1;
+      const auto top = rects[i].y + 1;
+      for (auto y = 0; y < field.height; ++y) {
+        const auto row = (size_t)(packer.height - 1 - (top + y));
+        std::copy_n(field.texels.begin() + (ptrdiff_t)y * field.width, field.width,
+                    image.texels.begin() + (ptrdiff_t)(row * image.width + x));
+      }
+      const auto bottom = packer.height - (top + field.height);
+      field.glyph.uv_rect = {(float)x / (float)image.width, (float)bottom / (float)image.height,
+                             (float)(x + field.width) / (float)image.width,
+                             (float)(bottom + field.height) / (float)image.height};
+    }
+    image.font.glyphs.insert({field.codepoint, field.glyph});
+  }
+  return image;
+}
+
+} // namespace
+
+auto SdfFont::find(char32_t codepoint) const -> const SdfGlyph * {
+  auto it = glyphs.find(codepoint);
+  return it != glyphs.end() ? &it->second : nullptr;
+}
+
+auto SdfFontCache::load(const SdfFontDesc &desc) -> std::optional<SdfFontImage> {
+  if (desc.em_size == 0 or desc.spread == 0) {
+    std::cerr << std::format("Error: font \"{}\" needs a non zero em size and spread\n", desc.face);
+    return std::nullopt;
+  }
+
+  auto charset = desc.charset;
+  if (charset.empty()) {
+    for (auto c = U' '; c <= U'~'; ++c) {
+      charset.push_back(c);
+    }
+  }
+
+  const auto hash = hash_desc(desc, charset);
+  const auto path = font_path(desc, hash);
+  if (use_disk_cache) {
+    if (auto image = load_font(path, hash); image.has_value()) {
+      return image;
+    }
+  }
+
+  auto image = build_font(desc, charset);
+  if (image.has_value() and use_disk_cache) {
+    save_font(path, hash, *image);
+  }
+  return image;
+}
+
+} // namespace rugame
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace rugame {
+
+struct SdfGlyph {
+  glm::vec2 offset = {0.f, 0.f}; // bottom left of the quad from the pen position on the baseline, in ems
+  glm::vec2 size = {0.f, 0.f};   // quad size in ems, includes the spread around the outline
+  float advance = 0.f;           // in ems
+  glm::vec4 uv_rect = {0.f, 0.f, 0.f, 0.f};
+};
+
+struct SdfFontDesc {
+  std::string face = "Segoe UI"; // installed font family, utf-8
+  uint32_t em_size = 48;         // texels per em in the atlas
+  uint32_t spread = 6;           // distance range on each side of the outline in texels
+  bool bold = false;
+  std::u32string charset; // empty: printable ascii
+};
+
+// a font as laid out by rugame::Text, metrics are in ems so text scales without rebuilding the atlas
+struct SdfFont {
+  std::string texture; // key of the atlas in ResourceManager::texture2d
+  float ascent = 0.f;
+  float line_height = 0.f;
+  std::unordered_map<char32_t, SdfGlyph> glyphs;
+
+  auto find(char32_t codepoint) const -> const SdfGlyph *;
+};
+
+// the atlas as built on the cpu, one distance byte per texel: 128 on the outline, more inside
+struct SdfFontImage {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<uint8_t> texels; // rows from the bottom, like the textures the sprite path loads
+  SdfFont font;
+};
+
+// builds signed distance field glyph atlases. the glyphs are rasterized by the os at 4x the atlas size,
+// the exact euclidean distance transform of that bitmap is averaged down to the atlas texels.
+// building takes a while for large charsets, so atlases are kept in cache_dir keyed by the desc.
+struct SdfFontCache {
+  inline static std::filesystem::path cache_dir = "font_cache";
+  inline static bool use_disk_cache = true;
+
+  static auto load(const SdfFontDesc &desc) -> std::optional<SdfFontImage>;
+};
+
+} // namespace rugame
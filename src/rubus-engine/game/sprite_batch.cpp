@@ -0,0 +1,182 @@
+#include "sprite_batch.hpp"
+
+#include <cstring>
+#include <span>
+
+#include <rubus-engine/graphics/state_cache.hpp>
+
+namespace rugame {
+
+auto make_sprite_instance(const Sprite *sprite, const TextureResource &texture, glm::vec4 params)
+  -> graphics::SpriteInstance {
+  // the sprite uv rect is relative to its image
+  const auto &image = texture.uv_rect;
+  const auto image_size = glm::vec2{image.z - image.x, image.w - image.y};
+  const auto uv_min = glm::vec2{image} + glm::vec2{sprite->uv_rect} * image_size;
+  const auto uv_max = glm::vec2{image} + glm::vec2{sprite->uv_rect.z, sprite->uv_rect.w} * image_size;
+
+  // the unit quad spans -1..1, so pivot * size are the half extents
+  const auto &transform = sprite->transform;
+  // two channels per float, 16 bit integers are exact
+  const auto color = sprite->color;
+  const auto red_green = (float)(color & 0xffff);
+  const auto blue_alpha = (float)(color >> 16);
+  return {
+    .axes = {transform.x_axis * (sprite->pivot.x * sprite->width),
+             transform.y_axis * (sprite->pivot.y * sprite->height)},
+    .center = {transform.translation, red_green, blue_alpha},
+    .uv_rect = {uv_min, uv_max},
+    .params = {params.x, params.y, params.z, (float)sprite->material.palette_row(texture)},
+  };
+}
+
+auto SpriteBatch::init() -> void {
+  ResourceManager::meshes.init();
+  mesh = graphics::make_sprite_mesh(ResourceManager::meshes.vbo, ResourceManager::meshes.ebo);
+  instance_buffer.init(initial_capacity * sizeof(graphics::SpriteInstance));
+  graphics::set_sprite_instance_buffer(mesh, instance_buffer.buffer);
+  instances.reserve(initial_capacity);
+}
+
+auto SpriteBatch::deinit() -> void {
+  mesh.delete_buffers();
+  mesh = {};
+  instance_buffer.deinit();
+  instances.clear();
+  batches.clear();
+}
+
+auto SpriteBatch::begin() -> void {
+  instances.clear();
+  batches.clear();
+  stats = {};
+}
+
+auto SpriteBatch::draw(Sprite *sprite, const TextureResource &texture_res, BlendMode blend, float depth) -> void {
+  const auto shader = sprite->material.program_handle(texture_res);
+  const auto texture = texture_res.handle;
+
+  const auto mesh = select_sprite_mesh(sprite->uv_rect, texture_res.mesh);
+  push_batch(shader, texture, blend, mesh).instance_count += 1;
+
+  const auto alpha_cutoff = blend == BlendMode::Opaque ? 0.5f : 0.f;
+  instances.push_back(make_sprite_instance(sprite, texture_res, {depth, alpha_cutoff, 0.f, 0.f}));
+  stats.sprites += 1;
+}
+
+auto SpriteBatch::draw(const SpriteTransformStream &stream, const SpriteMaterial &material,
+                       const TextureResource &texture_res, BlendMode blend, float depth, uint32_t color) -> void {
+  const auto count = (uint32_t)stream.size();
+  if (count == 0) {
+    return;
+  }
+  const auto shader = material.program_handle(texture_res);
+  push_batch(shader, texture_res.handle, blend, texture_res.mesh).instance_count += count;
+
+  // quads for the whole stream at once, then the parts every instance shares
+  const auto first = instances.size();
+  instances.resize(first + count);
+  const auto added = std::span{instances}.subspan(first);
+  compute_sprite_quads(stream, added);
+  const auto alpha_cutoff = blend == BlendMode::Opaque ? 0.5f : 0.f;
+  const auto palette = (float)material.palette_row(texture_res);
+  // packed like make_sprite_instance does
+  const auto red_green = (float)(color & 0xffff);
+  const auto blue_alpha = (float)(color >> 16);
+  for (auto &instance : added) {
+    instance.center.z = red_green;
+    instance.center.w = blue_alpha;
+    instance.uv_rect = texture_res.uv_rect;
+    instance.params = {depth, alpha_cutoff, 0.f, palette};
+  }
+  stats.sprites += count;
+}
+
+auto SpriteBatch::push_batch(uint32_t shader, uint32_t texture, BlendMode blend, SpriteMesh mesh) -> Batch & {
+  if (batches.empty() or batches.back().shader != shader or batches.back().texture != texture or
+      batches.back().blend != blend or batches.back().mesh != mesh) {
+    if (not batches.empty()) {
+      if (batches.back().shader != shader) {
+        stats.shader_breaks += 1;
+      } else if (batches.back().texture != texture) {
+        stats.texture_breaks += 1;
+      } else if (batches.back().blend != blend) {
+        stats.blend_breaks += 1;
+      } else {
+        stats.mesh_breaks += 1;
+      }
+    }
+    batches.push_back({shader, texture, blend, mesh, (uint32_t)instances.size(), 0});
+  }
+  return batches.back();
+}
+
+auto SpriteBatch::begin_frame() -> void {
+  instance_buffer.begin_frame();
+}
+
+auto SpriteBatch::end_frame() -> void {
+  instance_buffer.end_frame();
+}
+
+auto SpriteBatch::end() -> void {
+  if (not instances.empty()) {
+    constexpr auto stride = sizeof(graphics::SpriteInstance);
+    const auto size = instances.size() * stride;
+
+    auto alloc = instance_buffer.allocate(size, stride);
+    if (alloc.ptr == nullptr) {
+      // grow so the whole frame fits next time, the old storage is released by gl once the gpu is done with it.
+      // the new buffer starts on a fresh region, the rest of this frame goes there
+      auto region_size = instance_buffer.region_size;
+      while (region_size < instance_buffer.head + size) {
+        region_size *= 2;
+      }
+      instance_buffer.deinit();
+      instance_buffer.init(region_size);
+      graphics::set_sprite_instance_buffer(mesh, instance_buffer.buffer);
+      alloc = instance_buffer.allocate(size, stride);
+    }
+
+    // write every instance of this frame at once, the offset is a multiple of the stride
+    std::memcpy(alloc.ptr, instances.data(), size);
+    const auto base_instance = (uint32_t)(alloc.offset / stride);
+
+    // outlines of textures loaded since the last frame
+    ResourceManager::meshes.upload();
+
+    // the view projection comes from the camera uniform block
+    for (const auto &batch : batches) {
+      graphics::StateCache::use_program(batch.shader);
+      graphics::StateCache::bind_texture(0, batch.texture);
+      if (batch.shader == SpriteMaterial::palette_program.handle) {
+        graphics::StateCache::bind_texture(palette_texture_unit, ResourceManager::palettes.handle);
+      }
+      // only opaque batches write depth, blended ones are tested against it
+      switch (batch.blend) {
+      case BlendMode::Opaque:
+        graphics::StateCache::set_blend(false);
+        graphics::StateCache::set_depth_mask(true);
+        break;
+      case BlendMode::Alpha:
+        graphics::StateCache::set_blend(true);
+        graphics::StateCache::set_depth_mask(false);
+        graphics::StateCache::set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+      case BlendMode::Premultiplied:
+        graphics::StateCache::set_blend(true);
+        graphics::StateCache::set_depth_mask(false);
+        graphics::StateCache::set_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        break;
+      }
+      graphics::draw_sprites_instanced(mesh.vao, batch.mesh.first_index, batch.mesh.index_count,
+                                       batch.mesh.base_vertex, base_instance + batch.first_instance,
+                                       batch.instance_count);
+      stats.draw_calls += 1;
+    }
+  }
+
+  last_stats = stats;
+}
+
+} // namespace rugame
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <rubus-engine/graphics/graphics.hpp>
+#include <rubus-engine/graphics/stream_buffer.hpp>
+#include "game.hpp"
+#include "resource.hpp"
+#include "sprite_transform.hpp"
+
+namespace rugame {
+
+enum struct BlendMode : uint8_t {
+  Opaque,        // no blending, writes depth, texels below half alpha are discarded
+  Alpha,         // straight alpha, also keeps the destination alpha right for offscreen targets
+  Premultiplied, // color is already multiplied by alpha, e.g. a cached layer
+};
+
+// per instance data of a sprite, the sprite uv rect is mapped into the region of its (atlas) texture
+auto make_sprite_instance(const Sprite *sprite, const TextureResource &texture, glm::vec4 params)
+  -> graphics::SpriteInstance;
+
+// collects sprites into one instance buffer and draws them with as few instanced draw calls as possible.
+// every sprite shares one vertex array over the SpriteMeshPool, a batch is broken only when the shader, the texture,
+// the blend mode or the trimmed outline changes.
+// instances are written straight into a persistently mapped stream buffer, every begin()/end() between begin_frame()
+// and end_frame() allocates from the region of that frame.
+struct SpriteBatch {
+  struct Batch {
+    uint32_t shader = 0;
+    uint32_t texture = 0;
+    BlendMode blend = BlendMode::Alpha;
+    SpriteMesh mesh;
+    uint32_t first_instance = 0;
+    uint32_t instance_count = 0;
+  };
+
+  struct Stats {
+    uint32_t sprites = 0;
+    uint32_t draw_calls = 0;
+    uint32_t texture_breaks = 0;
+    uint32_t shader_breaks = 0;
+    uint32_t blend_breaks = 0;
+    uint32_t mesh_breaks = 0;
+  };
+
+  static constexpr uint32_t initial_capacity = 4096; // instances per frame
+
+  graphics::Mesh mesh;
+  graphics::StreamBuffer instance_buffer;
+
+  std::vector<graphics::SpriteInstance> instances;
+  std::vector<Batch> batches;
+
+  Stats stats;      // current frame
+  Stats last_stats; // last finished frame
+
+  auto init() -> void;
+  auto deinit() -> void;
+
+  // once per frame around every begin()/end(), e.g. the passes of cached layers and the main pass
+  auto begin_frame() -> void;
+  auto end_frame() -> void;
+
+  auto begin() -> void;
+  // depth is in normalized device coordinates, it only matters while the depth test is enabled
+  auto draw(Sprite *sprite, const TextureResource &texture, BlendMode blend = BlendMode::Alpha, float depth = 0.f)
+    -> void;
+  // every sprite of the stream shows the whole texture with one material and `color` (see Sprite::color), in a
+  // single batch
+  auto draw(const SpriteTransformStream &stream, const SpriteMaterial &material, const TextureResource &texture,
+            BlendMode blend = BlendMode::Alpha, float depth = 0.f, uint32_t color = 0xffffffff) -> void;
+  auto end() -> void;
+
+private:
+  auto push_batch(uint32_t shader, uint32_t texture, BlendMode blend, SpriteMesh mesh) -> Batch &;
+};
+
+} // namespace rugame
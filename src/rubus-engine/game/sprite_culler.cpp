@@ -0,0 +1,204 @@
+#include "sprite_culler.hpp"
+
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/state_cache.hpp>
+#include <rubus-engine/graphics/shader_cache.hpp>
+#include "sprite_batch.hpp"
+
+namespace rugame {
+
+auto SpriteCuller::init() -> void {
+  // normally compiled already by SpriteMaterial::init along with the sprite programs
+  auto sprite_cull = graphics::ShaderCache::load({
+    .name = "sprite_cull",
+    .stages = {{GL_COMPUTE_SHADER, "shaders/sprite/cull.glsl"}},
+  });
+  if (sprite_cull == nullptr) {
+    return;
+  }
+  program = *sprite_cull;
+  program.bind_uniform_block("Camera", graphics::camera_uniform_binding);
+
+  auto &device = graphics::Device::current();
+  ssbo_alignment = (size_t)std::max(device.get_integer(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT), 1);
+
+  output_buffer = device.create_buffer();
+  command_buffer = device.create_buffer();
+  ResourceManager::meshes.init();
+  mesh = graphics::make_sprite_mesh(ResourceManager::meshes.vbo, ResourceManager::meshes.ebo);
+  graphics::set_sprite_instance_buffer(mesh, output_buffer);
+
+  input_buffer.init(initial_capacity * sizeof(graphics::SpriteInstance));
+  reserve_output(initial_capacity);
+}
+
+auto SpriteCuller::deinit() -> void {
+  mesh.delete_buffers();
+  mesh = {};
+  input_buffer.deinit();
+  graphics::StateCache::forget_buffer(output_buffer);
+  graphics::StateCache::forget_buffer(command_buffer);
+  graphics::Device::current().delete_buffer(output_buffer);
+  graphics::Device::current().delete_buffer(command_buffer);
+  output_buffer = 0;
+  command_buffer = 0;
+  output_capacity = 0;
+
+  // the program is owned by graphics::ShaderCache
+  program = {};
+  items.clear();
+  command_infos.clear();
+  commands.clear();
+  command_keys.clear();
+}
+
+auto SpriteCuller::begin_frame() -> void {
+  input_buffer.begin_frame();
+}
+
+auto SpriteCuller::end_frame() -> void {
+  input_buffer.end_frame();
+}
+
+auto SpriteCuller::begin() -> void {
+  items.clear();
+  stats = {};
+}
+
+auto SpriteCuller::draw(Sprite *sprite, const TextureResource &texture, float depth) -> void {
+  items.push_back({sprite, &texture, depth});
+}
+
+auto SpriteCuller::end() -> void {
+  if (items.empty() or program.handle == 0) {
+    last_stats = stats;
+    return;
+  }
+  build_commands();
+
+  // stream every instance, tagged with its draw command
+  constexpr auto stride = sizeof(graphics::SpriteInstance);
+  const auto size = items.size() * stride;
+  auto alloc = input_buffer.allocate(size, ssbo_alignment);
+  if (alloc.ptr == nullptr) {
+    auto region_size = input_buffer.region_size;
+    while (region_size < input_buffer.head + size + ssbo_alignment) {
+      region_size *= 2;
+    }
+    input_buffer.deinit();
+    input_buffer.init(region_size);
+    alloc = input_buffer.allocate(size, ssbo_alignment);
+  }
+
+  auto instances = (graphics::SpriteInstance *)alloc.ptr;
+  auto last_key = CommandKey{};
+  auto last_command = 0u;
+  for (auto i = size_t{}; i < items.size(); ++i) {
+    const auto &item = items[i];
+    const auto key = command_key(item);
+    if (i == 0 or key != last_key) {
+      last_key = key;
+      last_command = command_infos.at(key).command;
+    }
+    instances[i] = make_sprite_instance(item.sprite, *item.texture, {item.depth, 0.5f, (float)last_command, 0.f});
+  }
+
+  reserve_output(items.size());
+  auto &device = graphics::Device::current();
+  device.buffer_data(command_buffer, commands.size() * sizeof(graphics::DrawElementsIndirectCommand),
+                     commands.data(), GL_DYNAMIC_DRAW);
+
+  // cull and compact, the shader reads the view projection from the camera uniform block
+  graphics::StateCache::use_program(program.handle);
+  device.uniform_uint(program.location("instance_count"), (uint32_t)items.size());
+  graphics::StateCache::bind_buffer(GL_SHADER_STORAGE_BUFFER, input_buffer.buffer);
+  device.bind_buffer_range(GL_SHADER_STORAGE_BUFFER, 0, input_buffer.buffer, alloc.offset, size);
+  graphics::StateCache::bind_buffer(GL_SHADER_STORAGE_BUFFER, output_buffer);
+  device.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 1, output_buffer);
+  graphics::StateCache::bind_buffer(GL_SHADER_STORAGE_BUFFER, command_buffer);
+  device.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 2, command_buffer);
+  device.dispatch_compute((uint32_t)((items.size() + group_size - 1) / group_size), 1, 1);
+  device.memory_barrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+  // one multi draw per shader/texture run
+  ResourceManager::meshes.upload();
+  graphics::StateCache::set_blend(false);
+  graphics::StateCache::set_depth_mask(true);
+  graphics::StateCache::bind_vertex_array(mesh.vao);
+  graphics::StateCache::bind_buffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+  for (auto first = size_t{}; first < commands.size();) {
+    const auto [shader, texture, _] = command_keys[first];
+    auto last = first + 1;
+    while (last < commands.size() and std::get<0>(command_keys[last]) == shader and
+           std::get<1>(command_keys[last]) == texture) {
+      last += 1;
+    }
+
+    graphics::StateCache::use_program(shader);
+    graphics::StateCache::bind_texture(0, texture);
+    if (shader == SpriteMaterial::palette_program.handle) {
+      graphics::StateCache::bind_texture(palette_texture_unit, ResourceManager::palettes.handle);
+    }
+    device.multi_draw_elements_indirect(GL_TRIANGLES, GL_UNSIGNED_SHORT,
+                                        first * sizeof(graphics::DrawElementsIndirectCommand),
+                                        (int32_t)(last - first));
+    stats.multi_draws += 1;
+    first = last;
+  }
+
+  stats.sprites = (uint32_t)items.size();
+  stats.commands = (uint32_t)commands.size();
+  last_stats = stats;
+}
+
+auto SpriteCuller::command_key(const Item &item) const -> CommandKey {
+  const auto mesh = select_sprite_mesh(item.sprite->uv_rect, item.texture->mesh);
+  return {item.sprite->material.program_handle(*item.texture), item.texture->handle, mesh.first_index};
+}
+
+auto SpriteCuller::build_commands() -> void {
+  // count the instances of every command
+  command_infos.clear();
+  for (const auto &item : items) {
+    auto &info = command_infos[command_key(item)];
+    info.mesh = select_sprite_mesh(item.sprite->uv_rect, item.texture->mesh);
+    info.instance_count += 1;
+  }
+
+  // every command owns a range of the output buffer as large as its input, the cull shader counts instances up
+  commands.clear();
+  command_keys.clear();
+  auto base_instance = uint32_t{};
+  for (auto &[key, info] : command_infos) {
+    info.command = (uint32_t)commands.size();
+    commands.push_back({
+      .count = info.mesh.index_count,
+      .instance_count = 0,
+      .first_index = info.mesh.first_index,
+      .base_vertex = info.mesh.base_vertex,
+      .base_instance = base_instance,
+    });
+    command_keys.push_back(key);
+    base_instance += info.instance_count;
+  }
+}
+
+auto SpriteCuller::reserve_output(size_t instance_count) -> void {
+  if (instance_count <= output_capacity) {
+    return;
+  }
+  auto capacity = std::max(output_capacity, (size_t)initial_capacity);
+  while (capacity < instance_count) {
+    capacity *= 2;
+  }
+  // the buffer name stays the same, so the vertex array keeps pointing at it
+  graphics::Device::current().buffer_data(output_buffer, capacity * sizeof(graphics::SpriteInstance), nullptr,
+                                          GL_DYNAMIC_COPY);
+  output_capacity = capacity;
+}
+
+} // namespace rugame
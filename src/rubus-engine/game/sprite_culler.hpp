@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include <rubus-engine/graphics/graphics.hpp>
+#include <rubus-engine/graphics/shader_program.hpp>
+#include <rubus-engine/graphics/stream_buffer.hpp>
+#include "game.hpp"
+#include "resource.hpp"
+#include "sprite_mesh.hpp"
+
+namespace rugame {
+
+// gpu driven path for the depth tested opaque pass, where draw order does not matter.
+// instances are streamed into an ssbo, a compute pass culls them against the camera and compacts the survivors
+// per draw command, and every shader/texture run is drawn with one glMultiDrawElementsIndirect. the cpu never
+// looks at visibility and never issues a draw per batch.
+struct SpriteCuller {
+  struct Item {
+    Sprite *sprite = nullptr;
+    const TextureResource *texture = nullptr;
+    float depth = 0.f;
+  };
+
+  struct Stats {
+    uint32_t sprites = 0;
+    uint32_t commands = 0;
+    uint32_t multi_draws = 0;
+  };
+
+  // shader, texture, first index of the outline. ordered so one shader/texture run is contiguous
+  using CommandKey = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+  struct CommandInfo {
+    SpriteMesh mesh;
+    uint32_t instance_count = 0;
+    uint32_t command = 0;
+  };
+
+  static constexpr uint32_t initial_capacity = 4096; // instances per frame
+  static constexpr uint32_t group_size = 64;         // local_size_x of the cull shader
+
+  graphics::ShaderProgram program;
+  graphics::Mesh mesh; // instance attributes come from the output buffer
+  graphics::StreamBuffer input_buffer;
+  uint32_t output_buffer = 0;
+  uint32_t command_buffer = 0;
+  size_t output_capacity = 0; // instances
+  size_t ssbo_alignment = 0;
+
+  std::vector<Item> items;
+  std::map<CommandKey, CommandInfo> command_infos;
+  std::vector<graphics::DrawElementsIndirectCommand> commands;
+  std::vector<CommandKey> command_keys;
+
+  Stats stats;      // current frame
+  Stats last_stats; // last finished frame
+
+  auto init() -> void;
+  auto deinit() -> void;
+
+  // once per frame around begin()/end(), see SpriteBatch::begin_frame
+  auto begin_frame() -> void;
+  auto end_frame() -> void;
+
+  auto begin() -> void;
+  auto draw(Sprite *sprite, const TextureResource &texture, float depth) -> void;
+  auto end() -> void;
+
+private:
+  auto command_key(const Item &item) const -> CommandKey;
+  auto build_commands() -> void;
+  auto reserve_output(size_t instance_count) -> void;
+};
+
+} // namespace rugame
@@ -0,0 +1,276 @@
+#include "sprite_mesh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glad/glad.h>
+
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/state_cache.hpp>
+
+namespace rugame {
+
+namespace {
+
+auto cross(glm::i64vec2 o, glm::i64vec2 a, glm::i64vec2 b) -> int64_t {
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+auto cross(glm::dvec2 a, glm::dvec2 b) -> double {
+  return a.x * b.y - a.y * b.x;
+}
+
+// andrew's monotone chain, counter clockwise without collinear points
+auto convex_hull(std::vector<glm::i64vec2> &points) -> std::vector<glm::i64vec2> {
+  std::sort(points.begin(), points.end(), [](auto a, auto b) {
+    return a.x < b.x or (a.x == b.x and a.y < b.y);
+  });
+  points.erase(std::unique(points.begin(), points.end()), points.end());
+  if (points.size() < 3) {
+    return {};
+  }
+
+  auto hull = std::vector<glm::i64vec2>(points.size() * 2);
+  auto k = size_t{};
+  for (auto i = size_t{}; i < points.size(); ++i) {
+    while (k >= 2 and cross(hull[k - 2], hull[k - 1], points[i]) <= 0) {
+      k -= 1;
+    }
+    hull[k++] = points[i];
+  }
+  for (auto i = points.size() - 1, lower = k + 1; i > 0; --i) {
+    while (k >= lower and cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0) {
+      k -= 1;
+    }
+    hull[k++] = points[i - 1];
+  }
+  hull.resize(k - 1);
+  return hull;
+}
+
+auto polygon_area(const std::vector<glm::dvec2> &polygon) -> double {
+  auto area = 0.0;
+  for (auto i = size_t{}; i < polygon.size(); ++i) {
+    area += cross(polygon[i], polygon[(i + 1) % polygon.size()]);
+  }
+  return area / 2.0;
+}
+
+// removes the edge whose removal adds the least area, by extending both neighbouring edges until they meet.
+// the polygon only grows, so it keeps enclosing every visible texel.
+auto remove_cheapest_edge(std::vector<glm::dvec2> &polygon, glm::dvec2 bounds) -> bool {
+  constexpr auto epsilon = 1e-6;
+  const auto n = polygon.size();
+
+  auto best = std::numeric_limits<double>::max();
+  auto best_edge = n;
+  auto best_point = glm::dvec2{};
+  for (auto i = size_t{}; i < n; ++i) {
+    const auto p0 = polygon[(i + n - 1) % n];
+    const auto p1 = polygon[i];
+    const auto p2 = polygon[(i + 1) % n];
+    const auto p3 = polygon[(i + 2) % n];
+
+    // p1 + t * d1 == p2 + u * d2, both lines have to be extended forward to meet
+    const auto d1 = p1 - p0;
+    const auto d2 = p2 - p3;
+    const auto denom = cross(d1, d2);
+    if (std::abs(denom) < epsilon) {
+      continue;
+    }
+    const auto t = cross(p2 - p1, d2) / denom;
+    const auto u = cross(p2 - p1, d1) / denom;
+    if (t < 0.0 or u < 0.0) {
+      continue;
+    }
+
+    // stay inside the image so an atlas neighbour is never sampled
+    const auto point = p1 + t * d1;
+    if (point.x < -epsilon or point.y < -epsilon or point.x > bounds.x + epsilon or point.y > bounds.y + epsilon) {
+      continue;
+    }
+
+    const auto added = std::abs(cross(p2 - p1, point - p1)) / 2.0;
+    if (added < best) {
+      best = added;
+      best_edge = i;
+      best_point = glm::clamp(point, glm::dvec2{0.0}, bounds);
+    }
+  }
+
+  if (best_edge == n) {
+    return false;
+  }
+  polygon[best_edge] = best_point;
+  polygon.erase(polygon.begin() + (std::ptrdiff_t)((best_edge + 1) % n));
+  return true;
+}
+
+} // namespace
+
+auto trim_sprite_outline(const uint8_t *rgba, int width, int height, uint32_t max_vertices, uint8_t alpha_threshold)
+  -> std::vector<glm::vec2> {
+  if (max_vertices < 3 or width <= 0 or height <= 0) {
+    return {};
+  }
+
+  // the outer texel corners of every row are enough for the hull
+  auto points = std::vector<glm::i64vec2>{};
+  for (auto y = 0; y < height; ++y) {
+    const auto row = rgba + (size_t)y * (size_t)width * 4;
+    auto first = -1;
+    auto last = -1;
+    for (auto x = 0; x < width; ++x) {
+      if (row[x * 4 + 3] > alpha_threshold) {
+        first = first < 0 ? x : first;
+        last = x;
+      }
+    }
+    if (first >= 0) {
+      points.push_back({first, y});
+      points.push_back({first, y + 1});
+      points.push_back({last + 1, y});
+      points.push_back({last + 1, y + 1});
+    }
+  }
+
+  auto hull = convex_hull(points);
+  if (hull.empty()) {
+    return {};
+  }
+
+  auto polygon = std::vector<glm::dvec2>{};
+  polygon.reserve(hull.size());
+  for (auto p : hull) {
+    polygon.emplace_back((double)p.x, (double)p.y);
+  }
+
+  const auto bounds = glm::dvec2{width, height};
+  while (polygon.size() > max_vertices) {
+    if (remove_cheapest_edge(polygon, bounds)) {
+      continue;
+    }
+    // no edge can be removed without leaving the image, fall back to the trimmed rectangle
+    if (max_vertices < 4) {
+      return {};
+    }
+    auto min = glm::dvec2{hull.front()};
+    auto max = glm::dvec2{hull.front()};
+    for (auto p : hull) {
+      min = glm::min(min, glm::dvec2{p});
+      max = glm::max(max, glm::dvec2{p});
+    }
+    polygon = {min, {max.x, min.y}, max, {min.x, max.y}};
+  }
+
+  // not worth breaking batches for
+  if (polygon_area(polygon) > 0.9 * bounds.x * bounds.y) {
+    return {};
+  }
+
+  auto outline = std::vector<glm::vec2>{};
+  outline.reserve(polygon.size());
+  for (auto p : polygon) {
+    outline.emplace_back(p / bounds);
+  }
+  return outline;
+}
+
+auto select_sprite_mesh(glm::vec4 sprite_uv_rect, SpriteMesh trimmed) -> SpriteMesh {
+  return sprite_uv_rect == glm::vec4{0.f, 0.f, 1.f, 1.f} ? trimmed : SpriteMesh{};
+}
+
+auto SpriteMeshPool::init() -> void {
+  if (vbo != 0) {
+    return;
+  }
+  vbo = graphics::Device::current().create_buffer();
+  ebo = graphics::Device::current().create_buffer();
+  clear();
+  upload();
+}
+
+auto SpriteMeshPool::deinit() -> void {
+  graphics::StateCache::forget_buffer(vbo);
+  graphics::StateCache::forget_buffer(ebo);
+  graphics::Device::current().delete_buffer(vbo);
+  graphics::Device::current().delete_buffer(ebo);
+  vbo = 0;
+  ebo = 0;
+  vertices.clear();
+  indices.clear();
+  free_meshes.clear();
+  dirty = false;
+}
+
+auto SpriteMeshPool::clear() -> void {
+  // same layout as graphics::make_quad_mesh
+  vertices = {
+    {{+1.f, +1.f, 0.f}, {1.f, 1.f}},
+    {{-1.f, +1.f, 0.f}, {0.f, 1.f}},
+    {{-1.f, -1.f, 0.f}, {0.f, 0.f}},
+    {{+1.f, -1.f, 0.f}, {1.f, 0.f}},
+  };
+  indices = {0, 1, 3, 1, 2, 3};
+  free_meshes.clear();
+  dirty = true;
+}
+
+auto SpriteMeshPool::add(std::span<const glm::vec2> polygon) -> SpriteMesh {
+  if (polygon.size() < 3 or polygon.size() > std::numeric_limits<uint16_t>::max()) {
+    return {};
+  }
+
+  const auto index_count = (uint32_t)(polygon.size() - 2) * 3;
+  auto reused = std::find_if(free_meshes.begin(), free_meshes.end(), [&](const SpriteMesh &mesh) {
+    return mesh.index_count == index_count;
+  });
+  if (reused != free_meshes.end()) {
+    const auto mesh = *reused;
+    free_meshes.erase(reused);
+    for (auto i = size_t{}; i < polygon.size(); ++i) {
+      vertices[(size_t)mesh.base_vertex + i] = {{polygon[i] * 2.f - 1.f, 0.f}, polygon[i]};
+    }
+    dirty = true;
+    return mesh;
+  }
+
+  auto mesh = SpriteMesh{};
+  mesh.first_index = (uint32_t)indices.size();
+  mesh.index_count = index_count;
+  mesh.base_vertex = (int32_t)vertices.size();
+
+  for (auto uv : polygon) {
+    vertices.push_back({{uv * 2.f - 1.f, 0.f}, uv});
+  }
+
+  // convex, a fan is enough
+  for (auto i = size_t{1}; i + 1 < polygon.size(); ++i) {
+    indices.push_back(0);
+    indices.push_back((uint16_t)i);
+    indices.push_back((uint16_t)(i + 1));
+  }
+
+  dirty = true;
+  return mesh;
+}
+
+auto SpriteMeshPool::release(SpriteMesh mesh) -> void {
+  if (mesh != SpriteMesh{}) {
+    free_meshes.push_back(mesh);
+  }
+}
+
+auto SpriteMeshPool::upload() -> void {
+  if (not dirty) {
+    return;
+  }
+  // the buffer names stay the same, so vertex arrays that reference them stay valid
+  auto &device = graphics::Device::current();
+  device.buffer_data(vbo, vertices.size() * sizeof(graphics::SpriteVertex), vertices.data(), GL_STATIC_DRAW);
+  device.buffer_data(ebo, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+  dirty = false;
+}
+
+} // namespace rugame
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <rubus-engine/graphics/graphics.hpp>
+
+namespace rugame {
+
+// index range of a sprite outline inside the SpriteMeshPool, the default is the full quad
+struct SpriteMesh {
+  uint32_t first_index = 0;
+  uint32_t index_count = 6;
+  int32_t base_vertex = 0;
+
+  auto operator==(const SpriteMesh &) const -> bool = default;
+};
+
+// convex polygon around the texels with alpha above `alpha_threshold`, in image uv space and counter clockwise.
+// the polygon never cuts a visible texel and has at most `max_vertices` vertices. returns an empty polygon when
+// the full quad is about as small, or the image is fully transparent.
+auto trim_sprite_outline(const uint8_t *rgba, int width, int height, uint32_t max_vertices,
+                         uint8_t alpha_threshold = 0) -> std::vector<glm::vec2>;
+
+// the trimmed outline covers the whole image, a sprite showing only a part of it keeps the quad
+auto select_sprite_mesh(glm::vec4 sprite_uv_rect, SpriteMesh trimmed) -> SpriteMesh;
+
+// one vertex and index buffer shared by every sprite, the full quad comes first. ranges are drawn with a base
+// vertex so sprites with different outlines still share a vertex array. released ranges are reused by outlines
+// with the same vertex count, the fan indices of a range only depend on that count.
+struct SpriteMeshPool {
+  uint32_t vbo = 0;
+  uint32_t ebo = 0;
+  std::vector<graphics::SpriteVertex> vertices;
+  std::vector<uint16_t> indices;
+  std::vector<SpriteMesh> free_meshes;
+  bool dirty = false;
+
+  auto init() -> void;
+  auto deinit() -> void;
+  auto clear() -> void; // keeps only the full quad
+
+  auto add(std::span<const glm::vec2> polygon) -> SpriteMesh;
+  auto release(SpriteMesh mesh) -> void; // the full quad is never released
+  auto upload() -> void;
+};
+
+} // namespace rugame
@@ -0,0 +1,317 @@
+#include "sprite_scene.hpp"
+
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/state_cache.hpp>
+#include <rubus-engine/graphics/sprite_backend.hpp>
+#include "resource.hpp"
+
+namespace rugame {
+
+auto SpriteScene::init(int width, int height) -> void {
+  screen = Screen{(float)width, (float)height};
+  camera = Camera2d{&screen, {0.f, 0.f, 10.f}};
+  // the sprite programs before the culler, so they are all compiled in one go
+  SpriteMaterial::init();
+  sprite_batch.init();
+  sprite_culler.init();
+}
+
+auto SpriteScene::deinit() -> void {
+  sprites.clear();
+  sprite_batch.deinit();
+  sprite_culler.deinit();
+  for (auto &layer : cached_layers) {
+    layer.deinit();
+  }
+  cached_layers.clear();
+  virtual_target.delete_buffers();
+  virtual_target = {};
+}
+
+auto SpriteScene::resize(int width, int height) -> void {
+  graphics::StateCache::set_viewport(0, 0, width, height);
+  screen.width = (float)width;
+  screen.height = (float)height;
+  screen.update_letterbox();
+  for (auto &layer : cached_layers) {
+    layer.invalidate();
+  }
+}
+
+auto SpriteScene::update(double delta) -> void {
+  this->delta = delta;
+  camera.update();
+}
+
+auto SpriteScene::render_sprites() -> void {
+  // images added to the atlas since the last frame
+  ResourceManager::atlas.update_mips();
+  // the cached layers and the main pass share one region of the stream buffers
+  sprite_batch.begin_frame();
+  sprite_culler.begin_frame();
+  graphics::StateCache::set_framebuffer_srgb(false);
+  graphics::StateCache::set_blend(true);
+
+  // sort sprites
+  render_queue.clear();
+  sprite_textures.resize(sprites.size());
+  for (auto i = uint32_t{}; i < sprites.size(); ++i) {
+    auto sprite = sprites[i];
+    auto texture = &ResourceManager::texture2d.at(sprite->material.texture);
+    sprite_textures[i] = texture;
+    auto key = render_queue.make_key(sprite->layer, sprite->zorder, sprite->material.program_handle(*texture),
+                                     texture->handle, sprite->z);
+    render_queue.push(key, i);
+  }
+  render_queue.sort();
+
+  // redraw cached layers that changed, cached targets have no depth buffer
+  graphics::StateCache::set_depth_test(false);
+  update_cached_layers();
+
+  // clear, in pixel perfect mode the sprite pass renders into the virtual target
+  const auto render_width = (int)screen.render_width();
+  const auto render_height = (int)screen.render_height();
+  if (screen.is_virtual()) {
+    if (virtual_target.width != render_width or virtual_target.height != render_height) {
+      virtual_target.delete_buffers();
+      virtual_target = graphics::make_render_target(render_width, render_height, true);
+    }
+    graphics::StateCache::bind_draw_framebuffer(virtual_target.framebuffer);
+  } else {
+    graphics::StateCache::bind_draw_framebuffer(0);
+  }
+  graphics::StateCache::set_viewport(0, 0, render_width, render_height);
+  graphics::StateCache::set_depth_mask(true);
+  graphics::Device::current().clear(1.f, 1.f, 1.f, 1.f,
+                                    GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+  // depth follows the sorted order, a sprite drawn later is nearer
+  const auto &items = render_queue.items;
+  const auto depth_of = [&](size_t rank) {
+    return 1.f - 2.f * (float)(rank + 1) / (float)(items.size() + 1);
+  };
+  const auto is_opaque = [&](uint32_t index) {
+    return opaque_pass and sprite_textures[index]->alpha != TextureAlpha::Translucent and
+           find_cached_layer(sprites[index]) == nullptr;
+  };
+  graphics::StateCache::set_depth_test(opaque_pass);
+  graphics::StateCache::set_depth_func(GL_LESS);
+
+  sprite_batch.begin();
+
+  // opaque pass, front to back
+  if (opaque_pass and gpu_culling) {
+    sprite_culler.begin();
+    for (auto rank = items.size(); rank-- > 0;) {
+      const auto &item = items[rank];
+      if (is_opaque(item.index)) {
+        sprite_culler.draw(sprites[item.index], *sprite_textures[item.index], depth_of(rank));
+      }
+    }
+    sprite_culler.end();
+  } else if (opaque_pass) {
+    for (auto rank = items.size(); rank-- > 0;) {
+      const auto &item = items[rank];
+      if (is_opaque(item.index)) {
+        sprite_batch.draw(sprites[item.index], *sprite_textures[item.index], BlendMode::Opaque, depth_of(rank));
+      }
+    }
+  }
+
+  // blended pass, back to front. a cached layer is composited where its first member would be drawn
+  for (auto rank = size_t{}; rank < items.size(); ++rank) {
+    const auto &item = items[rank];
+    auto sprite = sprites[item.index];
+    if (auto layer = find_cached_layer(sprite); layer != nullptr) {
+      if (layer->members.front() == item.index) {
+        sprite_batch.draw(&layer->quad, layer->texture(), BlendMode::Premultiplied, depth_of(rank));
+      }
+      continue;
+    }
+    if (is_opaque(item.index)) {
+      continue;
+    }
+    const auto texture = sprite_textures[item.index];
+    sprite_batch.draw(sprite, *texture, texture->premultiplied ? BlendMode::Premultiplied : BlendMode::Alpha,
+                      depth_of(rank));
+  }
+  sprite_batch.end();
+  sprite_batch.end_frame();
+  sprite_culler.end_frame();
+  sprites.clear();
+  if (screen.is_virtual()) {
+    present_virtual_target();
+  }
+  graphics::StateCache::end_frame();
+}
+
+auto SpriteScene::render_sprites_backend() -> void {
+  auto &backend = *graphics::SpriteBackend::active;
+
+  // same order and depth as render_sprites
+  render_queue.clear();
+  sprite_textures.resize(sprites.size());
+  for (auto i = uint32_t{}; i < sprites.size(); ++i) {
+    auto sprite = sprites[i];
+    auto texture = &ResourceManager::texture2d.at(sprite->material.texture);
+    sprite_textures[i] = texture;
+    auto key = render_queue.make_key(sprite->layer, sprite->zorder, 0, texture->handle, sprite->z);
+    render_queue.push(key, i);
+  }
+  render_queue.sort();
+
+  if (not backend.begin_frame((uint32_t)screen.width, (uint32_t)screen.height, camera.view_projection,
+                              {1.f, 1.f, 1.f, 1.f})) {
+    sprites.clear();
+    return;
+  }
+  const auto &items = render_queue.items;
+  const auto depth_of = [&](size_t rank) {
+    return 1.f - 2.f * (float)(rank + 1) / (float)(items.size() + 1);
+  };
+  const auto is_opaque = [&](uint32_t index) {
+    return opaque_pass and sprite_textures[index]->alpha != TextureAlpha::Translucent;
+  };
+
+  // opaque front to back, blended back to front, the texture travels with the instance
+  for (auto rank = items.size(); rank-- > 0;) {
+    const auto index = items[rank].index;
+    if (is_opaque(index)) {
+      const auto &texture = *sprite_textures[index];
+      backend.draw(make_sprite_instance(sprites[index], texture, {depth_of(rank), 0.5f, 0.f, 0.f}),
+                   texture.handle, false);
+    }
+  }
+  for (auto rank = size_t{}; rank < items.size(); ++rank) {
+    const auto index = items[rank].index;
+    if (not is_opaque(index)) {
+      const auto &texture = *sprite_textures[index];
+      backend.draw(make_sprite_instance(sprites[index], texture, {depth_of(rank), 0.f, 0.f, 0.f}),
+                   texture.handle, true);
+    }
+  }
+  backend.end_frame();
+  sprites.clear();
+}
+
+auto SpriteScene::set_virtual_resolution(int width, int height, float pixel_size) -> void {
+  screen.virtual_width = width;
+  screen.virtual_height = height;
+  screen.pixel_size = pixel_size;
+  screen.update_letterbox();
+  for (auto &layer : cached_layers) {
+    layer.invalidate();
+  }
+}
+
+auto SpriteScene::present_virtual_target() -> void {
+  graphics::StateCache::bind_draw_framebuffer(0);
+  graphics::StateCache::set_viewport(0, 0, (int)screen.width, (int)screen.height);
+
+  // letterbox bars
+  graphics::Device::current().clear(0.f, 0.f, 0.f, 1.f,
+                                    GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+  // integer upscale with nearest filtering, gl window coordinates start at the bottom left
+  const auto dst_width = screen.virtual_width * screen.scale;
+  const auto dst_height = screen.virtual_height * screen.scale;
+  const auto dst_x = screen.offset.x;
+  const auto dst_y = (int)screen.height - screen.offset.y - dst_height;
+  graphics::Device::current().blit_framebuffer(virtual_target.framebuffer, 0, 0, 0, virtual_target.width,
+                                               virtual_target.height, dst_x, dst_y, dst_x + dst_width,
+                                               dst_y + dst_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+
+auto SpriteScene::add_cached_layer(int32_t zorder_min, int32_t zorder_max) -> CachedLayer * {
+  return &cached_layers.emplace_back(zorder_min, zorder_max);
+}
+
+auto SpriteScene::find_cached_layer(const Sprite *sprite) -> CachedLayer * {
+  if (not sprite->is_static) {
+    return nullptr;
+  }
+  for (auto &layer : cached_layers) {
+    if (layer.contains(sprite)) {
+      return layer.interleaved ? nullptr : &layer;
+    }
+  }
+  return nullptr;
+}
+
+auto SpriteScene::update_cached_layers() -> void {
+  if (cached_layers.empty()) {
+    return;
+  }
+
+  // collect members in draw order, a sprite belongs to the first layer that contains it
+  for (auto &layer : cached_layers) {
+    layer.members.clear();
+  }
+  const auto &items = render_queue.items;
+  for (auto rank = size_t{}; rank < items.size(); ++rank) {
+    const auto sprite = sprites[items[rank].index];
+    if (not sprite->is_static) {
+      continue;
+    }
+    for (auto &layer : cached_layers) {
+      if (layer.contains(sprite)) {
+        if (layer.members.empty()) {
+          layer.first_rank = rank;
+        }
+        layer.last_rank = rank;
+        layer.members.push_back(items[rank].index);
+        break;
+      }
+    }
+  }
+  // the composite can only stand in for members that are drawn back to back
+  for (auto &layer : cached_layers) {
+    layer.interleaved = not layer.members.empty() and layer.last_rank - layer.first_rank + 1 != layer.members.size();
+  }
+
+  const auto width = (int)screen.render_width();
+  const auto height = (int)screen.render_height();
+  for (auto &layer : cached_layers) {
+    if (layer.members.empty() or layer.interleaved) {
+      continue;
+    }
+
+    // screen sized quad in front of the camera
+    layer.quad.width = screen.view_width();
+    layer.quad.height = screen.view_height();
+    layer.quad.zorder = layer.zorder_min;
+    layer.quad.transform = Affine2d::translate({camera.position.x, camera.position.y});
+
+    auto hash = uint64_t{14695981039346656037ull};
+    auto dirty = false;
+    for (auto index : layer.members) {
+      hash = CachedLayer::hash_member(hash, sprites[index], sprite_textures[index]);
+      dirty = dirty or sprites[index]->dirty;
+    }
+    if (not dirty and not layer.needs_redraw(&camera, hash)) {
+      continue;
+    }
+
+    layer.prepare_target(width, height);
+    graphics::StateCache::bind_draw_framebuffer(layer.target.framebuffer);
+    graphics::StateCache::set_viewport(0, 0, width, height);
+    graphics::Device::current().clear(0.f, 0.f, 0.f, 0.f, GL_COLOR_BUFFER_BIT);
+
+    sprite_batch.begin();
+    for (auto index : layer.members) {
+      const auto texture = sprite_textures[index];
+      sprite_batch.draw(sprites[index], *texture,
+                        texture->premultiplied ? BlendMode::Premultiplied : BlendMode::Alpha);
+      sprites[index]->dirty = false;
+    }
+    sprite_batch.end();
+
+    layer.valid = true;
+    layer.members_hash = hash;
+    layer.view_projection = camera.view_projection;
+    layer.redraws += 1;
+  }
+}
+
+} // namespace rugame
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include <rubus-engine/graphics/graphics.hpp>
+#include "game.hpp"
+#include "sprite_batch.hpp"
+#include "sprite_culler.hpp"
+#include "render_queue.hpp"
+#include "cached_layer.hpp"
+
+namespace rugame {
+
+// the sprite half of a rugame::Scene: camera, sorting and the sprite passes, without a window or the gui. it draws
+// on whatever graphics::Device is current, so it runs headless on a graphics::NullDevice (see tools/rubus-bench)
+struct SpriteScene {
+  Screen screen;
+  Camera2d camera;
+  std::vector<Sprite *> sprites;
+  RenderQueue render_queue;
+  std::vector<const TextureResource *> sprite_textures;
+  SpriteBatch sprite_batch;
+  SpriteCuller sprite_culler;
+  std::vector<CachedLayer> cached_layers;
+  graphics::RenderTarget virtual_target;
+
+  // draw opaque and cutout sprites front to back with depth writes first, so hidden pixels are rejected by
+  // the depth test, and only translucent sprites go through the sorted blended pass
+  bool opaque_pass = false;
+  bool gpu_culling = false; // the opaque pass is culled and drawn on the gpu by the SpriteCuller
+
+  double delta = 0;
+
+  // the size of the default framebuffer
+  auto init(int width, int height) -> void;
+  auto deinit() -> void;
+  auto resize(int width, int height) -> void;
+  auto update(double delta) -> void;
+  // draws and then clears `sprites`, no gui and no swap
+  auto render_sprites() -> void;
+  // render_sprites on graphics::SpriteBackend::active: window resolution, plain quads, no cached layers
+  auto render_sprites_backend() -> void;
+
+  // pixel perfect mode, pass 0 x 0 to render at window resolution again
+  auto set_virtual_resolution(int width, int height, float pixel_size = 1.f) -> void;
+  auto present_virtual_target() -> void;
+
+  auto add_cached_layer(int32_t zorder_min, int32_t zorder_max) -> CachedLayer *;
+  // the layer that composites `sprite` this frame, none for a dynamic sprite or an interleaved layer
+  auto find_cached_layer(const Sprite *sprite) -> CachedLayer *;
+  auto update_cached_layers() -> void;
+};
+
+} // namespace rugame
@@ -0,0 +1,238 @@
+#include "sprite_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define RUBUS_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RUBUS_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RUBUS_NEON 1
+#endif
+
+namespace rugame {
+
+namespace {
+
+// F: floats, I: int32s, M: per lane mask, all `width` wide
+struct ScalarLanes {
+  using F = float;
+  using I = int32_t;
+  using M = bool;
+  static constexpr size_t width = 1;
+
+  static auto load(const float *p) -> F { return *p; }
+  static auto store(float *p, F v) -> void { *p = v; }
+  static auto set(float v) -> F { return v; }
+  static auto add(F a, F b) -> F { return a + b; }
+  static auto sub(F a, F b) -> F { return a - b; }
+  static auto mul(F a, F b) -> F { return a * b; }
+  static auto madd(F a, F b, F c) -> F { return a * b + c; }
+  static auto round_to_int(F v) -> I { return (I)std::nearbyint(v); }
+  static auto to_float(I v) -> F { return (F)v; }
+  static auto bit_set(I v, int32_t bit) -> M { return (v & bit) != 0; }
+  static auto select(M m, F a, F b) -> F { return m ? a : b; }
+  static auto negate_if(M m, F v) -> F { return m ? -v : v; }
+  static auto add_int(I v, int32_t n) -> I { return v + n; }
+};
+
+#if defined(RUBUS_AVX2)
+struct SimdLanes {
+  using F = __m256;
+  using I = __m256i;
+  using M = __m256;
+  static constexpr size_t width = 8;
+
+  static auto load(const float *p) -> F { return _mm256_loadu_ps(p); }
+  static auto store(float *p, F v) -> void { _mm256_storeu_ps(p, v); }
+  static auto set(float v) -> F { return _mm256_set1_ps(v); }
+  static auto add(F a, F b) -> F { return _mm256_add_ps(a, b); }
+  static auto sub(F a, F b) -> F { return _mm256_sub_ps(a, b); }
+  static auto mul(F a, F b) -> F { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__)
+  static auto madd(F a, F b, F c) -> F { return _mm256_fmadd_ps(a, b, c); }
+#else
+  static auto madd(F a, F b, F c) -> F { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+  static auto round_to_int(F v) -> I { return _mm256_cvtps_epi32(v); }
+  static auto to_float(I v) -> F { return _mm256_cvtepi32_ps(v); }
+  static auto bit_set(I v, int32_t bit) -> M {
+    const auto b = _mm256_set1_epi32(bit);
+    return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(v, b), b));
+  }
+  static auto select(M m, F a, F b) -> F { return _mm256_blendv_ps(b, a, m); }
+  static auto negate_if(M m, F v) -> F { return _mm256_xor_ps(v, _mm256_and_ps(m, _mm256_set1_ps(-0.f))); }
+  static auto add_int(I v, int32_t n) -> I { return _mm256_add_epi32(v, _mm256_set1_epi32(n)); }
+};
+#elif defined(RUBUS_SSE2)
+struct SimdLanes {
+  using F = __m128;
+  using I = __m128i;
+  using M = __m128;
+  static constexpr size_t width = 4;
+
+  static auto load(const float *p) -> F { return _mm_loadu_ps(p); }
+  static auto store(float *p, F v) -> void { _mm_storeu_ps(p, v); }
+  static auto set(float v) -> F { return _mm_set1_ps(v); }
+  static auto add(F a, F b) -> F { return _mm_add_ps(a, b); }
+  static auto sub(F a, F b) -> F { return _mm_sub_ps(a, b); }
+  static auto mul(F a, F b) -> F { return _mm_mul_ps(a, b); }
+  static auto madd(F a, F b, F c) -> F { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+  static auto round_to_int(F v) -> I { return _mm_cvtps_epi32(v); }
+  static auto to_float(I v) -> F { return _mm_cvtepi32_ps(v); }
+  static auto bit_set(I v, int32_t bit) -> M {
+    const auto b = _mm_set1_epi32(bit);
+    return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(v, b), b));
+  }
+  static auto select(M m, F a, F b) -> F { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+  static auto negate_if(M m, F v) -> F { return _mm_xor_ps(v, _mm_and_ps(m, _mm_set1_ps(-0.f))); }
+  static auto add_int(I v, int32_t n) -> I { return _mm_add_epi32(v, _mm_set1_epi32(n)); }
+};
+#elif defined(RUBUS_NEON)
+struct SimdLanes {
+  using F = float32x4_t;
+  using I = int32x4_t;
+  using M = uint32x4_t;
+  static constexpr size_t width = 4;
+
+  static auto load(const float *p) -> F { return vld1q_f32(p); }
+  static auto store(float *p, F v) -> void { vst1q_f32(p, v); }
+  static auto set(float v) -> F { return vdupq_n_f32(v); }
+  static auto add(F a, F b) -> F { return vaddq_f32(a, b); }
+  static auto sub(F a, F b) -> F { return vsubq_f32(a, b); }
+  static auto mul(F a, F b) -> F { return vmulq_f32(a, b); }
+  static auto madd(F a, F b, F c) -> F { return vfmaq_f32(c, a, b); }
+  static auto round_to_int(F v) -> I { return vcvtnq_s32_f32(v); }
+  static auto to_float(I v) -> F { return vcvtq_f32_s32(v); }
+  static auto bit_set(I v, int32_t bit) -> M { return vtstq_s32(v, vdupq_n_s32(bit)); }
+  static auto select(M m, F a, F b) -> F { return vbslq_f32(m, a, b); }
+  static auto negate_if(M m, F v) -> F {
+    const auto sign = vandq_u32(m, vdupq_n_u32(0x80000000u));
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(v), sign));
+  }
+  static auto add_int(I v, int32_t n) -> I { return vaddq_s32(v, vdupq_n_s32(n)); }
+};
+#else
+using SimdLanes = ScalarLanes;
+#endif
+
+// sin and cos of every lane, accurate to a few ulp for sprite sized angles.
+// reduces by pi/2 in three steps (cody-waite) and evaluates the cephes minimax polynomials on [-pi/4, pi/4]
+template <typename L>
+auto sincos(typename L::F x, typename L::F &sin, typename L::F &cos) -> void {
+  constexpr auto two_over_pi = 0.636619772367581343f;
+  constexpr auto dp1 = 1.5703125f;
+  constexpr auto dp2 = 4.837512969970703125e-4f;
+  constexpr auto dp3 = 7.54978995489188216e-8f;
+
+  const auto quadrant = L::round_to_int(L::mul(x, L::set(two_over_pi)));
+  const auto q = L::to_float(quadrant);
+  auto r = L::madd(q, L::set(-dp1), x);
+  r = L::madd(q, L::set(-dp2), r);
+  r = L::madd(q, L::set(-dp3), r);
+  const auto r2 = L::mul(r, r);
+
+  auto ps = L::set(-1.9515295891e-4f);
+  ps = L::madd(ps, r2, L::set(8.3321608736e-3f));
+  ps = L::madd(ps, r2, L::set(-1.6666654611e-1f));
+  ps = L::madd(L::mul(ps, r2), r, r);
+
+  auto pc = L::set(2.443315711809948e-5f);
+  pc = L::madd(pc, r2, L::set(-1.388731625493765e-3f));
+  pc = L::madd(pc, r2, L::set(4.166664568298827e-2f));
+  pc = L::madd(L::mul(pc, r2), r2, L::madd(r2, L::set(-0.5f), L::set(1.f)));
+
+  // sin(r + q pi/2) cycles through sin, cos, -sin, -cos
+  const auto swap = L::bit_set(quadrant, 1);
+  sin = L::negate_if(L::bit_set(quadrant, 2), L::select(swap, pc, ps));
+  cos = L::negate_if(L::bit_set(L::add_int(quadrant, 1), 2), L::select(swap, ps, pc));
+}
+
+// sprites [first, last) in steps of L::width, returns where it stopped
+template <typename L>
+auto compute_quads(const SpriteTransformStream &stream, std::span<graphics::SpriteInstance> out, size_t first,
+                   size_t last) -> size_t {
+  auto i = first;
+  for (; i + L::width <= last; i += L::width) {
+    auto sin = typename L::F{};
+    auto cos = typename L::F{};
+    sincos<L>(L::load(stream.rotation.data() + i), sin, cos);
+
+    // half extents, the unit quad spans -1..1 and is scaled by pivot * size
+    const auto half_x = L::mul(L::mul(L::load(stream.pivot_x.data() + i), L::load(stream.width.data() + i)),
+                               L::load(stream.scale_x.data() + i));
+    const auto half_y = L::mul(L::mul(L::load(stream.pivot_y.data() + i), L::load(stream.height.data() + i)),
+                               L::load(stream.scale_y.data() + i));
+
+    float axis_x_x[L::width];
+    float axis_x_y[L::width];
+    float axis_y_x[L::width];
+    float axis_y_y[L::width];
+    L::store(axis_x_x, L::mul(cos, half_x));
+    L::store(axis_x_y, L::mul(sin, half_x));
+    L::store(axis_y_x, L::mul(L::sub(L::set(0.f), sin), half_y));
+    L::store(axis_y_y, L::mul(cos, half_y));
+
+    for (auto k = size_t{}; k < L::width; ++k) {
+      out[i + k].axes = {axis_x_x[k], axis_x_y[k], axis_y_x[k], axis_y_y[k]};
+      out[i + k].center = {stream.position_x[i + k], stream.position_y[i + k], 0.f, 0.f};
+    }
+  }
+  return i;
+}
+
+} // namespace
+
+auto SpriteTransformStream::size() const -> size_t {
+  return position_x.size();
+}
+
+auto SpriteTransformStream::clear() -> void {
+  position_x.clear();
+  position_y.clear();
+  rotation.clear();
+  scale_x.clear();
+  scale_y.clear();
+  pivot_x.clear();
+  pivot_y.clear();
+  width.clear();
+  height.clear();
+}
+
+auto SpriteTransformStream::reserve(size_t count) -> void {
+  position_x.reserve(count);
+  position_y.reserve(count);
+  rotation.reserve(count);
+  scale_x.reserve(count);
+  scale_y.reserve(count);
+  pivot_x.reserve(count);
+  pivot_y.reserve(count);
+  width.reserve(count);
+  height.reserve(count);
+}
+
+auto SpriteTransformStream::push(glm::vec2 position, float rotation, glm::vec2 scale, glm::vec2 pivot, float width,
+                                 float height) -> void {
+  position_x.push_back(position.x);
+  position_y.push_back(position.y);
+  this->rotation.push_back(rotation);
+  scale_x.push_back(scale.x);
+  scale_y.push_back(scale.y);
+  pivot_x.push_back(pivot.x);
+  pivot_y.push_back(pivot.y);
+  this->width.push_back(width);
+  this->height.push_back(height);
+}
+
+auto compute_sprite_quads(const SpriteTransformStream &stream, std::span<graphics::SpriteInstance> out) -> void {
+  const auto count = std::min(stream.size(), out.size());
+  const auto done = compute_quads<SimdLanes>(stream, out, 0, count);
+  compute_quads<ScalarLanes>(stream, out, done, count);
+}
+
+} // namespace rugame
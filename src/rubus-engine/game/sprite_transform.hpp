@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <rubus-engine/graphics/graphics.hpp>
+
+namespace rugame {
+
+// structure of arrays transforms for sprites that are drawn in bulk (particles, tiles, bullets), one entry per
+// sprite. the layout lets compute_sprite_quads load a full simd register from every field.
+struct SpriteTransformStream {
+  std::vector<float> position_x;
+  std::vector<float> position_y;
+  std::vector<float> rotation; // radians, counter clockwise
+  std::vector<float> scale_x;
+  std::vector<float> scale_y;
+  std::vector<float> pivot_x;
+  std::vector<float> pivot_y;
+  std::vector<float> width;
+  std::vector<float> height;
+
+  auto size() const -> size_t;
+  auto clear() -> void;
+  auto reserve(size_t count) -> void;
+  auto push(glm::vec2 position, float rotation, glm::vec2 scale, glm::vec2 pivot, float width, float height)
+    -> void;
+};
+
+// writes the final world space quad (center and rotated, scaled half axes) of every sprite in the stream into
+// `out`, which must hold stream.size() instances. the color in center.zw is zeroed, it is up to the caller along
+// with the uv rects and params, which are left alone.
+// uses avx2 (with fma when available), sse2 or neon for all but the last few sprites.
+auto compute_sprite_quads(const SpriteTransformStream &stream, std::span<graphics::SpriteInstance> out) -> void;
+
+} // namespace rugame
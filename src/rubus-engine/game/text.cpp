@@ -0,0 +1,168 @@
+#include "text.hpp"
+
+#include <algorithm>
+#include <format>
+#include <iostream>
+
+#include "resource.hpp"
+
+namespace rugame {
+
+Text::Text(std::string font, std::string_view text, float size)
+    : font{std::move(font)}, text{decode_utf8(text)}, size{size} {}
+
+auto Text::set_text(std::string_view text) -> void {
+  auto decoded = decode_utf8(text);
+  if (decoded != this->text) {
+    this->text = std::move(decoded);
+    dirty = true;
+  }
+}
+
+auto Text::set_font(std::string font) -> void {
+  if (font != this->font) {
+    this->font = std::move(font);
+    dirty = true;
+  }
+}
+
+auto Text::set_size(float size) -> void {
+  if (size != this->size) {
+    this->size = size;
+    dirty = true;
+  }
+}
+
+auto Text::set_anchor(glm::vec2 anchor) -> void {
+  if (anchor != this->anchor) {
+    this->anchor = anchor;
+    dirty = true;
+  }
+}
+
+auto Text::bounds() -> glm::vec4 {
+  if (dirty) {
+    layout();
+  }
+  return extent;
+}
+
+auto Text::draw(std::vector<Sprite *> &sprites) -> void {
+  if (dirty) {
+    layout();
+  }
+  for (auto i = size_t{}; i < glyphs.size(); ++i) {
+    auto &glyph = glyphs[i];
+    glyph.transform = transform * Affine2d::translate(centers[i]);
+    glyph.z = z;
+    glyph.layer = layer;
+    glyph.zorder = zorder;
+    glyph.color = color;
+    sprites.push_back(&glyph);
+  }
+}
+
+auto Text::layout() -> void {
+  dirty = false;
+  glyphs.clear();
+  centers.clear();
+  extent = {0.f, 0.f, 0.f, 0.f};
+
+  auto it = ResourceManager::fonts.find(font);
+  if (it == ResourceManager::fonts.end()) {
+    std::cerr << std::format("Error: font \"{}\" is not loaded\n", font);
+    return;
+  }
+  const auto &sdf_font = it->second;
+  const auto fallback = sdf_font.find(U'?');
+
+  // pen positions in ems, lines going down from the top of the block at y = 0
+  struct Line {
+    size_t first_glyph = 0;
+    float width = 0.f;
+  };
+  auto lines = std::vector<Line>{{}};
+  auto pen = glm::vec2{0.f, -sdf_font.ascent};
+  for (auto codepoint : text) {
+    if (codepoint == U'\n') {
+      lines.back().width = pen.x;
+      lines.push_back({glyphs.size(), 0.f});
+      pen = {0.f, pen.y - sdf_font.line_height};
+      continue;
+    }
+    auto glyph = sdf_font.find(codepoint);
+    if (glyph == nullptr) {
+      glyph = fallback;
+    }
+    if (glyph == nullptr) {
+      continue;
+    }
+    // whitespace only moves the pen
+    if (glyph->size.x > 0.f and glyph->size.y > 0.f) {
+      auto sprite = Sprite{{0.5f, 0.5f}, glyph->size.x * size, glyph->size.y * size, SpriteMaterial{font}};
+      sprite.uv_rect = glyph->uv_rect;
+      sprite.material.shader = SpriteShader::Sdf;
+      glyphs.push_back(std::move(sprite));
+      centers.push_back((pen + glyph->offset + glyph->size * 0.5f) * size);
+    }
+    pen.x += glyph->advance;
+  }
+  lines.back().width = pen.x;
+
+  // align the lines within the block, then put the anchor at the origin
+  auto block_width = 0.f;
+  for (const auto &line : lines) {
+    block_width = std::max(block_width, line.width);
+  }
+  const auto width = block_width * size;
+  const auto height = (float)lines.size() * sdf_font.line_height * size;
+  const auto origin = glm::vec2{anchor.x * width, anchor.y * height - height};
+  for (auto i = size_t{}; i < lines.size(); ++i) {
+    const auto last_glyph = i + 1 < lines.size() ? lines[i + 1].first_glyph : glyphs.size();
+    const auto shift = glm::vec2{(block_width - lines[i].width) * size * anchor.x, 0.f} - origin;
+    for (auto g = lines[i].first_glyph; g < last_glyph; ++g) {
+      centers[g] += shift;
+    }
+  }
+  extent = {-origin.x, -height - origin.y, width - origin.x, -origin.y};
+}
+
+auto decode_utf8(std::string_view text) -> std::u32string {
+  auto result = std::u32string{};
+  result.reserve(text.size());
+  for (auto i = size_t{}; i < text.size();) {
+    const auto lead = (uint8_t)text[i];
+    auto length = size_t{};
+    auto codepoint = char32_t{};
+    if (lead < 0x80) {
+      length = 1;
+      codepoint = lead;
+    } else if (lead >= 0xc0 and lead < 0xe0) {
+      length = 2;
+      codepoint = lead & 0x1f;
+    } else if (lead >= 0xe0 and lead < 0xf0) {
+      length = 3;
+      codepoint = lead & 0x0f;
+    } else if (lead >= 0xf0 and lead < 0xf8) {
+      length = 4;
+      codepoint = lead & 0x07;
+    }
+
+    auto valid = length > 0 and i + length <= text.size();
+    for (auto k = size_t{1}; valid and k < length; ++k) {
+      const auto next = (uint8_t)text[i + k];
+      valid = (next & 0xc0) == 0x80;
+      codepoint = (codepoint << 6) | (next & 0x3f);
+    }
+    if (not valid) {
+      result.push_back(U'\ufffd');
+      i += 1;
+      continue;
+    }
+    result.push_back(codepoint);
+    i += length;
+  }
+  return result;
+}
+
+} // namespace rugame
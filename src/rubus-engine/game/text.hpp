@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "affine2d.hpp"
+#include "game.hpp"
+
+namespace rugame {
+
+// world-space text, one sdf sprite per glyph. the glyphs go through the sorted and batched sprite path, so every
+// label of one font shares the draws of its zorder, and scaling only changes the quads.
+struct Text {
+  Affine2d transform;
+  float z = 0.f;
+  uint8_t layer = 0;
+  int32_t zorder = 0;
+  uint32_t color = 0xffffffff; // rgba8, r in the low byte
+
+  Text() = default;
+  // `font` is a key of ResourceManager::fonts, `size` the em size in world units
+  Text(std::string font, std::string_view text, float size);
+
+  auto set_text(std::string_view text) -> void; // utf-8
+  auto set_font(std::string font) -> void;
+  auto set_size(float size) -> void;
+  // point of the text block that sits at the transform origin, {0, 0} is the bottom left, lines follow it too
+  auto set_anchor(glm::vec2 anchor) -> void;
+
+  // local rectangle of the text block, xy: min, zw: max
+  auto bounds() -> glm::vec4;
+  // appends the glyph sprites, e.g. to Scene::sprites. they stay owned by the text and valid until it changes
+  auto draw(std::vector<Sprite *> &sprites) -> void;
+
+private:
+  std::string font;
+  std::u32string text;
+  float size = 16.f;
+  glm::vec2 anchor = {0.5f, 0.5f};
+
+  bool dirty = true;
+  std::vector<Sprite> glyphs;
+  std::vector<glm::vec2> centers; // glyph centers in the local space of the block
+  glm::vec4 extent = {0.f, 0.f, 0.f, 0.f};
+
+  auto layout() -> void;
+};
+
+// codepoints of utf-8 text, malformed sequences become U+FFFD
+auto decode_utf8(std::string_view text) -> std::u32string;
+
+} // namespace rugame
@@ -0,0 +1,242 @@
+#include "texture_atlas.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+
+#include <glad/glad.h>
+
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/state_cache.hpp>
+#include <rubus-engine/graphics/upload_ring.hpp>
+
+namespace rugame {
+
+auto SkylinePacker::init(int width, int height) -> void {
+  this->width = width;
+  this->height = height;
+  used_area = 0;
+  skyline.clear();
+  skyline.push_back({0, 0, width});
+}
+
+auto SkylinePacker::pack(int width, int height) -> std::optional<AtlasRect> {
+  auto best_index = std::optional<size_t>{};
+  auto best_y = std::numeric_limits<int>::max();
+  auto best_width = std::numeric_limits<int>::max();
+
+  // lowest position first, then the narrowest skyline segment
+  for (auto i = size_t{}; i < skyline.size(); ++i) {
+    auto y = fit(i, width, height);
+    if (y.has_value() and (*y < best_y or (*y == best_y and skyline[i].width < best_width))) {
+      best_index = i;
+      best_y = *y;
+      best_width = skyline[i].width;
+    }
+  }
+  if (not best_index.has_value()) {
+    return std::nullopt;
+  }
+
+  const auto index = *best_index;
+  const auto rect = AtlasRect{skyline[index].x, best_y, width, height};
+  skyline.insert(skyline.begin() + (ptrdiff_t)index, Node{rect.x, rect.y + height, width});
+
+  // shrink or remove the segments now covered by the new one
+  for (auto i = index + 1; i < skyline.size();) {
+    const auto &prev = skyline[i - 1];
+    auto &node = skyline[i];
+    const auto prev_end = prev.x + prev.width;
+    if (node.x >= prev_end) {
+      break;
+    }
+    const auto shrink = prev_end - node.x;
+    if (node.width <= shrink) {
+      skyline.erase(skyline.begin() + (ptrdiff_t)i);
+      continue;
+    }
+    node.x += shrink;
+    node.width -= shrink;
+    break;
+  }
+
+  // merge neighbours on the same height
+  for (auto i = size_t{1}; i < skyline.size();) {
+    if (skyline[i - 1].y == skyline[i].y) {
+      skyline[i - 1].width += skyline[i].width;
+      skyline.erase(skyline.begin() + (ptrdiff_t)i);
+    } else {
+      ++i;
+    }
+  }
+
+  used_area += (int64_t)width * height;
+  return rect;
+}
+
+auto SkylinePacker::fit(size_t index, int width, int height) -> std::optional<int> {
+  const auto x = skyline[index].x;
+  if (x + width > this->width) {
+    return std::nullopt;
+  }
+
+  auto y = 0;
+  auto remaining = width;
+  for (auto i = index; remaining > 0; ++i) {
+    if (i == skyline.size()) {
+      return std::nullopt;
+    }
+    y = std::max(y, skyline[i].y);
+    if (y + height > this->height) {
+      return std::nullopt;
+    }
+    remaining -= skyline[i].width;
+  }
+  return y;
+}
+
+auto TextureAtlas::add(const uint8_t *texels, int width, int height) -> std::optional<AtlasEntry> {
+  // gutter on every side, rounded up to the gutter grid
+  const auto cell_w = (width + gutter * 2 + gutter - 1) / gutter * gutter;
+  const auto cell_h = (height + gutter * 2 + gutter - 1) / gutter * gutter;
+  if (cell_w > page_size or cell_h > page_size) {
+    return std::nullopt;
+  }
+
+  // reuse pages in order, empty pages are recreated lazily
+  for (auto i = size_t{}; i <= pages.size(); ++i) {
+    if (i == pages.size()) {
+      pages.push_back(new_page());
+    }
+    auto &page = pages[i];
+    if (page.handle == 0) {
+      page = new_page();
+    }
+
+    auto cell = page.packer.pack(cell_w, cell_h);
+    if (not cell.has_value()) {
+      continue;
+    }
+
+    upload(page, *cell, texels, width, height);
+    page.texture_count += 1;
+    page.texel_area += (int64_t)width * height;
+
+    const auto x = (float)(cell->x + gutter);
+    const auto y = (float)(cell->y + gutter);
+    const auto size = (float)page_size;
+    return AtlasEntry{
+      .page = (int32_t)i,
+      .uv_rect = {x / size, y / size, (x + (float)width) / size, (y + (float)height) / size},
+    };
+  }
+  return std::nullopt;
+}
+
+auto TextureAtlas::release(int32_t page_index) -> void {
+  if (page_index < 0 or (size_t)page_index >= pages.size()) {
+    return;
+  }
+  auto &page = pages[page_index];
+  page.texture_count -= 1;
+  if (page.texture_count == 0) {
+    // free space inside a page is not reclaimed, an empty page is released as a whole
+    graphics::StateCache::forget_texture(page.handle);
+    graphics::Device::current().delete_texture(page.handle);
+    page = {};
+  }
+}
+
+auto TextureAtlas::update_mips() -> void {
+  // the whole page is filtered down, so a burst of adds costs one generation per page instead of one per image
+  for (auto &page : pages) {
+    if (page.mips_stale) {
+      graphics::Device::current().generate_mipmap(page.handle);
+      page.mips_stale = false;
+    }
+  }
+}
+
+auto TextureAtlas::clear() -> void {
+  for (auto &page : pages) {
+    if (page.handle != 0) {
+      graphics::StateCache::forget_texture(page.handle);
+      graphics::Device::current().delete_texture(page.handle);
+    }
+  }
+  pages.clear();
+}
+
+auto TextureAtlas::page_count() const -> size_t {
+  auto count = size_t{};
+  for (const auto &page : pages) {
+    count += page.handle != 0 ? 1 : 0;
+  }
+  return count;
+}
+
+auto TextureAtlas::efficiency() const -> float {
+  auto texels = int64_t{};
+  auto total = int64_t{};
+  for (const auto &page : pages) {
+    if (page.handle != 0) {
+      texels += page.texel_area;
+      total += (int64_t)page_size * page_size;
+    }
+  }
+  return total == 0 ? 0.f : (float)texels / (float)total;
+}
+
+auto TextureAtlas::max_mip_level() const -> int {
+  return indexed ? 0 : std::bit_width((unsigned)gutter) - 1;
+}
+
+auto TextureAtlas::texel_size() const -> size_t {
+  return indexed ? 1 : 4;
+}
+
+auto TextureAtlas::new_page() -> AtlasPage {
+  auto page = AtlasPage{};
+  page.packer.init(page_size, page_size);
+
+  auto &device = graphics::Device::current();
+  page.handle = device.create_texture();
+  device.texture_parameter(page.handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  device.texture_parameter(page.handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  device.texture_parameter(page.handle, GL_TEXTURE_MIN_FILTER, indexed ? GL_NEAREST : GL_NEAREST_MIPMAP_LINEAR);
+  device.texture_parameter(page.handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  device.texture_parameter(page.handle, GL_TEXTURE_MAX_LEVEL, max_mip_level());
+  device.texture_storage(page.handle, max_mip_level() + 1, indexed ? GL_R8 : GL_RGBA8, page_size, page_size);
+
+  // start fully transparent, or at index 0
+  const auto clear_color = std::array<uint8_t, 4>{0, 0, 0, 0};
+  device.clear_texture(page.handle, 0, indexed ? GL_RED : GL_RGBA, GL_UNSIGNED_BYTE, clear_color.data());
+
+  return page;
+}
+
+auto TextureAtlas::upload(AtlasPage &page, AtlasRect rect, const uint8_t *texels, int width, int height) -> void {
+  // copy the image into the cell and replicate its edge texels into the gutter
+  const auto cell_w = rect.width;
+  const auto cell_h = rect.height;
+  const auto size = texel_size();
+  auto cell = std::vector<uint8_t>((size_t)cell_w * cell_h * size);
+  for (auto y = 0; y < cell_h; ++y) {
+    const auto src_y = std::clamp(y - gutter, 0, height - 1);
+    for (auto x = 0; x < cell_w; ++x) {
+      const auto src_x = std::clamp(x - gutter, 0, width - 1);
+      const auto src = texels + ((size_t)src_y * width + src_x) * size;
+      std::copy_n(src, size, cell.data() + ((size_t)y * cell_w + x) * size);
+    }
+  }
+
+  auto &device = graphics::Device::current();
+  device.pixel_store(GL_UNPACK_ALIGNMENT, 1);
+  const auto format = indexed ? GL_RED : GL_RGBA;
+  graphics::upload_texture_sub_image(page.handle, 0, rect.x, rect.y, cell_w, cell_h, format, GL_UNSIGNED_BYTE,
+                                     cell.data());
+  page.mips_stale = not indexed;
+}
+
+} // namespace rugame
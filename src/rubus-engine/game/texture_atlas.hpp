@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace rugame {
+
+struct AtlasRect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+// skyline bottom-left rectangle packer
+struct SkylinePacker {
+  struct Node {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+  };
+
+  int width = 0;
+  int height = 0;
+  int64_t used_area = 0;
+  std::vector<Node> skyline;
+
+  auto init(int width, int height) -> void;
+  auto pack(int width, int height) -> std::optional<AtlasRect>;
+
+private:
+  auto fit(size_t index, int width, int height) -> std::optional<int>;
+};
+
+struct AtlasPage {
+  uint32_t handle = 0;
+  uint32_t texture_count = 0;
+  int64_t texel_area = 0; // texels of the packed images without gutters
+  bool mips_stale = false; // images were added since the mips were generated
+  SkylinePacker packer;
+};
+
+struct AtlasEntry {
+  int32_t page = -1;
+  glm::vec4 uv_rect = {0.f, 0.f, 1.f, 1.f};
+};
+
+// packs images into large texture pages so sprites with different images can share one draw call.
+// every image is surrounded by a gutter of replicated edge texels and placed on a grid of `gutter`
+// texels, so mip levels up to log2(gutter) never mix texels of neighbouring images.
+// an indexed atlas holds the r8 palette indices of rugame::IndexedImage instead, one level without filtering since
+// neighbouring indices do not blend.
+// adding an image only marks its page stale, update_mips regenerates the mips of stale pages once before drawing
+struct TextureAtlas {
+  int page_size = 2048;
+  int gutter = 4;
+  bool indexed = false;
+  std::vector<AtlasPage> pages;
+
+  // `texels` are rgba8, or one index per texel for an indexed atlas
+  auto add(const uint8_t *texels, int width, int height) -> std::optional<AtlasEntry>;
+  auto release(int32_t page) -> void;
+  auto update_mips() -> void;
+  auto clear() -> void;
+
+  auto page_count() const -> size_t;
+  auto efficiency() const -> float; // image texels / page texels of live pages
+  auto max_mip_level() const -> int;
+  auto texel_size() const -> size_t; // bytes
+
+private:
+  auto new_page() -> AtlasPage;
+  auto upload(AtlasPage &page, AtlasRect rect, const uint8_t *texels, int width, int height) -> void;
+};
+
+} // namespace rugame
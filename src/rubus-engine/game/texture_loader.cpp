@@ -0,0 +1,242 @@
+#include "texture_loader.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <iostream>
+
+#include <stb_image.h>
+
+#include <rubus-engine/graphics/sprite_backend.hpp>
+#include "resource.hpp"
+#include "sprite_mesh.hpp"
+
+namespace rugame {
+
+namespace {
+
+auto asset_exists(const std::filesystem::path &path) -> bool {
+  return utils::Vfs::find(path.generic_string()).has_value() or std::filesystem::exists(path);
+}
+
+// packed files are views into the mounted pack, loose ones are mapped and kept with the texture
+auto map_texture_file(const char *file_path, DecodedTexture &texture) -> std::optional<std::span<const std::byte>> {
+  if (auto packed = utils::Vfs::find(file_path); packed.has_value()) {
+    return packed;
+  }
+  texture.file = std::make_unique<utils::MappedFile>();
+  if (not texture.file->open(file_path)) {
+    return std::nullopt;
+  }
+  return texture.file->data();
+}
+
+// the outline and the palette indices, the backends draw plain rgba quads and need neither
+auto derive_from_texels(DecodedTexture &texture, TextureOptions options) -> void {
+  if (graphics::SpriteBackend::active != nullptr) {
+    return;
+  }
+  const auto &base = texture.levels[0];
+  if (options.trim_vertices > 0 and not options.atlas and texture.alpha != TextureAlpha::Opaque) {
+    texture.outline = trim_sprite_outline(base.rgba, base.width, base.height, options.trim_vertices);
+  }
+  if (options.indexed) {
+    texture.indexed = index_image(base.rgba, base.width, base.height);
+  }
+}
+
+} // namespace
+
+auto decode_texture_file(const char *file_path, TextureOptions options) -> std::optional<DecodedTexture> {
+  // block compressed variants are only cooked for the images that opted in, large backgrounds
+  if (options.compressed and graphics::SpriteBackend::active == nullptr) {
+    for (const auto compression : ResourceManager::texture_compressions()) {
+      const auto variant = std::filesystem::path{file_path}.replace_extension(
+        std::format(".{}.ktx2", texture_compression_name(compression)));
+      if (not asset_exists(variant)) {
+        continue;
+      }
+      if (auto texture = decode_ktx2_texture(variant.generic_string().c_str()); texture.has_value()) {
+        return texture;
+      }
+    }
+  }
+  const auto cooked = std::filesystem::path{file_path}.replace_extension(".rtex");
+  if (asset_exists(cooked)) {
+    if (auto texture = decode_cooked_texture(cooked.generic_string().c_str(), options); texture.has_value()) {
+      return texture;
+    }
+  }
+
+  auto width = 0;
+  auto height = 0;
+  auto channels = 0;
+  stbi_set_flip_vertically_on_load_thread(true);
+  auto data = (stbi_uc *)nullptr;
+  if (auto packed = utils::Vfs::find(file_path); packed.has_value()) {
+    data = stbi_load_from_memory((const stbi_uc *)packed->data(), (int)packed->size(), &width, &height, &channels,
+                                 STBI_rgb_alpha);
+  } else {
+    data = stbi_load(file_path, &width, &height, &channels, STBI_rgb_alpha);
+  }
+  if (data == nullptr) {
+    std::cerr << std::format("Error: failed to load texture file \"{}\"\n", file_path);
+    return std::nullopt;
+  }
+
+  auto texture = DecodedTexture{};
+  texture.image.assign(data, data + (size_t)width * height * 4);
+  stbi_image_free(data);
+  texture.levels = {{texture.image.data(), width, height}};
+  texture.alpha = classify_texture_alpha(texture.image.data(), width, height);
+  derive_from_texels(texture, options);
+  return texture;
+}
+
+auto decode_cooked_texture(const char *file_path, TextureOptions options) -> std::optional<DecodedTexture> {
+  auto texture = DecodedTexture{};
+  auto data = map_texture_file(file_path, texture);
+  if (not data.has_value()) {
+    return std::nullopt;
+  }
+  auto cooked = parse_cooked_texture(*data);
+  if (not cooked.has_value()) {
+    std::cerr << std::format("Error: \"{}\" is not a cooked texture of version {}\n", file_path,
+                             cooked_texture_version);
+    return std::nullopt;
+  }
+  // the backends blend straight alpha only
+  if (cooked->header.premultiplied and graphics::SpriteBackend::active != nullptr) {
+    std::cerr << std::format("Error: premultiplied texture \"{}\" needs the gl sprite path\n", file_path);
+    return std::nullopt;
+  }
+
+  for (auto i = size_t{}; i < cooked->levels.size(); ++i) {
+    const auto &level = cooked->levels[i];
+    texture.levels.push_back({cooked->level_data(i), (int)level.width, (int)level.height});
+  }
+  texture.alpha = cooked->header.alpha;
+  texture.premultiplied = cooked->header.premultiplied;
+  // the cooker derived the outline and the palette already, the backends need neither
+  if (graphics::SpriteBackend::active != nullptr) {
+    return texture;
+  }
+  if (options.indexed and not cooked->palette.empty()) {
+    texture.indexed = IndexedImage{
+      .indices = {cooked->indices.begin(), cooked->indices.end()},
+      .palette = {cooked->palette.begin(), cooked->palette.end()},
+    };
+  }
+  // the atlas pages filter their own mips, the cooked chain gets a texture of its own. index textures draw their
+  // base level at every scale
+  texture.standalone = not texture.indexed.has_value() and texture.levels.size() > 1;
+  if (options.trim_vertices > 0 and (not options.atlas or texture.standalone)) {
+    texture.outline.assign(cooked->outline.begin(), cooked->outline.end());
+  }
+  return texture;
+}
+
+auto decode_ktx2_texture(const char *file_path) -> std::optional<DecodedTexture> {
+  // the backends take rgba8 sprites only
+  if (graphics::SpriteBackend::active != nullptr) {
+    std::cerr << std::format("Error: block compressed texture \"{}\" needs the gl sprite path\n", file_path);
+    return std::nullopt;
+  }
+
+  auto texture = DecodedTexture{};
+  auto data = map_texture_file(file_path, texture);
+  if (not data.has_value()) {
+    return std::nullopt;
+  }
+  texture.ktx2 = parse_ktx2(*data);
+  if (not texture.ktx2.has_value()) {
+    std::cerr << std::format("Error: \"{}\" is not a block compressed 2d ktx2 texture\n", file_path);
+    return std::nullopt;
+  }
+  const auto supported = ResourceManager::texture_compressions();
+  if (std::find(supported.begin(), supported.end(), texture.ktx2->compression) == supported.end()) {
+    std::cerr << std::format("Error: the context cannot sample the {} texture \"{}\"\n",
+                             texture_compression_name(texture.ktx2->compression), file_path);
+    return std::nullopt;
+  }
+  texture.alpha = texture.ktx2->alpha;
+  texture.premultiplied = texture.ktx2->premultiplied;
+  return texture;
+}
+
+TextureLoader::~TextureLoader() {
+  stop();
+}
+
+auto TextureLoader::submit(Request request) -> void {
+  {
+    auto lock = std::lock_guard{mutex};
+    if (workers.empty()) {
+      const auto count = thread_count != 0 ? thread_count : std::max(std::thread::hardware_concurrency(), 2u) - 1;
+      quit = false;
+      for (auto i = uint32_t{}; i < count; ++i) {
+        workers.emplace_back([this] { work(); });
+      }
+    }
+    requests.push_back(std::move(request));
+  }
+  wake.notify_one();
+}
+
+auto TextureLoader::poll() -> std::optional<Result> {
+  auto lock = std::lock_guard{mutex};
+  if (results.empty()) {
+    return std::nullopt;
+  }
+  auto result = std::move(results.front());
+  results.pop_front();
+  return result;
+}
+
+auto TextureLoader::wait() -> void {
+  auto lock = std::unique_lock{mutex};
+  ready.wait(lock, [this] { return not results.empty(); });
+}
+
+auto TextureLoader::discard() -> void {
+  auto lock = std::lock_guard{mutex};
+  requests.clear();
+  results.clear();
+}
+
+auto TextureLoader::stop() -> void {
+  {
+    auto lock = std::lock_guard{mutex};
+    quit = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+  discard();
+}
+
+auto TextureLoader::work() -> void {
+  while (true) {
+    auto request = Request{};
+    {
+      auto lock = std::unique_lock{mutex};
+      wake.wait(lock, [this] { return quit or not requests.empty(); });
+      if (quit) {
+        return;
+      }
+      request = std::move(requests.front());
+      requests.pop_front();
+    }
+
+    auto texture = decode_texture_file(request.file_path.c_str(), request.options);
+    {
+      auto lock = std::lock_guard{mutex};
+      results.push_back({request.id, std::move(request.key), request.options, std::move(texture)});
+    }
+    ready.notify_all();
+  }
+}
+
+} // namespace rugame
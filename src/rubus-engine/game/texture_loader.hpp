@@ -0,0 +1,133 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <rubus-engine/graphics/upload_ring.hpp>
+#include <rubus-engine/utils/vfs.hpp>
+#include "cooked_texture.hpp"
+#include "ktx2.hpp"
+#include "palette.hpp"
+
+namespace rugame {
+
+// rgba8 texels of one mip level, first row at the bottom
+struct TextureLevel {
+  const uint8_t *rgba = nullptr;
+  int width = 0;
+  int height = 0;
+};
+
+struct TextureOptions {
+  bool atlas = true;          // pack into the shared atlas if the image fits
+  // vertex budget of the trimmed outline, 0 always uses the full quad. only images outside the atlas are trimmed,
+  // the sprite batch breaks on every mesh change and an outline per atlased image would undo the shared page.
+  // cooked textures bring the outline of the cooker's budget
+  uint32_t trim_vertices = 8;
+  bool compressed = false;    // take a block compressed variant of the cooker when the context samples it, lossy
+  bool indexed = true;        // store images of up to 256 colors as r8 palette indices, only the base level is kept
+};
+
+// a texture file read and decoded with everything derived from its texels, all the work of a load before gl
+struct DecodedTexture {
+  std::unique_ptr<utils::MappedFile> file; // a loose cooked or ktx2 file the levels point into
+  std::vector<uint8_t> image;              // texels decoded from an image file the levels point into
+  std::vector<TextureLevel> levels;        // rgba8, the base level first
+  std::optional<Ktx2Texture> ktx2;         // a block compressed texture instead of the levels
+  TextureAlpha alpha = TextureAlpha::Translucent;
+  bool premultiplied = false;
+  bool standalone = false;             // cooked mips that the atlas would regenerate, never packed
+  std::vector<glm::vec2> outline;      // trimmed outline of the base level, empty for the full quad
+  std::optional<IndexedImage> indexed; // palette indices of the base level when it has few colors
+};
+
+// these never touch gl and may run on any thread. they print the reason of a failure. the block compressed
+// variants are only looked for once ResourceManager::texture_compressions was queried on the render thread
+auto decode_texture_file(const char *file_path, TextureOptions options) -> std::optional<DecodedTexture>;
+auto decode_cooked_texture(const char *file_path, TextureOptions options) -> std::optional<DecodedTexture>;
+auto decode_ktx2_texture(const char *file_path) -> std::optional<DecodedTexture>;
+
+// called on the render thread once the texture is resident (true) or failed to load (false)
+using TextureLoadCallback = std::function<void(const std::string &key, bool loaded)>;
+
+// decodes texture files on a pool of worker threads. ResourceManager::load_texture2d_async queues them and
+// ResourceManager::update_texture_loads uploads the decoded ones through a ring of pixel buffer objects, spending at
+// most `frame_budget` per frame
+struct TextureLoader {
+  struct Request {
+    uint64_t id = 0;
+    std::string key;
+    std::string file_path;
+    TextureOptions options;
+  };
+
+  struct Result {
+    uint64_t id = 0;
+    std::string key;
+    TextureOptions options;
+    std::optional<DecodedTexture> texture;
+  };
+
+  // a ResourceManager::load_palette_swap of a texture that is still loading, made once it is resident
+  struct PaletteSwap {
+    std::string key;
+    std::vector<std::pair<uint32_t, uint32_t>> recolor;
+  };
+
+  // a queued load, render thread only
+  struct Pending {
+    uint64_t id = 0;
+    std::promise<bool> promise;
+    TextureLoadCallback callback;
+    std::vector<PaletteSwap> palette_swaps;
+  };
+
+  uint32_t thread_count = 0;      // 0 uses every hardware thread but one, read when the first load is queued
+  double frame_budget = 0.002;    // seconds of uploads per frame, at least one texture is uploaded
+  size_t staging_size = 8u << 20; // bytes of each upload ring region, uploads that do not fit skip the ring
+
+  std::unordered_map<std::string, Pending> pending;
+  uint64_t last_id = 0;
+  std::optional<uint32_t> placeholder; // transparent 1x1 texture the keys of pending loads show
+  graphics::UploadRing upload_ring;
+
+  TextureLoader() = default;
+  TextureLoader(const TextureLoader &) = delete;
+  auto operator=(const TextureLoader &) -> TextureLoader & = delete;
+  ~TextureLoader();
+
+  auto submit(Request request) -> void;
+  // a decoded texture, nullopt when none is ready
+  auto poll() -> std::optional<Result>;
+  // blocks until a decoded texture is ready
+  auto wait() -> void;
+  // drops the queued requests and the decoded textures
+  auto discard() -> void;
+  auto stop() -> void;
+
+private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable ready;
+  std::deque<Request> requests;
+  std::deque<Result> results;
+  bool quit = false;
+
+  auto work() -> void;
+};
+
+} // namespace rugame
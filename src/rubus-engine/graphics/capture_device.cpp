@@ -0,0 +1,787 @@
+#include "capture_device.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <utility>
+
+#include <glad/glad.h>
+
+namespace graphics {
+
+CaptureDevice::CaptureDevice(Device &inner, std::filesystem::path path, uint32_t frame_count)
+  : inner(inner), path(std::move(path)), frames_left(frame_count) {
+  trace.put(trace_magic);
+  trace.put(trace_version);
+}
+
+CaptureDevice::~CaptureDevice() {
+  finish();
+}
+
+auto CaptureDevice::capturing() const -> bool {
+  return frames_left > 0;
+}
+
+auto CaptureDevice::name() const -> std::string_view {
+  return inner.name();
+}
+
+auto CaptureDevice::get_integer(uint32_t pname) -> int32_t {
+  if (begin(DeviceCall::GetInteger)) {
+    trace.put(pname);
+  }
+  return inner.get_integer(pname);
+}
+
+auto CaptureDevice::get_string(uint32_t name) -> std::string {
+  if (begin(DeviceCall::GetString)) {
+    trace.put(name);
+  }
+  return inner.get_string(name);
+}
+
+auto CaptureDevice::has_extension(std::string_view extension) -> bool {
+  if (begin(DeviceCall::HasExtension)) {
+    trace.put_string(extension);
+  }
+  return inner.has_extension(extension);
+}
+
+auto CaptureDevice::enable_parallel_shader_compile() -> bool {
+  begin(DeviceCall::EnableParallelShaderCompile);
+  return inner.enable_parallel_shader_compile();
+}
+
+auto CaptureDevice::create_buffer() -> uint32_t {
+  const auto buffer = inner.create_buffer();
+  if (begin(DeviceCall::CreateBuffer)) {
+    trace.put(buffer);
+  }
+  return buffer;
+}
+
+auto CaptureDevice::delete_buffer(uint32_t buffer) -> void {
+  if (begin(DeviceCall::DeleteBuffer)) {
+    trace.put(buffer);
+  }
+  mapped.erase(buffer);
+  if (unpack_buffer == buffer) {
+    unpack_buffer = 0;
+  }
+  inner.delete_buffer(buffer);
+}
+
+auto CaptureDevice::bind_buffer(uint32_t target, uint32_t buffer) -> void {
+  if (target == GL_PIXEL_UNPACK_BUFFER) {
+    unpack_buffer = buffer;
+    inner.bind_buffer(target, buffer);
+    return;
+  }
+  if (begin(DeviceCall::BindBuffer)) {
+    trace.put(target);
+    trace.put(buffer);
+  }
+  inner.bind_buffer(target, buffer);
+}
+
+auto CaptureDevice::bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer) -> void {
+  if (begin(DeviceCall::BindBufferBase)) {
+    trace.put(target);
+    trace.put(index);
+    trace.put(buffer);
+  }
+  inner.bind_buffer_base(target, index, buffer);
+}
+
+auto CaptureDevice::bind_buffer_range(uint32_t target, uint32_t index, uint32_t buffer, size_t offset, size_t size)
+  -> void {
+  if (begin(DeviceCall::BindBufferRange)) {
+    trace.put(target);
+    trace.put(index);
+    trace.put(buffer);
+    trace.put((uint64_t)offset);
+    trace.put((uint64_t)size);
+  }
+  inner.bind_buffer_range(target, index, buffer, offset, size);
+}
+
+auto CaptureDevice::buffer_data(uint32_t buffer, size_t size, const void *data, uint32_t usage) -> void {
+  if (begin(DeviceCall::BufferData)) {
+    trace.put(buffer);
+    trace.put((uint64_t)size);
+    trace.put(usage);
+    trace.put_bytes(data, data == nullptr ? 0 : size);
+  }
+  inner.buffer_data(buffer, size, data, usage);
+}
+
+auto CaptureDevice::buffer_sub_data(uint32_t buffer, size_t offset, size_t size, const void *data) -> void {
+  if (begin(DeviceCall::BufferSubData)) {
+    trace.put(buffer);
+    trace.put((uint64_t)offset);
+    trace.put_bytes(data, size);
+  }
+  inner.buffer_sub_data(buffer, offset, size, data);
+}
+
+auto CaptureDevice::map_persistent(uint32_t buffer, size_t size) -> std::byte * {
+  const auto memory = inner.map_persistent(buffer, size);
+  if (begin(DeviceCall::MapPersistent)) {
+    trace.put(buffer);
+    trace.put((uint64_t)size);
+    if (memory != nullptr) {
+      // the replay zero fills its mapping, the engine's writes show up as differences to zero
+      mapped[buffer] = {memory, std::vector<std::byte>(size)};
+    }
+  }
+  return memory;
+}
+
+auto CaptureDevice::unmap_buffer(uint32_t buffer) -> void {
+  if (begin(DeviceCall::UnmapBuffer)) {
+    trace.put(buffer);
+  }
+  mapped.erase(buffer);
+  inner.unmap_buffer(buffer);
+}
+
+auto CaptureDevice::fence() -> Fence {
+  const auto fence = inner.fence();
+  if (begin(DeviceCall::Fence)) {
+    trace.put(fence_id(fence));
+  }
+  return fence;
+}
+
+auto CaptureDevice::wait_fence(Fence fence, uint64_t timeout_ns) -> bool {
+  if (begin(DeviceCall::WaitFence)) {
+    trace.put(fence_id(fence));
+    trace.put(timeout_ns);
+  }
+  return inner.wait_fence(fence, timeout_ns);
+}
+
+auto CaptureDevice::delete_fence(Fence fence) -> void {
+  if (begin(DeviceCall::DeleteFence)) {
+    trace.put(fence_id(fence));
+  }
+  fence_ids.erase(fence);
+  inner.delete_fence(fence);
+}
+
+auto CaptureDevice::create_texture() -> uint32_t {
+  const auto texture = inner.create_texture();
+  if (begin(DeviceCall::CreateTexture)) {
+    trace.put(texture);
+  }
+  return texture;
+}
+
+auto CaptureDevice::delete_texture(uint32_t texture) -> void {
+  if (begin(DeviceCall::DeleteTexture)) {
+    trace.put(texture);
+  }
+  inner.delete_texture(texture);
+}
+
+auto CaptureDevice::bind_texture(uint32_t unit, uint32_t texture) -> void {
+  if (begin(DeviceCall::BindTexture)) {
+    trace.put(unit);
+    trace.put(texture);
+  }
+  inner.bind_texture(unit, texture);
+}
+
+auto CaptureDevice::texture_parameter(uint32_t texture, uint32_t pname, int32_t value) -> void {
+  if (begin(DeviceCall::TextureParameter)) {
+    trace.put(texture);
+    trace.put(pname);
+    trace.put(value);
+  }
+  inner.texture_parameter(texture, pname, value);
+}
+
+auto CaptureDevice::texture_border_color(uint32_t texture, const float *rgba) -> void {
+  if (begin(DeviceCall::TextureBorderColor)) {
+    trace.put(texture);
+    trace.put_bytes(rgba, 4 * sizeof(float));
+  }
+  inner.texture_border_color(texture, rgba);
+}
+
+auto CaptureDevice::texture_storage(uint32_t texture, int32_t levels, uint32_t internal_format, int32_t width,
+                                    int32_t height) -> void {
+  if (begin(DeviceCall::TextureStorage)) {
+    trace.put(texture);
+    trace.put(levels);
+    trace.put(internal_format);
+    trace.put(width);
+    trace.put(height);
+  }
+  inner.texture_storage(texture, levels, internal_format, width, height);
+}
+
+auto CaptureDevice::texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width,
+                                      int32_t height, uint32_t format, uint32_t type, const void *pixels) -> void {
+  if (begin(DeviceCall::TextureSubImage)) {
+    trace.put(texture);
+    trace.put(level);
+    trace.put(x);
+    trace.put(y);
+    trace.put(width);
+    trace.put(height);
+    trace.put(format);
+    trace.put(type);
+    const auto size = pixel_data_size(format, type, width, height, unpack_alignment, unpack_row_length);
+    trace.put_bytes(unpack_source(pixels), size);
+  }
+  inner.texture_sub_image(texture, level, x, y, width, height, format, type, pixels);
+}
+
+auto CaptureDevice::compressed_texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y,
+                                                 int32_t width, int32_t height, uint32_t format, size_t size,
+                                                 const void *data) -> void {
+  if (begin(DeviceCall::CompressedTextureSubImage)) {
+    trace.put(texture);
+    trace.put(level);
+    trace.put(x);
+    trace.put(y);
+    trace.put(width);
+    trace.put(height);
+    trace.put(format);
+    trace.put_bytes(unpack_source(data), size);
+  }
+  inner.compressed_texture_sub_image(texture, level, x, y, width, height, format, size, data);
+}
+
+auto CaptureDevice::clear_texture(uint32_t texture, int32_t level, uint32_t format, uint32_t type, const void *data)
+  -> void {
+  if (begin(DeviceCall::ClearTexture)) {
+    trace.put(texture);
+    trace.put(level);
+    trace.put(format);
+    trace.put(type);
+    trace.put_bytes(data, data == nullptr ? 0 : pixel_data_size(format, type, 1, 1));
+  }
+  inner.clear_texture(texture, level, format, type, data);
+}
+
+auto CaptureDevice::generate_mipmap(uint32_t texture) -> void {
+  if (begin(DeviceCall::GenerateMipmap)) {
+    trace.put(texture);
+  }
+  inner.generate_mipmap(texture);
+}
+
+auto CaptureDevice::pixel_store(uint32_t pname, int32_t value) -> void {
+  if (pname == GL_UNPACK_ALIGNMENT) {
+    unpack_alignment = value;
+  } else if (pname == GL_UNPACK_ROW_LENGTH) {
+    unpack_row_length = value;
+  }
+  if (begin(DeviceCall::PixelStore)) {
+    trace.put(pname);
+    trace.put(value);
+  }
+  inner.pixel_store(pname, value);
+}
+
+auto CaptureDevice::create_framebuffer() -> uint32_t {
+  const auto framebuffer = inner.create_framebuffer();
+  if (begin(DeviceCall::CreateFramebuffer)) {
+    trace.put(framebuffer);
+  }
+  return framebuffer;
+}
+
+auto CaptureDevice::delete_framebuffer(uint32_t framebuffer) -> void {
+  if (begin(DeviceCall::DeleteFramebuffer)) {
+    trace.put(framebuffer);
+  }
+  inner.delete_framebuffer(framebuffer);
+}
+
+auto CaptureDevice::bind_framebuffer(uint32_t target, uint32_t framebuffer) -> void {
+  if (begin(DeviceCall::BindFramebuffer)) {
+    trace.put(target);
+    trace.put(framebuffer);
+  }
+  inner.bind_framebuffer(target, framebuffer);
+}
+
+auto CaptureDevice::framebuffer_texture(uint32_t framebuffer, uint32_t attachment, uint32_t texture) -> void {
+  if (begin(DeviceCall::FramebufferTexture)) {
+    trace.put(framebuffer);
+    trace.put(attachment);
+    trace.put(texture);
+  }
+  inner.framebuffer_texture(framebuffer, attachment, texture);
+}
+
+auto CaptureDevice::create_renderbuffer(uint32_t internal_format, int32_t width, int32_t height) -> uint32_t {
+  const auto renderbuffer = inner.create_renderbuffer(internal_format, width, height);
+  if (begin(DeviceCall::CreateRenderbuffer)) {
+    trace.put(internal_format);
+    trace.put(width);
+    trace.put(height);
+    trace.put(renderbuffer);
+  }
+  return renderbuffer;
+}
+
+auto CaptureDevice::delete_renderbuffer(uint32_t renderbuffer) -> void {
+  if (begin(DeviceCall::DeleteRenderbuffer)) {
+    trace.put(renderbuffer);
+  }
+  inner.delete_renderbuffer(renderbuffer);
+}
+
+auto CaptureDevice::framebuffer_renderbuffer(uint32_t framebuffer, uint32_t attachment, uint32_t renderbuffer)
+  -> void {
+  if (begin(DeviceCall::FramebufferRenderbuffer)) {
+    trace.put(framebuffer);
+    trace.put(attachment);
+    trace.put(renderbuffer);
+  }
+  inner.framebuffer_renderbuffer(framebuffer, attachment, renderbuffer);
+}
+
+auto CaptureDevice::framebuffer_complete(uint32_t framebuffer) -> bool {
+  if (begin(DeviceCall::FramebufferComplete)) {
+    trace.put(framebuffer);
+  }
+  return inner.framebuffer_complete(framebuffer);
+}
+
+auto CaptureDevice::blit_framebuffer(uint32_t src, uint32_t dst, int32_t src_x0, int32_t src_y0, int32_t src_x1,
+                                     int32_t src_y1, int32_t dst_x0, int32_t dst_y0, int32_t dst_x1, int32_t dst_y1,
+                                     uint32_t mask, uint32_t filter) -> void {
+  if (begin(DeviceCall::BlitFramebuffer)) {
+    trace.put(src);
+    trace.put(dst);
+    for (auto value : {src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1}) {
+      trace.put(value);
+    }
+    trace.put(mask);
+    trace.put(filter);
+  }
+  inner.blit_framebuffer(src, dst, src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1, mask, filter);
+}
+
+auto CaptureDevice::create_vertex_array() -> uint32_t {
+  const auto vertex_array = inner.create_vertex_array();
+  if (begin(DeviceCall::CreateVertexArray)) {
+    trace.put(vertex_array);
+  }
+  return vertex_array;
+}
+
+auto CaptureDevice::delete_vertex_array(uint32_t vertex_array) -> void {
+  if (begin(DeviceCall::DeleteVertexArray)) {
+    trace.put(vertex_array);
+  }
+  inner.delete_vertex_array(vertex_array);
+}
+
+auto CaptureDevice::bind_vertex_array(uint32_t vertex_array) -> void {
+  if (begin(DeviceCall::BindVertexArray)) {
+    trace.put(vertex_array);
+  }
+  inner.bind_vertex_array(vertex_array);
+}
+
+auto CaptureDevice::vertex_attrib(const VertexAttrib &attrib) -> void {
+  if (begin(DeviceCall::VertexAttrib)) {
+    trace.put(attrib.index);
+    trace.put(attrib.size);
+    trace.put(attrib.type);
+    trace.put((uint8_t)attrib.normalized);
+    trace.put(attrib.stride);
+    trace.put((uint64_t)attrib.offset);
+    trace.put(attrib.divisor);
+  }
+  inner.vertex_attrib(attrib);
+}
+
+auto CaptureDevice::create_shader(uint32_t type) -> uint32_t {
+  const auto shader = inner.create_shader(type);
+  if (begin(DeviceCall::CreateShader)) {
+    trace.put(type);
+    trace.put(shader);
+  }
+  return shader;
+}
+
+auto CaptureDevice::delete_shader(uint32_t shader) -> void {
+  if (begin(DeviceCall::DeleteShader)) {
+    trace.put(shader);
+  }
+  inner.delete_shader(shader);
+}
+
+auto CaptureDevice::compile_shader(uint32_t shader, std::string_view source) -> void {
+  if (begin(DeviceCall::CompileShader)) {
+    trace.put(shader);
+    trace.put_string(source);
+  }
+  inner.compile_shader(shader, source);
+}
+
+auto CaptureDevice::shader_compiled(uint32_t shader) -> bool {
+  if (begin(DeviceCall::ShaderCompiled)) {
+    trace.put(shader);
+  }
+  return inner.shader_compiled(shader);
+}
+
+auto CaptureDevice::shader_info_log(uint32_t shader) -> std::string {
+  if (begin(DeviceCall::ShaderInfoLog)) {
+    trace.put(shader);
+  }
+  return inner.shader_info_log(shader);
+}
+
+auto CaptureDevice::create_program() -> uint32_t {
+  const auto program = inner.create_program();
+  if (begin(DeviceCall::CreateProgram)) {
+    trace.put(program);
+  }
+  return program;
+}
+
+auto CaptureDevice::delete_program(uint32_t program) -> void {
+  if (begin(DeviceCall::DeleteProgram)) {
+    trace.put(program);
+  }
+  inner.delete_program(program);
+}
+
+auto CaptureDevice::program_parameter(uint32_t program, uint32_t pname, int32_t value) -> void {
+  if (begin(DeviceCall::ProgramParameter)) {
+    trace.put(program);
+    trace.put(pname);
+    trace.put(value);
+  }
+  inner.program_parameter(program, pname, value);
+}
+
+auto CaptureDevice::attach_shader(uint32_t program, uint32_t shader) -> void {
+  if (begin(DeviceCall::AttachShader)) {
+    trace.put(program);
+    trace.put(shader);
+  }
+  inner.attach_shader(program, shader);
+}
+
+auto CaptureDevice::detach_shader(uint32_t program, uint32_t shader) -> void {
+  if (begin(DeviceCall::DetachShader)) {
+    trace.put(program);
+    trace.put(shader);
+  }
+  inner.detach_shader(program, shader);
+}
+
+auto CaptureDevice::link_program(uint32_t program) -> void {
+  if (begin(DeviceCall::LinkProgram)) {
+    trace.put(program);
+  }
+  inner.link_program(program);
+}
+
+auto CaptureDevice::program_linked(uint32_t program) -> bool {
+  if (begin(DeviceCall::ProgramLinked)) {
+    trace.put(program);
+  }
+  return inner.program_linked(program);
+}
+
+auto CaptureDevice::program_info_log(uint32_t program) -> std::string {
+  if (begin(DeviceCall::ProgramInfoLog)) {
+    trace.put(program);
+  }
+  return inner.program_info_log(program);
+}
+
+auto CaptureDevice::get_program_binary(uint32_t program) -> ProgramBinary {
+  if (begin(DeviceCall::GetProgramBinary)) {
+    trace.put(program);
+  }
+  return inner.get_program_binary(program);
+}
+
+auto CaptureDevice::program_binary(uint32_t program, const ProgramBinary &binary) -> void {
+  // while capturing the program stays unlinked, the engine falls back to compiling the sources
+  if (not capturing()) {
+    inner.program_binary(program, binary);
+  }
+}
+
+auto CaptureDevice::use_program(uint32_t program) -> void {
+  if (begin(DeviceCall::UseProgram)) {
+    trace.put(program);
+  }
+  inner.use_program(program);
+}
+
+auto CaptureDevice::active_uniforms(uint32_t program) -> std::vector<ActiveUniform> {
+  if (begin(DeviceCall::ActiveUniforms)) {
+    trace.put(program);
+  }
+  return inner.active_uniforms(program);
+}
+
+auto CaptureDevice::uniform_location(uint32_t program, const char *name) -> int32_t {
+  const auto location = inner.uniform_location(program, name);
+  if (begin(DeviceCall::UniformLocation)) {
+    trace.put(program);
+    trace.put_string(name);
+    trace.put(location);
+  }
+  return location;
+}
+
+auto CaptureDevice::active_uniform_blocks(uint32_t program) -> std::vector<std::string> {
+  auto blocks = inner.active_uniform_blocks(program);
+  if (begin(DeviceCall::ActiveUniformBlocks)) {
+    // the replay matches block indices by name
+    trace.put(program);
+    trace.put((uint32_t)blocks.size());
+    for (const auto &block : blocks) {
+      trace.put_string(block);
+    }
+  }
+  return blocks;
+}
+
+auto CaptureDevice::uniform_block_parameter(uint32_t program, uint32_t index, uint32_t pname) -> int32_t {
+  if (begin(DeviceCall::UniformBlockParameter)) {
+    trace.put(program);
+    trace.put(index);
+    trace.put(pname);
+  }
+  return inner.uniform_block_parameter(program, index, pname);
+}
+
+auto CaptureDevice::uniform_block_binding(uint32_t program, uint32_t index, uint32_t binding) -> void {
+  if (begin(DeviceCall::UniformBlockBinding)) {
+    trace.put(program);
+    trace.put(index);
+    trace.put(binding);
+  }
+  inner.uniform_block_binding(program, index, binding);
+}
+
+auto CaptureDevice::uniform_mat4(int32_t location, const float *value) -> void {
+  if (begin(DeviceCall::UniformMat4)) {
+    trace.put(location);
+    trace.put_bytes(value, 16 * sizeof(float));
+  }
+  inner.uniform_mat4(location, value);
+}
+
+auto CaptureDevice::uniform_uint(int32_t location, uint32_t value) -> void {
+  if (begin(DeviceCall::UniformUint)) {
+    trace.put(location);
+    trace.put(value);
+  }
+  inner.uniform_uint(location, value);
+}
+
+auto CaptureDevice::enable(uint32_t cap) -> void {
+  if (begin(DeviceCall::Enable)) {
+    trace.put(cap);
+  }
+  inner.enable(cap);
+}
+
+auto CaptureDevice::disable(uint32_t cap) -> void {
+  if (begin(DeviceCall::Disable)) {
+    trace.put(cap);
+  }
+  inner.disable(cap);
+}
+
+auto CaptureDevice::blend_func(uint32_t src_rgb, uint32_t dst_rgb, uint32_t src_alpha, uint32_t dst_alpha)
+  -> void {
+  if (begin(DeviceCall::BlendFunc)) {
+    trace.put(src_rgb);
+    trace.put(dst_rgb);
+    trace.put(src_alpha);
+    trace.put(dst_alpha);
+  }
+  inner.blend_func(src_rgb, dst_rgb, src_alpha, dst_alpha);
+}
+
+auto CaptureDevice::depth_mask(bool enabled) -> void {
+  if (begin(DeviceCall::DepthMask)) {
+    trace.put((uint8_t)enabled);
+  }
+  inner.depth_mask(enabled);
+}
+
+auto CaptureDevice::depth_func(uint32_t func) -> void {
+  if (begin(DeviceCall::DepthFunc)) {
+    trace.put(func);
+  }
+  inner.depth_func(func);
+}
+
+auto CaptureDevice::viewport(int32_t x, int32_t y, int32_t width, int32_t height) -> void {
+  if (begin(DeviceCall::Viewport)) {
+    trace.put(x);
+    trace.put(y);
+    trace.put(width);
+    trace.put(height);
+  }
+  inner.viewport(x, y, width, height);
+}
+
+auto CaptureDevice::clear(float r, float g, float b, float a, uint32_t mask) -> void {
+  if (begin(DeviceCall::Clear)) {
+    for (auto value : {r, g, b, a}) {
+      trace.put(value);
+    }
+    trace.put(mask);
+  }
+  inner.clear(r, g, b, a, mask);
+}
+
+auto CaptureDevice::draw_elements(uint32_t mode, int32_t count, uint32_t type, size_t offset) -> void {
+  write_mapped();
+  if (begin(DeviceCall::DrawElements)) {
+    trace.put(mode);
+    trace.put(count);
+    trace.put(type);
+    trace.put((uint64_t)offset);
+  }
+  inner.draw_elements(mode, count, type, offset);
+}
+
+auto CaptureDevice::draw_elements_instanced(uint32_t mode, int32_t count, uint32_t type, size_t offset,
+                                            int32_t instance_count, int32_t base_vertex, uint32_t base_instance)
+  -> void {
+  write_mapped();
+  if (begin(DeviceCall::DrawElementsInstanced)) {
+    trace.put(mode);
+    trace.put(count);
+    trace.put(type);
+    trace.put((uint64_t)offset);
+    trace.put(instance_count);
+    trace.put(base_vertex);
+    trace.put(base_instance);
+  }
+  inner.draw_elements_instanced(mode, count, type, offset, instance_count, base_vertex, base_instance);
+}
+
+auto CaptureDevice::multi_draw_elements_indirect(uint32_t mode, uint32_t type, size_t offset, int32_t draw_count)
+  -> void {
+  write_mapped();
+  if (begin(DeviceCall::MultiDrawElementsIndirect)) {
+    trace.put(mode);
+    trace.put(type);
+    trace.put((uint64_t)offset);
+    trace.put(draw_count);
+  }
+  inner.multi_draw_elements_indirect(mode, type, offset, draw_count);
+}
+
+auto CaptureDevice::dispatch_compute(uint32_t x, uint32_t y, uint32_t z) -> void {
+  write_mapped();
+  if (begin(DeviceCall::DispatchCompute)) {
+    trace.put(x);
+    trace.put(y);
+    trace.put(z);
+  }
+  inner.dispatch_compute(x, y, z);
+}
+
+auto CaptureDevice::memory_barrier(uint32_t barriers) -> void {
+  if (begin(DeviceCall::MemoryBarrier)) {
+    trace.put(barriers);
+  }
+  inner.memory_barrier(barriers);
+}
+
+auto CaptureDevice::end_frame() -> void {
+  if (begin(DeviceCall::EndFrame)) {
+    frames_left -= 1;
+    if (frames_left == 0) {
+      finish();
+    }
+  }
+  inner.end_frame();
+}
+
+auto CaptureDevice::begin(DeviceCall call) -> bool {
+  if (not capturing()) {
+    return false;
+  }
+  trace.put((uint8_t)call);
+  return true;
+}
+
+auto CaptureDevice::unpack_source(const void *pixels) const -> const void * {
+  if (unpack_buffer == 0) {
+    return pixels;
+  }
+  // only the persistently mapped staging ring is ever bound for uploads
+  const auto buffer = mapped.find(unpack_buffer);
+  return buffer != mapped.end() ? buffer->second.memory + (uintptr_t)pixels : nullptr;
+}
+
+auto CaptureDevice::write_mapped() -> void {
+  if (not capturing()) {
+    return;
+  }
+
+  // compare in blocks and record runs of changed blocks
+  constexpr auto block = size_t{256};
+  for (auto &[buffer, map] : mapped) {
+    const auto size = map.shadow.size();
+    auto offset = size_t{};
+    while (offset < size) {
+      const auto differs = [&](size_t at) {
+        return std::memcmp(map.memory + at, map.shadow.data() + at, std::min(block, size - at)) != 0;
+      };
+      if (not differs(offset)) {
+        offset += block;
+        continue;
+      }
+      auto end = offset + block;
+      while (end < size and differs(end)) {
+        end += block;
+      }
+      end = std::min(end, size);
+      std::memcpy(map.shadow.data() + offset, map.memory + offset, end - offset);
+      trace.put(trace_mapped_write);
+      trace.put(buffer);
+      trace.put((uint64_t)offset);
+      trace.put_bytes(map.memory + offset, end - offset);
+      offset = end;
+    }
+  }
+}
+
+auto CaptureDevice::fence_id(Fence fence) -> uint32_t {
+  auto [it, inserted] = fence_ids.try_emplace(fence, next_fence);
+  if (inserted) {
+    next_fence += 1;
+  }
+  return it->second;
+}
+
+auto CaptureDevice::finish() -> void {
+  if (trace.data.empty()) {
+    return;
+  }
+  frames_left = 0;
+  if (trace.save(path)) {
+    std::cerr << std::format("Captured {} bytes of device calls to {}\n", trace.data.size(), path.string());
+  }
+  trace.data = {};
+  mapped.clear();
+}
+
+} // namespace graphics
@@ -0,0 +1,179 @@
+#include "device.hpp"
+
+#include "gl_device.hpp"
+
+namespace graphics {
+
+auto device_call_name(DeviceCall call) -> std::string_view {
+  switch (call) {
+  case DeviceCall::GetInteger:
+    return "get_integer";
+  case DeviceCall::GetString:
+    return "get_string";
+  case DeviceCall::HasExtension:
+    return "has_extension";
+  case DeviceCall::EnableParallelShaderCompile:
+    return "enable_parallel_shader_compile";
+  case DeviceCall::CreateBuffer:
+    return "create_buffer";
+  case DeviceCall::DeleteBuffer:
+    return "delete_buffer";
+  case DeviceCall::BindBuffer:
+    return "bind_buffer";
+  case DeviceCall::BindBufferBase:
+    return "bind_buffer_base";
+  case DeviceCall::BindBufferRange:
+    return "bind_buffer_range";
+  case DeviceCall::BufferData:
+    return "buffer_data";
+  case DeviceCall::BufferSubData:
+    return "buffer_sub_data";
+  case DeviceCall::MapPersistent:
+    return "map_persistent";
+  case DeviceCall::UnmapBuffer:
+    return "unmap_buffer";
+  case DeviceCall::Fence:
+    return "fence";
+  case DeviceCall::WaitFence:
+    return "wait_fence";
+  case DeviceCall::DeleteFence:
+    return "delete_fence";
+  case DeviceCall::CreateTexture:
+    return "create_texture";
+  case DeviceCall::DeleteTexture:
+    return "delete_texture";
+  case DeviceCall::BindTexture:
+    return "bind_texture";
+  case DeviceCall::TextureParameter:
+    return "texture_parameter";
+  case DeviceCall::TextureBorderColor:
+    return "texture_border_color";
+  case DeviceCall::TextureStorage:
+    return "texture_storage";
+  case DeviceCall::TextureSubImage:
+    return "texture_sub_image";
+  case DeviceCall::CompressedTextureSubImage:
+    return "compressed_texture_sub_image";
+  case DeviceCall::ClearTexture:
+    return "clear_texture";
+  case DeviceCall::GenerateMipmap:
+    return "generate_mipmap";
+  case DeviceCall::PixelStore:
+    return "pixel_store";
+  case DeviceCall::CreateFramebuffer:
+    return "create_framebuffer";
+  case DeviceCall::DeleteFramebuffer:
+    return "delete_framebuffer";
+  case DeviceCall::BindFramebuffer:
+    return "bind_framebuffer";
+  case DeviceCall::FramebufferTexture:
+    return "framebuffer_texture";
+  case DeviceCall::CreateRenderbuffer:
+    return "create_renderbuffer";
+  case DeviceCall::DeleteRenderbuffer:
+    return "delete_renderbuffer";
+  case DeviceCall::FramebufferRenderbuffer:
+    return "framebuffer_renderbuffer";
+  case DeviceCall::FramebufferComplete:
+    return "framebuffer_complete";
+  case DeviceCall::BlitFramebuffer:
+    return "blit_framebuffer";
+  case DeviceCall::CreateVertexArray:
+    return "create_vertex_array";
+  case DeviceCall::DeleteVertexArray:
+    return "delete_vertex_array";
+  case DeviceCall::BindVertexArray:
+    return "bind_vertex_array";
+  case DeviceCall::VertexAttrib:
+    return "vertex_attrib";
+  case DeviceCall::CreateShader:
+    return "create_shader";
+  case DeviceCall::DeleteShader:
+    return "delete_shader";
+  case DeviceCall::CompileShader:
+    return "compile_shader";
+  case DeviceCall::ShaderCompiled:
+    return "shader_compiled";
+  case DeviceCall::ShaderInfoLog:
+    return "shader_info_log";
+  case DeviceCall::CreateProgram:
+    return "create_program";
+  case DeviceCall::DeleteProgram:
+    return "delete_program";
+  case DeviceCall::ProgramParameter:
+    return "program_parameter";
+  case DeviceCall::AttachShader:
+    return "attach_shader";
+  case DeviceCall::DetachShader:
+    return "detach_shader";
+  case DeviceCall::LinkProgram:
+    return "link_program";
+  case DeviceCall::ProgramLinked:
+    return "program_linked";
+  case DeviceCall::ProgramInfoLog:
+    return "program_info_log";
+  case DeviceCall::GetProgramBinary:
+    return "get_program_binary";
+  case DeviceCall::ProgramBinary:
+    return "program_binary";
+  case DeviceCall::UseProgram:
+    return "use_program";
+  case DeviceCall::ActiveUniforms:
+    return "active_uniforms";
+  case DeviceCall::UniformLocation:
+    return "uniform_location";
+  case DeviceCall::ActiveUniformBlocks:
+    return "active_uniform_blocks";
+  case DeviceCall::UniformBlockParameter:
+    return "uniform_block_parameter";
+  case DeviceCall::UniformBlockBinding:
+    return "uniform_block_binding";
+  case DeviceCall::UniformMat4:
+    return "uniform_mat4";
+  case DeviceCall::UniformUint:
+    return "uniform_uint";
+  case DeviceCall::Enable:
+    return "enable";
+  case DeviceCall::Disable:
+    return "disable";
+  case DeviceCall::BlendFunc:
+    return "blend_func";
+  case DeviceCall::DepthMask:
+    return "depth_mask";
+  case DeviceCall::DepthFunc:
+    return "depth_func";
+  case DeviceCall::Viewport:
+    return "viewport";
+  case DeviceCall::Clear:
+    return "clear";
+  case DeviceCall::DrawElements:
+    return "draw_elements";
+  case DeviceCall::DrawElementsInstanced:
+    return "draw_elements_instanced";
+  case DeviceCall::MultiDrawElementsIndirect:
+    return "multi_draw_elements_indirect";
+  case DeviceCall::DispatchCompute:
+    return "dispatch_compute";
+  case DeviceCall::MemoryBarrier:
+    return "memory_barrier";
+  case DeviceCall::EndFrame:
+    return "end_frame";
+  case DeviceCall::Count:
+    break;
+  }
+  return "unknown";
+}
+
+auto Device::current() -> Device & {
+  if (active == nullptr) {
+    static auto gl = GlDevice{};
+    active = &gl;
+  }
+  return *active;
+}
+
+auto Device::set_current(Device *device) -> void {
+  active = device;
+}
+
+} // namespace graphics
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace graphics {
+
+using Fence = void *;
+
+// one entry per device call, for counting and serializing call streams
+enum struct DeviceCall : uint8_t {
+  GetInteger,
+  GetString,
+  HasExtension,
+  EnableParallelShaderCompile,
+  CreateBuffer,
+  DeleteBuffer,
+  BindBuffer,
+  BindBufferBase,
+  BindBufferRange,
+  BufferData,
+  BufferSubData,
+  MapPersistent,
+  UnmapBuffer,
+  Fence,
+  WaitFence,
+  DeleteFence,
+  CreateTexture,
+  DeleteTexture,
+  BindTexture,
+  TextureParameter,
+  TextureBorderColor,
+  TextureStorage,
+  TextureSubImage,
+  CompressedTextureSubImage,
+  ClearTexture,
+  GenerateMipmap,
+  PixelStore,
+  CreateFramebuffer,
+  DeleteFramebuffer,
+  BindFramebuffer,
+  FramebufferTexture,
+  CreateRenderbuffer,
+  DeleteRenderbuffer,
+  FramebufferRenderbuffer,
+  FramebufferComplete,
+  BlitFramebuffer,
+  CreateVertexArray,
+  DeleteVertexArray,
+  BindVertexArray,
+  VertexAttrib,
+  CreateShader,
+  DeleteShader,
+  CompileShader,
+  ShaderCompiled,
+  ShaderInfoLog,
+  CreateProgram,
+  DeleteProgram,
+  ProgramParameter,
+  AttachShader,
+  DetachShader,
+  LinkProgram,
+  ProgramLinked,
+  ProgramInfoLog,
+  GetProgramBinary,
+  ProgramBinary,
+  UseProgram,
+  ActiveUniforms,
+  UniformLocation,
+  ActiveUniformBlocks,
+  UniformBlockParameter,
+  UniformBlockBinding,
+  UniformMat4,
+  UniformUint,
+  Enable,
+  Disable,
+  BlendFunc,
+  DepthMask,
+  DepthFunc,
+  Viewport,
+  Clear,
+  DrawElements,
+  DrawElementsInstanced,
+  MultiDrawElementsIndirect,
+  DispatchCompute,
+  MemoryBarrier,
+  EndFrame,
+  Count,
+};
+
+auto device_call_name(DeviceCall call) -> std::string_view;
+
+struct VertexAttrib {
+  uint32_t index = 0;
+  int32_t size = 0; // components
+  uint32_t type = 0;
+  bool normalized = false;
+  int32_t stride = 0;
+  size_t offset = 0;
+  uint32_t divisor = 0; // 1 for per instance attributes
+};
+
+struct ActiveUniform {
+  std::string name;
+  int32_t size = 0;
+  uint32_t type = 0;
+};
+
+struct ProgramBinary {
+  uint32_t format = 0;
+  std::vector<char> data;
+};
+
+// every call the engine makes into the graphics api goes through the current device, so the engine can run
+// without a gl context (see graphics::NullDevice) or on top of a recording layer.
+// the vocabulary is gl's: enums are gl enums and handles are gl names, objects are addressed by name (dsa)
+// except for vertex attributes, which go to the bound vertex array and array buffer.
+struct Device {
+  virtual ~Device() = default;
+
+  // the gl device unless another one was set
+  static auto current() -> Device &;
+  static auto set_current(Device *device) -> void;
+
+  virtual auto name() const -> std::string_view = 0;
+
+  // queries
+  virtual auto get_integer(uint32_t pname) -> int32_t = 0;
+  virtual auto get_string(uint32_t name) -> std::string = 0;
+  virtual auto has_extension(std::string_view extension) -> bool = 0;
+  virtual auto enable_parallel_shader_compile() -> bool = 0; // false when unsupported
+
+  // buffers
+  virtual auto create_buffer() -> uint32_t = 0;
+  virtual auto delete_buffer(uint32_t buffer) -> void = 0;
+  virtual auto bind_buffer(uint32_t target, uint32_t buffer) -> void = 0;
+  virtual auto bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer) -> void = 0;
+  virtual auto bind_buffer_range(uint32_t target, uint32_t index, uint32_t buffer, size_t offset, size_t size)
+    -> void = 0;
+  virtual auto buffer_data(uint32_t buffer, size_t size, const void *data, uint32_t usage) -> void = 0;
+  virtual auto buffer_sub_data(uint32_t buffer, size_t offset, size_t size, const void *data) -> void = 0;
+  // immutable storage mapped persistently and coherently for writing, nullptr on failure
+  virtual auto map_persistent(uint32_t buffer, size_t size) -> std::byte * = 0;
+  virtual auto unmap_buffer(uint32_t buffer) -> void = 0;
+
+  // sync
+  virtual auto fence() -> Fence = 0;
+  // false while the fence is still pending after the timeout, a zero timeout only polls
+  virtual auto wait_fence(Fence fence, uint64_t timeout_ns) -> bool = 0;
+  virtual auto delete_fence(Fence fence) -> void = 0;
+
+  // textures, always GL_TEXTURE_2D
+  virtual auto create_texture() -> uint32_t = 0;
+  virtual auto delete_texture(uint32_t texture) -> void = 0;
+  virtual auto bind_texture(uint32_t unit, uint32_t texture) -> void = 0;
+  virtual auto texture_parameter(uint32_t texture, uint32_t pname, int32_t value) -> void = 0;
+  virtual auto texture_border_color(uint32_t texture, const float *rgba) -> void = 0;
+  virtual auto texture_storage(uint32_t texture, int32_t levels, uint32_t internal_format, int32_t width,
+                               int32_t height) -> void = 0;
+  virtual auto texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width,
+                                 int32_t height, uint32_t format, uint32_t type, const void *pixels) -> void = 0;
+  // `size` bytes of blocks in the compressed `format` of the texture's storage
+  virtual auto compressed_texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width,
+                                            int32_t height, uint32_t format, size_t size, const void *data)
+    -> void = 0;
+  virtual auto clear_texture(uint32_t texture, int32_t level, uint32_t format, uint32_t type, const void *data)
+    -> void = 0;
+  virtual auto generate_mipmap(uint32_t texture) -> void = 0;
+  virtual auto pixel_store(uint32_t pname, int32_t value) -> void = 0;
+
+  // framebuffers
+  virtual auto create_framebuffer() -> uint32_t = 0;
+  virtual auto delete_framebuffer(uint32_t framebuffer) -> void = 0;
+  virtual auto bind_framebuffer(uint32_t target, uint32_t framebuffer) -> void = 0;
+  virtual auto framebuffer_texture(uint32_t framebuffer, uint32_t attachment, uint32_t texture) -> void = 0;
+  virtual auto create_renderbuffer(uint32_t internal_format, int32_t width, int32_t height) -> uint32_t = 0;
+  virtual auto delete_renderbuffer(uint32_t renderbuffer) -> void = 0;
+  virtual auto framebuffer_renderbuffer(uint32_t framebuffer, uint32_t attachment, uint32_t renderbuffer)
+    -> void = 0;
+  virtual auto framebuffer_complete(uint32_t framebuffer) -> bool = 0;
+  virtual auto blit_framebuffer(uint32_t src, uint32_t dst, int32_t src_x0, int32_t src_y0, int32_t src_x1,
+                                int32_t src_y1, int32_t dst_x0, int32_t dst_y0, int32_t dst_x1, int32_t dst_y1,
+                                uint32_t mask, uint32_t filter) -> void = 0;
+
+  // vertex arrays
+  virtual auto create_vertex_array() -> uint32_t = 0;
+  virtual auto delete_vertex_array(uint32_t vertex_array) -> void = 0;
+  virtual auto bind_vertex_array(uint32_t vertex_array) -> void = 0;
+  virtual auto vertex_attrib(const VertexAttrib &attrib) -> void = 0;
+
+  // shaders and programs
+  virtual auto create_shader(uint32_t type) -> uint32_t = 0;
+  virtual auto delete_shader(uint32_t shader) -> void = 0;
+  virtual auto compile_shader(uint32_t shader, std::string_view source) -> void = 0;
+  virtual auto shader_compiled(uint32_t shader) -> bool = 0;
+  virtual auto shader_info_log(uint32_t shader) -> std::string = 0;
+  virtual auto create_program() -> uint32_t = 0;
+  virtual auto delete_program(uint32_t program) -> void = 0;
+  virtual auto program_parameter(uint32_t program, uint32_t pname, int32_t value) -> void = 0;
+  virtual auto attach_shader(uint32_t program, uint32_t shader) -> void = 0;
+  virtual auto detach_shader(uint32_t program, uint32_t shader) -> void = 0;
+  virtual auto link_program(uint32_t program) -> void = 0;
+  virtual auto program_linked(uint32_t program) -> bool = 0;
+  virtual auto program_info_log(uint32_t program) -> std::string = 0;
+  virtual auto get_program_binary(uint32_t program) -> ProgramBinary = 0;
+  virtual auto program_binary(uint32_t program, const ProgramBinary &binary) -> void = 0;
+  virtual auto use_program(uint32_t program) -> void = 0;
+
+  // reflection
+  virtual auto active_uniforms(uint32_t program) -> std::vector<ActiveUniform> = 0;
+  virtual auto uniform_location(uint32_t program, const char *name) -> int32_t = 0;
+  virtual auto active_uniform_blocks(uint32_t program) -> std::vector<std::string> = 0;
+  virtual auto uniform_block_parameter(uint32_t program, uint32_t index, uint32_t pname) -> int32_t = 0;
+  virtual auto uniform_block_binding(uint32_t program, uint32_t index, uint32_t binding) -> void = 0;
+
+  // uniforms of the program in use
+  virtual auto uniform_mat4(int32_t location, const float *value) -> void = 0;
+  virtual auto uniform_uint(int32_t location, uint32_t value) -> void = 0;
+
+  // fixed function state
+  virtual auto enable(uint32_t cap) -> void = 0;
+  virtual auto disable(uint32_t cap) -> void = 0;
+  virtual auto blend_func(uint32_t src_rgb, uint32_t dst_rgb, uint32_t src_alpha, uint32_t dst_alpha) -> void = 0;
+  virtual auto depth_mask(bool enabled) -> void = 0;
+  virtual auto depth_func(uint32_t func) -> void = 0;
+  virtual auto viewport(int32_t x, int32_t y, int32_t width, int32_t height) -> void = 0;
+  virtual auto clear(float r, float g, float b, float a, uint32_t mask) -> void = 0;
+
+  // draws and dispatches
+  virtual auto draw_elements(uint32_t mode, int32_t count, uint32_t type, size_t offset) -> void = 0;
+  virtual auto draw_elements_instanced(uint32_t mode, int32_t count, uint32_t type, size_t offset,
+                                       int32_t instance_count, int32_t base_vertex, uint32_t base_instance)
+    -> void = 0;
+  virtual auto multi_draw_elements_indirect(uint32_t mode, uint32_t type, size_t offset, int32_t draw_count)
+    -> void = 0;
+  virtual auto dispatch_compute(uint32_t x, uint32_t y, uint32_t z) -> void = 0;
+  virtual auto memory_barrier(uint32_t barriers) -> void = 0;
+
+  // marks the end of a frame's calls
+  virtual auto end_frame() -> void = 0;
+
+private:
+  inline static Device *active = nullptr;
+};
+
+} // namespace graphics
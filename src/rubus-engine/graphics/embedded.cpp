@@ -0,0 +1,14 @@
+#include "embedded.hpp"
+
+namespace graphics {
+
+auto find_embedded_shader(std::string_view path) -> std::optional<std::string_view> {
+  for (const auto &file : embedded_shaders()) {
+    if (file.path == path) {
+      return file.data;
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace graphics
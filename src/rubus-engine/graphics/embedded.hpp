@@ -0,0 +1,22 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace graphics {
+
+// a file embedded into the binary at build time (cmake/embed.cmake)
+struct EmbeddedFile {
+  std::string_view path;
+  std::string_view data;
+};
+
+auto embedded_shaders() -> std::span<const EmbeddedFile>;
+
+// spir-v of the vulkan sprite shaders, only built with RUBUS_VULKAN
+auto embedded_vulkan_shaders() -> std::span<const EmbeddedFile>;
+
+auto find_embedded_shader(std::string_view path) -> std::optional<std::string_view>;
+
+} // namespace graphics
@@ -0,0 +1,409 @@
+#include "gl_device.hpp"
+
+#include <array>
+
+#include <glad/glad.h>
+
+namespace graphics {
+
+auto GlDevice::name() const -> std::string_view {
+  return "gl";
+}
+
+auto GlDevice::get_integer(uint32_t pname) -> int32_t {
+  auto value = GLint{};
+  glGetIntegerv(pname, &value);
+  return value;
+}
+
+auto GlDevice::get_string(uint32_t name) -> std::string {
+  auto value = (const char *)glGetString(name);
+  return value == nullptr ? std::string{} : std::string{value};
+}
+
+auto GlDevice::has_extension(std::string_view extension) -> bool {
+  auto count = GLint{};
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (auto i = GLuint{}; i < (GLuint)count; ++i) {
+    if (auto name = (const char *)glGetStringi(GL_EXTENSIONS, i); name != nullptr and extension == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto GlDevice::enable_parallel_shader_compile() -> bool {
+#ifdef GL_KHR_parallel_shader_compile
+  if (GLAD_GL_KHR_parallel_shader_compile) {
+    // let the driver pick the number of compiler threads
+    glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    return true;
+  }
+#endif
+  return false;
+}
+
+auto GlDevice::create_buffer() -> uint32_t {
+  auto buffer = uint32_t{};
+  glCreateBuffers(1, &buffer);
+  return buffer;
+}
+
+auto GlDevice::delete_buffer(uint32_t buffer) -> void {
+  glDeleteBuffers(1, &buffer);
+}
+
+auto GlDevice::bind_buffer(uint32_t target, uint32_t buffer) -> void {
+  glBindBuffer(target, buffer);
+}
+
+auto GlDevice::bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer) -> void {
+  glBindBufferBase(target, index, buffer);
+}
+
+auto GlDevice::bind_buffer_range(uint32_t target, uint32_t index, uint32_t buffer, size_t offset, size_t size)
+  -> void {
+  glBindBufferRange(target, index, buffer, (GLintptr)offset, (GLsizeiptr)size);
+}
+
+auto GlDevice::buffer_data(uint32_t buffer, size_t size, const void *data, uint32_t usage) -> void {
+  glNamedBufferData(buffer, (GLsizeiptr)size, data, usage);
+}
+
+auto GlDevice::buffer_sub_data(uint32_t buffer, size_t offset, size_t size, const void *data) -> void {
+  glNamedBufferSubData(buffer, (GLintptr)offset, (GLsizeiptr)size, data);
+}
+
+auto GlDevice::map_persistent(uint32_t buffer, size_t size) -> std::byte * {
+  constexpr auto flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glNamedBufferStorage(buffer, (GLsizeiptr)size, nullptr, flags);
+  return (std::byte *)glMapNamedBufferRange(buffer, 0, (GLsizeiptr)size, flags);
+}
+
+auto GlDevice::unmap_buffer(uint32_t buffer) -> void {
+  glUnmapNamedBuffer(buffer);
+}
+
+auto GlDevice::fence() -> Fence {
+  return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+auto GlDevice::wait_fence(Fence fence, uint64_t timeout_ns) -> bool {
+  // only flush when actually waiting, a poll must not stall
+  const auto flags = timeout_ns > 0 ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+  const auto result = glClientWaitSync((GLsync)fence, flags, timeout_ns);
+  // a failed wait is not retried
+  return result != GL_TIMEOUT_EXPIRED;
+}
+
+auto GlDevice::delete_fence(Fence fence) -> void {
+  glDeleteSync((GLsync)fence);
+}
+
+auto GlDevice::create_texture() -> uint32_t {
+  auto texture = uint32_t{};
+  glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+  return texture;
+}
+
+auto GlDevice::delete_texture(uint32_t texture) -> void {
+  glDeleteTextures(1, &texture);
+}
+
+auto GlDevice::bind_texture(uint32_t unit, uint32_t texture) -> void {
+  glBindTextureUnit(unit, texture);
+}
+
+auto GlDevice::texture_parameter(uint32_t texture, uint32_t pname, int32_t value) -> void {
+  glTextureParameteri(texture, pname, value);
+}
+
+auto GlDevice::texture_border_color(uint32_t texture, const float *rgba) -> void {
+  glTextureParameterfv(texture, GL_TEXTURE_BORDER_COLOR, rgba);
+}
+
+auto GlDevice::texture_storage(uint32_t texture, int32_t levels, uint32_t internal_format, int32_t width,
+                               int32_t height) -> void {
+  glTextureStorage2D(texture, levels, internal_format, width, height);
+}
+
+auto GlDevice::texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width,
+                                 int32_t height, uint32_t format, uint32_t type, const void *pixels) -> void {
+  glTextureSubImage2D(texture, level, x, y, width, height, format, type, pixels);
+}
+
+auto GlDevice::compressed_texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width,
+                                            int32_t height, uint32_t format, size_t size, const void *data) -> void {
+  glCompressedTextureSubImage2D(texture, level, x, y, width, height, format, (GLsizei)size, data);
+}
+
+auto GlDevice::clear_texture(uint32_t texture, int32_t level, uint32_t format, uint32_t type, const void *data)
+  -> void {
+  glClearTexImage(texture, level, format, type, data);
+}
+
+auto GlDevice::generate_mipmap(uint32_t texture) -> void {
+  glGenerateTextureMipmap(texture);
+}
+
+auto GlDevice::pixel_store(uint32_t pname, int32_t value) -> void {
+  glPixelStorei(pname, value);
+}
+
+auto GlDevice::create_framebuffer() -> uint32_t {
+  auto framebuffer = uint32_t{};
+  glCreateFramebuffers(1, &framebuffer);
+  return framebuffer;
+}
+
+auto GlDevice::delete_framebuffer(uint32_t framebuffer) -> void {
+  glDeleteFramebuffers(1, &framebuffer);
+}
+
+auto GlDevice::bind_framebuffer(uint32_t target, uint32_t framebuffer) -> void {
+  glBindFramebuffer(target, framebuffer);
+}
+
+auto GlDevice::framebuffer_texture(uint32_t framebuffer, uint32_t attachment, uint32_t texture) -> void {
+  glNamedFramebufferTexture(framebuffer, attachment, texture, 0);
+}
+
+auto GlDevice::create_renderbuffer(uint32_t internal_format, int32_t width, int32_t height) -> uint32_t {
+  auto renderbuffer = uint32_t{};
+  glCreateRenderbuffers(1, &renderbuffer);
+  glNamedRenderbufferStorage(renderbuffer, internal_format, width, height);
+  return renderbuffer;
+}
+
+auto GlDevice::delete_renderbuffer(uint32_t renderbuffer) -> void {
+  glDeleteRenderbuffers(1, &renderbuffer);
+}
+
+auto GlDevice::framebuffer_renderbuffer(uint32_t framebuffer, uint32_t attachment, uint32_t renderbuffer)
+  -> void {
+  glNamedFramebufferRenderbuffer(framebuffer, attachment, GL_RENDERBUFFER, renderbuffer);
+}
+
+auto GlDevice::framebuffer_complete(uint32_t framebuffer) -> bool {
+  return glCheckNamedFramebufferStatus(framebuffer, GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+auto GlDevice::blit_framebuffer(uint32_t src, uint32_t dst, int32_t src_x0, int32_t src_y0, int32_t src_x1,
+                                int32_t src_y1, int32_t dst_x0, int32_t dst_y0, int32_t dst_x1, int32_t dst_y1,
+                                uint32_t mask, uint32_t filter) -> void {
+  glBlitNamedFramebuffer(src, dst, src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1, mask, filter);
+}
+
+auto GlDevice::create_vertex_array() -> uint32_t {
+  // not glCreateVertexArrays, attributes are set up through the bind points
+  auto vertex_array = uint32_t{};
+  glGenVertexArrays(1, &vertex_array);
+  return vertex_array;
+}
+
+auto GlDevice::delete_vertex_array(uint32_t vertex_array) -> void {
+  glDeleteVertexArrays(1, &vertex_array);
+}
+
+auto GlDevice::bind_vertex_array(uint32_t vertex_array) -> void {
+  glBindVertexArray(vertex_array);
+}
+
+auto GlDevice::vertex_attrib(const VertexAttrib &attrib) -> void {
+  glEnableVertexAttribArray(attrib.index);
+  glVertexAttribPointer(attrib.index, attrib.size, attrib.type, attrib.normalized ? GL_TRUE : GL_FALSE,
+                        attrib.stride, (const void *)attrib.offset); // NOLINT
+  glVertexAttribDivisor(attrib.index, attrib.divisor);
+}
+
+auto GlDevice::create_shader(uint32_t type) -> uint32_t {
+  return glCreateShader(type);
+}
+
+auto GlDevice::delete_shader(uint32_t shader) -> void {
+  glDeleteShader(shader);
+}
+
+auto GlDevice::compile_shader(uint32_t shader, std::string_view source) -> void {
+  auto data = source.data();
+  auto length = (GLint)source.size();
+  glShaderSource(shader, 1, &data, &length);
+  glCompileShader(shader);
+}
+
+auto GlDevice::shader_compiled(uint32_t shader) -> bool {
+  auto success = 0;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  return success != 0;
+}
+
+auto GlDevice::shader_info_log(uint32_t shader) -> std::string {
+  auto msg = std::array<char, 512>{};
+  glGetShaderInfoLog(shader, msg.size(), nullptr, msg.data());
+  return msg.data();
+}
+
+auto GlDevice::create_program() -> uint32_t {
+  return glCreateProgram();
+}
+
+auto GlDevice::delete_program(uint32_t program) -> void {
+  glDeleteProgram(program);
+}
+
+auto GlDevice::program_parameter(uint32_t program, uint32_t pname, int32_t value) -> void {
+  glProgramParameteri(program, pname, value);
+}
+
+auto GlDevice::attach_shader(uint32_t program, uint32_t shader) -> void {
+  glAttachShader(program, shader);
+}
+
+auto GlDevice::detach_shader(uint32_t program, uint32_t shader) -> void {
+  glDetachShader(program, shader);
+}
+
+auto GlDevice::link_program(uint32_t program) -> void {
+  glLinkProgram(program);
+}
+
+auto GlDevice::program_linked(uint32_t program) -> bool {
+  auto success = 0;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  return success != 0;
+}
+
+auto GlDevice::program_info_log(uint32_t program) -> std::string {
+  auto msg = std::array<char, 512>{};
+  glGetProgramInfoLog(program, msg.size(), nullptr, msg.data());
+  return msg.data();
+}
+
+auto GlDevice::get_program_binary(uint32_t program) -> ProgramBinary {
+  auto size = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+  if (size <= 0) {
+    return {};
+  }
+  auto binary = ProgramBinary{};
+  binary.data.resize((size_t)size);
+  auto format = GLenum{};
+  glGetProgramBinary(program, size, nullptr, &format, binary.data.data());
+  binary.format = format;
+  return binary;
+}
+
+auto GlDevice::program_binary(uint32_t program, const ProgramBinary &binary) -> void {
+  glProgramBinary(program, binary.format, binary.data.data(), (GLsizei)binary.data.size());
+}
+
+auto GlDevice::use_program(uint32_t program) -> void {
+  glUseProgram(program);
+}
+
+auto GlDevice::active_uniforms(uint32_t program) -> std::vector<ActiveUniform> {
+  auto result = std::vector<ActiveUniform>{};
+  auto name = std::array<char, 256>{};
+  auto count = 0;
+  glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+  for (auto i = 0; i < count; ++i) {
+    auto length = 0;
+    auto size = 0;
+    auto type = GLenum{};
+    glGetActiveUniform(program, i, name.size(), &length, &size, &type, name.data());
+    result.push_back({std::string{name.data(), (size_t)length}, size, type});
+  }
+  return result;
+}
+
+auto GlDevice::uniform_location(uint32_t program, const char *name) -> int32_t {
+  return glGetUniformLocation(program, name);
+}
+
+auto GlDevice::active_uniform_blocks(uint32_t program) -> std::vector<std::string> {
+  auto result = std::vector<std::string>{};
+  auto name = std::array<char, 256>{};
+  auto count = 0;
+  glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+  for (auto i = 0; i < count; ++i) {
+    auto length = 0;
+    glGetActiveUniformBlockName(program, i, name.size(), &length, name.data());
+    result.emplace_back(name.data(), (size_t)length);
+  }
+  return result;
+}
+
+auto GlDevice::uniform_block_parameter(uint32_t program, uint32_t index, uint32_t pname) -> int32_t {
+  auto value = 0;
+  glGetActiveUniformBlockiv(program, index, pname, &value);
+  return value;
+}
+
+auto GlDevice::uniform_block_binding(uint32_t program, uint32_t index, uint32_t binding) -> void {
+  glUniformBlockBinding(program, index, binding);
+}
+
+auto GlDevice::uniform_mat4(int32_t location, const float *value) -> void {
+  glUniformMatrix4fv(location, 1, GL_FALSE, value);
+}
+
+auto GlDevice::uniform_uint(int32_t location, uint32_t value) -> void {
+  glUniform1ui(location, value);
+}
+
+auto GlDevice::enable(uint32_t cap) -> void {
+  glEnable(cap);
+}
+
+auto GlDevice::disable(uint32_t cap) -> void {
+  glDisable(cap);
+}
+
+auto GlDevice::blend_func(uint32_t src_rgb, uint32_t dst_rgb, uint32_t src_alpha, uint32_t dst_alpha) -> void {
+  glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha);
+}
+
+auto GlDevice::depth_mask(bool enabled) -> void {
+  glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+auto GlDevice::depth_func(uint32_t func) -> void {
+  glDepthFunc(func);
+}
+
+auto GlDevice::viewport(int32_t x, int32_t y, int32_t width, int32_t height) -> void {
+  glViewport(x, y, width, height);
+}
+
+auto GlDevice::clear(float r, float g, float b, float a, uint32_t mask) -> void {
+  glClearColor(r, g, b, a);
+  glClear(mask);
+}
+
+auto GlDevice::draw_elements(uint32_t mode, int32_t count, uint32_t type, size_t offset) -> void {
+  glDrawElements(mode, count, type, (const void *)offset); // NOLINT
+}
+
+auto GlDevice::draw_elements_instanced(uint32_t mode, int32_t count, uint32_t type, size_t offset,
+                                       int32_t instance_count, int32_t base_vertex, uint32_t base_instance)
+  -> void {
+  glDrawElementsInstancedBaseVertexBaseInstance(mode, count, type, (const void *)offset, // NOLINT
+                                                instance_count, base_vertex, base_instance);
+}
+
+auto GlDevice::multi_draw_elements_indirect(uint32_t mode, uint32_t type, size_t offset, int32_t draw_count)
+  -> void {
+  glMultiDrawElementsIndirect(mode, type, (const void *)offset, draw_count, 0); // NOLINT
+}
+
+auto GlDevice::dispatch_compute(uint32_t x, uint32_t y, uint32_t z) -> void {
+  glDispatchCompute(x, y, z);
+}
+
+auto GlDevice::memory_barrier(uint32_t barriers) -> void {
+  glMemoryBarrier(barriers);
+}
+
+auto GlDevice::end_frame() -> void {}
+
+} // namespace graphics
@@ -1,18 +1,41 @@
 #include "graphics.hpp"
 
+#include <algorithm>
 #include <array>
 #include <format>
+#include <cstddef>
 #include <iostream>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RUBUS_SSE2 1
+#endif
+
 #include <stb_image.h>
 #include <glad/glad.h>
 
+#include "device.hpp"
+#include "state_cache.hpp"
+
 namespace graphics {
 
 auto Mesh::delete_buffers() -> void {
-  glDeleteVertexArrays(1, &vao);
-  glDeleteBuffers(1, &vbo);
-  glDeleteBuffers(1, &ebo);
+  StateCache::forget_vertex_array(vao);
+  StateCache::forget_buffer(vbo);
+  StateCache::forget_buffer(ebo);
+  auto &device = Device::current();
+  device.delete_vertex_array(vao);
+  device.delete_buffer(vbo);
+  device.delete_buffer(ebo);
+}
+
+auto RenderTarget::delete_buffers() -> void {
+  StateCache::forget_framebuffer(framebuffer);
+  StateCache::forget_texture(color);
+  auto &device = Device::current();
+  device.delete_framebuffer(framebuffer);
+  device.delete_texture(color);
+  device.delete_renderbuffer(depth_stencil);
 }
 
 auto world_to_screen_space(float width, float height, glm::mat4 mvp, glm::vec2 pos) -> glm::vec2 {
@@ -33,58 +56,103 @@ auto screen_to_world_space(float width, float height, glm::mat4 vp, glm::vec2 po
   return {world_pos.x, world_pos.y};
 }
 
+auto transform_points(const glm::mat3 &affine, std::span<const glm::vec2> in, std::span<glm::vec2> out) -> void {
+  // out = m * in + t, glm::mat3 is column major
+  const auto m00 = affine[0][0];
+  const auto m10 = affine[0][1];
+  const auto m01 = affine[1][0];
+  const auto m11 = affine[1][1];
+  const auto tx = affine[2][0];
+  const auto ty = affine[2][1];
+
+  const auto count = std::min(in.size(), out.size());
+  auto i = size_t{};
+#ifdef RUBUS_SSE2
+  // [x0 y0 x1 y1] -> [x0 x0 x1 x1] * [m00 m10 ..] + [y0 y0 y1 y1] * [m01 m11 ..] + [tx ty ..]
+  const auto col0 = _mm_setr_ps(m00, m10, m00, m10);
+  const auto col1 = _mm_setr_ps(m01, m11, m01, m11);
+  const auto translation = _mm_setr_ps(tx, ty, tx, ty);
+  const auto src = (const float *)in.data();
+  const auto dst = (float *)out.data();
+  for (; i + 2 <= count; i += 2) {
+    const auto points = _mm_loadu_ps(src + i * 2);
+    const auto xs = _mm_shuffle_ps(points, points, _MM_SHUFFLE(2, 2, 0, 0));
+    const auto ys = _mm_shuffle_ps(points, points, _MM_SHUFFLE(3, 3, 1, 1));
+    const auto result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, col0), _mm_mul_ps(ys, col1)), translation);
+    _mm_storeu_ps(dst + i * 2, result);
+  }
+#endif
+  for (; i < count; ++i) {
+    const auto p = in[i];
+    out[i] = {m00 * p.x + m01 * p.y + tx, m10 * p.x + m11 * p.y + ty};
+  }
+}
+
 auto compile_shader(int shader_type, std::span<const char *> shader_src) -> uint32_t {
-  auto shader = uint32_t{};
-  shader = glCreateShader(shader_type);
-  glShaderSource(shader, 1, shader_src.data(), nullptr);
-  glCompileShader(shader);
-
-  auto success = 0;
-  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    auto msg = std::array<char, 512>{};
-    glGetShaderInfoLog(shader, msg.size(), nullptr, msg.data());
-    glDeleteShader(shader);
-    std::cout << std::format("Error: shader compilation failed\n{}\n", msg.data());
+  auto &device = Device::current();
+  auto shader = device.create_shader((uint32_t)shader_type);
+  device.compile_shader(shader, shader_src.front());
+
+  if (not device.shader_compiled(shader)) {
+    auto msg = device.shader_info_log(shader);
+    device.delete_shader(shader);
+    std::cout << std::format("Error: shader compilation failed\n{}\n", msg);
   }
 
   return shader;
 }
 
 auto link_shaders(std::initializer_list<uint32_t> shaders) -> uint32_t {
-  auto program = uint32_t{};
-  program = glCreateProgram();
+  auto &device = Device::current();
+  auto program = device.create_program();
   for (auto shader : shaders) {
-    glAttachShader(program, shader);
+    device.attach_shader(program, shader);
   }
-  glLinkProgram(program);
+  device.link_program(program);
 
   for (auto shader : shaders) {
-    glDetachShader(program, shader);
-    glDeleteShader(shader);
+    device.detach_shader(program, shader);
+    device.delete_shader(shader);
   }
 
-  auto success = 0;
-  glGetProgramiv(program, GL_LINK_STATUS, &success);
-  if (!success) {
-    auto msg = std::array<char, 512>{};
-    glGetProgramInfoLog(program, msg.size(), nullptr, msg.data());
-    glDeleteProgram(program);
-    std::cout << std::format("Error: shader linking failed\n{}\n", msg.data());
+  if (not device.program_linked(program)) {
+    auto msg = device.program_info_log(program);
+    device.delete_program(program);
+    std::cout << std::format("Error: shader linking failed\n{}\n", msg);
   }
 
   return program;
 }
 
 auto set_uniform_mat4f(uint32_t shader_program, const char *name, float *value_ptr) -> void {
-  auto loc = glGetUniformLocation(shader_program, name);
-  glUniformMatrix4fv(loc, 1, GL_FALSE, value_ptr);
+  auto &device = Device::current();
+  device.uniform_mat4(device.uniform_location(shader_program, name), value_ptr);
+}
+
+auto make_uniform_buffer(size_t size) -> uint32_t {
+  auto &device = Device::current();
+  auto ubo = device.create_buffer();
+  device.buffer_data(ubo, size, nullptr, GL_DYNAMIC_DRAW);
+  return ubo;
+}
+
+auto update_uniform_buffer(uint32_t ubo, uint32_t binding, std::span<const std::byte> data) -> void {
+  auto &device = Device::current();
+  device.buffer_sub_data(ubo, 0, data.size(), data.data());
+  device.bind_buffer_base(GL_UNIFORM_BUFFER, binding, ubo);
+  // the indexed bind also binds the generic target
+  StateCache::buffers[(size_t)StateCache::BufferTarget::Uniform] = ubo;
+}
+
+auto delete_uniform_buffer(uint32_t ubo) -> void {
+  StateCache::forget_buffer(ubo);
+  Device::current().delete_buffer(ubo);
 }
 
 auto make_quad_mesh(glm::vec3 tr, glm::vec3 tl, glm::vec3 bl, glm::vec3 br) -> Mesh {
-  auto vao = uint32_t{};
-  glGenVertexArrays(1, &vao);
-  glBindVertexArray(vao);
+  auto &device = Device::current();
+  auto vao = device.create_vertex_array();
+  StateCache::bind_vertex_array(vao);
 
   // clang-format off
   auto vertices = std::array{
@@ -100,30 +168,26 @@ auto make_quad_mesh(glm::vec3 tr, glm::vec3 tl, glm::vec3 bl, glm::vec3 br) -> M
   };
   // clang-format on
 
-  constexpr auto stride = 5 * sizeof(float);
+  constexpr auto stride = (int32_t)(5 * sizeof(float));
 
-  auto vbo = uint32_t{};
-  glGenBuffers(1, &vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+  auto vbo = device.create_buffer();
+  device.buffer_data(vbo, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+  StateCache::bind_buffer(GL_ARRAY_BUFFER, vbo);
 
   // positions
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void *)0); // NOLINT
+  device.vertex_attrib({.index = 0, .size = 3, .type = GL_FLOAT, .stride = stride, .offset = 0});
 
   // uv
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void *)(3 * sizeof(float))); // NOLINT
+  device.vertex_attrib({.index = 1, .size = 2, .type = GL_FLOAT, .stride = stride, .offset = 3 * sizeof(float)});
 
-  auto ebo = uint32_t{};
-  glGenBuffers(1, &ebo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint8_t), indices.data(), GL_STATIC_DRAW);
+  auto ebo = device.create_buffer();
+  device.buffer_data(ebo, indices.size() * sizeof(uint8_t), indices.data(), GL_STATIC_DRAW);
+  StateCache::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 
   // reset state
-  glBindVertexArray(0);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  StateCache::bind_vertex_array(0);
+  StateCache::bind_buffer(GL_ARRAY_BUFFER, 0);
+  StateCache::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
   return {vao, vbo, ebo};
 }
@@ -136,10 +200,96 @@ auto make_quad_mesh(glm::vec2 pivot, float width, float height) -> Mesh {
   return make_quad_mesh(tr, tl, bl, br);
 }
 
+auto make_render_target(int width, int height, bool depth_stencil) -> RenderTarget {
+  auto &device = Device::current();
+  auto target = RenderTarget{.width = width, .height = height};
+
+  target.color = device.create_texture();
+  device.texture_parameter(target.color, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  device.texture_parameter(target.color, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  device.texture_parameter(target.color, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  device.texture_parameter(target.color, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  device.texture_storage(target.color, 1, GL_RGBA8, width, height);
+
+  target.framebuffer = device.create_framebuffer();
+  device.framebuffer_texture(target.framebuffer, GL_COLOR_ATTACHMENT0, target.color);
+
+  if (depth_stencil) {
+    target.depth_stencil = device.create_renderbuffer(GL_DEPTH24_STENCIL8, width, height);
+    device.framebuffer_renderbuffer(target.framebuffer, GL_DEPTH_STENCIL_ATTACHMENT, target.depth_stencil);
+  }
+
+  if (not device.framebuffer_complete(target.framebuffer)) {
+    std::cerr << std::format("Error: render target {}x{} is incomplete\n", width, height);
+  }
+
+  return target;
+}
+
+auto make_sprite_mesh(uint32_t vbo, uint32_t ebo) -> Mesh {
+  // the vertex and index buffers are shared and owned by the caller, uint16 indices
+  auto &device = Device::current();
+  auto vao = device.create_vertex_array();
+  StateCache::bind_vertex_array(vao);
+
+  constexpr auto stride = (int32_t)sizeof(SpriteVertex);
+  StateCache::bind_buffer(GL_ARRAY_BUFFER, vbo);
+
+  // positions
+  device.vertex_attrib(
+    {.index = 0, .size = 3, .type = GL_FLOAT, .stride = stride, .offset = offsetof(SpriteVertex, position)});
+
+  // uv
+  device.vertex_attrib(
+    {.index = 1, .size = 2, .type = GL_FLOAT, .stride = stride, .offset = offsetof(SpriteVertex, uv)});
+
+  StateCache::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+  // reset state
+  StateCache::bind_vertex_array(0);
+  StateCache::bind_buffer(GL_ARRAY_BUFFER, 0);
+
+  return {vao, 0, 0};
+}
+
+auto set_sprite_instance_buffer(const Mesh &mesh, uint32_t instance_buffer) -> void {
+  StateCache::bind_vertex_array(mesh.vao);
+  StateCache::bind_buffer(GL_ARRAY_BUFFER, instance_buffer);
+
+  auto &device = Device::current();
+  constexpr auto stride = (int32_t)sizeof(SpriteInstance);
+  const auto instance_attrib = [&](uint32_t index, size_t offset) {
+    device.vertex_attrib(
+      {.index = index, .size = 4, .type = GL_FLOAT, .stride = stride, .offset = offset, .divisor = 1});
+  };
+
+  // quad axes
+  instance_attrib(2, offsetof(SpriteInstance, axes));
+
+  // quad center
+  instance_attrib(3, offsetof(SpriteInstance, center));
+
+  // uv rect
+  instance_attrib(4, offsetof(SpriteInstance, uv_rect));
+
+  // depth, alpha discard threshold
+  instance_attrib(5, offsetof(SpriteInstance, params));
+
+  // reset state
+  StateCache::bind_vertex_array(0);
+}
+
 auto draw_quad(uint32_t vao) -> void {
-  glBindVertexArray(vao);
-  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, nullptr);
-  glBindVertexArray(0);
+  StateCache::bind_vertex_array(vao);
+  Device::current().draw_elements(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, 0);
+}
+
+auto draw_sprites_instanced(uint32_t vao, uint32_t first_index, uint32_t index_count, int32_t base_vertex,
+                            uint32_t first_instance, uint32_t instance_count) -> void {
+  StateCache::bind_vertex_array(vao);
+  Device::current().draw_elements_instanced(GL_TRIANGLES, (int32_t)index_count, GL_UNSIGNED_SHORT,
+                                            first_index * sizeof(uint16_t), (int32_t)instance_count, base_vertex,
+                                            first_instance);
 }
 
 } // namespace graphics
@@ -17,17 +17,63 @@ struct Mesh {
   auto delete_buffers() -> void;
 };
 
+struct RenderTarget {
+  uint32_t framebuffer = 0;
+  uint32_t color = 0;
+  uint32_t depth_stencil = 0;
+  int width = 0;
+  int height = 0;
+
+  auto delete_buffers() -> void;
+};
+
+struct SpriteVertex {
+  glm::vec3 position; // unit space, corners of the full quad at (+-1, +-1)
+  glm::vec2 uv;       // relative to the image
+};
+
+// the final world space quad of a sprite, its corners are center +- axis_x +- axis_y
+struct SpriteInstance {
+  glm::vec4 axes;    // xy: axis_x, zw: axis_y, both are half extents with pivot, size, rotation and scale applied
+  glm::vec4 center;  // xy: center in world space, zw: sprite color, rg and ba as 16 bit integers
+  glm::vec4 uv_rect; // xy: min uv, zw: max uv
+  glm::vec4 params;  // x: ndc depth, y: alpha discard threshold, z: draw command of the gpu culler, w: palette row
+};
+
+// layout of glMultiDrawElementsIndirect commands
+struct DrawElementsIndirectCommand {
+  uint32_t count = 0;
+  uint32_t instance_count = 0;
+  uint32_t first_index = 0;
+  int32_t base_vertex = 0;
+  uint32_t base_instance = 0;
+};
+
 auto world_to_screen_space(float width, float height, glm::mat4 mvp, glm::vec2 pos = {0, 0}) -> glm::vec2;
 auto screen_to_world_space(float width, float height, glm::mat4 mvp, glm::vec2 pos) -> glm::vec2;
 
+// applies the 2d affine transform in the upper two rows of `affine` to every point, `out` must hold as many points
+// as `in`. two points per sse register where available.
+auto transform_points(const glm::mat3 &affine, std::span<const glm::vec2> in, std::span<glm::vec2> out) -> void;
+
 auto compile_shader(int shader_type, std::span<const char *> shader_src) -> uint32_t;
 auto link_shaders(std::initializer_list<uint32_t> shaders) -> uint32_t;
 
 auto set_uniform_mat4f(uint32_t shader_program, const char *name, float *value_ptr) -> void;
 
+auto make_uniform_buffer(size_t size) -> uint32_t;
+auto update_uniform_buffer(uint32_t ubo, uint32_t binding, std::span<const std::byte> data) -> void;
+auto delete_uniform_buffer(uint32_t ubo) -> void;
+
 auto make_quad_mesh(glm::vec3 tr, glm::vec3 tl, glm::vec3 bl, glm::vec3 br) -> Mesh;
 auto make_quad_mesh(glm::vec2 pivot, float width, float height) -> Mesh;
+auto make_render_target(int width, int height, bool depth_stencil) -> RenderTarget;
+
+auto make_sprite_mesh(uint32_t vbo, uint32_t ebo) -> Mesh;
+auto set_sprite_instance_buffer(const Mesh &mesh, uint32_t instance_buffer) -> void;
 
 auto draw_quad(uint32_t vao) -> void;
+auto draw_sprites_instanced(uint32_t vao, uint32_t first_index, uint32_t index_count, int32_t base_vertex,
+                            uint32_t first_instance, uint32_t instance_count) -> void;
 
 } // namespace graphics
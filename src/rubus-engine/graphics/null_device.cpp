@@ -0,0 +1,498 @@
+#include "null_device.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <iostream>
+
+#include <glad/glad.h>
+
+namespace graphics {
+
+namespace {
+
+auto is_identifier(std::string_view token) -> bool {
+  return not token.empty() and (std::isalpha((unsigned char)token[0]) or token[0] == '_');
+}
+
+// identifiers, numbers and single punctuation characters of glsl source, without comments
+auto glsl_tokens(std::string_view source) -> std::vector<std::string_view> {
+  const auto is_word = [](char c) { return std::isalnum((unsigned char)c) or c == '_'; };
+  auto tokens = std::vector<std::string_view>{};
+  auto i = size_t{};
+  while (i < source.size()) {
+    if (std::isspace((unsigned char)source[i])) {
+      i += 1;
+    } else if (source.substr(i, 2) == "//") {
+      i = std::min(source.find('\n', i), source.size());
+    } else if (source.substr(i, 2) == "/*") {
+      i = std::min(source.find("*/", i + 2), source.size() - 2) + 2;
+    } else if (is_word(source[i])) {
+      const auto start = i;
+      while (i < source.size() and is_word(source[i])) {
+        i += 1;
+      }
+      tokens.push_back(source.substr(start, i - start));
+    } else {
+      tokens.push_back(source.substr(i, 1));
+      i += 1;
+    }
+  }
+  return tokens;
+}
+
+} // namespace
+
+auto NullDevice::name() const -> std::string_view {
+  return "null";
+}
+
+auto NullDevice::get_integer(uint32_t pname) -> int32_t {
+  note(DeviceCall::GetInteger, pname);
+  switch (pname) {
+  case GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT:
+  case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:
+    return 16;
+  case GL_MAX_TEXTURE_SIZE:
+    return 16384;
+  default:
+    return 0;
+  }
+}
+
+auto NullDevice::get_string(uint32_t name) -> std::string {
+  note(DeviceCall::GetString, name);
+  switch (name) {
+  case GL_VENDOR:
+    return "rubus";
+  case GL_RENDERER:
+    return "null";
+  case GL_VERSION:
+    return "4.6 null";
+  default:
+    return "";
+  }
+}
+
+auto NullDevice::has_extension(std::string_view) -> bool {
+  note(DeviceCall::HasExtension);
+  return false;
+}
+
+auto NullDevice::enable_parallel_shader_compile() -> bool {
+  note(DeviceCall::EnableParallelShaderCompile);
+  return false;
+}
+
+auto NullDevice::create_buffer() -> uint32_t {
+  const auto buffer = next_name++;
+  note(DeviceCall::CreateBuffer, buffer);
+  return buffer;
+}
+
+auto NullDevice::delete_buffer(uint32_t buffer) -> void {
+  note(DeviceCall::DeleteBuffer, buffer);
+  mapped.erase(buffer);
+}
+
+auto NullDevice::bind_buffer(uint32_t, uint32_t buffer) -> void {
+  note(DeviceCall::BindBuffer, buffer);
+}
+
+auto NullDevice::bind_buffer_base(uint32_t, uint32_t, uint32_t buffer) -> void {
+  note(DeviceCall::BindBufferBase, buffer);
+}
+
+auto NullDevice::bind_buffer_range(uint32_t, uint32_t, uint32_t buffer, size_t, size_t size) -> void {
+  note(DeviceCall::BindBufferRange, buffer, size);
+}
+
+auto NullDevice::buffer_data(uint32_t buffer, size_t size, const void *, uint32_t) -> void {
+  note(DeviceCall::BufferData, buffer, size);
+}
+
+auto NullDevice::buffer_sub_data(uint32_t buffer, size_t, size_t size, const void *) -> void {
+  note(DeviceCall::BufferSubData, buffer, size);
+}
+
+auto NullDevice::map_persistent(uint32_t buffer, size_t size) -> std::byte * {
+  note(DeviceCall::MapPersistent, buffer, size);
+  auto &storage = mapped[buffer];
+  storage.assign(size, std::byte{});
+  return storage.data();
+}
+
+auto NullDevice::unmap_buffer(uint32_t buffer) -> void {
+  note(DeviceCall::UnmapBuffer, buffer);
+  mapped.erase(buffer);
+}
+
+auto NullDevice::fence() -> Fence {
+  const auto fence = next_name++;
+  note(DeviceCall::Fence, fence);
+  return (Fence)(uintptr_t)fence; // NOLINT
+}
+
+auto NullDevice::wait_fence(Fence fence, uint64_t) -> bool {
+  note(DeviceCall::WaitFence, (uint32_t)(uintptr_t)fence); // NOLINT
+  return true;
+}
+
+auto NullDevice::delete_fence(Fence fence) -> void {
+  note(DeviceCall::DeleteFence, (uint32_t)(uintptr_t)fence); // NOLINT
+}
+
+auto NullDevice::create_texture() -> uint32_t {
+  const auto texture = next_name++;
+  note(DeviceCall::CreateTexture, texture);
+  return texture;
+}
+
+auto NullDevice::delete_texture(uint32_t texture) -> void {
+  note(DeviceCall::DeleteTexture, texture);
+}
+
+auto NullDevice::bind_texture(uint32_t, uint32_t texture) -> void {
+  note(DeviceCall::BindTexture, texture);
+}
+
+auto NullDevice::texture_parameter(uint32_t texture, uint32_t, int32_t) -> void {
+  note(DeviceCall::TextureParameter, texture);
+}
+
+auto NullDevice::texture_border_color(uint32_t texture, const float *) -> void {
+  note(DeviceCall::TextureBorderColor, texture);
+}
+
+auto NullDevice::texture_storage(uint32_t texture, int32_t, uint32_t, int32_t width, int32_t height) -> void {
+  note(DeviceCall::TextureStorage, texture, (uint64_t)width * (uint64_t)height * 4);
+}
+
+auto NullDevice::texture_sub_image(uint32_t texture, int32_t, int32_t, int32_t, int32_t width, int32_t height,
+                                   uint32_t, uint32_t, const void *) -> void {
+  note(DeviceCall::TextureSubImage, texture, (uint64_t)width * (uint64_t)height * 4);
+}
+
+auto NullDevice::compressed_texture_sub_image(uint32_t texture, int32_t, int32_t, int32_t, int32_t, int32_t,
+                                              uint32_t, size_t size, const void *) -> void {
+  note(DeviceCall::CompressedTextureSubImage, texture, size);
+}
+
+auto NullDevice::clear_texture(uint32_t texture, int32_t, uint32_t, uint32_t, const void *) -> void {
+  note(DeviceCall::ClearTexture, texture);
+}
+
+auto NullDevice::generate_mipmap(uint32_t texture) -> void {
+  note(DeviceCall::GenerateMipmap, texture);
+}
+
+auto NullDevice::pixel_store(uint32_t pname, int32_t) -> void {
+  note(DeviceCall::PixelStore, pname);
+}
+
+auto NullDevice::create_framebuffer() -> uint32_t {
+  const auto framebuffer = next_name++;
+  note(DeviceCall::CreateFramebuffer, framebuffer);
+  return framebuffer;
+}
+
+auto NullDevice::delete_framebuffer(uint32_t framebuffer) -> void {
+  note(DeviceCall::DeleteFramebuffer, framebuffer);
+}
+
+auto NullDevice::bind_framebuffer(uint32_t, uint32_t framebuffer) -> void {
+  note(DeviceCall::BindFramebuffer, framebuffer);
+}
+
+auto NullDevice::framebuffer_texture(uint32_t framebuffer, uint32_t, uint32_t) -> void {
+  note(DeviceCall::FramebufferTexture, framebuffer);
+}
+
+auto NullDevice::create_renderbuffer(uint32_t, int32_t width, int32_t height) -> uint32_t {
+  const auto renderbuffer = next_name++;
+  note(DeviceCall::CreateRenderbuffer, renderbuffer, (uint64_t)width * (uint64_t)height * 4);
+  return renderbuffer;
+}
+
+auto NullDevice::delete_renderbuffer(uint32_t renderbuffer) -> void {
+  note(DeviceCall::DeleteRenderbuffer, renderbuffer);
+}
+
+auto NullDevice::framebuffer_renderbuffer(uint32_t framebuffer, uint32_t, uint32_t) -> void {
+  note(DeviceCall::FramebufferRenderbuffer, framebuffer);
+}
+
+auto NullDevice::framebuffer_complete(uint32_t framebuffer) -> bool {
+  note(DeviceCall::FramebufferComplete, framebuffer);
+  return true;
+}
+
+auto NullDevice::blit_framebuffer(uint32_t src, uint32_t, int32_t, int32_t, int32_t, int32_t, int32_t dst_x0,
+                                  int32_t dst_y0, int32_t dst_x1, int32_t dst_y1, uint32_t, uint32_t) -> void {
+  note(DeviceCall::BlitFramebuffer, src, (uint64_t)(dst_x1 - dst_x0) * (uint64_t)(dst_y1 - dst_y0));
+}
+
+auto NullDevice::create_vertex_array() -> uint32_t {
+  const auto vertex_array = next_name++;
+  note(DeviceCall::CreateVertexArray, vertex_array);
+  return vertex_array;
+}
+
+auto NullDevice::delete_vertex_array(uint32_t vertex_array) -> void {
+  note(DeviceCall::DeleteVertexArray, vertex_array);
+}
+
+auto NullDevice::bind_vertex_array(uint32_t vertex_array) -> void {
+  note(DeviceCall::BindVertexArray, vertex_array);
+}
+
+auto NullDevice::vertex_attrib(const VertexAttrib &attrib) -> void {
+  note(DeviceCall::VertexAttrib, attrib.index);
+}
+
+auto NullDevice::create_shader(uint32_t) -> uint32_t {
+  const auto shader = next_name++;
+  note(DeviceCall::CreateShader, shader);
+  return shader;
+}
+
+auto NullDevice::delete_shader(uint32_t shader) -> void {
+  note(DeviceCall::DeleteShader, shader);
+  shader_sources.erase(shader);
+}
+
+auto NullDevice::compile_shader(uint32_t shader, std::string_view source) -> void {
+  note(DeviceCall::CompileShader, shader, source.size());
+  shader_sources[shader] = std::string{source};
+}
+
+auto NullDevice::shader_compiled(uint32_t shader) -> bool {
+  note(DeviceCall::ShaderCompiled, shader);
+  return true;
+}
+
+auto NullDevice::shader_info_log(uint32_t shader) -> std::string {
+  note(DeviceCall::ShaderInfoLog, shader);
+  return "";
+}
+
+auto NullDevice::create_program() -> uint32_t {
+  const auto program = next_name++;
+  note(DeviceCall::CreateProgram, program);
+  programs[program] = {};
+  return program;
+}
+
+auto NullDevice::delete_program(uint32_t program) -> void {
+  note(DeviceCall::DeleteProgram, program);
+  programs.erase(program);
+}
+
+auto NullDevice::program_parameter(uint32_t program, uint32_t, int32_t) -> void {
+  note(DeviceCall::ProgramParameter, program);
+}
+
+auto NullDevice::attach_shader(uint32_t program, uint32_t shader) -> void {
+  note(DeviceCall::AttachShader, program);
+  programs[program].shaders.push_back(shader);
+}
+
+auto NullDevice::detach_shader(uint32_t program, uint32_t shader) -> void {
+  note(DeviceCall::DetachShader, program);
+  std::erase(programs[program].shaders, shader);
+}
+
+auto NullDevice::link_program(uint32_t program) -> void {
+  note(DeviceCall::LinkProgram, program);
+
+  // no compiler, reflection comes from the declarations in the sources: "uniform <block> {" and
+  // "uniform <type> <name>[<size>];"
+  auto &info = programs[program];
+  info.uniforms.clear();
+  info.blocks.clear();
+  for (auto shader : info.shaders) {
+    const auto tokens = glsl_tokens(shader_sources[shader]);
+    for (auto i = size_t{}; i + 3 < tokens.size(); ++i) {
+      if (tokens[i] != "uniform" or not is_identifier(tokens[i + 1])) {
+        continue;
+      }
+      if (tokens[i + 2] == "{") {
+        const auto block = std::string{tokens[i + 1]};
+        if (std::find(info.blocks.begin(), info.blocks.end(), block) == info.blocks.end()) {
+          info.blocks.push_back(block);
+        }
+        continue;
+      }
+      if (not is_identifier(tokens[i + 2])) {
+        continue;
+      }
+      auto size = 1;
+      auto end = i + 3;
+      if (tokens[end] == "[" and end + 3 < tokens.size() and tokens[end + 2] == "]") {
+        const auto count = tokens[end + 1];
+        std::from_chars(count.data(), count.data() + count.size(), size);
+        end += 3;
+      }
+      if (tokens[end] == ";") {
+        info.uniforms.push_back({std::string{tokens[i + 2]}, size, 0});
+      }
+    }
+  }
+  info.block_bindings.assign(info.blocks.size(), 0);
+  info.linked = true;
+}
+
+auto NullDevice::program_linked(uint32_t program) -> bool {
+  note(DeviceCall::ProgramLinked, program);
+  auto it = programs.find(program);
+  return it != programs.end() and it->second.linked;
+}
+
+auto NullDevice::program_info_log(uint32_t program) -> std::string {
+  note(DeviceCall::ProgramInfoLog, program);
+  return "";
+}
+
+auto NullDevice::get_program_binary(uint32_t program) -> ProgramBinary {
+  note(DeviceCall::GetProgramBinary, program);
+  return {};
+}
+
+auto NullDevice::program_binary(uint32_t program, const ProgramBinary &binary) -> void {
+  // a binary of another device is never accepted, the program stays unlinked
+  note(DeviceCall::ProgramBinary, program, binary.data.size());
+}
+
+auto NullDevice::use_program(uint32_t program) -> void {
+  note(DeviceCall::UseProgram, program);
+}
+
+auto NullDevice::active_uniforms(uint32_t program) -> std::vector<ActiveUniform> {
+  note(DeviceCall::ActiveUniforms, program);
+  return programs[program].uniforms;
+}
+
+auto NullDevice::uniform_location(uint32_t program, const char *name) -> int32_t {
+  note(DeviceCall::UniformLocation, program);
+  const auto &uniforms = programs[program].uniforms;
+  for (auto i = size_t{}; i < uniforms.size(); ++i) {
+    if (uniforms[i].name == name) {
+      return (int32_t)i;
+    }
+  }
+  return -1;
+}
+
+auto NullDevice::active_uniform_blocks(uint32_t program) -> std::vector<std::string> {
+  note(DeviceCall::ActiveUniformBlocks, program);
+  return programs[program].blocks;
+}
+
+auto NullDevice::uniform_block_parameter(uint32_t program, uint32_t index, uint32_t pname) -> int32_t {
+  note(DeviceCall::UniformBlockParameter, program);
+  const auto &info = programs[program];
+  if (pname == GL_UNIFORM_BLOCK_BINDING and index < info.block_bindings.size()) {
+    return (int32_t)info.block_bindings[index];
+  }
+  return 0;
+}
+
+auto NullDevice::uniform_block_binding(uint32_t program, uint32_t index, uint32_t binding) -> void {
+  note(DeviceCall::UniformBlockBinding, program);
+  auto &info = programs[program];
+  if (index < info.block_bindings.size()) {
+    info.block_bindings[index] = binding;
+  }
+}
+
+auto NullDevice::uniform_mat4(int32_t location, const float *) -> void {
+  note(DeviceCall::UniformMat4, (uint32_t)location);
+}
+
+auto NullDevice::uniform_uint(int32_t location, uint32_t) -> void {
+  note(DeviceCall::UniformUint, (uint32_t)location);
+}
+
+auto NullDevice::enable(uint32_t cap) -> void {
+  note(DeviceCall::Enable, cap);
+}
+
+auto NullDevice::disable(uint32_t cap) -> void {
+  note(DeviceCall::Disable, cap);
+}
+
+auto NullDevice::blend_func(uint32_t, uint32_t, uint32_t, uint32_t) -> void {
+  note(DeviceCall::BlendFunc);
+}
+
+auto NullDevice::depth_mask(bool enabled) -> void {
+  note(DeviceCall::DepthMask, (uint32_t)enabled);
+}
+
+auto NullDevice::depth_func(uint32_t func) -> void {
+  note(DeviceCall::DepthFunc, func);
+}
+
+auto NullDevice::viewport(int32_t, int32_t, int32_t width, int32_t height) -> void {
+  note(DeviceCall::Viewport, 0, (uint64_t)width * (uint64_t)height);
+}
+
+auto NullDevice::clear(float, float, float, float, uint32_t mask) -> void {
+  note(DeviceCall::Clear, mask);
+}
+
+auto NullDevice::draw_elements(uint32_t, int32_t count, uint32_t, size_t) -> void {
+  note(DeviceCall::DrawElements, 0, (uint64_t)count);
+}
+
+auto NullDevice::draw_elements_instanced(uint32_t, int32_t, uint32_t, size_t, int32_t instance_count, int32_t,
+                                         uint32_t) -> void {
+  note(DeviceCall::DrawElementsInstanced, 0, (uint64_t)instance_count);
+}
+
+auto NullDevice::multi_draw_elements_indirect(uint32_t, uint32_t, size_t, int32_t draw_count) -> void {
+  // the instance counts live in a gpu buffer, only the number of draws is known
+  note(DeviceCall::MultiDrawElementsIndirect, 0, (uint64_t)draw_count);
+}
+
+auto NullDevice::dispatch_compute(uint32_t x, uint32_t y, uint32_t z) -> void {
+  note(DeviceCall::DispatchCompute, 0, (uint64_t)x * y * z);
+}
+
+auto NullDevice::memory_barrier(uint32_t barriers) -> void {
+  note(DeviceCall::MemoryBarrier, barriers);
+}
+
+auto NullDevice::end_frame() -> void {
+  note(DeviceCall::EndFrame);
+}
+
+auto NullDevice::count(DeviceCall call) const -> uint32_t {
+  return counts[(size_t)call];
+}
+
+auto NullDevice::total_calls() const -> uint32_t {
+  auto total = uint32_t{};
+  for (auto count : counts) {
+    total += count;
+  }
+  return total;
+}
+
+auto NullDevice::reset() -> void {
+  counts.fill(0);
+  commands.clear();
+}
+
+auto NullDevice::note(DeviceCall call, uint32_t object, uint64_t size) -> void {
+  counts[(size_t)call] += 1;
+  if (record) {
+    commands.push_back({call, object, size});
+  }
+  if (log) {
+    std::cerr << std::format("{} {} {}\n", device_call_name(call), object, size);
+  }
+}
+
+} // namespace graphics
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "device.hpp"
+
+namespace graphics {
+
+struct DeviceCommand {
+  DeviceCall call = DeviceCall::Count;
+  uint32_t object = 0; // first handle the call takes or returns
+  uint64_t size = 0;   // bytes uploaded, elements or instances drawn, depending on the call
+};
+
+// a device without a gpu: it hands out fake names, keeps mapped buffers in cpu memory and reports every
+// program as linked, so the engine runs headless. every call is counted, and optionally recorded or logged,
+// which measures the cpu cost and the call stream of a frame in isolation.
+struct NullDevice final : Device {
+  std::array<uint32_t, (size_t)DeviceCall::Count> counts = {};
+  bool record = false;
+  std::vector<DeviceCommand> commands;
+  bool log = false; // prints every call to std::cerr, next to the errors of the engine
+
+  auto name() const -> std::string_view override;
+
+  auto get_integer(uint32_t pname) -> int32_t override;
+  auto get_string(uint32_t name) -> std::string override;
+  auto has_extension(std::string_view extension) -> bool override;
+  auto enable_parallel_shader_compile() -> bool override;
+
+  auto create_buffer() -> uint32_t override;
+  auto delete_buffer(uint32_t buffer) -> void override;
+  auto bind_buffer(uint32_t target, uint32_t buffer) -> void override;
+  auto bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer) -> void override;
+  auto bind_buffer_range(uint32_t target, uint32_t index, uint32_t buffer, size_t offset, size_t size)
+    -> void override;
+  auto buffer_data(uint32_t buffer, size_t size, const void *data, uint32_t usage) -> void override;
+  auto buffer_sub_data(uint32_t buffer, size_t offset, size_t size, const void *data) -> void override;
+  auto map_persistent(uint32_t buffer, size_t size) -> std::byte * override;
+  auto unmap_buffer(uint32_t buffer) -> void override;
+
+  auto fence() -> Fence override;
+  auto wait_fence(Fence fence, uint64_t timeout_ns) -> bool override;
+  auto delete_fence(Fence fence) -> void override;
+
+  auto create_texture() -> uint32_t override;
+  auto delete_texture(uint32_t texture) -> void override;
+  auto bind_texture(uint32_t unit, uint32_t texture) -> void override;
+  auto texture_parameter(uint32_t texture, uint32_t pname, int32_t value) -> void override;
+  auto texture_border_color(uint32_t texture, const float *rgba) -> void override;
+  auto texture_storage(uint32_t texture, int32_t levels, uint32_t internal_format, int32_t width, int32_t height)
+    -> void override;
+  auto texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width, int32_t height,
+                         uint32_t format, uint32_t type, const void *pixels) -> void override;
+  auto compressed_texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width,
+                                    int32_t height, uint32_t format, size_t size, const void *data) -> void override;
+  auto clear_texture(uint32_t texture, int32_t level, uint32_t format, uint32_t type, const void *data)
+    -> void override;
+  auto generate_mipmap(uint32_t texture) -> void override;
+  auto pixel_store(uint32_t pname, int32_t value) -> void override;
+
+  auto create_framebuffer() -> uint32_t override;
+  auto delete_framebuffer(uint32_t framebuffer) -> void override;
+  auto bind_framebuffer(uint32_t target, uint32_t framebuffer) -> void override;
+  auto framebuffer_texture(uint32_t framebuffer, uint32_t attachment, uint32_t texture) -> void override;
+  auto create_renderbuffer(uint32_t internal_format, int32_t width, int32_t height) -> uint32_t override;
+  auto delete_renderbuffer(uint32_t renderbuffer) -> void override;
+  auto framebuffer_renderbuffer(uint32_t framebuffer, uint32_t attachment, uint32_t renderbuffer)
+    -> void override;
+  auto framebuffer_complete(uint32_t framebuffer) -> bool override;
+  auto blit_framebuffer(uint32_t src, uint32_t dst, int32_t src_x0, int32_t src_y0, int32_t src_x1, int32_t src_y1,
+                        int32_t dst_x0, int32_t dst_y0, int32_t dst_x1, int32_t dst_y1, uint32_t mask,
+                        uint32_t filter) -> void override;
+
+  auto create_vertex_array() -> uint32_t override;
+  auto delete_vertex_array(uint32_t vertex_array) -> void override;
+  auto bind_vertex_array(uint32_t vertex_array) -> void override;
+  auto vertex_attrib(const VertexAttrib &attrib) -> void override;
+
+  auto create_shader(uint32_t type) -> uint32_t override;
+  auto delete_shader(uint32_t shader) -> void override;
+  auto compile_shader(uint32_t shader, std::string_view source) -> void override;
+  auto shader_compiled(uint32_t shader) -> bool override;
+  auto shader_info_log(uint32_t shader) -> std::string override;
+  auto create_program() -> uint32_t override;
+  auto delete_program(uint32_t program) -> void override;
+  auto program_parameter(uint32_t program, uint32_t pname, int32_t value) -> void override;
+  auto attach_shader(uint32_t program, uint32_t shader) -> void override;
+  auto detach_shader(uint32_t program, uint32_t shader) -> void override;
+  auto link_program(uint32_t program) -> void override;
+  auto program_linked(uint32_t program) -> bool override;
+  auto program_info_log(uint32_t program) -> std::string override;
+  auto get_program_binary(uint32_t program) -> ProgramBinary override;
+  auto program_binary(uint32_t program, const ProgramBinary &binary) -> void override;
+  auto use_program(uint32_t program) -> void override;
+
+  auto active_uniforms(uint32_t program) -> std::vector<ActiveUniform> override;
+  auto uniform_location(uint32_t program, const char *name) -> int32_t override;
+  auto active_uniform_blocks(uint32_t program) -> std::vector<std::string> override;
+  auto uniform_block_parameter(uint32_t program, uint32_t index, uint32_t pname) -> int32_t override;
+  auto uniform_block_binding(uint32_t program, uint32_t index, uint32_t binding) -> void override;
+
+  auto uniform_mat4(int32_t location, const float *value) -> void override;
+  auto uniform_uint(int32_t location, uint32_t value) -> void override;
+
+  auto enable(uint32_t cap) -> void override;
+  auto disable(uint32_t cap) -> void override;
+  auto blend_func(uint32_t src_rgb, uint32_t dst_rgb, uint32_t src_alpha, uint32_t dst_alpha) -> void override;
+  auto depth_mask(bool enabled) -> void override;
+  auto depth_func(uint32_t func) -> void override;
+  auto viewport(int32_t x, int32_t y, int32_t width, int32_t height) -> void override;
+  auto clear(float r, float g, float b, float a, uint32_t mask) -> void override;
+
+  auto draw_elements(uint32_t mode, int32_t count, uint32_t type, size_t offset) -> void override;
+  auto draw_elements_instanced(uint32_t mode, int32_t count, uint32_t type, size_t offset, int32_t instance_count,
+                               int32_t base_vertex, uint32_t base_instance) -> void override;
+  auto multi_draw_elements_indirect(uint32_t mode, uint32_t type, size_t offset, int32_t draw_count)
+    -> void override;
+  auto dispatch_compute(uint32_t x, uint32_t y, uint32_t z) -> void override;
+  auto memory_barrier(uint32_t barriers) -> void override;
+
+  auto end_frame() -> void override;
+
+  auto count(DeviceCall call) const -> uint32_t;
+  auto total_calls() const -> uint32_t;
+  auto reset() -> void; // counts and recorded commands
+
+private:
+  struct ProgramInfo {
+    std::vector<uint32_t> shaders;
+    std::vector<ActiveUniform> uniforms;
+    std::vector<std::string> blocks;
+    std::vector<uint32_t> block_bindings;
+    bool linked = false;
+  };
+
+  uint32_t next_name = 1;
+  std::unordered_map<uint32_t, std::vector<std::byte>> mapped;
+  std::unordered_map<uint32_t, std::string> shader_sources;
+  std::unordered_map<uint32_t, ProgramInfo> programs;
+
+  auto note(DeviceCall call, uint32_t object = 0, uint64_t size = 0) -> void;
+};
+
+} // namespace graphics
@@ -0,0 +1,218 @@
+#include "shader_cache.hpp"
+
+#include <format>
+#include <fstream>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include <rubus-engine/utils/utils.hpp>
+#include "device.hpp"
+#include "embedded.hpp"
+#include "state_cache.hpp"
+
+namespace graphics {
+
+namespace {
+
+constexpr auto binary_magic = uint32_t{0x43535552}; // "RUSC"
+
+struct BinaryHeader {
+  uint32_t magic = binary_magic;
+  uint32_t format = 0;
+  uint64_t hash = 0;
+  uint32_t size = 0;
+  uint32_t reserved = 0;
+};
+
+struct PendingProgram {
+  const ProgramDesc *desc = nullptr;
+  uint32_t program = 0;
+  uint64_t hash = 0;
+  std::vector<uint32_t> shaders;
+};
+
+auto fnv1a(std::string_view data, uint64_t hash = 14695981039346656037ull) -> uint64_t {
+  for (auto c : data) {
+    hash ^= (uint8_t)c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+auto read_source(std::string_view path) -> std::string {
+  if (auto source = find_embedded_shader(path); source.has_value()) {
+    return std::string{*source};
+  }
+  // not embedded, e.g. a shader added without rebuilding
+  return utils::read_file(path);
+}
+
+auto binary_path(const ProgramDesc &desc, uint64_t hash) -> std::filesystem::path {
+  return ShaderCache::cache_dir / std::format("{}-{:016x}.bin", desc.name, hash);
+}
+
+auto load_binary(const std::filesystem::path &path, uint64_t hash) -> uint32_t {
+  auto fs = std::ifstream{path, std::ios::binary};
+  if (not fs) {
+    return 0;
+  }
+
+  auto header = BinaryHeader{};
+  fs.read((char *)&header, sizeof(header));
+  if (not fs or header.magic != binary_magic or header.hash != hash) {
+    return 0;
+  }
+  auto binary = std::vector<char>(header.size);
+  fs.read(binary.data(), (std::streamsize)binary.size());
+  if (not fs) {
+    return 0;
+  }
+
+  // the driver rejects binaries from another driver version
+  auto &device = Device::current();
+  auto program = device.create_program();
+  device.program_binary(program, {header.format, std::move(binary)});
+  if (not device.program_linked(program)) {
+    device.delete_program(program);
+    return 0;
+  }
+  return program;
+}
+
+auto save_binary(const std::filesystem::path &path, uint32_t program, uint64_t hash) -> void {
+  auto binary = Device::current().get_program_binary(program);
+  if (binary.data.empty()) {
+    return;
+  }
+
+  auto header = BinaryHeader{};
+  header.hash = hash;
+  header.format = binary.format;
+  header.size = (uint32_t)binary.data.size();
+
+  auto ec = std::error_code{};
+  std::filesystem::create_directories(path.parent_path(), ec);
+  auto fs = std::ofstream{path, std::ios::binary | std::ios::trunc};
+  if (not fs) {
+    std::cerr << std::format("Error: failed to write shader binary \"{}\"\n", path.string());
+    return;
+  }
+  fs.write((const char *)&header, sizeof(header));
+  fs.write(binary.data.data(), (std::streamsize)binary.data.size());
+}
+
+auto print_info_logs(const PendingProgram &pending) -> void {
+  auto &device = Device::current();
+  for (auto shader : pending.shaders) {
+    if (not device.shader_compiled(shader)) {
+      std::cerr << std::format("Error: shader compilation failed ({})\n{}\n", pending.desc->name,
+                               device.shader_info_log(shader));
+    }
+  }
+  std::cerr << std::format("Error: shader linking failed ({})\n{}\n", pending.desc->name,
+                           device.program_info_log(pending.program));
+}
+
+} // namespace
+
+auto ShaderCache::get(const std::string &name) -> const ShaderProgram * {
+  auto it = programs.find(name);
+  if (it == programs.end()) {
+    return nullptr;
+  }
+  return &it->second;
+}
+
+auto ShaderCache::load(const ProgramDesc &desc) -> const ShaderProgram * {
+  load_all(std::span{&desc, 1});
+  return get(desc.name);
+}
+
+auto ShaderCache::load_all(std::span<const ProgramDesc> descs) -> void {
+  enable_parallel_compile();
+  auto &device = Device::current();
+
+  // kick off every compile and link before querying any status, so the driver can work in parallel
+  auto pending = std::vector<PendingProgram>{};
+  for (const auto &desc : descs) {
+    if (programs.contains(desc.name)) {
+      continue;
+    }
+
+    auto sources = std::vector<std::string>{};
+    auto hash = fnv1a(driver_id());
+    for (const auto &stage : desc.stages) {
+      sources.push_back(read_source(stage.path));
+      hash = fnv1a(std::format("{}", stage.type), hash);
+      hash = fnv1a(sources.back(), hash);
+    }
+
+    if (use_binary_cache) {
+      if (auto program = load_binary(binary_path(desc, hash), hash); program != 0) {
+        programs.insert({desc.name, ShaderProgram::reflect(program)});
+        stats.binary_hits += 1;
+        continue;
+      }
+      stats.binary_misses += 1;
+    }
+
+    auto p = PendingProgram{.desc = &desc, .program = device.create_program(), .hash = hash, .shaders = {}};
+    device.program_parameter(p.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    for (auto i = size_t{}; i < desc.stages.size(); ++i) {
+      auto shader = device.create_shader(desc.stages[i].type);
+      device.compile_shader(shader, sources[i]);
+      device.attach_shader(p.program, shader);
+      p.shaders.push_back(shader);
+    }
+    device.link_program(p.program);
+    pending.push_back(std::move(p));
+  }
+
+  // collect
+  for (auto &p : pending) {
+    const auto success = device.program_linked(p.program);
+    if (not success) {
+      print_info_logs(p);
+    }
+
+    for (auto shader : p.shaders) {
+      device.detach_shader(p.program, shader);
+      device.delete_shader(shader);
+    }
+
+    if (not success) {
+      device.delete_program(p.program);
+      continue;
+    }
+
+    if (use_binary_cache) {
+      save_binary(binary_path(*p.desc, p.hash), p.program, p.hash);
+    }
+    programs.insert({p.desc->name, ShaderProgram::reflect(p.program)});
+    stats.compiled += 1;
+  }
+}
+
+auto ShaderCache::deinit() -> void {
+  for (auto &[_, program] : programs) {
+    program.destroy();
+  }
+  programs.clear();
+}
+
+auto ShaderCache::driver_id() -> const std::string & {
+  auto &device = Device::current();
+  static auto id = std::format("{}|{}|{}", device.get_string(GL_VENDOR), device.get_string(GL_RENDERER),
+                               device.get_string(GL_VERSION));
+  return id;
+}
+
+auto ShaderCache::enable_parallel_compile() -> void {
+  static auto enabled = false;
+  if (not enabled) {
+    enabled = Device::current().enable_parallel_shader_compile();
+  }
+}
+
+} // namespace graphics
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "shader_program.hpp"
+
+namespace graphics {
+
+struct ShaderStage {
+  uint32_t type = 0;     // GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, ...
+  std::string_view path; // embedded path, e.g. "shaders/sprite/vert.glsl"
+};
+
+struct ShaderCacheStats {
+  uint32_t compiled = 0;
+  uint32_t binary_hits = 0;
+  uint32_t binary_misses = 0;
+};
+
+struct ProgramDesc {
+  std::string name;
+  std::vector<ShaderStage> stages;
+};
+
+// owns every linked program for the life of the process.
+// sources come from the embedded shaders (or disk as a fallback) and linked programs are saved with
+// glGetProgramBinary, keyed by the driver and the source hash, so warm starts skip compilation.
+struct ShaderCache {
+  inline static std::unordered_map<std::string, ShaderProgram> programs;
+  inline static std::filesystem::path cache_dir = "shader_cache";
+  inline static bool use_binary_cache = true;
+  inline static ShaderCacheStats stats;
+
+  static auto get(const std::string &name) -> const ShaderProgram *;
+  static auto load(const ProgramDesc &desc) -> const ShaderProgram *;
+  static auto load_all(std::span<const ProgramDesc> descs) -> void; // compiles in parallel when supported
+  static auto deinit() -> void;
+
+private:
+  static auto driver_id() -> const std::string &;
+  static auto enable_parallel_compile() -> void;
+};
+
+} // namespace graphics
@@ -0,0 +1,82 @@
+#include "shader_program.hpp"
+
+#include <format>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include "device.hpp"
+#include "state_cache.hpp"
+
+namespace graphics {
+
+auto ShaderProgram::reflect(uint32_t program) -> ShaderProgram {
+  auto result = ShaderProgram{};
+  result.handle = program;
+  if (program == 0) {
+    return result;
+  }
+
+  auto &device = Device::current();
+
+  // uniforms
+  for (auto &uniform : device.active_uniforms(program)) {
+    // uniforms inside a block have no location
+    auto location = device.uniform_location(program, uniform.name.c_str());
+    if (location == -1) {
+      continue;
+    }
+
+    // arrays are reported as "name[0]"
+    auto uniform_name = std::move(uniform.name);
+    if (uniform_name.ends_with("[0]")) {
+      uniform_name.resize(uniform_name.size() - 3);
+    }
+    result.uniforms.insert(
+      {uniform_name, UniformInfo{.location = location, .type = uniform.type, .size = uniform.size}});
+  }
+
+  // uniform blocks
+  const auto blocks = device.active_uniform_blocks(program);
+  for (auto i = uint32_t{}; i < blocks.size(); ++i) {
+    auto binding = device.uniform_block_parameter(program, i, GL_UNIFORM_BLOCK_BINDING);
+    auto data_size = device.uniform_block_parameter(program, i, GL_UNIFORM_BLOCK_DATA_SIZE);
+    result.uniform_blocks.insert({
+      blocks[i],
+      UniformBlockInfo{.index = i, .binding = (uint32_t)binding, .data_size = data_size},
+    });
+  }
+
+  return result;
+}
+
+auto ShaderProgram::location(const std::string &name) const -> int32_t {
+  auto it = uniforms.find(name);
+  if (it == uniforms.end()) {
+    return -1;
+  }
+  return it->second.location;
+}
+
+auto ShaderProgram::bind_uniform_block(const std::string &name, uint32_t binding) -> bool {
+  auto it = uniform_blocks.find(name);
+  if (it == uniform_blocks.end()) {
+    std::cerr << std::format("Error: uniform block \"{}\" not found in program {}\n", name, handle);
+    return false;
+  }
+  if (it->second.binding != binding) {
+    Device::current().uniform_block_binding(handle, it->second.index, binding);
+    it->second.binding = binding;
+  }
+  return true;
+}
+
+auto ShaderProgram::destroy() -> void {
+  StateCache::forget_program(handle);
+  Device::current().delete_program(handle);
+  handle = 0;
+  uniforms.clear();
+  uniform_blocks.clear();
+}
+
+} // namespace graphics
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace graphics {
+
+// std140 uniform block binding points shared by every shader
+static constexpr uint32_t camera_uniform_binding = 0;
+
+struct UniformInfo {
+  int32_t location = -1;
+  uint32_t type = 0;
+  int32_t size = 0;
+};
+
+struct UniformBlockInfo {
+  uint32_t index = 0;
+  uint32_t binding = 0;
+  int32_t data_size = 0;
+};
+
+// a linked program with its active uniforms and uniform blocks read once at link time
+struct ShaderProgram {
+  uint32_t handle = 0;
+  std::unordered_map<std::string, UniformInfo> uniforms;
+  std::unordered_map<std::string, UniformBlockInfo> uniform_blocks;
+
+  static auto reflect(uint32_t program) -> ShaderProgram;
+
+  auto location(const std::string &name) const -> int32_t;
+  auto bind_uniform_block(const std::string &name, uint32_t binding) -> bool;
+  auto destroy() -> void;
+};
+
+} // namespace graphics
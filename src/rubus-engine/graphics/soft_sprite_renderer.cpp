@@ -0,0 +1,548 @@
+#include "soft_sprite_renderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <iostream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define RUBUS_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RUBUS_SSE2 1
+#endif
+
+namespace graphics {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// F: floats, I: int32s, M: per lane mask, all `width` wide. texels and colors are rgba8 in an int32 lane
+struct ScalarLanes {
+  using F = float;
+  using I = int32_t;
+  using M = bool;
+  static constexpr uint32_t width = 1;
+
+  static auto iota() -> F { return 0.f; }
+  static auto set(float v) -> F { return v; }
+  static auto add(F a, F b) -> F { return a + b; }
+  static auto sub(F a, F b) -> F { return a - b; }
+  static auto mul(F a, F b) -> F { return a * b; }
+  static auto madd(F a, F b, F c) -> F { return a * b + c; }
+  static auto min(F a, F b) -> F { return std::min(a, b); }
+  static auto max(F a, F b) -> F { return std::max(a, b); }
+  static auto floor(F v) -> F { return std::floor(v); }
+  static auto ge(F a, F b) -> M { return a >= b; }
+  static auto lt(F a, F b) -> M { return a < b; }
+  static auto both(M a, M b) -> M { return a and b; }
+  static auto any(M m) -> bool { return m; }
+  static auto select(M m, F a, F b) -> F { return m ? a : b; }
+  static auto load(const float *p) -> F { return *p; }
+  static auto store(float *p, F v) -> void { *p = v; }
+  static auto to_int(F v) -> I { return (I)v; }
+  static auto to_float(I v) -> F { return (F)v; }
+  static auto load_int(const uint32_t *p) -> I { return (I)*p; }
+  static auto store_int(uint32_t *p, I v) -> void { *p = (uint32_t)v; }
+  static auto select_int(M m, I a, I b) -> I { return m ? a : b; }
+  static auto gather(const uint32_t *base, I index, M m) -> I { return m ? (I)base[index] : 0; }
+  static auto channel(I v, int32_t shift) -> F { return (F)(((uint32_t)v >> shift) & 0xff); }
+  static auto pack(F r, F g, F b, F a) -> I {
+    const auto rg = (uint32_t)to_int(r) | (uint32_t)to_int(g) << 8;
+    return (I)(rg | (uint32_t)to_int(b) << 16 | (uint32_t)to_int(a) << 24);
+  }
+};
+
+#if defined(RUBUS_AVX2)
+struct SimdLanes {
+  using F = __m256;
+  using I = __m256i;
+  using M = __m256;
+  static constexpr uint32_t width = 8;
+
+  static auto iota() -> F { return _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f); }
+  static auto set(float v) -> F { return _mm256_set1_ps(v); }
+  static auto add(F a, F b) -> F { return _mm256_add_ps(a, b); }
+  static auto sub(F a, F b) -> F { return _mm256_sub_ps(a, b); }
+  static auto mul(F a, F b) -> F { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__)
+  static auto madd(F a, F b, F c) -> F { return _mm256_fmadd_ps(a, b, c); }
+#else
+  static auto madd(F a, F b, F c) -> F { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+  static auto min(F a, F b) -> F { return _mm256_min_ps(a, b); }
+  static auto max(F a, F b) -> F { return _mm256_max_ps(a, b); }
+  static auto floor(F v) -> F { return _mm256_floor_ps(v); }
+  static auto ge(F a, F b) -> M { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+  static auto lt(F a, F b) -> M { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static auto both(M a, M b) -> M { return _mm256_and_ps(a, b); }
+  static auto any(M m) -> bool { return _mm256_movemask_ps(m) != 0; }
+  static auto select(M m, F a, F b) -> F { return _mm256_blendv_ps(b, a, m); }
+  static auto load(const float *p) -> F { return _mm256_loadu_ps(p); }
+  static auto store(float *p, F v) -> void { _mm256_storeu_ps(p, v); }
+  static auto to_int(F v) -> I { return _mm256_cvttps_epi32(v); }
+  static auto to_float(I v) -> F { return _mm256_cvtepi32_ps(v); }
+  static auto load_int(const uint32_t *p) -> I { return _mm256_loadu_si256((const __m256i *)p); }
+  static auto store_int(uint32_t *p, I v) -> void { _mm256_storeu_si256((__m256i *)p, v); }
+  static auto select_int(M m, I a, I b) -> I { return _mm256_blendv_epi8(b, a, _mm256_castps_si256(m)); }
+  static auto gather(const uint32_t *base, I index, M m) -> I {
+    return _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *)base, index, _mm256_castps_si256(m), 4);
+  }
+  static auto channel(I v, int32_t shift) -> F {
+    const auto shifted = _mm256_srl_epi32(v, _mm_cvtsi32_si128(shift));
+    return _mm256_cvtepi32_ps(_mm256_and_si256(shifted, _mm256_set1_epi32(0xff)));
+  }
+  static auto pack(F r, F g, F b, F a) -> I {
+    const auto rg = _mm256_or_si256(to_int(r), _mm256_slli_epi32(to_int(g), 8));
+    const auto ba = _mm256_or_si256(_mm256_slli_epi32(to_int(b), 16), _mm256_slli_epi32(to_int(a), 24));
+    return _mm256_or_si256(rg, ba);
+  }
+};
+#elif defined(RUBUS_SSE2)
+struct SimdLanes {
+  using F = __m128;
+  using I = __m128i;
+  using M = __m128;
+  static constexpr uint32_t width = 4;
+
+  static auto iota() -> F { return _mm_setr_ps(0.f, 1.f, 2.f, 3.f); }
+  static auto set(float v) -> F { return _mm_set1_ps(v); }
+  static auto add(F a, F b) -> F { return _mm_add_ps(a, b); }
+  static auto sub(F a, F b) -> F { return _mm_sub_ps(a, b); }
+  static auto mul(F a, F b) -> F { return _mm_mul_ps(a, b); }
+  static auto madd(F a, F b, F c) -> F { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+  static auto min(F a, F b) -> F { return _mm_min_ps(a, b); }
+  static auto max(F a, F b) -> F { return _mm_max_ps(a, b); }
+  // no roundps before sse4.1: truncate, then step down where that rounded up
+  static auto floor(F v) -> F {
+    const auto t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.f)));
+  }
+  static auto ge(F a, F b) -> M { return _mm_cmpge_ps(a, b); }
+  static auto lt(F a, F b) -> M { return _mm_cmplt_ps(a, b); }
+  static auto both(M a, M b) -> M { return _mm_and_ps(a, b); }
+  static auto any(M m) -> bool { return _mm_movemask_ps(m) != 0; }
+  static auto select(M m, F a, F b) -> F { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+  static auto load(const float *p) -> F { return _mm_loadu_ps(p); }
+  static auto store(float *p, F v) -> void { _mm_storeu_ps(p, v); }
+  static auto to_int(F v) -> I { return _mm_cvttps_epi32(v); }
+  static auto to_float(I v) -> F { return _mm_cvtepi32_ps(v); }
+  static auto load_int(const uint32_t *p) -> I { return _mm_loadu_si128((const __m128i *)p); }
+  static auto store_int(uint32_t *p, I v) -> void { _mm_storeu_si128((__m128i *)p, v); }
+  static auto select_int(M m, I a, I b) -> I {
+    const auto mask = _mm_castps_si128(m);
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+  }
+  // no gather before avx2, one load per covered lane
+  static auto gather(const uint32_t *base, I index, M m) -> I {
+    alignas(16) int32_t indices[4];
+    alignas(16) uint32_t texels[4] = {};
+    _mm_store_si128((__m128i *)indices, index);
+    const auto bits = _mm_movemask_ps(m);
+    for (auto i = 0; i < 4; ++i) {
+      if ((bits & (1 << i)) != 0) {
+        texels[i] = base[indices[i]];
+      }
+    }
+    return _mm_load_si128((const __m128i *)texels);
+  }
+  static auto channel(I v, int32_t shift) -> F {
+    return _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(v, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(0xff)));
+  }
+  static auto pack(F r, F g, F b, F a) -> I {
+    const auto rg = _mm_or_si128(to_int(r), _mm_slli_epi32(to_int(g), 8));
+    const auto ba = _mm_or_si128(_mm_slli_epi32(to_int(b), 16), _mm_slli_epi32(to_int(a), 24));
+    return _mm_or_si128(rg, ba);
+  }
+};
+#else
+using SimdLanes = ScalarLanes;
+#endif
+
+// channels as 0..255 floats
+template <typename L>
+struct Rgba {
+  typename L::F r;
+  typename L::F g;
+  typename L::F b;
+  typename L::F a;
+};
+
+template <typename L>
+auto unpack(typename L::I v) -> Rgba<L> {
+  return {L::channel(v, 0), L::channel(v, 8), L::channel(v, 16), L::channel(v, 24)};
+}
+
+// the texel at (x, y), transparent black outside the texture (GL_CLAMP_TO_BORDER) and in masked lanes
+template <typename L>
+auto fetch(const SoftSpriteRenderer::Texture &texture, typename L::F x, typename L::F y, typename L::M m)
+  -> typename L::I {
+  const auto zero = L::set(0.f);
+  const auto width = L::set((float)texture.width);
+  const auto inside = L::both(L::both(L::ge(x, zero), L::lt(x, width)),
+                              L::both(L::ge(y, zero), L::lt(y, L::set((float)texture.height))));
+  // float indices are exact up to 2^24 texels, the largest texture the gl path creates
+  return L::gather(texture.texels.data(), L::to_int(L::madd(y, width, x)), L::both(m, inside));
+}
+
+template <typename L, SoftFilter filter>
+auto sample(const SoftSpriteRenderer::Texture &texture, typename L::F u, typename L::F v, typename L::M m)
+  -> Rgba<L> {
+  const auto x = L::mul(u, L::set((float)texture.width));
+  const auto y = L::mul(v, L::set((float)texture.height));
+  if constexpr (filter == SoftFilter::Nearest) {
+    return unpack<L>(fetch<L>(texture, L::floor(x), L::floor(y), m));
+  } else {
+    // texel centers sit at +0.5
+    const auto half = L::set(0.5f);
+    const auto one = L::set(1.f);
+    const auto x0 = L::floor(L::sub(x, half));
+    const auto y0 = L::floor(L::sub(y, half));
+    const auto fx = L::sub(L::sub(x, half), x0);
+    const auto fy = L::sub(L::sub(y, half), y0);
+    const auto x1 = L::add(x0, one);
+    const auto y1 = L::add(y0, one);
+
+    auto result = Rgba<L>{L::set(0.f), L::set(0.f), L::set(0.f), L::set(0.f)};
+    const auto accumulate = [&](typename L::I texel, typename L::F weight) {
+      const auto c = unpack<L>(texel);
+      result.r = L::madd(c.r, weight, result.r);
+      result.g = L::madd(c.g, weight, result.g);
+      result.b = L::madd(c.b, weight, result.b);
+      result.a = L::madd(c.a, weight, result.a);
+    };
+    accumulate(fetch<L>(texture, x0, y0, m), L::mul(L::sub(one, fx), L::sub(one, fy)));
+    accumulate(fetch<L>(texture, x1, y0, m), L::mul(fx, L::sub(one, fy)));
+    accumulate(fetch<L>(texture, x0, y1, m), L::mul(L::sub(one, fx), fy));
+    accumulate(fetch<L>(texture, x1, y1, m), L::mul(fx, fy));
+    return result;
+  }
+}
+
+// rounds 0..255 channels to rgba8 like a unorm8 color attachment
+template <typename L>
+auto pack(const Rgba<L> &c) -> typename L::I {
+  const auto clamp = [](typename L::F v) {
+    return L::add(L::min(L::max(v, L::set(0.f)), L::set(255.f)), L::set(0.5f));
+  };
+  return L::pack(clamp(c.r), clamp(c.g), clamp(c.b), clamp(c.a));
+}
+
+// shades the pixels [x_begin, x_end) of one row of a tile. x_begin is a multiple of the lane width and
+// x_end - x_begin is padded to one, the coverage mask cuts the lanes outside the quad and the image
+template <typename L, SoftFilter filter, bool blended>
+auto shade_span(const SoftSpriteRenderer::Quad &quad, const SoftSpriteRenderer::Texture &texture, uint32_t *color,
+                float *depth, uint32_t x_begin, uint32_t x_end, uint32_t image_width, float window_y) -> void {
+  const auto minus_one = L::set(-1.f);
+  const auto one = L::set(1.f);
+  const auto half = L::set(0.5f);
+  const auto inv_255 = L::set(1.f / 255.f);
+  const auto limit = L::set((float)image_width);
+  const auto quad_depth = L::set(quad.depth);
+  const auto cutoff = L::set(quad.alpha_cutoff * 255.f);
+  const auto row_x = quad.local_origin.x + quad.local_dy.x * window_y;
+  const auto row_y = quad.local_origin.y + quad.local_dy.y * window_y;
+  const auto uv_min_u = L::set(quad.uv_rect.x);
+  const auto uv_min_v = L::set(quad.uv_rect.y);
+  const auto uv_size_u = L::set(quad.uv_rect.z - quad.uv_rect.x);
+  const auto uv_size_v = L::set(quad.uv_rect.w - quad.uv_rect.y);
+
+  for (auto x = x_begin; x < x_end; x += L::width) {
+    // pixel centers, then their position on the quad
+    const auto px = L::add(L::iota(), L::set((float)x + 0.5f));
+    const auto lx = L::madd(L::set(quad.local_dx.x), px, L::set(row_x));
+    const auto ly = L::madd(L::set(quad.local_dx.y), px, L::set(row_y));
+    auto m = L::both(L::both(L::ge(lx, minus_one), L::lt(lx, one)), L::both(L::ge(ly, minus_one), L::lt(ly, one)));
+    m = L::both(m, L::lt(px, limit));
+    if (not L::any(m)) {
+      continue;
+    }
+    const auto old_depth = L::load(depth + x);
+    m = L::both(m, L::lt(quad_depth, old_depth));
+    if (not L::any(m)) {
+      continue;
+    }
+
+    // the quad's -1..1 maps onto its uv rect, as mix(uv_rect.xy, uv_rect.zw, in_uv) in vert.glsl
+    const auto u = L::madd(L::madd(lx, half, half), uv_size_u, uv_min_u);
+    const auto v = L::madd(L::madd(ly, half, half), uv_size_v, uv_min_v);
+    auto src = sample<L, filter>(texture, u, v, m);
+    m = L::both(m, L::ge(src.a, cutoff));
+    if (not L::any(m)) {
+      continue;
+    }
+
+    const auto old_color = L::load_int(color + x);
+    if constexpr (blended) {
+      // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA for color, GL_ONE, GL_ONE_MINUS_SRC_ALPHA for alpha
+      const auto dst = unpack<L>(old_color);
+      const auto alpha = L::mul(src.a, inv_255);
+      const auto keep = L::sub(one, alpha);
+      src.r = L::madd(src.r, alpha, L::mul(dst.r, keep));
+      src.g = L::madd(src.g, alpha, L::mul(dst.g, keep));
+      src.b = L::madd(src.b, alpha, L::mul(dst.b, keep));
+      src.a = L::madd(dst.a, keep, src.a);
+    } else {
+      L::store(depth + x, L::select(m, quad_depth, old_depth));
+    }
+    L::store_int(color + x, L::select_int(m, pack<L>(src), old_color));
+  }
+}
+
+template <typename L, SoftFilter filter>
+auto shade_span(const SoftSpriteRenderer::Quad &quad, const SoftSpriteRenderer::Texture &texture, uint32_t *color,
+                float *depth, uint32_t x_begin, uint32_t x_end, uint32_t image_width, float window_y) -> void {
+  if (quad.blended) {
+    shade_span<L, filter, true>(quad, texture, color, depth, x_begin, x_end, image_width, window_y);
+  } else {
+    shade_span<L, filter, false>(quad, texture, color, depth, x_begin, x_end, image_width, window_y);
+  }
+}
+
+auto pack_color(glm::vec4 color) -> uint32_t {
+  const auto c = glm::round(glm::clamp(color, 0.f, 1.f) * 255.f);
+  return (uint32_t)c.r | (uint32_t)c.g << 8 | (uint32_t)c.b << 16 | (uint32_t)c.a << 24;
+}
+
+} // namespace
+
+SoftSpriteRenderer::~SoftSpriteRenderer() {
+  deinit();
+}
+
+auto SoftSpriteRenderer::init(uint32_t thread_count) -> void {
+  if (thread_count == 0) {
+    thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  quit = false;
+  for (auto i = uint32_t{1}; i < thread_count; ++i) {
+    workers.emplace_back([this] { work(); });
+  }
+}
+
+auto SoftSpriteRenderer::deinit() -> void {
+  {
+    auto lock = std::lock_guard{mutex};
+    quit = true;
+  }
+  wake.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+  textures.clear();
+  free_textures.clear();
+  quads.clear();
+  bins.clear();
+  if (SpriteBackend::active == this) {
+    SpriteBackend::active = nullptr;
+  }
+}
+
+auto SoftSpriteRenderer::create_texture(const uint8_t *rgba, uint32_t width, uint32_t height) -> uint32_t {
+  if ((uint64_t)width * height > (1u << 24)) {
+    std::cerr << std::format("Error: software textures hold at most 2^24 texels, got {}x{}\n", width, height);
+    return 0;
+  }
+  auto index = uint32_t{};
+  if (not free_textures.empty()) {
+    index = free_textures.back();
+    free_textures.pop_back();
+  } else {
+    index = (uint32_t)textures.size();
+    textures.emplace_back();
+  }
+  auto &texture = textures[index];
+  texture.width = width;
+  texture.height = height;
+  texture.texels.resize((size_t)width * height);
+  std::memcpy(texture.texels.data(), rgba, texture.texels.size() * sizeof(uint32_t));
+  return index;
+}
+
+auto SoftSpriteRenderer::delete_texture(uint32_t texture) -> void {
+  if (texture >= textures.size() or textures[texture].texels.empty()) {
+    return;
+  }
+  textures[texture] = {};
+  free_textures.push_back(texture);
+}
+
+auto SoftSpriteRenderer::begin_frame(uint32_t width, uint32_t height, const glm::mat4 &view_projection,
+                                     glm::vec4 clear_color) -> bool {
+  stats = {};
+  quads.clear();
+  if (width == 0 or height == 0) {
+    return false;
+  }
+  if (width != this->width or height != this->height) {
+    this->width = width;
+    this->height = height;
+    stride = (width + tile_size - 1) / tile_size * tile_size;
+    color.assign((size_t)stride * height, 0);
+    depth.assign((size_t)stride * height, 1.f);
+    tiles_x = stride / tile_size;
+    tiles_y = (height + tile_size - 1) / tile_size;
+    bins.resize((size_t)tiles_x * tiles_y);
+  }
+  this->view_projection = view_projection;
+  this->clear_color = clear_color;
+  return true;
+}
+
+auto SoftSpriteRenderer::draw(const SpriteInstance &instance, uint32_t texture, bool blended) -> void {
+  if (texture >= textures.size() or textures[texture].texels.empty()) {
+    return;
+  }
+  // the corner and both axes in gl window coordinates, the camera is orthographic so the quad stays a
+  // parallelogram
+  const auto to_window = [&](glm::vec2 world) {
+    const auto clip = view_projection * glm::vec4{world, 0.f, 1.f};
+    return (glm::vec2{clip} / clip.w * 0.5f + 0.5f) * glm::vec2{(float)width, (float)height};
+  };
+  const auto center = glm::vec2{instance.center};
+  const auto c = to_window(center);
+  const auto a = to_window(center + glm::vec2{instance.axes.x, instance.axes.y}) - c;
+  const auto b = to_window(center + glm::vec2{instance.axes.z, instance.axes.w}) - c;
+  const auto det = a.x * b.y - b.x * a.y;
+  if (std::abs(det) < 1e-12f) {
+    return;
+  }
+
+  const auto lo = glm::min(glm::min(c - a - b, c + a - b), glm::min(c - a + b, c + a + b));
+  const auto hi = glm::max(glm::max(c - a - b, c + a - b), glm::max(c - a + b, c + a + b));
+  const auto first_column = std::max((int)std::floor(lo.x), 0);
+  const auto last_column = std::min((int)std::ceil(hi.x), (int)width - 1);
+  const auto first_row = std::max((int)std::floor((float)height - hi.y), 0);
+  const auto last_row = std::min((int)std::ceil((float)height - lo.y), (int)height - 1);
+  if (first_column > last_column or first_row > last_row) {
+    return;
+  }
+
+  // inverse of the window = c + local.x * a + local.y * b mapping
+  auto &quad = quads.emplace_back();
+  quad.local_dx = glm::vec2{b.y, -a.y} / det;
+  quad.local_dy = glm::vec2{-b.x, a.x} / det;
+  quad.local_origin = -(quad.local_dx * c.x + quad.local_dy * c.y);
+  quad.uv_rect = instance.uv_rect;
+  quad.depth = instance.params.x;
+  quad.alpha_cutoff = instance.params.y;
+  quad.texture = texture;
+  quad.blended = blended;
+  quad.rows_columns = {first_row, last_row, first_column, last_column};
+  (blended ? stats.blended : stats.opaque) += 1;
+}
+
+auto SoftSpriteRenderer::end_frame() -> void {
+  if (color.empty()) {
+    return;
+  }
+  const auto start = Clock::now();
+
+  // bin in draw order, so each tile sees the opaque pass before the blended one
+  for (auto &bin : bins) {
+    bin.clear();
+  }
+  for (auto i = uint32_t{}; i < quads.size(); ++i) {
+    const auto &rc = quads[i].rows_columns;
+    for (auto ty = (uint32_t)rc.x / tile_size; ty <= (uint32_t)rc.y / tile_size; ++ty) {
+      for (auto tx = (uint32_t)rc.z / tile_size; tx <= (uint32_t)rc.w / tile_size; ++tx) {
+        bins[(size_t)ty * tiles_x + tx].push_back(i);
+        stats.binned += 1;
+      }
+    }
+  }
+
+  next_tile = 0;
+  {
+    auto lock = std::lock_guard{mutex};
+    busy = (uint32_t)workers.size();
+    generation += 1;
+  }
+  wake.notify_all();
+  run_tiles();
+  {
+    auto lock = std::unique_lock{mutex};
+    done.wait(lock, [this] { return busy == 0; });
+  }
+
+  stats.raster_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+  last_stats = stats;
+}
+
+auto SoftSpriteRenderer::read_pixels(std::vector<uint32_t> &out) const -> void {
+  out.resize((size_t)width * height);
+  for (auto row = uint32_t{}; row < height; ++row) {
+    std::memcpy(out.data() + (size_t)row * width, color.data() + (size_t)row * stride, width * sizeof(uint32_t));
+  }
+}
+
+auto SoftSpriteRenderer::work() -> void {
+  auto seen = uint64_t{};
+  while (true) {
+    {
+      auto lock = std::unique_lock{mutex};
+      wake.wait(lock, [&] { return quit or generation != seen; });
+      if (quit) {
+        return;
+      }
+      seen = generation;
+    }
+    run_tiles();
+    {
+      auto lock = std::lock_guard{mutex};
+      busy -= 1;
+      if (busy == 0) {
+        done.notify_one();
+      }
+    }
+  }
+}
+
+auto SoftSpriteRenderer::run_tiles() -> void {
+  const auto tile_count = tiles_x * tiles_y;
+  for (auto tile = next_tile.fetch_add(1); tile < tile_count; tile = next_tile.fetch_add(1)) {
+    render_tile(tile);
+  }
+}
+
+auto SoftSpriteRenderer::render_tile(uint32_t tile) -> void {
+  const auto x0 = tile % tiles_x * tile_size;
+  const auto y0 = tile / tiles_x * tile_size;
+  const auto y1 = std::min(y0 + tile_size, height);
+
+  // clear
+  const auto clear = pack_color(clear_color);
+  for (auto row = y0; row < y1; ++row) {
+    std::fill_n(color.data() + (size_t)row * stride + x0, tile_size, clear);
+    std::fill_n(depth.data() + (size_t)row * stride + x0, tile_size, 1.f);
+  }
+
+  constexpr auto lanes = SimdLanes::width;
+  for (auto index : bins[tile]) {
+    const auto &quad = quads[index];
+    const auto &texture = textures[quad.texture];
+    const auto first_row = std::max((uint32_t)quad.rows_columns.x, y0);
+    const auto last_row = std::min((uint32_t)quad.rows_columns.y, y1 - 1);
+    // whole spans inside the tile, tile_size is a multiple of every lane width
+    const auto x_begin = std::max((uint32_t)quad.rows_columns.z, x0) / lanes * lanes;
+    const auto x_end = ((std::min((uint32_t)quad.rows_columns.w, x0 + tile_size - 1) + lanes) / lanes) * lanes;
+    for (auto row = first_row; row <= last_row; ++row) {
+      const auto offset = (size_t)row * stride;
+      const auto window_y = (float)height - (float)row - 0.5f;
+      if (filter == SoftFilter::Nearest) {
+        shade_span<SimdLanes, SoftFilter::Nearest>(quad, texture, color.data() + offset, depth.data() + offset,
+                                                   x_begin, x_end, width, window_y);
+      } else {
+        shade_span<SimdLanes, SoftFilter::Bilinear>(quad, texture, color.data() + offset, depth.data() + offset,
+                                                    x_begin, x_end, width, window_y);
+      }
+    }
+  }
+}
+
+} // namespace graphics
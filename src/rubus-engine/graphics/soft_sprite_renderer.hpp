@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "sprite_backend.hpp"
+
+namespace graphics {
+
+enum struct SoftFilter : uint8_t {
+  Nearest, // the gl path (GL_NEAREST magnification)
+  Bilinear,
+};
+
+struct SoftSpriteStats {
+  uint32_t opaque = 0;
+  uint32_t blended = 0;
+  uint32_t binned = 0;    // quad and tile pairs
+  uint64_t raster_ns = 0; // setup, binning and the tile workers
+};
+
+// the sprite passes on the cpu, for thumbnails, golden images (tools/rubus-golden) and tests on machines without a
+// gpu. offscreen only, nothing presents the image, read it back with read_pixels. quads are binned into
+// screen tiles and the tiles are rasterized in parallel, each by one thread, so no two threads touch a pixel.
+// the spans of a tile are shaded 8 (avx2) or 4 (sse2) pixels at once, a scalar fallback covers other cpus.
+// follows the gl state of the sprite passes: depth less, alpha cutoff discard, non premultiplied alpha blending,
+// transparent black outside the texture. orthographic cameras only, uvs are interpolated affinely and sampled
+// from the base level, so minified sprites alias where gl would filter between mips.
+struct SoftSpriteRenderer final : SpriteBackend {
+  static constexpr uint32_t tile_size = 64;
+
+  struct Texture {
+    std::vector<uint32_t> texels; // rgba8, first row at the bottom
+    uint32_t width = 0;
+    uint32_t height = 0;
+  };
+
+  // a quad in window pixels: the local position (x, y in -1..1) of a pixel center is
+  // local = local_origin + local_dx * window_x + local_dy * window_y, window y going up as in gl
+  struct Quad {
+    glm::vec2 local_origin;
+    glm::vec2 local_dx;
+    glm::vec2 local_dy;
+    glm::vec4 uv_rect;
+    float depth = 0.f;
+    float alpha_cutoff = 0.f;
+    uint32_t texture = 0;
+    bool blended = false;
+    glm::ivec4 rows_columns; // first row, last row (top first), first column, last column, inclusive
+  };
+
+  SoftFilter filter = SoftFilter::Nearest;
+
+  std::vector<Texture> textures;
+  std::vector<uint32_t> free_textures;
+
+  // rows from the top, `stride` pixels apart so that every tile is a whole number of simd spans
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t stride = 0;
+  std::vector<uint32_t> color;
+  std::vector<float> depth;
+
+  SoftSpriteStats stats;
+  SoftSpriteStats last_stats;
+
+  ~SoftSpriteRenderer() override;
+
+  // 0 uses every hardware thread, the calling thread always works on tiles too
+  auto init(uint32_t thread_count = 0) -> void;
+  auto deinit() -> void;
+
+  auto create_texture(const uint8_t *rgba, uint32_t width, uint32_t height) -> uint32_t override;
+  auto delete_texture(uint32_t texture) -> void override;
+
+  auto begin_frame(uint32_t width, uint32_t height, const glm::mat4 &view_projection, glm::vec4 clear_color)
+    -> bool override;
+  auto draw(const SpriteInstance &instance, uint32_t texture, bool blended) -> void override;
+  auto end_frame() -> void override;
+
+  // rgba8 rows from the top, like VkSpriteRenderer::read_pixels
+  auto read_pixels(std::vector<uint32_t> &out) const -> void;
+
+private:
+  glm::mat4 view_projection = glm::mat4{1.f};
+  glm::vec4 clear_color = {1.f, 1.f, 1.f, 1.f};
+  std::vector<Quad> quads;
+  uint32_t tiles_x = 0;
+  uint32_t tiles_y = 0;
+  std::vector<std::vector<uint32_t>> bins; // quad indices per tile, in draw order
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  uint64_t generation = 0;
+  uint32_t busy = 0;
+  bool quit = false;
+  std::atomic<uint32_t> next_tile = 0;
+
+  auto work() -> void;
+  auto run_tiles() -> void;
+  auto render_tile(uint32_t tile) -> void;
+};
+
+} // namespace graphics
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "graphics.hpp"
+
+namespace graphics {
+
+// a renderer that takes the sprite passes away from the gl device (vulkan, software). the scene sorts as usual
+// and hands it instances, resources hand it their pixels instead of creating gl textures.
+struct SpriteBackend {
+  // scenes and resources go through this backend while set, see rugame::Scene::render_sprites_backend
+  inline static SpriteBackend *active = nullptr;
+
+  virtual ~SpriteBackend() = default;
+
+  // rgba8 with the first row at the bottom (as the gl path loads them), returns the texture index
+  virtual auto create_texture(const uint8_t *rgba, uint32_t width, uint32_t height) -> uint32_t = 0;
+  virtual auto delete_texture(uint32_t texture) -> void = 0;
+
+  // false when there is nothing to draw into this frame (minimized window)
+  virtual auto begin_frame(uint32_t width, uint32_t height, const glm::mat4 &view_projection,
+                           glm::vec4 clear_color) -> bool = 0;
+  // opaque sprites front to back, then blended sprites back to front. params.x is the gl ndc depth
+  virtual auto draw(const SpriteInstance &instance, uint32_t texture, bool blended) -> void = 0;
+  virtual auto end_frame() -> void = 0;
+};
+
+} // namespace graphics
@@ -0,0 +1,241 @@
+#include "state_cache.hpp"
+
+#include <glad/glad.h>
+
+#include "device.hpp"
+
+namespace graphics {
+
+auto StateCache::invalidate() -> void {
+  program = unknown;
+  vertex_array = unknown;
+  textures.fill(unknown);
+  buffers.fill(unknown);
+  draw_framebuffer = unknown;
+  blend = unknown;
+  blend_src_rgb = unknown;
+  blend_dst_rgb = unknown;
+  blend_src_alpha = unknown;
+  blend_dst_alpha = unknown;
+  depth_test = unknown;
+  depth_mask = unknown;
+  depth_func = unknown;
+  framebuffer_srgb = unknown;
+  viewport = {-1, -1, -1, -1};
+}
+
+auto StateCache::end_frame() -> void {
+  Device::current().end_frame();
+  last_stats = stats;
+  stats = {};
+}
+
+auto StateCache::use_program(uint32_t program) -> void {
+  if (StateCache::program == program) {
+    stats.skipped += 1;
+    return;
+  }
+  Device::current().use_program(program);
+  StateCache::program = program;
+  stats.calls += 1;
+}
+
+auto StateCache::bind_vertex_array(uint32_t vertex_array) -> void {
+  if (StateCache::vertex_array == vertex_array) {
+    stats.skipped += 1;
+    return;
+  }
+  Device::current().bind_vertex_array(vertex_array);
+  StateCache::vertex_array = vertex_array;
+  // the element array binding is part of the vertex array state
+  buffers[(size_t)BufferTarget::ElementArray] = unknown;
+  stats.calls += 1;
+}
+
+auto StateCache::bind_texture(uint32_t unit, uint32_t texture) -> void {
+  if (textures[unit] == texture) {
+    stats.skipped += 1;
+    return;
+  }
+  Device::current().bind_texture(unit, texture);
+  textures[unit] = texture;
+  stats.calls += 1;
+}
+
+auto StateCache::bind_buffer(uint32_t target, uint32_t buffer) -> void {
+  auto slot = buffer_slot(target);
+  if (slot == nullptr) {
+    Device::current().bind_buffer(target, buffer);
+    stats.calls += 1;
+    return;
+  }
+  if (*slot == buffer) {
+    stats.skipped += 1;
+    return;
+  }
+  Device::current().bind_buffer(target, buffer);
+  *slot = buffer;
+  stats.calls += 1;
+}
+
+auto StateCache::bind_draw_framebuffer(uint32_t framebuffer) -> void {
+  if (draw_framebuffer == framebuffer) {
+    stats.skipped += 1;
+    return;
+  }
+  Device::current().bind_framebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+  draw_framebuffer = framebuffer;
+  stats.calls += 1;
+}
+
+auto StateCache::set_blend(bool enabled) -> void {
+  if (blend == (uint32_t)enabled) {
+    stats.skipped += 1;
+    return;
+  }
+  if (enabled) {
+    Device::current().enable(GL_BLEND);
+  } else {
+    Device::current().disable(GL_BLEND);
+  }
+  blend = (uint32_t)enabled;
+  stats.calls += 1;
+}
+
+auto StateCache::set_blend_func(uint32_t src, uint32_t dst) -> void {
+  set_blend_func(src, dst, src, dst);
+}
+
+auto StateCache::set_blend_func(uint32_t src_rgb, uint32_t dst_rgb, uint32_t src_alpha, uint32_t dst_alpha)
+  -> void {
+  if (blend_src_rgb == src_rgb and blend_dst_rgb == dst_rgb and blend_src_alpha == src_alpha and
+      blend_dst_alpha == dst_alpha) {
+    stats.skipped += 1;
+    return;
+  }
+  Device::current().blend_func(src_rgb, dst_rgb, src_alpha, dst_alpha);
+  blend_src_rgb = src_rgb;
+  blend_dst_rgb = dst_rgb;
+  blend_src_alpha = src_alpha;
+  blend_dst_alpha = dst_alpha;
+  stats.calls += 1;
+}
+
+auto StateCache::set_depth_test(bool enabled) -> void {
+  if (depth_test == (uint32_t)enabled) {
+    stats.skipped += 1;
+    return;
+  }
+  if (enabled) {
+    Device::current().enable(GL_DEPTH_TEST);
+  } else {
+    Device::current().disable(GL_DEPTH_TEST);
+  }
+  depth_test = (uint32_t)enabled;
+  stats.calls += 1;
+}
+
+auto StateCache::set_depth_mask(bool enabled) -> void {
+  if (depth_mask == (uint32_t)enabled) {
+    stats.skipped += 1;
+    return;
+  }
+  Device::current().depth_mask(enabled);
+  depth_mask = (uint32_t)enabled;
+  stats.calls += 1;
+}
+
+auto StateCache::set_depth_func(uint32_t func) -> void {
+  if (depth_func == func) {
+    stats.skipped += 1;
+    return;
+  }
+  Device::current().depth_func(func);
+  depth_func = func;
+  stats.calls += 1;
+}
+
+auto StateCache::set_framebuffer_srgb(bool enabled) -> void {
+  if (framebuffer_srgb == (uint32_t)enabled) {
+    stats.skipped += 1;
+    return;
+  }
+  if (enabled) {
+    Device::current().enable(GL_FRAMEBUFFER_SRGB);
+  } else {
+    Device::current().disable(GL_FRAMEBUFFER_SRGB);
+  }
+  framebuffer_srgb = (uint32_t)enabled;
+  stats.calls += 1;
+}
+
+auto StateCache::set_viewport(int32_t x, int32_t y, int32_t width, int32_t height) -> void {
+  if (viewport.x == x and viewport.y == y and viewport.width == width and viewport.height == height) {
+    stats.skipped += 1;
+    return;
+  }
+  Device::current().viewport(x, y, width, height);
+  viewport = {x, y, width, height};
+  stats.calls += 1;
+}
+
+auto StateCache::forget_program(uint32_t program) -> void {
+  // a program in use is only flagged for deletion, but it can not be used again by name
+  if (StateCache::program == program) {
+    StateCache::program = unknown;
+  }
+}
+
+auto StateCache::forget_vertex_array(uint32_t vertex_array) -> void {
+  if (StateCache::vertex_array == vertex_array) {
+    StateCache::vertex_array = 0;
+    buffers[(size_t)BufferTarget::ElementArray] = unknown;
+  }
+}
+
+auto StateCache::forget_texture(uint32_t texture) -> void {
+  for (auto &bound : textures) {
+    if (bound == texture) {
+      bound = 0;
+    }
+  }
+}
+
+auto StateCache::forget_buffer(uint32_t buffer) -> void {
+  for (auto &bound : buffers) {
+    if (bound == buffer) {
+      bound = 0;
+    }
+  }
+}
+
+auto StateCache::forget_framebuffer(uint32_t framebuffer) -> void {
+  if (draw_framebuffer == framebuffer) {
+    draw_framebuffer = 0;
+  }
+}
+
+auto StateCache::buffer_slot(uint32_t target) -> uint32_t * {
+  switch (target) {
+  case GL_ARRAY_BUFFER:
+    return &buffers[(size_t)BufferTarget::Array];
+  case GL_ELEMENT_ARRAY_BUFFER:
+    return &buffers[(size_t)BufferTarget::ElementArray];
+  case GL_UNIFORM_BUFFER:
+    return &buffers[(size_t)BufferTarget::Uniform];
+  case GL_SHADER_STORAGE_BUFFER:
+    return &buffers[(size_t)BufferTarget::ShaderStorage];
+  case GL_DRAW_INDIRECT_BUFFER:
+    return &buffers[(size_t)BufferTarget::DrawIndirect];
+  case GL_PIXEL_UNPACK_BUFFER:
+    return &buffers[(size_t)BufferTarget::PixelUnpack];
+  case GL_COPY_READ_BUFFER:
+    return &buffers[(size_t)BufferTarget::CopyRead];
+  case GL_COPY_WRITE_BUFFER:
+    return &buffers[(size_t)BufferTarget::CopyWrite];
+  default:
+    return nullptr;
+  }
+}
+
+} // namespace graphics
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace graphics {
+
+struct StateCacheStats {
+  uint32_t calls = 0;   // gl calls issued
+  uint32_t skipped = 0; // redundant gl calls avoided
+};
+
+struct Viewport {
+  int32_t x = 0;
+  int32_t y = 0;
+  int32_t width = 0;
+  int32_t height = 0;
+};
+
+// shadows the gl state the engine touches and only issues device calls when something actually changes.
+// anything that changes gl state behind our back (skia, external code) must be followed by invalidate().
+struct StateCache {
+  enum struct BufferTarget : uint8_t {
+    Array,
+    ElementArray,
+    Uniform,
+    ShaderStorage,
+    DrawIndirect,
+    PixelUnpack,
+    CopyRead,
+    CopyWrite,
+    Count,
+  };
+
+  static constexpr uint32_t unknown = 0xFFFFFFFF;
+  static constexpr uint32_t max_texture_units = 16;
+
+  inline static uint32_t program = unknown;
+  inline static uint32_t vertex_array = unknown;
+  inline static std::array<uint32_t, max_texture_units> textures = {};
+  inline static std::array<uint32_t, (size_t)BufferTarget::Count> buffers = {};
+  inline static uint32_t draw_framebuffer = unknown;
+
+  inline static uint32_t blend = unknown; // 0: disabled, 1: enabled
+  inline static uint32_t blend_src_rgb = unknown;
+  inline static uint32_t blend_dst_rgb = unknown;
+  inline static uint32_t blend_src_alpha = unknown;
+  inline static uint32_t blend_dst_alpha = unknown;
+  inline static uint32_t depth_test = unknown;
+  inline static uint32_t depth_mask = unknown;
+  inline static uint32_t depth_func = unknown;
+  inline static uint32_t framebuffer_srgb = unknown;
+  inline static Viewport viewport = {-1, -1, -1, -1};
+
+  inline static StateCacheStats stats;      // current frame
+  inline static StateCacheStats last_stats; // last finished frame
+
+  static auto invalidate() -> void;
+  static auto end_frame() -> void;
+
+  static auto use_program(uint32_t program) -> void;
+  static auto bind_vertex_array(uint32_t vertex_array) -> void;
+  static auto bind_texture(uint32_t unit, uint32_t texture) -> void;
+  static auto bind_buffer(uint32_t target, uint32_t buffer) -> void;
+  static auto bind_draw_framebuffer(uint32_t framebuffer) -> void;
+
+  static auto set_blend(bool enabled) -> void;
+  static auto set_blend_func(uint32_t src, uint32_t dst) -> void;
+  static auto set_blend_func(uint32_t src_rgb, uint32_t dst_rgb, uint32_t src_alpha, uint32_t dst_alpha) -> void;
+  static auto set_depth_test(bool enabled) -> void;
+  static auto set_depth_mask(bool enabled) -> void; // glClear of the depth buffer also needs the mask on
+  static auto set_depth_func(uint32_t func) -> void;
+  static auto set_framebuffer_srgb(bool enabled) -> void;
+  static auto set_viewport(int32_t x, int32_t y, int32_t width, int32_t height) -> void;
+
+  // gl resets bindings of deleted objects, these keep the cache in sync
+  static auto forget_program(uint32_t program) -> void;
+  static auto forget_vertex_array(uint32_t vertex_array) -> void;
+  static auto forget_texture(uint32_t texture) -> void;
+  static auto forget_buffer(uint32_t buffer) -> void;
+  static auto forget_framebuffer(uint32_t framebuffer) -> void;
+
+private:
+  static auto buffer_slot(uint32_t target) -> uint32_t *;
+};
+
+} // namespace graphics
@@ -0,0 +1,88 @@
+#include "stream_buffer.hpp"
+
+#include <format>
+#include <iostream>
+
+#include "device.hpp"
+#include "state_cache.hpp"
+
+namespace graphics {
+
+auto StreamBuffer::init(size_t region_size) -> void {
+  this->region_size = region_size;
+  const auto total_size = region_size * region_count;
+
+  auto &device = Device::current();
+  buffer = device.create_buffer();
+  mapped = device.map_persistent(buffer, total_size);
+  if (mapped == nullptr) {
+    std::cerr << std::format("Error: failed to map stream buffer of {} bytes\n", total_size);
+  }
+
+  region = 0;
+  head = 0;
+  fences.fill(nullptr);
+}
+
+auto StreamBuffer::deinit() -> void {
+  for (auto &fence : fences) {
+    if (fence != nullptr) {
+      Device::current().delete_fence(fence);
+      fence = nullptr;
+    }
+  }
+  if (buffer != 0) {
+    Device::current().unmap_buffer(buffer);
+    StateCache::forget_buffer(buffer);
+    Device::current().delete_buffer(buffer);
+  }
+  buffer = 0;
+  mapped = nullptr;
+  region_size = 0;
+}
+
+auto StreamBuffer::begin_frame() -> void {
+  stats = {};
+  wait_fence(region);
+  head = 0;
+}
+
+auto StreamBuffer::allocate(size_t size, size_t alignment) -> Allocation {
+  const auto region_start = region * region_size;
+  const auto absolute_head = region_start + head;
+
+  // the alignment does not have to be a power of two, e.g. the stride of an instance
+  const auto aligned = (absolute_head + alignment - 1) / alignment * alignment;
+  if (mapped == nullptr or aligned + size > region_start + region_size) {
+    return {};
+  }
+
+  head = aligned + size - region_start;
+  stats.allocations += 1;
+  stats.bytes += size;
+  return {mapped + aligned, aligned, size};
+}
+
+auto StreamBuffer::end_frame() -> void {
+  fences[region] = Device::current().fence();
+  region = (region + 1) % region_count;
+}
+
+auto StreamBuffer::wait_fence(uint32_t region) -> void {
+  auto &fence = fences[region];
+  if (fence == nullptr) {
+    return;
+  }
+
+  auto &device = Device::current();
+  if (not device.wait_fence(fence, 0)) {
+    // the gpu is more than region_count frames behind
+    stats.fence_waits += 1;
+    while (not device.wait_fence(fence, 1'000'000)) {
+    }
+  }
+  device.delete_fence(fence);
+  fence = nullptr;
+}
+
+} // namespace graphics
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "device.hpp"
+
+namespace graphics {
+
+// a persistently and coherently mapped ring buffer split into one region per frame in flight.
+// every frame writes into its own region, a fence guards a region until the gpu has consumed it.
+struct StreamBuffer {
+  struct Allocation {
+    std::byte *ptr = nullptr;
+    size_t offset = 0; // offset from the start of the buffer
+    size_t size = 0;
+  };
+
+  struct Stats {
+    uint32_t allocations = 0;
+    size_t bytes = 0;
+    uint32_t fence_waits = 0;
+  };
+
+  static constexpr uint32_t region_count = 3;
+
+  uint32_t buffer = 0;
+  std::byte *mapped = nullptr;
+  size_t region_size = 0;
+
+  uint32_t region = 0;
+  size_t head = 0; // write head inside the current region
+  std::array<Fence, region_count> fences = {};
+
+  Stats stats;
+
+  auto init(size_t region_size) -> void;
+  auto deinit() -> void;
+
+  auto begin_frame() -> void;
+  auto allocate(size_t size, size_t alignment) -> Allocation;
+  auto end_frame() -> void;
+
+private:
+  auto wait_fence(uint32_t region) -> void;
+};
+
+} // namespace graphics
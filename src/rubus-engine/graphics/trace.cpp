@@ -0,0 +1,106 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+#include <glad/glad.h>
+
+namespace graphics {
+
+namespace {
+
+auto component_count(uint32_t format) -> size_t {
+  switch (format) {
+  case GL_RED:
+  case GL_RED_INTEGER:
+  case GL_DEPTH_COMPONENT:
+    return 1;
+  case GL_RG:
+  case GL_RG_INTEGER:
+    return 2;
+  case GL_RGB:
+  case GL_BGR:
+    return 3;
+  default:
+    return 4;
+  }
+}
+
+auto component_size(uint32_t type) -> size_t {
+  switch (type) {
+  case GL_UNSIGNED_BYTE:
+  case GL_BYTE:
+    return 1;
+  case GL_UNSIGNED_SHORT:
+  case GL_SHORT:
+  case GL_HALF_FLOAT:
+    return 2;
+  default:
+    return 4;
+  }
+}
+
+} // namespace
+
+auto TraceWriter::put_bytes(const void *bytes, size_t size) -> void {
+  put((uint64_t)size);
+  const auto offset = data.size();
+  // without a source the payload stays zero filled
+  data.resize(offset + size);
+  if (size != 0 and bytes != nullptr) {
+    std::memcpy(data.data() + offset, bytes, size);
+  }
+}
+
+auto TraceWriter::put_string(std::string_view string) -> void {
+  put_bytes(string.data(), string.size());
+}
+
+auto TraceWriter::save(const std::filesystem::path &path) const -> bool {
+  auto file = std::ofstream{path, std::ios::binary};
+  if (not file) {
+    std::cerr << std::format("Error: could not write trace {}\n", path.string());
+    return false;
+  }
+  file.write((const char *)data.data(), (std::streamsize)data.size());
+  return (bool)file;
+}
+
+auto TraceReader::get_bytes() -> std::span<const std::byte> {
+  const auto size = get<uint64_t>();
+  if (size > data.size() - offset) {
+    failed = true;
+    offset = data.size();
+    return {};
+  }
+  const auto bytes = data.subspan(offset, size);
+  offset += size;
+  return bytes;
+}
+
+auto TraceReader::get_string() -> std::string_view {
+  const auto bytes = get_bytes();
+  return {(const char *)bytes.data(), bytes.size()};
+}
+
+auto TraceReader::at_end() const -> bool {
+  return offset >= data.size();
+}
+
+auto pixel_data_size(uint32_t format, uint32_t type, int32_t width, int32_t height, int32_t alignment,
+                     int32_t row_length) -> size_t {
+  if (width <= 0 or height <= 0) {
+    return 0;
+  }
+  const auto pixel = type == GL_UNSIGNED_INT_8_8_8_8 or type == GL_UNSIGNED_INT_8_8_8_8_REV
+                       ? size_t{4}
+                       : component_count(format) * component_size(type);
+  const auto align = (size_t)std::max(alignment, 1);
+  const auto stride = ((size_t)(row_length > 0 ? row_length : width) * pixel + align - 1) / align * align;
+  // the last row is not padded
+  return stride * (size_t)(height - 1) + (size_t)width * pixel;
+}
+
+} // namespace graphics
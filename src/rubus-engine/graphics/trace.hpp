@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace graphics {
+
+// binary trace of device calls, written by graphics::CaptureDevice and read by rubus-replay.
+// a header followed by records, each a uint8_t DeviceCall (or trace_mapped_write) and its arguments in
+// declaration order. handles are the names of the capturing device, payloads are a uint64_t size and the bytes.
+constexpr auto trace_magic = uint32_t{0x52545242}; // "BRTR"
+constexpr auto trace_version = uint32_t{2};
+
+// bytes the engine wrote into a persistently mapped buffer: buffer, offset, payload
+constexpr auto trace_mapped_write = uint8_t{0xff};
+
+struct TraceWriter {
+  std::vector<std::byte> data;
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  auto put(const T &value) -> void {
+    const auto offset = data.size();
+    data.resize(offset + sizeof(T));
+    std::memcpy(data.data() + offset, &value, sizeof(T));
+  }
+
+  auto put_bytes(const void *bytes, size_t size) -> void;
+  auto put_string(std::string_view string) -> void;
+  auto save(const std::filesystem::path &path) const -> bool;
+};
+
+// reads past the end return zeros and set `failed`
+struct TraceReader {
+  std::span<const std::byte> data;
+  size_t offset = 0;
+  bool failed = false;
+
+  template <typename T>
+    requires std::is_trivially_copyable_v<T>
+  auto get() -> T {
+    auto value = T{};
+    if (offset + sizeof(T) > data.size()) {
+      failed = true;
+      offset = data.size();
+      return value;
+    }
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+  }
+
+  auto get_bytes() -> std::span<const std::byte>;
+  auto get_string() -> std::string_view;
+  auto at_end() const -> bool;
+};
+
+// size of a client side pixel rectangle with the given unpack alignment and row length (0 for width)
+auto pixel_data_size(uint32_t format, uint32_t type, int32_t width, int32_t height, int32_t alignment = 4,
+                     int32_t row_length = 0) -> size_t;
+
+} // namespace graphics
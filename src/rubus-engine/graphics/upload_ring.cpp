@@ -0,0 +1,83 @@
+#include "upload_ring.hpp"
+
+#include <cstring>
+
+#include <glad/glad.h>
+
+#include "device.hpp"
+#include "state_cache.hpp"
+#include "trace.hpp"
+
+namespace graphics {
+
+namespace {
+
+// keeps every staged copy aligned for any texel and block size
+constexpr auto staging_alignment = size_t{16};
+
+} // namespace
+
+auto UploadRing::init(size_t region_size) -> void {
+  if (staging.buffer != 0) {
+    return;
+  }
+  staging.init(region_size);
+}
+
+auto UploadRing::deinit() -> void {
+  if (active == this) {
+    active = nullptr;
+  }
+  staging.deinit();
+}
+
+auto UploadRing::begin_frame() -> void {
+  staging.begin_frame();
+  active = this;
+}
+
+auto UploadRing::end_frame() -> void {
+  last_stats = staging.stats;
+  staging.end_frame();
+  active = nullptr;
+}
+
+auto UploadRing::stage(const void *data, size_t size) -> std::optional<size_t> {
+  const auto alloc = staging.allocate(size, staging_alignment);
+  if (alloc.ptr == nullptr) {
+    return std::nullopt;
+  }
+  std::memcpy(alloc.ptr, data, size);
+  return alloc.offset;
+}
+
+auto upload_texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width, int32_t height,
+                              uint32_t format, uint32_t type, const void *pixels) -> void {
+  auto &device = Device::current();
+  if (auto ring = UploadRing::active; ring != nullptr) {
+    const auto size = pixel_data_size(format, type, width, height, 1);
+    if (auto offset = ring->stage(pixels, size); offset.has_value()) {
+      StateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, ring->staging.buffer);
+      device.texture_sub_image(texture, level, x, y, width, height, format, type, (const void *)*offset);
+      StateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      return;
+    }
+  }
+  device.texture_sub_image(texture, level, x, y, width, height, format, type, pixels);
+}
+
+auto upload_compressed_texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width,
+                                         int32_t height, uint32_t format, size_t size, const void *data) -> void {
+  auto &device = Device::current();
+  if (auto ring = UploadRing::active; ring != nullptr) {
+    if (auto offset = ring->stage(data, size); offset.has_value()) {
+      StateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, ring->staging.buffer);
+      device.compressed_texture_sub_image(texture, level, x, y, width, height, format, size, (const void *)*offset);
+      StateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      return;
+    }
+  }
+  device.compressed_texture_sub_image(texture, level, x, y, width, height, format, size, data);
+}
+
+} // namespace graphics
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "stream_buffer.hpp"
+
+namespace graphics {
+
+// texel uploads staged in a ring of pixel buffer objects. while a ring is active, upload_texture_sub_image copies
+// the texels into the region of this frame and gl reads them from the unpack buffer, so the copy into the texture
+// runs asynchronously instead of stalling on client memory. without an active ring (or when the region is full)
+// the texels are uploaded from client memory as before
+struct UploadRing {
+  inline static UploadRing *active = nullptr;
+
+  StreamBuffer staging;
+  StreamBuffer::Stats last_stats;
+
+  auto init(size_t region_size) -> void;
+  auto deinit() -> void;
+
+  // makes the ring active until end_frame
+  auto begin_frame() -> void;
+  auto end_frame() -> void;
+
+  // offset of the copy inside the unpack buffer
+  auto stage(const void *data, size_t size) -> std::optional<size_t>;
+};
+
+// rows are tightly packed (GL_UNPACK_ALIGNMENT 1), like every texel upload of the engine
+auto upload_texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width, int32_t height,
+                              uint32_t format, uint32_t type, const void *pixels) -> void;
+auto upload_compressed_texture_sub_image(uint32_t texture, int32_t level, int32_t x, int32_t y, int32_t width,
+                                         int32_t height, uint32_t format, size_t size, const void *data) -> void;
+
+} // namespace graphics
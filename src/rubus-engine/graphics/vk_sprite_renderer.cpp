@@ -0,0 +1,1157 @@
+// the win32 surface functions are only declared with the platform define
+#if defined(_WIN32)
+#define VK_USE_PLATFORM_WIN32_KHR
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#include "vk_sprite_renderer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <iostream>
+
+#include "embedded.hpp"
+
+namespace graphics {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto depth_format = VK_FORMAT_D32_SFLOAT;
+
+auto check(VkResult result, const char *what) -> bool {
+  if (result != VK_SUCCESS) {
+    std::cerr << std::format("Error: {} failed ({})\n", what, (int)result);
+    return false;
+  }
+  return true;
+}
+
+auto elapsed_ns(Clock::time_point start) -> uint64_t {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+auto find_vulkan_shader(std::string_view path) -> std::vector<uint32_t> {
+  for (const auto &file : embedded_vulkan_shaders()) {
+    if (file.path == path) {
+      // spir-v is a stream of words, the embedded bytes have no alignment guarantee
+      auto words = std::vector<uint32_t>(file.data.size() / sizeof(uint32_t));
+      std::memcpy(words.data(), file.data.data(), words.size() * sizeof(uint32_t));
+      return words;
+    }
+  }
+  std::cerr << std::format("Error: vulkan shader \"{}\" is not embedded\n", path);
+  return {};
+}
+
+auto image_barrier(VkCommandBuffer cmd, VkImage image, VkImageLayout from, VkImageLayout to,
+                   VkAccessFlags src_access, VkAccessFlags dst_access, VkPipelineStageFlags src_stage,
+                   VkPipelineStageFlags dst_stage, uint32_t first_level, uint32_t level_count) -> void {
+  const auto barrier = VkImageMemoryBarrier{
+    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask = src_access,
+    .dstAccessMask = dst_access,
+    .oldLayout = from,
+    .newLayout = to,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image = image,
+    .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, first_level, level_count, 0, 1},
+  };
+  vkCmdPipelineBarrier(cmd, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+} // namespace
+
+auto VkSpriteRenderer::init(void *window, uint32_t width, uint32_t height) -> bool {
+  // instance
+  auto extensions = std::vector<const char *>{};
+  if (window != nullptr) {
+    extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+#if defined(_WIN32)
+    extensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+#endif
+  }
+  const auto app_info = VkApplicationInfo{
+    .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+    .pApplicationName = "rubus",
+    .pEngineName = "rubus-engine",
+    .apiVersion = VK_API_VERSION_1_2,
+  };
+  const auto instance_info = VkInstanceCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+    .pApplicationInfo = &app_info,
+    .enabledExtensionCount = (uint32_t)extensions.size(),
+    .ppEnabledExtensionNames = extensions.data(),
+  };
+  if (not check(vkCreateInstance(&instance_info, nullptr, &instance), "vkCreateInstance")) {
+    return false;
+  }
+
+  // surface
+  if (window != nullptr) {
+#if defined(_WIN32)
+    const auto surface_info = VkWin32SurfaceCreateInfoKHR{
+      .sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
+      .hinstance = ::GetModuleHandleW(nullptr),
+      .hwnd = (HWND)window,
+    };
+    if (not check(vkCreateWin32SurfaceKHR(instance, &surface_info, nullptr, &surface), "vkCreateWin32SurfaceKHR")) {
+      return false;
+    }
+#else
+    std::cerr << "Error: vulkan window surfaces are only supported on windows\n";
+    return false;
+#endif
+  }
+
+  extent = {width, height};
+  if (not create_device(surface != VK_NULL_HANDLE) or not create_targets() or not create_pipelines() or
+      not create_frames()) {
+    return false;
+  }
+  record_passes();
+  return true;
+}
+
+auto VkSpriteRenderer::deinit() -> void {
+  if (device != VK_NULL_HANDLE) {
+    vkDeviceWaitIdle(device);
+    for (auto &frame : frames) {
+      vkDestroyFence(device, frame.done, nullptr);
+      vkDestroySemaphore(device, frame.image_ready, nullptr);
+      vkDestroySemaphore(device, frame.render_done, nullptr);
+      destroy_buffer(frame.instances);
+      destroy_buffer(frame.commands);
+      destroy_buffer(frame.camera);
+      frame = {};
+    }
+    for (auto &texture : textures) {
+      vkDestroyImageView(device, texture.view, nullptr);
+      vkDestroyImage(device, texture.image, nullptr);
+      vkFreeMemory(device, texture.memory, nullptr);
+    }
+    textures.clear();
+    free_textures.clear();
+    destroy_buffer(quad);
+    destroy_targets();
+    vkDestroySwapchainKHR(device, swapchain, nullptr);
+    vkDestroyCommandPool(device, command_pool, nullptr);
+    for (auto &pipeline : pipelines) {
+      vkDestroyPipeline(device, pipeline, nullptr);
+      pipeline = VK_NULL_HANDLE;
+    }
+    vkDestroyPipelineLayout(device, pipeline_layout, nullptr);
+    vkDestroySampler(device, sampler, nullptr);
+    vkDestroyDescriptorPool(device, descriptor_pool, nullptr);
+    vkDestroyDescriptorSetLayout(device, texture_layout, nullptr);
+    vkDestroyDescriptorSetLayout(device, camera_layout, nullptr);
+    vkDestroyRenderPass(device, render_pass, nullptr);
+    vkDestroyDevice(device, nullptr);
+  }
+  if (surface != VK_NULL_HANDLE) {
+    vkDestroySurfaceKHR(instance, surface, nullptr);
+  }
+  if (instance != VK_NULL_HANDLE) {
+    vkDestroyInstance(instance, nullptr);
+  }
+  if (SpriteBackend::active == this) {
+    SpriteBackend::active = nullptr;
+  }
+  *this = {};
+}
+
+auto VkSpriteRenderer::create_device(bool present) -> bool {
+  auto count = uint32_t{};
+  vkEnumeratePhysicalDevices(instance, &count, nullptr);
+  auto candidates = std::vector<VkPhysicalDevice>(count);
+  vkEnumeratePhysicalDevices(instance, &count, candidates.data());
+
+  // a real gpu when there is one, lavapipe (a cpu device) otherwise
+  const auto rank = [](VkPhysicalDeviceType type) {
+    switch (type) {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+      return 0;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+      return 1;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+      return 2;
+    default:
+      return 3;
+    }
+  };
+  auto best_rank = 4;
+  for (auto candidate : candidates) {
+    auto properties = VkPhysicalDeviceProperties{};
+    vkGetPhysicalDeviceProperties(candidate, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2) {
+      continue;
+    }
+    auto indexing = VkPhysicalDeviceDescriptorIndexingFeatures{
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+    };
+    auto features = VkPhysicalDeviceFeatures2{
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+      .pNext = &indexing,
+    };
+    vkGetPhysicalDeviceFeatures2(candidate, &features);
+    // everything create_device enables, textures are written into the array while frames using it are in flight
+    if (not indexing.runtimeDescriptorArray or not indexing.descriptorBindingPartiallyBound or
+        not indexing.shaderSampledImageArrayNonUniformIndexing or
+        not indexing.descriptorBindingSampledImageUpdateAfterBind or
+        not indexing.descriptorBindingUpdateUnusedWhilePending) {
+      std::cerr << std::format("Error: vulkan device {} lacks a descriptor indexing feature, skipped\n",
+                               properties.deviceName);
+      continue;
+    }
+
+    auto family_count = uint32_t{};
+    vkGetPhysicalDeviceQueueFamilyProperties(candidate, &family_count, nullptr);
+    auto families = std::vector<VkQueueFamilyProperties>(family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(candidate, &family_count, families.data());
+    for (auto i = uint32_t{}; i < family_count; ++i) {
+      auto supports_present = VkBool32{VK_TRUE};
+      if (present) {
+        vkGetPhysicalDeviceSurfaceSupportKHR(candidate, i, surface, &supports_present);
+      }
+      if ((families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0 and supports_present and
+          rank(properties.deviceType) < best_rank) {
+        physical_device = candidate;
+        queue_family = i;
+        best_rank = rank(properties.deviceType);
+        break;
+      }
+    }
+  }
+  if (physical_device == VK_NULL_HANDLE) {
+    std::cerr << "Error: no vulkan 1.2 device with descriptor indexing (runtime arrays, partially bound and non "
+                 "uniformly indexed sampled images, updated after bind and while unused and pending)\n";
+    return false;
+  }
+
+  const auto priority = 1.f;
+  const auto queue_info = VkDeviceQueueCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+    .queueFamilyIndex = queue_family,
+    .queueCount = 1,
+    .pQueuePriorities = &priority,
+  };
+  auto indexing = VkPhysicalDeviceDescriptorIndexingFeatures{
+    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+    .shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+    .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+    .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+    .descriptorBindingPartiallyBound = VK_TRUE,
+    .runtimeDescriptorArray = VK_TRUE,
+  };
+  const auto device_extensions = std::array{VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+  const auto device_info = VkDeviceCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+    .pNext = &indexing,
+    .queueCreateInfoCount = 1,
+    .pQueueCreateInfos = &queue_info,
+    .enabledExtensionCount = present ? (uint32_t)device_extensions.size() : 0,
+    .ppEnabledExtensionNames = device_extensions.data(),
+  };
+  if (not check(vkCreateDevice(physical_device, &device_info, nullptr, &device), "vkCreateDevice")) {
+    return false;
+  }
+  vkGetDeviceQueue(device, queue_family, 0, &queue);
+
+  const auto pool_info = VkCommandPoolCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+    .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+    .queueFamilyIndex = queue_family,
+  };
+  if (not check(vkCreateCommandPool(device, &pool_info, nullptr, &command_pool), "vkCreateCommandPool")) {
+    return false;
+  }
+
+  // the color format decides the render pass, pick it before the targets exist
+  if (present) {
+    auto format_count = uint32_t{};
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, nullptr);
+    auto formats = std::vector<VkSurfaceFormatKHR>(format_count);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &format_count, formats.data());
+    color_format = formats.empty() ? VK_FORMAT_B8G8R8A8_UNORM : formats.front().format;
+    for (const auto &format : formats) {
+      // the gl path renders without srgb conversion
+      if (format.format == VK_FORMAT_B8G8R8A8_UNORM or format.format == VK_FORMAT_R8G8B8A8_UNORM) {
+        color_format = format.format;
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+auto VkSpriteRenderer::create_targets() -> bool {
+  if (render_pass == VK_NULL_HANDLE) {
+    const auto attachments = std::array{
+      VkAttachmentDescription{
+        .format = color_format,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+        .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+        .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .finalLayout = surface != VK_NULL_HANDLE ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+                                                 : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      },
+      VkAttachmentDescription{
+        .format = depth_format,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+        .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+        .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+      },
+    };
+    const auto color_ref = VkAttachmentReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    const auto depth_ref = VkAttachmentReference{1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+    const auto subpass = VkSubpassDescription{
+      .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+      .colorAttachmentCount = 1,
+      .pColorAttachments = &color_ref,
+      .pDepthStencilAttachment = &depth_ref,
+    };
+    // the previous frame still writes the shared depth image and, offscreen, the same color image
+    const auto dependency = VkSubpassDependency{
+      .srcSubpass = VK_SUBPASS_EXTERNAL,
+      .dstSubpass = 0,
+      .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT |
+                      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+      .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                       VK_ACCESS_TRANSFER_READ_BIT,
+      .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                       VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+    };
+    const auto render_pass_info = VkRenderPassCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+      .attachmentCount = (uint32_t)attachments.size(),
+      .pAttachments = attachments.data(),
+      .subpassCount = 1,
+      .pSubpasses = &subpass,
+      .dependencyCount = 1,
+      .pDependencies = &dependency,
+    };
+    if (not check(vkCreateRenderPass(device, &render_pass_info, nullptr, &render_pass), "vkCreateRenderPass")) {
+      return false;
+    }
+  }
+
+  auto images = std::vector<VkImage>{};
+  if (surface != VK_NULL_HANDLE) {
+    auto capabilities = VkSurfaceCapabilitiesKHR{};
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device, surface, &capabilities);
+    if (capabilities.currentExtent.width != UINT32_MAX) {
+      extent = capabilities.currentExtent;
+    }
+    if (extent.width == 0 or extent.height == 0) {
+      return true;
+    }
+    auto image_count = std::max(capabilities.minImageCount + 1, frames_in_flight);
+    if (capabilities.maxImageCount > 0) {
+      image_count = std::min(image_count, capabilities.maxImageCount);
+    }
+    const auto old_swapchain = swapchain;
+    const auto swapchain_info = VkSwapchainCreateInfoKHR{
+      .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+      .surface = surface,
+      .minImageCount = image_count,
+      .imageFormat = color_format,
+      .imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
+      .imageExtent = extent,
+      .imageArrayLayers = 1,
+      .imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+      .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .preTransform = capabilities.currentTransform,
+      .compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+      .presentMode = VK_PRESENT_MODE_FIFO_KHR,
+      .clipped = VK_TRUE,
+      .oldSwapchain = old_swapchain,
+    };
+    if (not check(vkCreateSwapchainKHR(device, &swapchain_info, nullptr, &swapchain), "vkCreateSwapchainKHR")) {
+      return false;
+    }
+    if (old_swapchain != VK_NULL_HANDLE) {
+      vkDestroySwapchainKHR(device, old_swapchain, nullptr);
+    }
+    vkGetSwapchainImagesKHR(device, swapchain, &image_count, nullptr);
+    images.resize(image_count);
+    vkGetSwapchainImagesKHR(device, swapchain, &image_count, images.data());
+  } else {
+    if (extent.width == 0 or extent.height == 0) {
+      return true;
+    }
+    offscreen = create_image(extent.width, extent.height, 1, color_format,
+                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, offscreen_memory);
+    images.push_back(offscreen);
+  }
+
+  depth = create_image(extent.width, extent.height, 1, depth_format, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                       depth_memory);
+  depth_view = create_view(depth, depth_format, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
+  for (auto image : images) {
+    auto &target = targets.emplace_back();
+    target.image = image;
+    target.view = create_view(image, color_format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+    const auto views = std::array{target.view, depth_view};
+    const auto framebuffer_info = VkFramebufferCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+      .renderPass = render_pass,
+      .attachmentCount = (uint32_t)views.size(),
+      .pAttachments = views.data(),
+      .width = extent.width,
+      .height = extent.height,
+      .layers = 1,
+    };
+    if (not check(vkCreateFramebuffer(device, &framebuffer_info, nullptr, &target.framebuffer),
+                  "vkCreateFramebuffer")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto VkSpriteRenderer::destroy_targets() -> void {
+  for (auto &target : targets) {
+    vkDestroyFramebuffer(device, target.framebuffer, nullptr);
+    vkDestroyImageView(device, target.view, nullptr);
+  }
+  targets.clear();
+  vkDestroyImageView(device, depth_view, nullptr);
+  vkDestroyImage(device, depth, nullptr);
+  vkFreeMemory(device, depth_memory, nullptr);
+  vkDestroyImage(device, offscreen, nullptr);
+  vkFreeMemory(device, offscreen_memory, nullptr);
+  depth_view = VK_NULL_HANDLE;
+  depth = VK_NULL_HANDLE;
+  depth_memory = VK_NULL_HANDLE;
+  offscreen = VK_NULL_HANDLE;
+  offscreen_memory = VK_NULL_HANDLE;
+}
+
+auto VkSpriteRenderer::create_pipelines() -> bool {
+  // set 0: every texture, written when a texture is created, even while frames using the set are in flight
+  const auto texture_binding = VkDescriptorSetLayoutBinding{
+    .binding = 0,
+    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+    .descriptorCount = max_textures,
+    .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+  };
+  const auto binding_flags = VkDescriptorBindingFlags{VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                                      VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                                      VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT};
+  const auto flags_info = VkDescriptorSetLayoutBindingFlagsCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+    .bindingCount = 1,
+    .pBindingFlags = &binding_flags,
+  };
+  const auto texture_layout_info = VkDescriptorSetLayoutCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+    .pNext = &flags_info,
+    .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+    .bindingCount = 1,
+    .pBindings = &texture_binding,
+  };
+  // set 1: the camera of a frame slot
+  const auto camera_binding = VkDescriptorSetLayoutBinding{
+    .binding = 0,
+    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+    .descriptorCount = 1,
+    .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+  };
+  const auto camera_layout_info = VkDescriptorSetLayoutCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+    .bindingCount = 1,
+    .pBindings = &camera_binding,
+  };
+  if (not check(vkCreateDescriptorSetLayout(device, &texture_layout_info, nullptr, &texture_layout),
+                "vkCreateDescriptorSetLayout") or
+      not check(vkCreateDescriptorSetLayout(device, &camera_layout_info, nullptr, &camera_layout),
+                "vkCreateDescriptorSetLayout")) {
+    return false;
+  }
+
+  const auto pool_sizes = std::array{
+    VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, max_textures},
+    VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, frames_in_flight},
+  };
+  const auto pool_info = VkDescriptorPoolCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+    .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+    .maxSets = 1 + frames_in_flight,
+    .poolSizeCount = (uint32_t)pool_sizes.size(),
+    .pPoolSizes = pool_sizes.data(),
+  };
+  if (not check(vkCreateDescriptorPool(device, &pool_info, nullptr, &descriptor_pool), "vkCreateDescriptorPool")) {
+    return false;
+  }
+  const auto texture_set_info = VkDescriptorSetAllocateInfo{
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+    .descriptorPool = descriptor_pool,
+    .descriptorSetCount = 1,
+    .pSetLayouts = &texture_layout,
+  };
+  if (not check(vkAllocateDescriptorSets(device, &texture_set_info, &texture_set), "vkAllocateDescriptorSets")) {
+    return false;
+  }
+
+  // same filtering as the gl textures: nearest texels, blended mips, transparent outside
+  const auto sampler_info = VkSamplerCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+    .magFilter = VK_FILTER_NEAREST,
+    .minFilter = VK_FILTER_NEAREST,
+    .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+    .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+    .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+    .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+    .maxLod = VK_LOD_CLAMP_NONE,
+    .borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK,
+  };
+  if (not check(vkCreateSampler(device, &sampler_info, nullptr, &sampler), "vkCreateSampler")) {
+    return false;
+  }
+
+  const auto set_layouts = std::array{texture_layout, camera_layout};
+  const auto layout_info = VkPipelineLayoutCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+    .setLayoutCount = (uint32_t)set_layouts.size(),
+    .pSetLayouts = set_layouts.data(),
+  };
+  if (not check(vkCreatePipelineLayout(device, &layout_info, nullptr, &pipeline_layout), "vkCreatePipelineLayout")) {
+    return false;
+  }
+
+  const auto vert_code = find_vulkan_shader("shaders/sprite/vk_vert.spv");
+  const auto frag_code = find_vulkan_shader("shaders/sprite/vk_frag.spv");
+  if (vert_code.empty() or frag_code.empty()) {
+    return false;
+  }
+  auto modules = std::array<VkShaderModule, 2>{};
+  for (auto i = size_t{}; i < modules.size(); ++i) {
+    const auto &code = i == 0 ? vert_code : frag_code;
+    const auto module_info = VkShaderModuleCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+      .codeSize = code.size() * sizeof(uint32_t),
+      .pCode = code.data(),
+    };
+    if (not check(vkCreateShaderModule(device, &module_info, nullptr, &modules[i]), "vkCreateShaderModule")) {
+      return false;
+    }
+  }
+  const auto stages = std::array{
+    VkPipelineShaderStageCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .stage = VK_SHADER_STAGE_VERTEX_BIT,
+      .module = modules[0],
+      .pName = "main",
+    },
+    VkPipelineShaderStageCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+      .module = modules[1],
+      .pName = "main",
+    },
+  };
+
+  // binding 0 is the unit quad, binding 1 the instances, same locations as the gl vertex array
+  const auto bindings = std::array{
+    VkVertexInputBindingDescription{0, sizeof(SpriteVertex), VK_VERTEX_INPUT_RATE_VERTEX},
+    VkVertexInputBindingDescription{1, sizeof(SpriteInstance), VK_VERTEX_INPUT_RATE_INSTANCE},
+  };
+  const auto attributes = std::array{
+    VkVertexInputAttributeDescription{0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(SpriteVertex, position)},
+    VkVertexInputAttributeDescription{1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(SpriteVertex, uv)},
+    VkVertexInputAttributeDescription{2, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteInstance, axes)},
+    VkVertexInputAttributeDescription{3, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteInstance, center)},
+    VkVertexInputAttributeDescription{4, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteInstance, uv_rect)},
+    VkVertexInputAttributeDescription{5, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(SpriteInstance, params)},
+  };
+  const auto vertex_input = VkPipelineVertexInputStateCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+    .vertexBindingDescriptionCount = (uint32_t)bindings.size(),
+    .pVertexBindingDescriptions = bindings.data(),
+    .vertexAttributeDescriptionCount = (uint32_t)attributes.size(),
+    .pVertexAttributeDescriptions = attributes.data(),
+  };
+  const auto input_assembly = VkPipelineInputAssemblyStateCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+    .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+  };
+  const auto viewport_state = VkPipelineViewportStateCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+    .viewportCount = 1,
+    .scissorCount = 1,
+  };
+  const auto rasterization = VkPipelineRasterizationStateCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+    .polygonMode = VK_POLYGON_MODE_FILL,
+    .cullMode = VK_CULL_MODE_NONE,
+    .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+    .lineWidth = 1.f,
+  };
+  const auto multisample = VkPipelineMultisampleStateCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+    .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+  };
+  const auto dynamic_states = std::array{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+  const auto dynamic_state = VkPipelineDynamicStateCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+    .dynamicStateCount = (uint32_t)dynamic_states.size(),
+    .pDynamicStates = dynamic_states.data(),
+  };
+
+  auto result = true;
+  for (auto blended : {false, true}) {
+    // opaque writes depth and discards below the alpha cutoff, blended tests against it (BlendMode::Alpha)
+    const auto depth_stencil = VkPipelineDepthStencilStateCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+      .depthTestEnable = VK_TRUE,
+      .depthWriteEnable = blended ? VK_FALSE : VK_TRUE,
+      .depthCompareOp = VK_COMPARE_OP_LESS,
+    };
+    const auto blend_attachment = VkPipelineColorBlendAttachmentState{
+      .blendEnable = blended ? VK_TRUE : VK_FALSE,
+      .srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+      .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+      .colorBlendOp = VK_BLEND_OP_ADD,
+      .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+      .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+      .alphaBlendOp = VK_BLEND_OP_ADD,
+      .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+                        VK_COLOR_COMPONENT_A_BIT,
+    };
+    const auto color_blend = VkPipelineColorBlendStateCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+      .attachmentCount = 1,
+      .pAttachments = &blend_attachment,
+    };
+    const auto pipeline_info = VkGraphicsPipelineCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+      .stageCount = (uint32_t)stages.size(),
+      .pStages = stages.data(),
+      .pVertexInputState = &vertex_input,
+      .pInputAssemblyState = &input_assembly,
+      .pViewportState = &viewport_state,
+      .pRasterizationState = &rasterization,
+      .pMultisampleState = &multisample,
+      .pDepthStencilState = &depth_stencil,
+      .pColorBlendState = &color_blend,
+      .pDynamicState = &dynamic_state,
+      .layout = pipeline_layout,
+      .renderPass = render_pass,
+      .subpass = 0,
+    };
+    result = result and check(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipeline_info, nullptr,
+                                                        &pipelines[blended ? 1 : 0]),
+                              "vkCreateGraphicsPipelines");
+  }
+  for (auto module : modules) {
+    vkDestroyShaderModule(device, module, nullptr);
+  }
+  return result;
+}
+
+auto VkSpriteRenderer::create_frames() -> bool {
+  // the full quad, same as graphics::make_quad_mesh, then its indices
+  const auto vertices = std::array{
+    SpriteVertex{{+1.f, +1.f, 0.f}, {1.f, 1.f}},
+    SpriteVertex{{-1.f, +1.f, 0.f}, {0.f, 1.f}},
+    SpriteVertex{{-1.f, -1.f, 0.f}, {0.f, 0.f}},
+    SpriteVertex{{+1.f, -1.f, 0.f}, {1.f, 0.f}},
+  };
+  const auto indices = std::array<uint16_t, 6>{0, 1, 3, 1, 2, 3};
+  quad = create_buffer(sizeof(vertices) + sizeof(indices),
+                       VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+  if (quad.mapped == nullptr) {
+    return false;
+  }
+  std::memcpy(quad.mapped, vertices.data(), sizeof(vertices));
+  std::memcpy(quad.mapped + sizeof(vertices), indices.data(), sizeof(indices));
+
+  for (auto &frame : frames) {
+    auto buffers = std::array<VkCommandBuffer, 3>{};
+    auto buffer_info = VkCommandBufferAllocateInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+      .commandPool = command_pool,
+      .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+      .commandBufferCount = 1,
+    };
+    if (not check(vkAllocateCommandBuffers(device, &buffer_info, &buffers[0]), "vkAllocateCommandBuffers")) {
+      return false;
+    }
+    buffer_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    buffer_info.commandBufferCount = 2;
+    if (not check(vkAllocateCommandBuffers(device, &buffer_info, &buffers[1]), "vkAllocateCommandBuffers")) {
+      return false;
+    }
+    frame.primary = buffers[0];
+    frame.passes = {buffers[1], buffers[2]};
+
+    const auto fence_info = VkFenceCreateInfo{
+      .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+      .flags = VK_FENCE_CREATE_SIGNALED_BIT,
+    };
+    const auto semaphore_info = VkSemaphoreCreateInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    if (not check(vkCreateFence(device, &fence_info, nullptr, &frame.done), "vkCreateFence") or
+        not check(vkCreateSemaphore(device, &semaphore_info, nullptr, &frame.image_ready), "vkCreateSemaphore") or
+        not check(vkCreateSemaphore(device, &semaphore_info, nullptr, &frame.render_done), "vkCreateSemaphore")) {
+      return false;
+    }
+
+    frame.instances = create_buffer(2 * max_sprites * sizeof(SpriteInstance), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    frame.commands = create_buffer(2 * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+    frame.camera = create_buffer(sizeof(glm::mat4), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    if (frame.instances.mapped == nullptr or frame.commands.mapped == nullptr or frame.camera.mapped == nullptr) {
+      return false;
+    }
+    std::memset(frame.commands.mapped, 0, 2 * sizeof(VkDrawIndexedIndirectCommand));
+
+    const auto set_info = VkDescriptorSetAllocateInfo{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      .descriptorPool = descriptor_pool,
+      .descriptorSetCount = 1,
+      .pSetLayouts = &camera_layout,
+    };
+    if (not check(vkAllocateDescriptorSets(device, &set_info, &frame.camera_set), "vkAllocateDescriptorSets")) {
+      return false;
+    }
+    const auto camera_info = VkDescriptorBufferInfo{frame.camera.buffer, 0, sizeof(glm::mat4)};
+    const auto write = VkWriteDescriptorSet{
+      .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+      .dstSet = frame.camera_set,
+      .dstBinding = 0,
+      .descriptorCount = 1,
+      .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+      .pBufferInfo = &camera_info,
+    };
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+  }
+  return true;
+}
+
+auto VkSpriteRenderer::record_passes() -> void {
+  // everything but the instance counts is known up front, the secondaries are only recorded again on resize
+  const auto inheritance = VkCommandBufferInheritanceInfo{
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+    .renderPass = render_pass,
+    .subpass = 0,
+  };
+  const auto begin_info = VkCommandBufferBeginInfo{
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
+    .pInheritanceInfo = &inheritance,
+  };
+  const auto viewport = VkViewport{0.f, 0.f, (float)extent.width, (float)extent.height, 0.f, 1.f};
+  const auto scissor = VkRect2D{{0, 0}, extent};
+  constexpr auto index_offset = VkDeviceSize{4 * sizeof(SpriteVertex)};
+
+  for (auto &frame : frames) {
+    for (auto pass = uint32_t{}; pass < 2; ++pass) {
+      auto cmd = frame.passes[pass];
+      vkResetCommandBuffer(cmd, 0);
+      vkBeginCommandBuffer(cmd, &begin_info);
+      vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[pass]);
+      vkCmdSetViewport(cmd, 0, 1, &viewport);
+      vkCmdSetScissor(cmd, 0, 1, &scissor);
+      const auto sets = std::array{texture_set, frame.camera_set};
+      vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, (uint32_t)sets.size(),
+                              sets.data(), 0, nullptr);
+      const auto vertex_buffers = std::array{quad.buffer, frame.instances.buffer};
+      const auto offsets = std::array<VkDeviceSize, 2>{0, 0};
+      vkCmdBindVertexBuffers(cmd, 0, 2, vertex_buffers.data(), offsets.data());
+      vkCmdBindIndexBuffer(cmd, quad.buffer, index_offset, VK_INDEX_TYPE_UINT16);
+      vkCmdDrawIndexedIndirect(cmd, frame.commands.buffer, pass * sizeof(VkDrawIndexedIndirectCommand), 1,
+                               sizeof(VkDrawIndexedIndirectCommand));
+      vkEndCommandBuffer(cmd);
+    }
+  }
+}
+
+auto VkSpriteRenderer::create_texture(const uint8_t *rgba, uint32_t width, uint32_t height) -> uint32_t {
+  auto index = uint32_t{};
+  if (not free_textures.empty()) {
+    index = free_textures.back();
+    free_textures.pop_back();
+  } else if (textures.size() < max_textures) {
+    index = (uint32_t)textures.size();
+    textures.emplace_back();
+  } else {
+    std::cerr << std::format("Error: more than {} vulkan textures\n", max_textures);
+    return 0;
+  }
+
+  const auto levels = (uint32_t)std::bit_width(std::max(width, height));
+  auto &texture = textures[index];
+  texture.image = create_image(width, height, levels, VK_FORMAT_R8G8B8A8_UNORM,
+                               VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                                 VK_IMAGE_USAGE_SAMPLED_BIT,
+                               texture.memory);
+  texture.view = create_view(texture.image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, levels);
+
+  const auto size = (VkDeviceSize)width * height * 4;
+  auto staging = create_buffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+  std::memcpy(staging.mapped, rgba, size);
+  run_once([&](VkCommandBuffer cmd) {
+    image_barrier(cmd, texture.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0,
+                  VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                  levels);
+    const auto copy = VkBufferImageCopy{
+      .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      .imageExtent = {width, height, 1},
+    };
+    vkCmdCopyBufferToImage(cmd, staging.buffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+    // mip chain, every level is blitted from the one above it
+    auto level_width = (int32_t)width;
+    auto level_height = (int32_t)height;
+    for (auto level = uint32_t{1}; level < levels; ++level) {
+      image_barrier(cmd, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, level - 1, 1);
+      const auto next_width = std::max(level_width / 2, 1);
+      const auto next_height = std::max(level_height / 2, 1);
+      const auto blit = VkImageBlit{
+        .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1},
+        .srcOffsets = {{0, 0, 0}, {level_width, level_height, 1}},
+        .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1},
+        .dstOffsets = {{0, 0, 0}, {next_width, next_height, 1}},
+      };
+      vkCmdBlitImage(cmd, texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, texture.image,
+                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+      level_width = next_width;
+      level_height = next_height;
+    }
+    if (levels > 1) {
+      image_barrier(cmd, texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, levels - 1);
+    }
+    image_barrier(cmd, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                  VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, levels - 1, 1);
+  });
+  destroy_buffer(staging);
+
+  const auto image_info = VkDescriptorImageInfo{sampler, texture.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+  const auto write = VkWriteDescriptorSet{
+    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+    .dstSet = texture_set,
+    .dstBinding = 0,
+    .dstArrayElement = index,
+    .descriptorCount = 1,
+    .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+    .pImageInfo = &image_info,
+  };
+  vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+  return index;
+}
+
+auto VkSpriteRenderer::delete_texture(uint32_t texture) -> void {
+  if (texture >= textures.size() or textures[texture].image == VK_NULL_HANDLE) {
+    return;
+  }
+  // frames in flight may still sample it, textures are rarely deleted
+  vkDeviceWaitIdle(device);
+  auto &entry = textures[texture];
+  vkDestroyImageView(device, entry.view, nullptr);
+  vkDestroyImage(device, entry.image, nullptr);
+  vkFreeMemory(device, entry.memory, nullptr);
+  entry = {};
+  free_textures.push_back(texture);
+}
+
+auto VkSpriteRenderer::begin_frame(uint32_t width, uint32_t height, const glm::mat4 &view_projection,
+                                   glm::vec4 clear_color) -> bool {
+  const auto start = Clock::now();
+  stats = {};
+  auto &frame = frames[frame_index];
+  vkWaitForFences(device, 1, &frame.done, VK_TRUE, UINT64_MAX);
+
+  if (width != extent.width or height != extent.height or targets.empty()) {
+    vkDeviceWaitIdle(device);
+    destroy_targets();
+    extent = {width, height};
+    if (not create_targets() or targets.empty()) {
+      return false;
+    }
+    record_passes();
+  }
+
+  if (swapchain != VK_NULL_HANDLE) {
+    const auto result =
+      vkAcquireNextImageKHR(device, swapchain, UINT64_MAX, frame.image_ready, VK_NULL_HANDLE, &target_index);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+      // recreated by the next frame
+      vkDeviceWaitIdle(device);
+      destroy_targets();
+      return false;
+    }
+    if (result != VK_SUCCESS and result != VK_SUBOPTIMAL_KHR) {
+      check(result, "vkAcquireNextImageKHR");
+      return false;
+    }
+  } else {
+    target_index = 0;
+  }
+
+  std::memcpy(frame.camera.mapped, &view_projection, sizeof(glm::mat4));
+  this->clear_color = clear_color;
+  frame.opaque = 0;
+  frame.blended = 0;
+  in_frame = true;
+  stats.wait_ns = elapsed_ns(start);
+  return true;
+}
+
+auto VkSpriteRenderer::draw(const SpriteInstance &instance, uint32_t texture, bool blended) -> void {
+  auto &frame = frames[frame_index];
+  auto &count = blended ? frame.blended : frame.opaque;
+  if (not in_frame or count >= max_sprites) {
+    return;
+  }
+  // written straight into the mapped instances of this frame slot, the texture index rides in params.w
+  auto dst = (SpriteInstance *)frame.instances.mapped + (blended ? max_sprites : 0) + count;
+  *dst = instance;
+  dst->params.w = (float)texture;
+  count += 1;
+}
+
+auto VkSpriteRenderer::end_frame() -> void {
+  if (not in_frame) {
+    return;
+  }
+  in_frame = false;
+  const auto start = Clock::now();
+  auto &frame = frames[frame_index];
+
+  const auto commands = std::array{
+    VkDrawIndexedIndirectCommand{6, frame.opaque, 0, 0, 0},
+    VkDrawIndexedIndirectCommand{6, frame.blended, 0, 0, max_sprites},
+  };
+  std::memcpy(frame.commands.mapped, commands.data(), sizeof(commands));
+
+  auto cmd = frame.primary;
+  vkResetCommandBuffer(cmd, 0);
+  const auto begin_info = VkCommandBufferBeginInfo{
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  vkBeginCommandBuffer(cmd, &begin_info);
+  auto clear_values = std::array<VkClearValue, 2>{};
+  clear_values[0].color = {{clear_color.r, clear_color.g, clear_color.b, clear_color.a}};
+  clear_values[1].depthStencil = {1.f, 0};
+  const auto pass_info = VkRenderPassBeginInfo{
+    .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+    .renderPass = render_pass,
+    .framebuffer = targets[target_index].framebuffer,
+    .renderArea = {{0, 0}, extent},
+    .clearValueCount = (uint32_t)clear_values.size(),
+    .pClearValues = clear_values.data(),
+  };
+  vkCmdBeginRenderPass(cmd, &pass_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+  vkCmdExecuteCommands(cmd, (uint32_t)frame.passes.size(), frame.passes.data());
+  vkCmdEndRenderPass(cmd);
+  vkEndCommandBuffer(cmd);
+
+  const auto present = swapchain != VK_NULL_HANDLE;
+  const auto wait_stage = VkPipelineStageFlags{VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+  const auto submit_info = VkSubmitInfo{
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .waitSemaphoreCount = present ? 1u : 0u,
+    .pWaitSemaphores = &frame.image_ready,
+    .pWaitDstStageMask = &wait_stage,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &cmd,
+    .signalSemaphoreCount = present ? 1u : 0u,
+    .pSignalSemaphores = &frame.render_done,
+  };
+  vkResetFences(device, 1, &frame.done);
+  check(vkQueueSubmit(queue, 1, &submit_info, frame.done), "vkQueueSubmit");
+
+  if (present) {
+    const auto present_info = VkPresentInfoKHR{
+      .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+      .waitSemaphoreCount = 1,
+      .pWaitSemaphores = &frame.render_done,
+      .swapchainCount = 1,
+      .pSwapchains = &swapchain,
+      .pImageIndices = &target_index,
+    };
+    const auto result = vkQueuePresentKHR(queue, &present_info);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR or result == VK_SUBOPTIMAL_KHR) {
+      vkDeviceWaitIdle(device);
+      destroy_targets();
+    }
+  }
+
+  stats.opaque = frame.opaque;
+  stats.blended = frame.blended;
+  stats.submit_ns = elapsed_ns(start);
+  last_stats = stats;
+  frame_index = (frame_index + 1) % frames_in_flight;
+}
+
+auto VkSpriteRenderer::read_pixels(std::vector<uint32_t> &out) -> bool {
+  if (offscreen == VK_NULL_HANDLE) {
+    return false;
+  }
+  vkDeviceWaitIdle(device);
+  auto readback = create_buffer((VkDeviceSize)extent.width * extent.height * 4, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+  if (readback.mapped == nullptr) {
+    return false;
+  }
+  run_once([&](VkCommandBuffer cmd) {
+    const auto copy = VkBufferImageCopy{
+      .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      .imageExtent = {extent.width, extent.height, 1},
+    };
+    vkCmdCopyImageToBuffer(cmd, offscreen, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &copy);
+  });
+  out.resize((size_t)extent.width * extent.height);
+  std::memcpy(out.data(), readback.mapped, out.size() * sizeof(uint32_t));
+  destroy_buffer(readback);
+  return true;
+}
+
+auto VkSpriteRenderer::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage) -> Buffer {
+  // host visible and coherent: written by the cpu every frame and read once by the gpu
+  auto buffer = Buffer{};
+  const auto buffer_info = VkBufferCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    .size = size,
+    .usage = usage,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+  };
+  if (not check(vkCreateBuffer(device, &buffer_info, nullptr, &buffer.buffer), "vkCreateBuffer")) {
+    return {};
+  }
+  auto requirements = VkMemoryRequirements{};
+  vkGetBufferMemoryRequirements(device, buffer.buffer, &requirements);
+  const auto alloc_info = VkMemoryAllocateInfo{
+    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+    .allocationSize = requirements.size,
+    .memoryTypeIndex = memory_type(requirements.memoryTypeBits,
+                                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+  };
+  auto mapped = (void *)nullptr;
+  if (not check(vkAllocateMemory(device, &alloc_info, nullptr, &buffer.memory), "vkAllocateMemory") or
+      not check(vkBindBufferMemory(device, buffer.buffer, buffer.memory, 0), "vkBindBufferMemory") or
+      not check(vkMapMemory(device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &mapped), "vkMapMemory")) {
+    destroy_buffer(buffer);
+    return {};
+  }
+  buffer.mapped = (std::byte *)mapped;
+  return buffer;
+}
+
+auto VkSpriteRenderer::destroy_buffer(Buffer &buffer) -> void {
+  if (buffer.mapped != nullptr) {
+    vkUnmapMemory(device, buffer.memory);
+  }
+  vkDestroyBuffer(device, buffer.buffer, nullptr);
+  vkFreeMemory(device, buffer.memory, nullptr);
+  buffer = {};
+}
+
+auto VkSpriteRenderer::create_image(uint32_t width, uint32_t height, uint32_t levels, VkFormat format,
+                                    VkImageUsageFlags usage, VkDeviceMemory &memory) -> VkImage {
+  auto image = VkImage{VK_NULL_HANDLE};
+  const auto image_info = VkImageCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+    .imageType = VK_IMAGE_TYPE_2D,
+    .format = format,
+    .extent = {width, height, 1},
+    .mipLevels = levels,
+    .arrayLayers = 1,
+    .samples = VK_SAMPLE_COUNT_1_BIT,
+    .tiling = VK_IMAGE_TILING_OPTIMAL,
+    .usage = usage,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+  if (not check(vkCreateImage(device, &image_info, nullptr, &image), "vkCreateImage")) {
+    return VK_NULL_HANDLE;
+  }
+  auto requirements = VkMemoryRequirements{};
+  vkGetImageMemoryRequirements(device, image, &requirements);
+  const auto alloc_info = VkMemoryAllocateInfo{
+    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+    .allocationSize = requirements.size,
+    .memoryTypeIndex = memory_type(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+  };
+  if (not check(vkAllocateMemory(device, &alloc_info, nullptr, &memory), "vkAllocateMemory")) {
+    vkDestroyImage(device, image, nullptr);
+    return VK_NULL_HANDLE;
+  }
+  vkBindImageMemory(device, image, memory, 0);
+  return image;
+}
+
+auto VkSpriteRenderer::create_view(VkImage image, VkFormat format, VkImageAspectFlags aspect, uint32_t levels)
+  -> VkImageView {
+  auto view = VkImageView{VK_NULL_HANDLE};
+  const auto view_info = VkImageViewCreateInfo{
+    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+    .image = image,
+    .viewType = VK_IMAGE_VIEW_TYPE_2D,
+    .format = format,
+    .subresourceRange = {aspect, 0, levels, 0, 1},
+  };
+  check(vkCreateImageView(device, &view_info, nullptr, &view), "vkCreateImageView");
+  return view;
+}
+
+auto VkSpriteRenderer::memory_type(uint32_t bits, VkMemoryPropertyFlags properties) const -> uint32_t {
+  auto memory = VkPhysicalDeviceMemoryProperties{};
+  vkGetPhysicalDeviceMemoryProperties(physical_device, &memory);
+  for (auto i = uint32_t{}; i < memory.memoryTypeCount; ++i) {
+    if ((bits & (1u << i)) != 0 and (memory.memoryTypes[i].propertyFlags & properties) == properties) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+auto VkSpriteRenderer::run_once(const std::function<void(VkCommandBuffer)> &record) -> void {
+  // uploads and readbacks are rare, they wait for the queue
+  auto cmd = VkCommandBuffer{VK_NULL_HANDLE};
+  const auto buffer_info = VkCommandBufferAllocateInfo{
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+    .commandPool = command_pool,
+    .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+    .commandBufferCount = 1,
+  };
+  vkAllocateCommandBuffers(device, &buffer_info, &cmd);
+  const auto begin_info = VkCommandBufferBeginInfo{
+    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+  };
+  vkBeginCommandBuffer(cmd, &begin_info);
+  record(cmd);
+  vkEndCommandBuffer(cmd);
+  const auto submit_info = VkSubmitInfo{
+    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+    .commandBufferCount = 1,
+    .pCommandBuffers = &cmd,
+  };
+  vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE);
+  vkQueueWaitIdle(queue);
+  vkFreeCommandBuffers(device, command_pool, 1, &cmd);
+}
+
+} // namespace graphics
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include "sprite_backend.hpp"
+
+namespace graphics {
+
+struct VkSpriteStats {
+  uint32_t opaque = 0;
+  uint32_t blended = 0;
+  uint64_t wait_ns = 0;   // waiting for the frame slot and the swapchain image
+  uint64_t submit_ns = 0; // indirect commands, primary command buffer, submit and present
+};
+
+// the sprite pipeline on vulkan 1.2, next to the gl one. the draws of a frame are two indirect draws, opaque and
+// blended, recorded once per frame slot into secondary command buffers: a frame only writes instances and two
+// instance counts into mapped memory and executes the secondaries. textures are one descriptor array indexed by
+// the sprite (descriptor indexing), so a texture change never splits a draw.
+// runs without a gpu on mesa's lavapipe, without a window it renders into an offscreen image.
+struct VkSpriteRenderer final : SpriteBackend {
+  static constexpr uint32_t frames_in_flight = 2;
+  static constexpr uint32_t max_textures = 4096;
+  static constexpr uint32_t max_sprites = 1 << 17; // per pass and frame
+
+  struct Texture {
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+  };
+
+  struct Target {
+    VkImage image = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+  };
+
+  struct Buffer {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    std::byte *mapped = nullptr;
+  };
+
+  struct Frame {
+    VkCommandBuffer primary = VK_NULL_HANDLE;
+    std::array<VkCommandBuffer, 2> passes = {}; // opaque, blended
+    VkFence done = VK_NULL_HANDLE;
+    VkSemaphore image_ready = VK_NULL_HANDLE;
+    VkSemaphore render_done = VK_NULL_HANDLE;
+    Buffer instances; // opaque from 0, blended from max_sprites
+    Buffer commands;  // a VkDrawIndexedIndirectCommand per pass
+    Buffer camera;
+    VkDescriptorSet camera_set = VK_NULL_HANDLE;
+    uint32_t opaque = 0;
+    uint32_t blended = 0;
+  };
+
+  VkInstance instance = VK_NULL_HANDLE;
+  VkPhysicalDevice physical_device = VK_NULL_HANDLE;
+  VkDevice device = VK_NULL_HANDLE;
+  VkQueue queue = VK_NULL_HANDLE;
+  uint32_t queue_family = 0;
+  VkSurfaceKHR surface = VK_NULL_HANDLE;
+  VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+  VkFormat color_format = VK_FORMAT_R8G8B8A8_UNORM;
+  VkExtent2D extent = {};
+
+  VkRenderPass render_pass = VK_NULL_HANDLE;
+  std::vector<Target> targets; // swapchain images, or the offscreen image
+  VkImage offscreen = VK_NULL_HANDLE;
+  VkDeviceMemory offscreen_memory = VK_NULL_HANDLE;
+  VkImage depth = VK_NULL_HANDLE;
+  VkDeviceMemory depth_memory = VK_NULL_HANDLE;
+  VkImageView depth_view = VK_NULL_HANDLE;
+
+  VkDescriptorSetLayout texture_layout = VK_NULL_HANDLE;
+  VkDescriptorSetLayout camera_layout = VK_NULL_HANDLE;
+  VkDescriptorPool descriptor_pool = VK_NULL_HANDLE;
+  VkDescriptorSet texture_set = VK_NULL_HANDLE;
+  VkSampler sampler = VK_NULL_HANDLE;
+  VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+  std::array<VkPipeline, 2> pipelines = {}; // opaque, blended
+  VkCommandPool command_pool = VK_NULL_HANDLE;
+  Buffer quad;
+
+  std::vector<Texture> textures;
+  std::vector<uint32_t> free_textures;
+
+  std::array<Frame, frames_in_flight> frames = {};
+  uint32_t frame_index = 0;
+  uint32_t target_index = 0;
+  bool in_frame = false;
+
+  VkSpriteStats stats;
+  VkSpriteStats last_stats;
+
+  // window is a HWND on windows, nullptr renders offscreen
+  auto init(void *window, uint32_t width, uint32_t height) -> bool;
+  auto deinit() -> void;
+
+  auto create_texture(const uint8_t *rgba, uint32_t width, uint32_t height) -> uint32_t override;
+  auto delete_texture(uint32_t texture) -> void override;
+
+  auto begin_frame(uint32_t width, uint32_t height, const glm::mat4 &view_projection, glm::vec4 clear_color)
+    -> bool override;
+  auto draw(const SpriteInstance &instance, uint32_t texture, bool blended) -> void override;
+  auto end_frame() -> void override;
+
+  // copies the offscreen image, rgba8 rows from the top
+  auto read_pixels(std::vector<uint32_t> &out) -> bool;
+
+private:
+  glm::vec4 clear_color = {1.f, 1.f, 1.f, 1.f};
+
+  auto create_device(bool present) -> bool;
+  auto create_targets() -> bool;
+  auto destroy_targets() -> void;
+  auto create_pipelines() -> bool;
+  auto create_frames() -> bool;
+  auto record_passes() -> void;
+
+  auto create_buffer(VkDeviceSize size, VkBufferUsageFlags usage) -> Buffer;
+  auto destroy_buffer(Buffer &buffer) -> void;
+  auto create_image(uint32_t width, uint32_t height, uint32_t levels, VkFormat format, VkImageUsageFlags usage,
+                    VkDeviceMemory &memory) -> VkImage;
+  auto create_view(VkImage image, VkFormat format, VkImageAspectFlags aspect, uint32_t levels) -> VkImageView;
+  auto memory_type(uint32_t bits, VkMemoryPropertyFlags properties) const -> uint32_t;
+  auto run_once(const std::function<void(VkCommandBuffer)> &record) -> void;
+};
+
+} // namespace graphics
@@ -2,9 +2,15 @@
 
 #include <fstream>
 
+#include "vfs.hpp"
+
 namespace utils {
 
 auto read_file(const std::filesystem::path &path) -> std::string {
+  // mounted packs first, then the loose file
+  if (auto data = Vfs::find(path.generic_string()); data.has_value()) {
+    return {(const char *)data->data(), data->size()};
+  }
   auto fs = std::ifstream{path.c_str()};
   auto ss = std::stringstream{};
   ss << fs.rdbuf();
@@ -0,0 +1,412 @@
+#include "vfs.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+namespace utils {
+
+namespace {
+
+// lz4 block format: sequences of a token, literals, a 16 bit match offset and the match length
+constexpr auto lz4_min_match = size_t{4};
+constexpr auto lz4_last_literals = size_t{5}; // the block always ends with this many literals
+constexpr auto lz4_match_limit = size_t{12};  // no match starts this close to the end
+constexpr auto lz4_max_offset = size_t{65535};
+constexpr auto lz4_hash_bits = 12;
+
+auto read32(const std::byte *p) -> uint32_t {
+  auto value = uint32_t{};
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+auto put_length(std::vector<std::byte> &out, size_t length) -> void {
+  while (length >= 255) {
+    out.push_back(std::byte{255});
+    length -= 255;
+  }
+  out.push_back((std::byte)length);
+}
+
+auto put_sequence(std::vector<std::byte> &out, std::span<const std::byte> literals, size_t offset, size_t length)
+  -> void {
+  const auto match = length >= lz4_min_match ? length - lz4_min_match : 0;
+  const auto token = (std::min(literals.size(), size_t{15}) << 4) | (length > 0 ? std::min(match, size_t{15}) : 0);
+  out.push_back((std::byte)token);
+  if (literals.size() >= 15) {
+    put_length(out, literals.size() - 15);
+  }
+  out.insert(out.end(), literals.begin(), literals.end());
+  if (length == 0) {
+    return;
+  }
+  out.push_back((std::byte)(offset & 0xff));
+  out.push_back((std::byte)(offset >> 8));
+  if (match >= 15) {
+    put_length(out, match - 15);
+  }
+}
+
+auto get_length(std::span<const std::byte> data, size_t &i, size_t length) -> std::optional<size_t> {
+  if (length != 15) {
+    return length;
+  }
+  while (true) {
+    if (i >= data.size()) {
+      return std::nullopt;
+    }
+    const auto value = (size_t)data[i++];
+    length += value;
+    if (value != 255) {
+      return length;
+    }
+  }
+}
+
+} // namespace
+
+auto normalize_path(std::string_view path) -> std::string {
+  auto result = std::string{path};
+  std::replace(result.begin(), result.end(), '\\', '/');
+  while (result.starts_with("./")) {
+    result.erase(0, 2);
+  }
+  return result;
+}
+
+auto hash_path(std::string_view normalized_path) -> uint64_t {
+  auto hash = 14695981039346656037ull;
+  for (auto c : normalized_path) {
+    hash ^= (uint8_t)c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+auto lz4_compress(std::span<const std::byte> data) -> std::vector<std::byte> {
+  auto out = std::vector<std::byte>{};
+  out.reserve(data.size() + data.size() / 255 + 16);
+
+  // greedy matching against the last position of every hashed 4 byte sequence
+  auto table = std::vector<uint32_t>(size_t{1} << lz4_hash_bits, UINT32_MAX);
+  auto anchor = size_t{};
+  auto i = size_t{};
+  const auto match_end = data.size() > lz4_last_literals ? data.size() - lz4_last_literals : 0;
+  while (data.size() > lz4_match_limit and i < data.size() - lz4_match_limit) {
+    const auto sequence = read32(&data[i]);
+    const auto hash = (sequence * 2654435761u) >> (32 - lz4_hash_bits);
+    const auto candidate = (size_t)table[hash];
+    table[hash] = (uint32_t)i;
+    if (candidate == UINT32_MAX or i - candidate > lz4_max_offset or read32(&data[candidate]) != sequence) {
+      i += 1;
+      continue;
+    }
+
+    auto length = lz4_min_match;
+    while (i + length < match_end and data[candidate + length] == data[i + length]) {
+      length += 1;
+    }
+    put_sequence(out, data.subspan(anchor, i - anchor), i - candidate, length);
+    i += length;
+    anchor = i;
+  }
+  put_sequence(out, data.subspan(anchor), 0, 0);
+  return out;
+}
+
+auto lz4_decompress(std::span<const std::byte> data, std::span<std::byte> out) -> bool {
+  auto i = size_t{};
+  auto o = size_t{};
+  while (i < data.size()) {
+    const auto token = (size_t)data[i++];
+    const auto literals = get_length(data, i, token >> 4);
+    if (not literals.has_value() or i + *literals > data.size() or o + *literals > out.size()) {
+      return false;
+    }
+    // an empty file decompresses into an empty (null) span, memcpy must not see it even for zero bytes
+    if (*literals > 0) {
+      std::memcpy(out.data() + o, data.data() + i, *literals);
+    }
+    i += *literals;
+    o += *literals;
+    if (i == data.size()) {
+      break;
+    }
+
+    if (i + 2 > data.size()) {
+      return false;
+    }
+    const auto offset = (size_t)data[i] | ((size_t)data[i + 1] << 8);
+    i += 2;
+    auto length = get_length(data, i, token & 15);
+    if (not length.has_value() or offset == 0 or offset > o or o + *length + lz4_min_match > out.size()) {
+      return false;
+    }
+    // the match may overlap the bytes it produces
+    for (auto k = size_t{}; k < *length + lz4_min_match; ++k, ++o) {
+      out[o] = out[o - offset];
+    }
+  }
+  return o == out.size();
+}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+auto MappedFile::open(const std::filesystem::path &path) -> bool {
+  close();
+
+#if defined(_WIN32)
+  auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                          nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    std::cerr << std::format("Error: failed to open \"{}\"\n", path.string());
+    return false;
+  }
+  // empty files cannot be mapped
+  auto size = LARGE_INTEGER{};
+  auto mapping_handle = HANDLE{};
+  if (GetFileSizeEx(file, &size) and size.QuadPart > 0) {
+    mapping_handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  }
+  CloseHandle(file);
+  const auto address = mapping_handle != nullptr ? MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (address == nullptr) {
+    if (mapping_handle != nullptr) {
+      CloseHandle(mapping_handle);
+    }
+    std::cerr << std::format("Error: failed to map \"{}\"\n", path.string());
+    return false;
+  }
+  handle = mapping_handle;
+  mapping = {(const std::byte *)address, (size_t)size.QuadPart};
+#else
+  const auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << std::format("Error: failed to open \"{}\"\n", path.string());
+    return false;
+  }
+  struct stat info = {};
+  auto address = MAP_FAILED;
+  if (fstat(fd, &info) == 0 and info.st_size > 0) {
+    address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (address == MAP_FAILED) {
+    std::cerr << std::format("Error: failed to map \"{}\"\n", path.string());
+    return false;
+  }
+  mapping = {(const std::byte *)address, (size_t)info.st_size};
+#endif
+  return true;
+}
+
+auto MappedFile::close() -> void {
+  if (mapping.empty()) {
+    return;
+  }
+#if defined(_WIN32)
+  UnmapViewOfFile(mapping.data());
+  CloseHandle((HANDLE)handle);
+#else
+  munmap((void *)mapping.data(), mapping.size());
+#endif
+  handle = nullptr;
+  mapping = {};
+}
+
+auto MappedFile::data() const -> std::span<const std::byte> {
+  return mapping;
+}
+
+PackArchive::~PackArchive() {
+  close();
+}
+
+auto PackArchive::open(const std::filesystem::path &path) -> bool {
+  close();
+  if (not file.open(path)) {
+    return false;
+  }
+  mapping = file.data();
+  if (mapping.size() < sizeof(PackHeader)) {
+    std::cerr << std::format("Error: \"{}\" is not a pack\n", path.string());
+    close();
+    return false;
+  }
+
+  // the table of contents is read in place, only its bounds are checked here. offset + size can wrap, so the size
+  // is compared against what is left after the offset
+  const auto fits = [](uint64_t offset, uint64_t size, uint64_t total) {
+    return size <= total and offset <= total - size;
+  };
+  auto header = PackHeader{};
+  std::memcpy(&header, mapping.data(), sizeof(header));
+  const auto toc_size = (uint64_t)header.entry_count * sizeof(PackEntry);
+  if (header.magic != pack_magic or header.version != pack_version or header.toc_offset % alignof(PackEntry) != 0 or
+      not fits(header.toc_offset, toc_size, mapping.size()) or
+      not fits(header.names_offset, header.names_size, mapping.size())) {
+    std::cerr << std::format("Error: \"{}\" is not a pack of version {}\n", path.string(), pack_version);
+    close();
+    return false;
+  }
+  toc = {(const PackEntry *)(mapping.data() + header.toc_offset), header.entry_count};
+  for (const auto &entry : toc) {
+    if (not fits(entry.offset, entry.stored_size, mapping.size()) or
+        not fits(entry.name_offset, entry.name_size, header.names_size)) {
+      std::cerr << std::format("Error: pack \"{}\" is truncated\n", path.string());
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+auto PackArchive::close() -> void {
+  file.close();
+  mapping = {};
+  toc = {};
+  decompressed.clear();
+}
+
+auto PackArchive::find(std::string_view path) -> std::optional<std::span<const std::byte>> {
+  const auto normalized = normalize_path(path);
+  const auto hash = hash_path(normalized);
+  auto it = std::lower_bound(toc.begin(), toc.end(), hash,
+                             [](const PackEntry &entry, uint64_t hash) { return entry.hash < hash; });
+  for (; it != toc.end() and it->hash == hash; ++it) {
+    if (name(*it) != normalized) {
+      continue;
+    }
+
+    const auto stored = mapping.subspan(it->offset, it->stored_size);
+    if (it->codec == PackCodec::None) {
+      return stored;
+    }
+
+    const auto index = (size_t)(it - toc.begin());
+    auto lock = std::lock_guard{mutex};
+    if (auto cached = decompressed.find(index); cached != decompressed.end()) {
+      return std::span<const std::byte>{cached->second};
+    }
+    auto data = std::vector<std::byte>(it->size);
+    if (it->codec != PackCodec::Lz4 or not lz4_decompress(stored, data)) {
+      std::cerr << std::format("Error: failed to decompress \"{}\" from pack\n", normalized);
+      return std::nullopt;
+    }
+    return std::span<const std::byte>{decompressed.insert({index, std::move(data)}).first->second};
+  }
+  return std::nullopt;
+}
+
+auto PackArchive::entries() const -> std::span<const PackEntry> {
+  return toc;
+}
+
+auto PackArchive::name(const PackEntry &entry) const -> std::string_view {
+  auto header = PackHeader{};
+  std::memcpy(&header, mapping.data(), sizeof(header));
+  return {(const char *)mapping.data() + header.names_offset + entry.name_offset, entry.name_size};
+}
+
+auto Vfs::mount(const std::filesystem::path &path) -> bool {
+  auto archive = std::make_unique<PackArchive>();
+  if (not archive->open(path)) {
+    return false;
+  }
+  archives.push_back(std::move(archive));
+  return true;
+}
+
+auto Vfs::unmount_all() -> void {
+  archives.clear();
+}
+
+auto Vfs::find(std::string_view path) -> std::optional<std::span<const std::byte>> {
+  for (auto it = archives.rbegin(); it != archives.rend(); ++it) {
+    if (auto data = (*it)->find(path); data.has_value()) {
+      return data;
+    }
+  }
+  return std::nullopt;
+}
+
+auto PackWriter::add(std::string_view path, std::vector<std::byte> data, bool compress) -> void {
+  auto name = normalize_path(path);
+  std::erase_if(files, [&](const File &file) { return file.name == name; });
+  files.push_back({std::move(name), std::move(data), compress});
+}
+
+auto PackWriter::write(const std::filesystem::path &path) const -> bool {
+  const auto align = [&](uint64_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+  };
+
+  auto header = PackHeader{};
+  header.alignment = alignment;
+  header.entry_count = (uint32_t)files.size();
+
+  auto data = std::vector<std::byte>(sizeof(PackHeader));
+  auto toc = std::vector<PackEntry>{};
+  auto names = std::string{};
+  for (const auto &file : files) {
+    auto entry = PackEntry{};
+    entry.hash = hash_path(file.name);
+    entry.size = file.data.size();
+    entry.name_offset = (uint32_t)names.size();
+    entry.name_size = (uint32_t)file.name.size();
+    names += file.name;
+
+    auto stored = std::span<const std::byte>{file.data};
+    auto compressed = std::vector<std::byte>{};
+    if (file.compress and not file.data.empty()) {
+      compressed = lz4_compress(file.data);
+      if (compressed.size() < file.data.size()) {
+        entry.codec = PackCodec::Lz4;
+        stored = compressed;
+      }
+    }
+    entry.offset = align(data.size());
+    entry.stored_size = stored.size();
+    data.resize(entry.offset);
+    data.insert(data.end(), stored.begin(), stored.end());
+    toc.push_back(entry);
+  }
+
+  std::sort(toc.begin(), toc.end(), [](const PackEntry &a, const PackEntry &b) { return a.hash < b.hash; });
+  header.toc_offset = align(data.size());
+  data.resize(header.toc_offset);
+  const auto toc_bytes = std::as_bytes(std::span{toc});
+  data.insert(data.end(), toc_bytes.begin(), toc_bytes.end());
+  header.names_offset = data.size();
+  header.names_size = names.size();
+  const auto name_bytes = std::as_bytes(std::span{names});
+  data.insert(data.end(), name_bytes.begin(), name_bytes.end());
+  std::memcpy(data.data(), &header, sizeof(header));
+
+  auto fs = std::ofstream{path, std::ios::binary | std::ios::trunc};
+  if (not fs) {
+    std::cerr << std::format("Error: failed to write pack \"{}\"\n", path.string());
+    return false;
+  }
+  fs.write((const char *)data.data(), (std::streamsize)data.size());
+  return (bool)fs;
+}
+
+} // namespace utils
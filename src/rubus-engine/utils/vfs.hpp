@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace utils {
+
+// pack archive: a header, the entry data, the table of contents sorted by path hash, then the path names.
+// every entry starts on a multiple of `alignment` bytes so mapped views can be handed to simd code and uploads.
+constexpr auto pack_magic = uint32_t{0x4b415052}; // "RPAK"
+constexpr auto pack_version = uint32_t{1};
+
+enum struct PackCodec : uint32_t {
+  None,
+  Lz4, // lz4 block format, decompressed on first access and kept while the archive is mounted
+};
+
+struct PackHeader {
+  uint32_t magic = pack_magic;
+  uint32_t version = pack_version;
+  uint32_t alignment = 64;
+  uint32_t entry_count = 0;
+  uint64_t toc_offset = 0;
+  uint64_t names_offset = 0;
+  uint64_t names_size = 0;
+};
+
+struct PackEntry {
+  uint64_t hash = 0;        // hash_path of the name
+  uint64_t offset = 0;      // from the start of the archive
+  uint64_t size = 0;        // of the file
+  uint64_t stored_size = 0; // in the archive, after compression
+  PackCodec codec = PackCodec::None;
+  uint32_t name_offset = 0; // into the name table, not terminated
+  uint32_t name_size = 0;
+  uint32_t reserved = 0;
+};
+
+// forward slashes, no leading "./", so "shaders\sprite\vert.glsl" and "./shaders/sprite/vert.glsl" match
+auto normalize_path(std::string_view path) -> std::string;
+auto hash_path(std::string_view normalized_path) -> uint64_t;
+
+auto lz4_compress(std::span<const std::byte> data) -> std::vector<std::byte>;
+// `out` must be exactly the size of the original data
+auto lz4_decompress(std::span<const std::byte> data, std::span<std::byte> out) -> bool;
+
+// a whole file mapped read only
+struct MappedFile {
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  auto operator=(const MappedFile &) -> MappedFile & = delete;
+  ~MappedFile();
+
+  auto open(const std::filesystem::path &path) -> bool;
+  auto close() -> void;
+  auto data() const -> std::span<const std::byte>;
+
+private:
+  std::span<const std::byte> mapping;
+  void *handle = nullptr; // the file mapping object on windows
+};
+
+// a pack file mapped read only, entries are views into the mapping
+struct PackArchive {
+  PackArchive() = default;
+  PackArchive(const PackArchive &) = delete;
+  auto operator=(const PackArchive &) -> PackArchive & = delete;
+  ~PackArchive();
+
+  auto open(const std::filesystem::path &path) -> bool;
+  auto close() -> void;
+
+  // the file contents, valid until close
+  auto find(std::string_view path) -> std::optional<std::span<const std::byte>>;
+  auto entries() const -> std::span<const PackEntry>;
+  auto name(const PackEntry &entry) const -> std::string_view;
+
+private:
+  MappedFile file;
+  std::span<const std::byte> mapping;
+  std::span<const PackEntry> toc;
+
+  std::mutex mutex;
+  std::unordered_map<size_t, std::vector<std::byte>> decompressed; // by entry index
+};
+
+// files of the mounted archives, looked up before the loose files on disk (utils::read_file, texture loads).
+// archives mounted later shadow earlier ones.
+struct Vfs {
+  inline static std::vector<std::unique_ptr<PackArchive>> archives;
+
+  static auto mount(const std::filesystem::path &path) -> bool;
+  static auto unmount_all() -> void;
+
+  static auto find(std::string_view path) -> std::optional<std::span<const std::byte>>;
+};
+
+// builds pack archives, used by the rubus-pack tool
+struct PackWriter {
+  struct File {
+    std::string name;
+    std::vector<std::byte> data;
+    bool compress = false;
+  };
+
+  uint32_t alignment = 64;
+  std::vector<File> files;
+
+  // keeps the data uncompressed when lz4 does not make it smaller
+  auto add(std::string_view path, std::vector<std::byte> data, bool compress) -> void;
+  auto write(const std::filesystem::path &path) const -> bool;
+};
+
+} // namespace utils
@@ -0,0 +1,355 @@
+// the encoders checked against reference decoders written from the format specifications (bptc, s3tc, etc2 in the
+// khronos data format spec), so a block that a driver would read differently fails here.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <rubus-engine/game/block_compression.hpp>
+#include "test.hpp"
+
+using rugame::TextureCompression;
+
+namespace {
+
+using Texel = std::array<int, 4>;
+using Block = std::array<Texel, 16>; // row major
+
+struct BitReader {
+  const uint8_t *data = nullptr;
+  int bit = 0;
+
+  auto get(int bits) -> int {
+    auto value = 0;
+    for (auto i = 0; i < bits; ++i, ++bit) {
+      value |= ((data[bit >> 3] >> (bit & 7)) & 1) << i;
+    }
+    return value;
+  }
+};
+
+auto interpolate_bc7(int e0, int e1, int weight) -> int {
+  return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+// modes 5 and 6, the only ones the encoder writes. nullopt for the other modes
+auto decode_bc7(const uint8_t *data) -> std::optional<Block> {
+  constexpr auto weights2 = std::array{0, 21, 43, 64};
+  constexpr auto weights4 = std::array{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+  auto reader = BitReader{data};
+  auto mode = 0;
+  while (mode < 8 and reader.get(1) == 0) {
+    mode += 1;
+  }
+  auto block = Block{};
+  if (mode == 6) {
+    auto endpoints = std::array<Texel, 2>{};
+    for (auto c = 0; c < 4; ++c) {
+      endpoints[0][c] = reader.get(7);
+      endpoints[1][c] = reader.get(7);
+    }
+    for (auto &endpoint : endpoints) {
+      const auto p = reader.get(1);
+      for (auto &value : endpoint) {
+        value = value << 1 | p;
+      }
+    }
+    for (auto t = 0; t < 16; ++t) {
+      const auto index = reader.get(t == 0 ? 3 : 4);
+      for (auto c = 0; c < 4; ++c) {
+        block[t][c] = interpolate_bc7(endpoints[0][c], endpoints[1][c], weights4[index]);
+      }
+    }
+    return block;
+  }
+  if (mode == 5) {
+    const auto rotation = reader.get(2);
+    auto endpoints = std::array<Texel, 2>{};
+    for (auto c = 0; c < 3; ++c) {
+      endpoints[0][c] = reader.get(7);
+      endpoints[1][c] = reader.get(7);
+      for (auto &endpoint : endpoints) {
+        endpoint[c] = endpoint[c] << 1 | endpoint[c] >> 6;
+      }
+    }
+    endpoints[0][3] = reader.get(8);
+    endpoints[1][3] = reader.get(8);
+    auto color_indices = std::array<int, 16>{};
+    auto alpha_indices = std::array<int, 16>{};
+    for (auto t = 0; t < 16; ++t) {
+      color_indices[t] = reader.get(t == 0 ? 1 : 2);
+    }
+    for (auto t = 0; t < 16; ++t) {
+      alpha_indices[t] = reader.get(t == 0 ? 1 : 2);
+    }
+    for (auto t = 0; t < 16; ++t) {
+      for (auto c = 0; c < 3; ++c) {
+        block[t][c] = interpolate_bc7(endpoints[0][c], endpoints[1][c], weights2[color_indices[t]]);
+      }
+      block[t][3] = interpolate_bc7(endpoints[0][3], endpoints[1][3], weights2[alpha_indices[t]]);
+      if (rotation > 0) {
+        std::swap(block[t][3], block[t][rotation - 1]);
+      }
+    }
+    return block;
+  }
+  return std::nullopt;
+}
+
+auto expand565(int color) -> Texel {
+  const auto r = color >> 11 & 31;
+  const auto g = color >> 5 & 63;
+  const auto b = color & 31;
+  return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2, 255};
+}
+
+// dxt5: the alpha block, then a color block always read in four color mode
+auto decode_bc3(const uint8_t *data) -> Block {
+  auto block = Block{};
+  auto alpha = std::array<int, 8>{data[0], data[1]};
+  for (auto i = 1; i < 7; ++i) {
+    if (alpha[0] > alpha[1]) {
+      alpha[i + 1] = ((7 - i) * alpha[0] + i * alpha[1]) / 7;
+    } else if (i < 5) {
+      alpha[i + 1] = ((5 - i) * alpha[0] + i * alpha[1]) / 5;
+    }
+  }
+  if (alpha[0] <= alpha[1]) {
+    alpha[6] = 0;
+    alpha[7] = 255;
+  }
+  auto reader = BitReader{data + 2};
+  for (auto &texel : block) {
+    texel[3] = alpha[reader.get(3)];
+  }
+
+  const auto c0 = expand565(data[8] | data[9] << 8);
+  const auto c1 = expand565(data[10] | data[11] << 8);
+  auto colors = std::array<Texel, 4>{c0, c1};
+  for (auto c = 0; c < 3; ++c) {
+    colors[2][c] = (2 * c0[c] + c1[c]) / 3;
+    colors[3][c] = (c0[c] + 2 * c1[c]) / 3;
+  }
+  reader = BitReader{data + 12};
+  for (auto &texel : block) {
+    const auto &color = colors[reader.get(2)];
+    texel = {color[0], color[1], color[2], texel[3]};
+  }
+  return block;
+}
+
+auto read_big_endian(const uint8_t *data) -> uint64_t {
+  auto bits = uint64_t{};
+  for (auto i = 0; i < 8; ++i) {
+    bits = bits << 8 | data[i];
+  }
+  return bits;
+}
+
+// etc2 rgba8: eac alpha, then an etc color block. only the etc1 compatible individual and differential modes are
+// decoded, nullopt for the t, h and planar modes that an overflowing differential base selects
+auto decode_etc2(const uint8_t *data) -> std::optional<Block> {
+  constexpr int eac_modifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12}, {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12}, {-3, -6, -8, -12, 2, 5, 7, 11},  {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},  {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},  {-2, -4, -8, -10, 1, 3, 7, 9},   {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},   {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8},
+  };
+  constexpr int etc_modifiers[8][2] = {{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+  // texels are indexed column major, the index of texel (x, y) is number x * 4 + y
+  auto block = Block{};
+  const auto alpha = read_big_endian(data);
+  const auto base = (int)(alpha >> 56);
+  const auto multiplier = (int)(alpha >> 52 & 15);
+  const auto table = (int)(alpha >> 48 & 15);
+  for (auto t = 0; t < 16; ++t) {
+    const auto index = (int)(alpha >> (45 - (t % 4 * 4 + t / 4) * 3) & 7);
+    block[t][3] = std::clamp(base + eac_modifiers[table][index] * multiplier, 0, 255);
+  }
+
+  const auto color = read_big_endian(data + 8);
+  const auto differential = (color >> 33 & 1) != 0;
+  const auto flip = (color >> 32 & 1) != 0;
+  auto bases = std::array<Texel, 2>{};
+  for (auto c = 0; c < 3; ++c) {
+    const auto shift = 59 - c * 8;
+    if (differential) {
+      const auto value = (int)(color >> shift & 31);
+      auto delta = (int)(color >> (shift - 3) & 7);
+      delta = delta >= 4 ? delta - 8 : delta;
+      if (value + delta < 0 or value + delta > 31) {
+        return std::nullopt;
+      }
+      bases[0][c] = value << 3 | value >> 2;
+      bases[1][c] = (value + delta) << 3 | (value + delta) >> 2;
+    } else {
+      bases[0][c] = (int)(color >> (shift + 1) & 15) * 17;
+      bases[1][c] = (int)(color >> (shift - 3) & 15) * 17;
+    }
+  }
+  const auto tables = std::array{(int)(color >> 37 & 7), (int)(color >> 34 & 7)};
+  for (auto t = 0; t < 16; ++t) {
+    const auto x = t % 4;
+    const auto y = t / 4;
+    const auto sub = flip ? (y >= 2 ? 1 : 0) : (x >= 2 ? 1 : 0);
+    const auto p = x * 4 + y;
+    const auto msb = (int)(color >> (16 + p) & 1);
+    const auto lsb = (int)(color >> p & 1);
+    const auto modifier = etc_modifiers[tables[sub]][lsb] * (msb != 0 ? -1 : 1);
+    for (auto c = 0; c < 3; ++c) {
+      block[t][c] = std::clamp(bases[sub][c] + modifier, 0, 255);
+    }
+  }
+  return block;
+}
+
+auto decode_block(TextureCompression compression, const uint8_t *data) -> std::optional<Block> {
+  switch (compression) {
+  case TextureCompression::Bc7:
+    return decode_bc7(data);
+  case TextureCompression::Bc3:
+    return decode_bc3(data);
+  case TextureCompression::Etc2:
+    return decode_etc2(data);
+  default:
+    return std::nullopt;
+  }
+}
+
+struct Error {
+  bool decoded = true;
+  double color_rmse = 0;
+  int max_alpha = 0;
+};
+
+// the colors of fully transparent texels are free, they are left out
+auto measure(TextureCompression compression, const std::vector<uint8_t> &rgba, int width, int height) -> Error {
+  const auto data = rugame::compress_texture_level(compression, rgba.data(), width, height);
+  auto error = Error{};
+  if (data.size() != rugame::compressed_level_size(width, height)) {
+    error.decoded = false;
+    return error;
+  }
+  const auto blocks_x = (width + 3) / 4;
+  auto sum = 0.0;
+  auto count = 0;
+  for (auto y = 0; y < height; ++y) {
+    for (auto x = 0; x < width; ++x) {
+      const auto block_data = (const uint8_t *)data.data() + (size_t)(y / 4 * blocks_x + x / 4) * 16;
+      const auto block = decode_block(compression, block_data);
+      if (not block.has_value()) {
+        error.decoded = false;
+        return error;
+      }
+      const auto &decoded = (*block)[y % 4 * 4 + x % 4];
+      const auto texel = rgba.data() + ((size_t)y * width + x) * 4;
+      error.max_alpha = std::max(error.max_alpha, std::abs(decoded[3] - texel[3]));
+      if (texel[3] > 0) {
+        for (auto c = 0; c < 3; ++c) {
+          sum += (decoded[c] - texel[c]) * (decoded[c] - texel[c]);
+          count += 1;
+        }
+      }
+    }
+  }
+  error.color_rmse = count > 0 ? std::sqrt(sum / count) : 0.0;
+  return error;
+}
+
+// a smooth opaque gradient, 38x22 so the last blocks are partial
+auto gradient_image(int width, int height) -> std::vector<uint8_t> {
+  auto rgba = std::vector<uint8_t>((size_t)width * height * 4);
+  for (auto y = 0; y < height; ++y) {
+    for (auto x = 0; x < width; ++x) {
+      const auto texel = rgba.data() + ((size_t)y * width + x) * 4;
+      texel[0] = (uint8_t)(x * 255 / (width - 1));
+      texel[1] = (uint8_t)(y * 255 / (height - 1));
+      texel[2] = (uint8_t)(128 + 100 * std::sin(0.05 * (x + y)));
+      texel[3] = 255;
+    }
+  }
+  return rgba;
+}
+
+// pixel art like: flat 3x3 cells of a few colors or transparent, so blocks mix up to four of them
+auto cutout_image(int width, int height, uint32_t seed) -> std::vector<uint8_t> {
+  auto random = std::mt19937{seed};
+  auto pick = std::uniform_int_distribution<int>{0, 3};
+  constexpr auto colors = std::array<Texel, 4>{
+    Texel{0, 0, 0, 0}, Texel{200, 40, 40, 255}, Texel{40, 200, 60, 255}, Texel{250, 230, 200, 255}};
+  const auto cells_x = (width + 2) / 3;
+  auto cells = std::vector<int>((size_t)cells_x * ((height + 2) / 3));
+  for (auto &cell : cells) {
+    cell = pick(random);
+  }
+  auto rgba = std::vector<uint8_t>((size_t)width * height * 4);
+  for (auto y = 0; y < height; ++y) {
+    for (auto x = 0; x < width; ++x) {
+      const auto &color = colors[cells[y / 3 * cells_x + x / 3]];
+      for (auto c = 0; c < 4; ++c) {
+        rgba[((size_t)y * width + x) * 4 + c] = (uint8_t)color[c];
+      }
+    }
+  }
+  return rgba;
+}
+
+// the bounds sit a little above what the encoders reach today (a gradient across x and y is no line in color
+// space, a block of four flat colors is no line either), a broken block reads far off
+auto check_compression(TextureCompression compression, double gradient_rmse, double cutout_rmse) -> void {
+  const auto gradient = measure(compression, gradient_image(38, 22), 38, 22);
+  const auto cutout = measure(compression, cutout_image(32, 32, 5), 32, 32);
+  RUBUS_CHECK(gradient.decoded and cutout.decoded);
+  RUBUS_CHECK(gradient.color_rmse < gradient_rmse);
+  RUBUS_CHECK(gradient.max_alpha == 0);
+  RUBUS_CHECK(cutout.color_rmse < cutout_rmse);
+  // fully opaque and fully transparent texels stay exact, cutout sprites keep their edges
+  RUBUS_CHECK(cutout.max_alpha == 0);
+}
+
+} // namespace
+
+RUBUS_TEST(block_compression, bc7_decodes_close) {
+  check_compression(TextureCompression::Bc7, 6.0, 26.0);
+}
+
+RUBUS_TEST(block_compression, bc3_decodes_close) {
+  check_compression(TextureCompression::Bc3, 7.0, 26.0);
+}
+
+RUBUS_TEST(block_compression, etc2_decodes_close) {
+  check_compression(TextureCompression::Etc2, 7.0, 36.0);
+}
+
+RUBUS_TEST(block_compression, flat_blocks_are_exact) {
+  // a single color is representable in every format, up to the endpoint precision
+  for (const auto compression : {TextureCompression::Bc7, TextureCompression::Bc3, TextureCompression::Etc2}) {
+    auto rgba = std::vector<uint8_t>(8 * 8 * 4);
+    for (auto i = size_t{}; i < rgba.size(); i += 4) {
+      rgba[i + 0] = 96;
+      rgba[i + 1] = 160;
+      rgba[i + 2] = 32;
+      rgba[i + 3] = 255;
+    }
+    const auto error = measure(compression, rgba, 8, 8);
+    RUBUS_CHECK(error.decoded and error.color_rmse < 4.0 and error.max_alpha == 0);
+  }
+}
+
+RUBUS_TEST(block_compression, names_and_sizes) {
+  for (const auto compression : {TextureCompression::Bc7, TextureCompression::Bc3, TextureCompression::Etc2}) {
+    RUBUS_CHECK(rugame::parse_texture_compression(rugame::texture_compression_name(compression)) == compression);
+  }
+  RUBUS_CHECK(rugame::parse_texture_compression("png") == TextureCompression::None);
+  RUBUS_CHECK(rugame::compressed_level_size(1, 1) == 16);
+  RUBUS_CHECK(rugame::compressed_level_size(5, 4) == 32);
+  RUBUS_CHECK(rugame::compressed_level_size(8, 9) == 96);
+}
@@ -0,0 +1,51 @@
+#include <cstdint>
+
+#include <rubus-engine/game/cached_layer.hpp>
+#include "test.hpp"
+
+using rugame::CachedLayer;
+
+namespace {
+
+auto hash_of(const rugame::Sprite &sprite, const rugame::TextureResource &texture) -> uint64_t {
+  return CachedLayer::hash_member(14695981039346656037ull, &sprite, &texture);
+}
+
+} // namespace
+
+RUBUS_TEST(cached_layer, member_hash_follows_what_is_drawn) {
+  auto sprite = rugame::Sprite{{0.5f, 0.5f}, 16.f, 16.f, rugame::SpriteMaterial{}};
+  sprite.is_static = true;
+  auto texture = rugame::TextureResource{};
+  texture.handle = 1;
+  const auto base = hash_of(sprite, texture);
+  RUBUS_CHECK(hash_of(sprite, texture) == base);
+
+  // every change that shows redraws the layer without marking the sprite dirty. the member is identified by its
+  // address, so the change is made in place and undone after
+  const auto changed = [&](auto &&change) {
+    const auto old_sprite = sprite;
+    const auto old_texture = texture;
+    change(sprite, texture);
+    const auto hash = hash_of(sprite, texture);
+    sprite = old_sprite;
+    texture = old_texture;
+    return hash != base;
+  };
+  RUBUS_CHECK(changed([](auto &s, auto &) { s.transform = rugame::Affine2d::translate({1.f, 0.f}); }));
+  RUBUS_CHECK(changed([](auto &s, auto &) { s.width = 32.f; }));
+  RUBUS_CHECK(changed([](auto &s, auto &) { s.height = 32.f; }));
+  RUBUS_CHECK(changed([](auto &s, auto &) { s.pivot = {0.f, 0.f}; }));
+  RUBUS_CHECK(changed([](auto &s, auto &) { s.z = 1.f; }));
+  RUBUS_CHECK(changed([](auto &s, auto &) { s.color = 0xff0000ff; }));
+  RUBUS_CHECK(changed([](auto &s, auto &) { s.uv_rect = {0.f, 0.f, 0.5f, 0.5f}; }));
+  RUBUS_CHECK(changed([](auto &, auto &t) { t.handle = 2; }));
+  RUBUS_CHECK(changed([](auto &, auto &t) { t.uv_rect = {0.5f, 0.5f, 1.f, 1.f}; }));
+  RUBUS_CHECK(changed([](auto &, auto &t) { t.mesh.first_index = 6; }));
+  // only dirty forces a redraw, it is not part of what is drawn
+  RUBUS_CHECK(not changed([](auto &s, auto &) { s.dirty = true; }));
+
+  // another member in the same state is still a different member
+  const auto other = sprite;
+  RUBUS_CHECK(hash_of(other, texture) != base);
+}
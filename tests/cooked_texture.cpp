@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <rubus-engine/game/cooked_texture.hpp>
+#include <rubus-engine/game/ktx2.hpp>
+#include <rubus-engine/game/palette.hpp>
+#include "test.hpp"
+
+using rugame::TextureAlpha;
+
+namespace {
+
+// a cutout 6x3 image of two colors with a transparent first column, first row at the top
+auto make_image() -> std::vector<uint8_t> {
+  auto rgba = std::vector<uint8_t>(6 * 3 * 4);
+  for (auto y = 0; y < 3; ++y) {
+    for (auto x = 1; x < 6; ++x) {
+      const auto texel = rgba.data() + (y * 6 + x) * 4;
+      texel[0] = y == 0 ? 255 : 0;
+      texel[2] = y == 0 ? 0 : 255;
+      texel[3] = 255;
+    }
+  }
+  return rgba;
+}
+
+} // namespace
+
+RUBUS_TEST(cooked_texture, cook_and_parse) {
+  const auto image = make_image();
+  const auto data = rugame::cook_texture(image.data(), 6, 3, false, 8);
+  const auto cooked = rugame::parse_cooked_texture(data);
+  if (not RUBUS_CHECK(cooked.has_value())) {
+    return;
+  }
+  RUBUS_CHECK(cooked->header.width == 6 and cooked->header.height == 3);
+  RUBUS_CHECK(cooked->header.alpha == TextureAlpha::Cutout);
+  RUBUS_CHECK(cooked->levels.size() == 3);
+  RUBUS_CHECK(cooked->levels[1].width == 3 and cooked->levels[1].height == 1);
+  RUBUS_CHECK(cooked->levels[2].width == 1 and cooked->levels[2].height == 1);
+  for (auto i = size_t{}; i < cooked->levels.size(); ++i) {
+    RUBUS_CHECK(cooked->levels[i].offset % 64 == 0);
+  }
+
+  // the rows are stored from the bottom, the top row of the image is red
+  const auto base = cooked->level_data(0);
+  RUBUS_CHECK(std::memcmp(base, image.data() + 2 * 6 * 4, 6 * 4) == 0);
+  RUBUS_CHECK(std::memcmp(base + 2 * 6 * 4, image.data(), 6 * 4) == 0);
+
+  // the palette and indices match those of the stored base level
+  const auto indexed = rugame::index_image(base, 6, 3);
+  if (RUBUS_CHECK(indexed.has_value())) {
+    RUBUS_CHECK(std::vector<uint32_t>(cooked->palette.begin(), cooked->palette.end()) == indexed->palette);
+    RUBUS_CHECK(std::vector<uint8_t>(cooked->indices.begin(), cooked->indices.end()) == indexed->indices);
+  }
+  // the transparent column is trimmed away
+  RUBUS_CHECK(not cooked->outline.empty());
+  for (const auto &vertex : cooked->outline) {
+    RUBUS_CHECK(vertex.x >= 1.f / 6.f - 1e-5f);
+  }
+
+  // no outline without a budget
+  const auto untrimmed = rugame::cook_texture(image.data(), 6, 3, false, 0);
+  const auto parsed = rugame::parse_cooked_texture(untrimmed);
+  RUBUS_CHECK(parsed.has_value() and parsed->outline.empty());
+}
+
+RUBUS_TEST(cooked_texture, parse_rejects_bad_files) {
+  const auto image = make_image();
+  auto data = rugame::cook_texture(image.data(), 6, 3, false, 8);
+  RUBUS_CHECK(not rugame::parse_cooked_texture(std::span{data}.first(16)).has_value());
+  RUBUS_CHECK(not rugame::parse_cooked_texture(std::span{data}.first(data.size() - 1)).has_value());
+  data[0] = std::byte{0};
+  RUBUS_CHECK(not rugame::parse_cooked_texture(data).has_value());
+}
+
+RUBUS_TEST(cooked_texture, ktx2_round_trip) {
+  const auto image = make_image();
+  const auto compression = rugame::TextureCompression::Bc7;
+  auto levels = std::vector<std::vector<std::byte>>{};
+  levels.push_back(rugame::compress_texture_level(compression, image.data(), 6, 3));
+  levels.push_back(rugame::compress_texture_level(compression, image.data(), 3, 1));
+  levels.push_back(rugame::compress_texture_level(compression, image.data(), 1, 1));
+  const auto data = rugame::write_ktx2(compression, 6, 3, levels, TextureAlpha::Cutout, true);
+
+  const auto texture = rugame::parse_ktx2(data);
+  if (not RUBUS_CHECK(texture.has_value())) {
+    return;
+  }
+  RUBUS_CHECK(texture->compression == compression);
+  RUBUS_CHECK(texture->width == 6 and texture->height == 3);
+  RUBUS_CHECK(texture->bottom_up);
+  RUBUS_CHECK(texture->alpha == TextureAlpha::Cutout);
+  RUBUS_CHECK(texture->premultiplied);
+  if (RUBUS_CHECK(texture->levels.size() == levels.size())) {
+    for (auto i = size_t{}; i < levels.size(); ++i) {
+      const auto &level = texture->levels[i];
+      RUBUS_CHECK(std::vector<std::byte>(level.data.begin(), level.data.end()) == levels[i]);
+    }
+    RUBUS_CHECK(texture->levels[1].width == 3 and texture->levels[1].height == 1);
+  }
+
+  RUBUS_CHECK(not rugame::parse_ktx2(std::span{data}.first(data.size() - 1)).has_value());
+  RUBUS_CHECK(not rugame::parse_ktx2(std::span{data}.first(12)).has_value());
+}
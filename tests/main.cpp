@@ -0,0 +1,37 @@
+// runs the cases of tests/, all of them or those of the suites given on the command line:
+//
+//   rubus-tests [suite]...
+//
+// fails when a check failed or a suite has no cases.
+
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "test.hpp"
+
+auto main(int argc, char **argv) -> int {
+  const auto suites = std::vector<std::string_view>(argv + 1, argv + argc);
+  for (const auto suite : suites) {
+    if (std::ranges::none_of(test::cases(), [&](const test::Case &c) { return c.suite == suite; })) {
+      std::cerr << std::format("Error: no test suite {}\n", suite);
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto count = 0;
+  for (const auto &c : test::cases()) {
+    if (not suites.empty() and std::ranges::find(suites, c.suite) == suites.end()) {
+      continue;
+    }
+    const auto failures = test::failures;
+    c.run();
+    std::cout << std::format("{} {}.{}\n", test::failures == failures ? "ok  " : "FAIL", c.suite, c.name);
+    count += 1;
+  }
+  std::cout << std::format("{} tests, {} failed checks\n", count, test::failures);
+  return test::failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
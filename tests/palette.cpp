@@ -0,0 +1,50 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <rubus-engine/game/palette.hpp>
+#include "test.hpp"
+
+namespace {
+
+auto texel(uint8_t r, uint8_t g, uint8_t b, uint8_t a) -> uint32_t {
+  return (uint32_t)r | (uint32_t)g << 8 | (uint32_t)b << 16 | (uint32_t)a << 24;
+}
+
+auto to_rgba(const std::vector<uint32_t> &texels) -> std::vector<uint8_t> {
+  auto rgba = std::vector<uint8_t>(texels.size() * 4);
+  std::memcpy(rgba.data(), texels.data(), rgba.size());
+  return rgba;
+}
+
+} // namespace
+
+RUBUS_TEST(palette, index_image_round_trip) {
+  const auto red = texel(255, 0, 0, 255);
+  const auto blue = texel(0, 0, 255, 128);
+  // invisible texels of any color share index 0
+  const auto texels = std::vector<uint32_t>{red, texel(9, 9, 9, 0), blue, red, 0, blue};
+  const auto image = rugame::index_image(to_rgba(texels).data(), 3, 2);
+  if (not RUBUS_CHECK(image.has_value())) {
+    return;
+  }
+  RUBUS_CHECK(image->palette.size() == 3);
+  RUBUS_CHECK(image->palette[0] == 0);
+  RUBUS_CHECK(image->indices.size() == texels.size());
+  RUBUS_CHECK(image->indices[1] == 0 and image->indices[4] == 0);
+  for (auto i = size_t{}; i < texels.size(); ++i) {
+    const auto expected = (texels[i] >> 24) == 0 ? 0u : texels[i];
+    RUBUS_CHECK(image->palette[image->indices[i]] == expected);
+  }
+}
+
+RUBUS_TEST(palette, index_image_color_limit) {
+  // 255 opaque colors and transparent fill the palette, one more does not fit
+  auto texels = std::vector<uint32_t>{0};
+  for (auto i = 0; i < rugame::palette_size - 1; ++i) {
+    texels.push_back(texel((uint8_t)i, 1, 2, 255));
+  }
+  RUBUS_CHECK(rugame::index_image(to_rgba(texels).data(), (int)texels.size(), 1).has_value());
+  texels.push_back(texel(0, 0, 0, 255));
+  RUBUS_CHECK(not rugame::index_image(to_rgba(texels).data(), (int)texels.size(), 1).has_value());
+}
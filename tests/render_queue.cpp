@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <rubus-engine/game/render_queue.hpp>
+#include "test.hpp"
+
+using rugame::RenderQueue;
+
+RUBUS_TEST(render_queue, key_fields_order_by_significance) {
+  auto queue = RenderQueue{};
+  // layer first, then zorder, shader, texture and depth
+  RUBUS_CHECK(queue.make_key(0, 100, 255, 65535, 1.f) < queue.make_key(1, -100, 0, 0, 0.f));
+  RUBUS_CHECK(queue.make_key(0, 0, 255, 65535, 1.f) < queue.make_key(0, 1, 0, 0, 0.f));
+  RUBUS_CHECK(queue.make_key(0, 0, 0, 65535, 1.f) < queue.make_key(0, 0, 1, 0, 0.f));
+  RUBUS_CHECK(queue.make_key(0, 0, 0, 0, 1.f) < queue.make_key(0, 0, 0, 1, 0.f));
+}
+
+RUBUS_TEST(render_queue, signed_zorder_and_depth) {
+  auto queue = RenderQueue{};
+  RUBUS_CHECK(queue.make_key(0, -1, 0, 0, 0.f) < queue.make_key(0, 0, 0, 0, 0.f));
+  RUBUS_CHECK(queue.make_key(0, RenderQueue::min_zorder, 0, 0, 0.f) <
+              queue.make_key(0, RenderQueue::max_zorder, 0, 0, 0.f));
+
+  // depth keeps 20 bits of the float, values far enough apart keep their order across the sign
+  const auto depths = std::array{-1000.f, -1.f, -0.25f, 0.f, 0.25f, 1.f, 1000.f};
+  for (auto i = size_t{1}; i < depths.size(); ++i) {
+    RUBUS_CHECK(queue.make_key(0, 0, 0, 0, depths[i - 1]) < queue.make_key(0, 0, 0, 0, depths[i]));
+  }
+}
+
+RUBUS_TEST(render_queue, out_of_range_saturates) {
+  auto queue = RenderQueue{};
+  // saturated values tie with the bound but never wrap into the next field
+  RUBUS_CHECK(queue.make_key(200, 0, 0, 0, 0.f) == queue.make_key(RenderQueue::max_layer, 0, 0, 0, 0.f));
+  RUBUS_CHECK(queue.make_key(0, 100000, 0, 0, 0.f) == queue.make_key(0, RenderQueue::max_zorder, 0, 0, 0.f));
+  RUBUS_CHECK(queue.make_key(0, -100000, 0, 0, 0.f) == queue.make_key(0, RenderQueue::min_zorder, 0, 0, 0.f));
+  RUBUS_CHECK(queue.make_key(0, 100000, 0, 0, 0.f) < queue.make_key(1, RenderQueue::min_zorder, 0, 0, 0.f));
+}
+
+RUBUS_TEST(render_queue, out_of_range_is_counted_per_frame) {
+  // the first clamped key of a queue prints an error, every one of them is counted in the frame's stats
+  auto errors = std::ostringstream{};
+  const auto cerr = std::cerr.rdbuf(errors.rdbuf());
+  auto queue = RenderQueue{};
+  for (auto frame = 0; frame < 2; ++frame) {
+    queue.clear();
+    queue.push(queue.make_key(0, 100000, 0, 0, 0.f), 0);
+    queue.push(queue.make_key(0, 0, 0, 0, 0.f), 1);
+    queue.push(queue.make_key(200, 0, 0, 0, 0.f), 2);
+    queue.sort();
+    RUBUS_CHECK(queue.stats.clamped == 2 and queue.stats.items == 3);
+  }
+  queue.clear();
+  queue.push(queue.make_key(0, 0, 0, 0, 0.f), 0);
+  queue.sort();
+  RUBUS_CHECK(queue.stats.clamped == 0);
+  const auto first = errors.str();
+
+  // a new queue, e.g. of another scene, reports again
+  auto other = RenderQueue{};
+  other.make_key(0, -100000, 0, 0, 0.f);
+  std::cerr.rdbuf(cerr);
+  RUBUS_CHECK(std::ranges::count(first, '\n') == 1);
+  RUBUS_CHECK(std::ranges::count(errors.str(), '\n') == 2);
+}
+
+RUBUS_TEST(render_queue, sort_is_stable_and_ordered) {
+  auto random = std::mt19937{7};
+  auto zorder = std::uniform_int_distribution<int32_t>{-4, 4};
+  auto texture = std::uniform_int_distribution<uint32_t>{0, 3};
+  auto queue = RenderQueue{};
+  auto keys = std::vector<uint64_t>{};
+  // enough items for the radix sort, sorted again unchanged for the reused order
+  for (auto frame = 0; frame < 2; ++frame) {
+    queue.clear();
+    if (frame == 0) {
+      for (auto i = uint32_t{}; i < 5000; ++i) {
+        keys.push_back(queue.make_key(0, zorder(random), 0, texture(random), 0.f));
+      }
+    }
+    for (auto i = uint32_t{}; i < keys.size(); ++i) {
+      queue.push(keys[i], i);
+    }
+    queue.sort();
+
+    RUBUS_CHECK(queue.items.size() == keys.size());
+    for (auto i = size_t{1}; i < queue.items.size(); ++i) {
+      const auto &a = queue.items[i - 1];
+      const auto &b = queue.items[i];
+      RUBUS_CHECK(a.key < b.key or (a.key == b.key and a.index < b.index));
+    }
+  }
+  RUBUS_CHECK(queue.stats.reused_order);
+}
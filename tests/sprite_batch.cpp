@@ -0,0 +1,172 @@
+#include <cstdint>
+#include <vector>
+
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/null_device.hpp>
+#include <rubus-engine/game/resource.hpp>
+#include <rubus-engine/game/sprite_batch.hpp>
+#include "test.hpp"
+
+using rugame::BlendMode;
+using rugame::SpriteBatch;
+using rugame::TextureResource;
+
+namespace {
+
+// the batch draws on a null device, no shaders are loaded so every sprite shares program 0
+struct NullBatch {
+  graphics::NullDevice device;
+  SpriteBatch batch;
+
+  NullBatch() {
+    graphics::Device::set_current(&device);
+    batch.init();
+  }
+
+  ~NullBatch() {
+    batch.deinit();
+    rugame::ResourceManager::meshes.deinit();
+    graphics::Device::set_current(nullptr);
+  }
+};
+
+auto make_sprite(float x) -> rugame::Sprite {
+  auto sprite = rugame::Sprite{{0.5f, 0.5f}, 10.f, 20.f, rugame::SpriteMaterial{}};
+  sprite.transform = rugame::Affine2d::translate({x, 0.f});
+  return sprite;
+}
+
+auto make_texture(uint32_t handle, int32_t page = -1, glm::vec4 uv_rect = {0.f, 0.f, 1.f, 1.f}) -> TextureResource {
+  auto texture = TextureResource{};
+  texture.handle = handle;
+  texture.page = page;
+  texture.uv_rect = uv_rect;
+  return texture;
+}
+
+} // namespace
+
+RUBUS_TEST(sprite_batch, breaks_only_on_state_changes) {
+  auto null = NullBatch{};
+  auto &batch = null.batch;
+  const auto page = make_texture(1);
+  const auto atlased = make_texture(1, 0, {0.5f, 0.5f, 1.f, 1.f});
+  const auto other = make_texture(2);
+  auto sprites = std::vector<rugame::Sprite>{};
+  for (auto i = 0; i < 6; ++i) {
+    sprites.push_back(make_sprite((float)i));
+  }
+
+  batch.begin_frame();
+  batch.begin();
+  // images of one atlas page share a batch
+  batch.draw(&sprites[0], page);
+  batch.draw(&sprites[1], page);
+  batch.draw(&sprites[2], atlased);
+  batch.draw(&sprites[3], atlased);
+  batch.draw(&sprites[4], other);
+  batch.draw(&sprites[5], other, BlendMode::Opaque);
+  batch.end();
+  batch.end_frame();
+
+  RUBUS_CHECK(batch.last_stats.sprites == 6);
+  RUBUS_CHECK(batch.last_stats.draw_calls == 3);
+  RUBUS_CHECK(batch.last_stats.texture_breaks == 1);
+  RUBUS_CHECK(batch.last_stats.blend_breaks == 1);
+  RUBUS_CHECK(batch.last_stats.shader_breaks == 0 and batch.last_stats.mesh_breaks == 0);
+  if (RUBUS_CHECK(batch.batches.size() == 3)) {
+    RUBUS_CHECK(batch.batches[0].first_instance == 0 and batch.batches[0].instance_count == 4);
+    RUBUS_CHECK(batch.batches[1].first_instance == 4 and batch.batches[1].instance_count == 1);
+    RUBUS_CHECK(batch.batches[2].first_instance == 5 and batch.batches[2].instance_count == 1);
+  }
+
+  // the next frame starts over
+  batch.begin_frame();
+  batch.begin();
+  batch.end();
+  batch.end_frame();
+  RUBUS_CHECK(batch.last_stats.sprites == 0 and batch.last_stats.draw_calls == 0);
+}
+
+RUBUS_TEST(sprite_batch, instances) {
+  auto null = NullBatch{};
+  auto &batch = null.batch;
+  auto sprite = make_sprite(3.f);
+  sprite.uv_rect = {0.f, 0.f, 0.5f, 1.f};
+  sprite.color = 0x11223344;
+  const auto atlased = make_texture(1, 0, {0.5f, 0.5f, 1.f, 1.f});
+
+  batch.begin_frame();
+  batch.begin();
+  batch.draw(&sprite, atlased, BlendMode::Opaque, 0.25f);
+  batch.end();
+  batch.end_frame();
+
+  if (RUBUS_CHECK(batch.instances.size() == 1)) {
+    const auto &instance = batch.instances[0];
+    // pivot * size are the half extents
+    RUBUS_CHECK(instance.axes == glm::vec4{5.f, 0.f, 0.f, 10.f});
+    // the color as two exact 16 bit halves
+    RUBUS_CHECK(instance.center == glm::vec4{3.f, 0.f, (float)0x3344, (float)0x1122});
+    // the sprite uv rect mapped into the atlas region
+    RUBUS_CHECK(instance.uv_rect == glm::vec4{0.5f, 0.5f, 0.75f, 1.f});
+    // depth, the opaque alpha cutoff and no palette
+    RUBUS_CHECK(instance.params == glm::vec4{0.25f, 0.5f, 0.f, -1.f});
+  }
+}
+
+RUBUS_TEST(sprite_batch, stream_is_one_batch) {
+  auto null = NullBatch{};
+  auto &batch = null.batch;
+  auto stream = rugame::SpriteTransformStream{};
+  for (auto i = 0; i < 40; ++i) {
+    stream.push({(float)i, 0.f}, 0.f, {1.f, 1.f}, {0.5f, 0.5f}, 8.f, 8.f);
+  }
+  const auto texture = make_texture(1);
+
+  batch.begin_frame();
+  batch.begin();
+  batch.draw(stream, rugame::SpriteMaterial{}, texture, BlendMode::Alpha, 0.f, 0xff0000ff);
+  batch.end();
+  batch.end_frame();
+
+  RUBUS_CHECK(batch.last_stats.sprites == 40 and batch.last_stats.draw_calls == 1);
+  if (RUBUS_CHECK(batch.instances.size() == 40)) {
+    RUBUS_CHECK(batch.instances[39].center == glm::vec4{39.f, 0.f, (float)0x00ff, (float)0xff00});
+    RUBUS_CHECK(batch.instances[39].axes == glm::vec4{4.f, 0.f, 0.f, 4.f});
+  }
+}
+
+RUBUS_TEST(sprite_batch, passes_share_a_frame) {
+  auto null = NullBatch{};
+  auto &batch = null.batch;
+  const auto texture = make_texture(1);
+  auto sprites = std::vector<rugame::Sprite>(3000, make_sprite(0.f));
+  constexpr auto stride = sizeof(graphics::SpriteInstance);
+
+  // e.g. a cached layer and the main pass, one region per frame however many passes
+  batch.begin_frame();
+  for (auto pass = 0; pass < 2; ++pass) {
+    batch.begin();
+    for (auto i = 0; i < 2 + pass; ++i) {
+      batch.draw(&sprites[i], texture);
+    }
+    batch.end();
+  }
+  RUBUS_CHECK(batch.instance_buffer.region == 0 and batch.instance_buffer.head == 5 * stride);
+  batch.end_frame();
+  RUBUS_CHECK(batch.instance_buffer.region == 1);
+
+  // passes that overflow the region together grow the buffer to hold the whole frame
+  batch.begin_frame();
+  for (auto pass = 0; pass < 2; ++pass) {
+    batch.begin();
+    for (auto &sprite : sprites) {
+      batch.draw(&sprite, texture);
+    }
+    batch.end();
+  }
+  batch.end_frame();
+  RUBUS_CHECK(batch.instance_buffer.region_size >= 2 * sprites.size() * stride);
+  RUBUS_CHECK(batch.last_stats.sprites == sprites.size() and batch.last_stats.draw_calls == 1);
+}
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include <rubus-engine/game/sprite_transform.hpp>
+#include "test.hpp"
+
+namespace {
+
+auto close(float a, float b) -> bool {
+  return std::abs(a - b) <= 2e-4f * std::max(1.f, std::abs(b));
+}
+
+// every count from empty to a few full registers, so the simd loop and the scalar tail both run
+auto check_quads(size_t count, std::mt19937 &random) -> void {
+  auto position = std::uniform_real_distribution<float>{-2000.f, 2000.f};
+  // wide rotations, the polynomial has to reduce its range first
+  constexpr auto turns = 10.f * 2.f * std::numbers::pi_v<float>;
+  auto rotation = std::uniform_real_distribution<float>{-turns, turns};
+  auto scale = std::uniform_real_distribution<float>{-3.f, 3.f};
+  auto unit = std::uniform_real_distribution<float>{0.f, 1.f};
+  auto size = std::uniform_real_distribution<float>{1.f, 256.f};
+
+  auto stream = rugame::SpriteTransformStream{};
+  for (auto i = size_t{}; i < count; ++i) {
+    stream.push({position(random), position(random)}, rotation(random), {scale(random), scale(random)},
+                {unit(random), unit(random)}, size(random), size(random));
+  }
+  auto out = std::vector<graphics::SpriteInstance>(count);
+  for (auto &instance : out) {
+    instance.center = {0.f, 0.f, 7.f, 7.f};
+    instance.uv_rect = {0.25f, 0.5f, 0.75f, 1.f};
+  }
+  rugame::compute_sprite_quads(stream, out);
+
+  for (auto i = size_t{}; i < count; ++i) {
+    const auto sin = std::sin(stream.rotation[i]);
+    const auto cos = std::cos(stream.rotation[i]);
+    const auto half_x = stream.pivot_x[i] * stream.width[i] * stream.scale_x[i];
+    const auto half_y = stream.pivot_y[i] * stream.height[i] * stream.scale_y[i];
+    // relative to the largest half extent, the axes of a sprite share the rotation error
+    const auto extent = std::max({std::abs(half_x), std::abs(half_y), 1.f});
+    const auto &axes = out[i].axes;
+    RUBUS_CHECK(close(axes.x / extent, cos * half_x / extent));
+    RUBUS_CHECK(close(axes.y / extent, sin * half_x / extent));
+    RUBUS_CHECK(close(axes.z / extent, -sin * half_y / extent));
+    RUBUS_CHECK(close(axes.w / extent, cos * half_y / extent));
+    RUBUS_CHECK(out[i].center == glm::vec4{stream.position_x[i], stream.position_y[i], 0.f, 0.f});
+    RUBUS_CHECK(out[i].uv_rect == glm::vec4{0.25f, 0.5f, 0.75f, 1.f});
+  }
+}
+
+} // namespace
+
+RUBUS_TEST(sprite_transform, quads_match_scalar_math) {
+  auto random = std::mt19937{17};
+  for (auto count = size_t{}; count <= 35; ++count) {
+    check_quads(count, random);
+  }
+  check_quads(10007, random);
+}
+
+RUBUS_TEST(sprite_transform, exact_angles) {
+  auto stream = rugame::SpriteTransformStream{};
+  const auto quarter = std::numbers::pi_v<float> / 2.f;
+  for (auto i = 0; i < 19; ++i) {
+    stream.push({}, quarter * (float)(i % 4), {1.f, 1.f}, {0.5f, 0.5f}, 64.f, 32.f);
+  }
+  auto out = std::vector<graphics::SpriteInstance>(stream.size());
+  rugame::compute_sprite_quads(stream, out);
+  for (auto i = size_t{}; i < out.size(); ++i) {
+    const auto &axes = out[i].axes;
+    // axis_x has length 32 and axis_y 16, rotated by a quarter turn per step
+    constexpr float expected[4][4] = {{32, 0, 0, 16}, {0, 32, -16, 0}, {-32, 0, 0, -16}, {0, -32, 16, 0}};
+    const auto &e = expected[i % 4];
+    RUBUS_CHECK(std::abs(axes.x - e[0]) < 1e-3f and std::abs(axes.y - e[1]) < 1e-3f and
+                std::abs(axes.z - e[2]) < 1e-3f and std::abs(axes.w - e[3]) < 1e-3f);
+  }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// a minimal test runner for the gpu free code. RUBUS_TEST registers a case named "<suite>.<name>",
+// RUBUS_CHECK reports a failed condition with its location and lets the case go on. see tests/main.cpp
+
+#include <format>
+#include <iostream>
+#include <source_location>
+#include <string_view>
+#include <vector>
+
+namespace test {
+
+struct Case {
+  std::string_view suite;
+  std::string_view name;
+  void (*run)();
+};
+
+inline auto cases() -> std::vector<Case> & {
+  static auto all = std::vector<Case>{};
+  return all;
+}
+
+inline auto failures = 0;
+
+struct Register {
+  Register(std::string_view suite, std::string_view name, void (*run)()) {
+    cases().push_back({suite, name, run});
+  }
+};
+
+inline auto check(bool ok, std::string_view expression, std::source_location location = std::source_location::current())
+  -> bool {
+  if (not ok) {
+    std::cerr << std::format("Error: {}:{}: check failed: {}\n", location.file_name(), location.line(), expression);
+    failures += 1;
+  }
+  return ok;
+}
+
+} // namespace test
+
+#define RUBUS_TEST(suite, name)                                                                                      \
+  static auto suite##_##name() -> void;                                                                              \
+  static const auto suite##_##name##_register = test::Register{#suite, #name, suite##_##name};                       \
+  static auto suite##_##name() -> void
+
+#define RUBUS_CHECK(...) test::check((__VA_ARGS__), #__VA_ARGS__)
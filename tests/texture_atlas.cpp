@@ -0,0 +1,63 @@
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <rubus-engine/game/texture_atlas.hpp>
+#include "test.hpp"
+
+using rugame::AtlasRect;
+using rugame::SkylinePacker;
+
+namespace {
+
+auto overlap(const AtlasRect &a, const AtlasRect &b) -> bool {
+  return a.x < b.x + b.width and b.x < a.x + a.width and a.y < b.y + b.height and b.y < a.y + a.height;
+}
+
+} // namespace
+
+RUBUS_TEST(texture_atlas, packs_without_overlap) {
+  auto packer = SkylinePacker{};
+  packer.init(512, 512);
+  auto random = std::mt19937{3};
+  auto size = std::uniform_int_distribution<int>{4, 80};
+  auto rects = std::vector<AtlasRect>{};
+  auto area = int64_t{};
+  for (auto i = 0; i < 400; ++i) {
+    const auto width = size(random);
+    const auto height = size(random);
+    const auto rect = packer.pack(width, height);
+    if (not rect.has_value()) {
+      continue;
+    }
+    RUBUS_CHECK(rect->width == width and rect->height == height);
+    RUBUS_CHECK(rect->x >= 0 and rect->y >= 0 and rect->x + width <= 512 and rect->y + height <= 512);
+    for (const auto &other : rects) {
+      RUBUS_CHECK(not overlap(*rect, other));
+    }
+    rects.push_back(*rect);
+    area += (int64_t)width * height;
+  }
+  RUBUS_CHECK(packer.used_area == area);
+  // random sizes still fill most of the page before the first miss
+  RUBUS_CHECK(area > 512 * 512 / 2);
+}
+
+RUBUS_TEST(texture_atlas, fills_exactly_and_rejects) {
+  auto packer = SkylinePacker{};
+  packer.init(64, 64);
+  RUBUS_CHECK(not packer.pack(65, 1).has_value());
+  RUBUS_CHECK(not packer.pack(1, 65).has_value());
+  // sixteen 16x16 tiles fill the page, bottom left first
+  for (auto i = 0; i < 16; ++i) {
+    const auto rect = packer.pack(16, 16);
+    if (RUBUS_CHECK(rect.has_value())) {
+      RUBUS_CHECK(rect->x == i % 4 * 16 and rect->y == i / 4 * 16);
+    }
+  }
+  RUBUS_CHECK(packer.used_area == 64 * 64);
+  RUBUS_CHECK(not packer.pack(1, 1).has_value());
+
+  packer.init(64, 64);
+  RUBUS_CHECK(packer.used_area == 0 and packer.pack(64, 64).has_value());
+}
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <rubus-engine/utils/vfs.hpp>
+#include "test.hpp"
+
+namespace {
+
+auto round_trips(const std::vector<std::byte> &data) -> bool {
+  const auto compressed = utils::lz4_compress(data);
+  auto out = std::vector<std::byte>(data.size());
+  return utils::lz4_decompress(compressed, out) and out == data;
+}
+
+auto bytes(std::string_view text) -> std::vector<std::byte> {
+  const auto view = std::as_bytes(std::span{text});
+  return {view.begin(), view.end()};
+}
+
+auto write_file(const std::filesystem::path &path, std::span<const std::byte> data) -> void {
+  auto file = std::ofstream{path, std::ios::binary | std::ios::trunc};
+  file.write((const char *)data.data(), (std::streamsize)data.size());
+}
+
+auto read_file(const std::filesystem::path &path) -> std::vector<std::byte> {
+  auto file = std::ifstream{path, std::ios::binary};
+  const auto chars = std::vector<char>(std::istreambuf_iterator<char>{file}, {});
+  return std::vector<std::byte>((const std::byte *)chars.data(), (const std::byte *)chars.data() + chars.size());
+}
+
+} // namespace
+
+RUBUS_TEST(vfs, lz4_round_trip) {
+  auto random = std::mt19937{11};
+  auto byte = std::uniform_int_distribution<int>{0, 255};
+  auto noise = std::vector<std::byte>(100000);
+  for (auto &b : noise) {
+    b = (std::byte)byte(random);
+  }
+  // a repeated phrase with a random letter every few bytes, matches of every length and distance
+  constexpr auto phrase = std::string_view{"the quick brown fox jumps over the lazy dog. "};
+  auto text = std::vector<std::byte>(100000);
+  for (auto i = size_t{}; i < text.size(); ++i) {
+    text[i] = (std::byte)(i % 23 == 0 ? 'a' + byte(random) % 26 : phrase[i % phrase.size()]);
+  }
+
+  RUBUS_CHECK(round_trips({}));
+  RUBUS_CHECK(round_trips({std::byte{1}}));
+  RUBUS_CHECK(round_trips(std::vector<std::byte>(13, std::byte{7})));
+  RUBUS_CHECK(round_trips(std::vector<std::byte>(70000, std::byte{0})));
+  RUBUS_CHECK(round_trips(noise));
+  RUBUS_CHECK(round_trips(text));
+  RUBUS_CHECK(utils::lz4_compress(text).size() < text.size() / 2);
+}
+
+RUBUS_TEST(vfs, lz4_rejects_bad_input) {
+  auto data = std::vector<std::byte>(4096);
+  for (auto i = size_t{}; i < data.size(); ++i) {
+    data[i] = (std::byte)(i % 17);
+  }
+  const auto compressed = utils::lz4_compress(data);
+  auto out = std::vector<std::byte>(data.size());
+  // wrong sizes and truncated input fail instead of reading or writing out of bounds
+  auto shorter = std::vector<std::byte>(data.size() - 1);
+  auto longer = std::vector<std::byte>(data.size() + 1);
+  RUBUS_CHECK(not utils::lz4_decompress(compressed, shorter));
+  RUBUS_CHECK(not utils::lz4_decompress(compressed, longer));
+  RUBUS_CHECK(not utils::lz4_decompress(std::span{compressed}.first(compressed.size() / 2), out));
+}
+
+RUBUS_TEST(vfs, normalize_path) {
+  RUBUS_CHECK(utils::normalize_path("shaders\\sprite\\vert.glsl") == "shaders/sprite/vert.glsl");
+  RUBUS_CHECK(utils::normalize_path("./shaders/sprite/vert.glsl") == "shaders/sprite/vert.glsl");
+  RUBUS_CHECK(utils::hash_path(utils::normalize_path("./a/b")) == utils::hash_path("a/b"));
+}
+
+RUBUS_TEST(vfs, pack_round_trip_and_bad_tocs) {
+  const auto path = std::filesystem::temp_directory_path() / "rubus-tests-vfs.pack";
+  auto writer = utils::PackWriter{};
+  writer.add("a/hello.txt", bytes("hello"), false);
+  writer.add("b/text.txt", bytes(std::string(1000, 'x')), true);
+  RUBUS_CHECK(writer.write(path));
+
+  auto archive = utils::PackArchive{};
+  if (RUBUS_CHECK(archive.open(path))) {
+    const auto hello = archive.find("./a/hello.txt");
+    RUBUS_CHECK(hello.has_value() and std::ranges::equal(*hello, bytes("hello")));
+    const auto text = archive.find("b\\text.txt");
+    RUBUS_CHECK(text.has_value() and text->size() == 1000);
+    RUBUS_CHECK(not archive.find("c.txt").has_value());
+  }
+  archive.close();
+
+  // offsets that wrap when the size is added, and a file cut short, are rejected instead of read out of bounds
+  const auto pack = read_file(path);
+  auto header = utils::PackHeader{};
+  std::memcpy(&header, pack.data(), sizeof(header));
+  const auto broken = [&](auto &&patch) {
+    auto data = pack;
+    auto entry = utils::PackEntry{};
+    std::memcpy(&entry, data.data() + header.toc_offset, sizeof(entry));
+    auto copy = header;
+    patch(copy, entry, data);
+    std::memcpy(data.data(), &copy, sizeof(copy));
+    std::memcpy(data.data() + header.toc_offset, &entry, sizeof(entry));
+    write_file(path, data);
+    return not archive.open(path);
+  };
+  constexpr auto max = std::numeric_limits<uint64_t>::max();
+  RUBUS_CHECK(broken([](auto &, auto &entry, auto &) { entry.name_offset = std::numeric_limits<uint32_t>::max(); }));
+  RUBUS_CHECK(broken([](auto &, auto &entry, auto &) { entry.offset = max - entry.stored_size / 2; }));
+  RUBUS_CHECK(broken([](auto &header, auto &, auto &) { header.toc_offset = max / 64 * 64; }));
+  RUBUS_CHECK(broken([](auto &header, auto &, auto &) { header.names_offset = max; }));
+  RUBUS_CHECK(broken([](auto &header, auto &, auto &data) { data.resize(header.names_offset + 1); }));
+  RUBUS_CHECK(not broken([](auto &, auto &, auto &) {}));
+  archive.close();
+  std::filesystem::remove(path);
+}
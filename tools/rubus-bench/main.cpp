@@ -0,0 +1,253 @@
+// runs the sprite half of a scene (rugame::SpriteScene) without a window and reports what a frame costs: cpu time,
+// draw calls and device calls. the engine draws on a graphics::NullDevice, so neither a gpu nor a display is needed.
+//
+//   rubus-bench [--sprites <count>] [--frames <count>] [--size <width>x<height>] [--spread <factor>]
+//               [--opaque-pass] [--gpu-culling] [--backend null|soft|vulkan]
+//
+// run it from the source directory, the sprites show the images of assets/. they are scattered over `spread` times
+// the view from a fixed seed and a tenth of them moves every frame. --gpu-culling hands the opaque pass to the
+// SpriteCuller (and implies --opaque-pass), the null device runs no compute so it measures the cpu side of the cull:
+// streaming instances and building the indirect commands instead of batching. --backend soft rasterizes on the cpu
+// with graphics::SoftSpriteRenderer, --backend vulkan draws through graphics::VkSpriteRenderer into its offscreen
+// image (builds with RUBUS_VULKAN, runs on lavapipe without a gpu), the timings then include the rasterization or
+// waiting for the gpu. fails when a texture does not load or nothing was drawn.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/null_device.hpp>
+#include <rubus-engine/graphics/shader_cache.hpp>
+#include <rubus-engine/graphics/soft_sprite_renderer.hpp>
+#include <rubus-engine/graphics/sprite_backend.hpp>
+#include <rubus-engine/game/resource.hpp>
+#include <rubus-engine/game/sprite_scene.hpp>
+#if defined(RUBUS_VULKAN)
+#include <rubus-engine/graphics/vk_sprite_renderer.hpp>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto texture_paths = std::array{
+  "assets/character/human_warrior.png", "assets/character/human_priest.png", "assets/character/elf_archer.png",
+  "assets/character/elf_mage.png",      "assets/monster/green_dragon.png",   "assets/monster/red_dragon.png",
+  "assets/skill/attack_sword.png",      "assets/skill/attack_magic.png",     "assets/skill/skill_heal.png",
+  "assets/skill/skill_meteorite.png",
+};
+
+struct Options {
+  uint32_t sprites = 10000;
+  uint32_t frames = 120;
+  int width = 1920;
+  int height = 1080;
+  float spread = 1.f;
+  bool opaque_pass = false;
+  bool gpu_culling = false;
+  std::string backend = "null"; // the null gl device, or a graphics::SpriteBackend
+};
+
+struct FrameStats {
+  uint64_t cpu_ns = 0;
+  uint32_t draw_calls = 0;
+  uint32_t multi_draws = 0;
+  uint32_t backend_sprites = 0;
+  uint32_t device_calls = 0;
+};
+
+auto parse_options(int argc, char **argv, Options &options) -> bool {
+  for (auto i = 1; i < argc; ++i) {
+    const auto arg = std::string_view{argv[i]};
+    if (arg == "--sprites" and i + 1 < argc) {
+      options.sprites = (uint32_t)std::atoi(argv[++i]);
+    } else if (arg == "--frames" and i + 1 < argc) {
+      options.frames = (uint32_t)std::max(std::atoi(argv[++i]), 1);
+    } else if (arg == "--size" and i + 1 < argc) {
+      const auto size = std::string{argv[++i]};
+      const auto x = size.find('x');
+      if (x == std::string::npos) {
+        std::cerr << std::format("Error: bad size {}\n", size);
+        return false;
+      }
+      options.width = std::atoi(size.substr(0, x).c_str());
+      options.height = std::atoi(size.substr(x + 1).c_str());
+    } else if (arg == "--spread" and i + 1 < argc) {
+      options.spread = std::max((float)std::atof(argv[++i]), 0.f);
+    } else if (arg == "--opaque-pass") {
+      options.opaque_pass = true;
+    } else if (arg == "--gpu-culling") {
+      options.opaque_pass = true;
+      options.gpu_culling = true;
+    } else if (arg == "--backend" and i + 1 < argc) {
+      options.backend = argv[++i];
+    } else {
+      std::cerr << "usage: rubus-bench [--sprites <count>] [--frames <count>] [--size <width>x<height>] "
+                   "[--spread <factor>] [--opaque-pass] [--gpu-culling] [--backend null|soft|vulkan]\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+auto make_sprites(const Options &options, std::mt19937 &random) -> std::vector<rugame::Sprite> {
+  const auto half_width = 0.5f * options.spread * (float)options.width;
+  const auto half_height = 0.5f * options.spread * (float)options.height;
+  auto x = std::uniform_real_distribution<float>{-half_width, half_width};
+  auto y = std::uniform_real_distribution<float>{-half_height, half_height};
+  auto size = std::uniform_real_distribution<float>{24.f, 96.f};
+  auto texture = std::uniform_int_distribution<size_t>{0, texture_paths.size() - 1};
+  auto zorder = std::uniform_int_distribution<int32_t>{0, 7};
+
+  auto sprites = std::vector<rugame::Sprite>{};
+  sprites.reserve(options.sprites);
+  for (auto i = uint32_t{}; i < options.sprites; ++i) {
+    const auto extent = size(random);
+    auto &sprite = sprites.emplace_back(glm::vec2{0.5f, 0.5f}, extent, extent,
+                                        rugame::SpriteMaterial{texture_paths[texture(random)]});
+    sprite.transform = rugame::Affine2d::translate({x(random), y(random)});
+    sprite.zorder = zorder(random);
+  }
+  return sprites;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  auto options = Options{};
+  if (not parse_options(argc, argv, options)) {
+    return EXIT_FAILURE;
+  }
+
+  auto device = graphics::NullDevice{};
+  graphics::Device::set_current(&device);
+  // the null device has no program binaries to cache
+  graphics::ShaderCache::use_binary_cache = false;
+
+  // the gl side of the scene stays on the null device while a backend draws the sprites
+  auto soft = graphics::SoftSpriteRenderer{};
+#if defined(RUBUS_VULKAN)
+  auto vulkan = graphics::VkSpriteRenderer{};
+#endif
+  if (options.backend == "soft") {
+    soft.init();
+    graphics::SpriteBackend::active = &soft;
+  } else if (options.backend == "vulkan") {
+#if defined(RUBUS_VULKAN)
+    if (not vulkan.init(nullptr, (uint32_t)options.width, (uint32_t)options.height)) {
+      return EXIT_FAILURE;
+    }
+    graphics::SpriteBackend::active = &vulkan;
+#else
+    std::cerr << "Error: rubus-bench was built without RUBUS_VULKAN\n";
+    return EXIT_FAILURE;
+#endif
+  } else if (options.backend != "null") {
+    std::cerr << std::format("Error: unknown backend {}\n", options.backend);
+    return EXIT_FAILURE;
+  }
+  const auto backend_sprites = [&]() -> uint32_t {
+    if (graphics::SpriteBackend::active == &soft) {
+      return soft.last_stats.opaque + soft.last_stats.blended;
+    }
+#if defined(RUBUS_VULKAN)
+    if (graphics::SpriteBackend::active == &vulkan) {
+      return vulkan.last_stats.opaque + vulkan.last_stats.blended;
+    }
+#endif
+    return 0;
+  };
+
+  for (const auto path : texture_paths) {
+    rugame::ResourceManager::load_texture2d_pixel(path, path);
+    if (not rugame::ResourceManager::texture2d.contains(path)) {
+      return EXIT_FAILURE;
+    }
+  }
+  rugame::SpriteMaterial::init();
+
+  auto scene = rugame::SpriteScene{};
+  scene.init(options.width, options.height);
+  scene.opaque_pass = options.opaque_pass;
+  scene.gpu_culling = options.gpu_culling;
+
+  auto random = std::mt19937{1234};
+  auto sprites = make_sprites(options, random);
+  auto step = std::uniform_real_distribution<float>{-2.f, 2.f};
+  auto frames = std::vector<FrameStats>{};
+  frames.reserve(options.frames);
+  for (auto frame = uint32_t{}; frame < options.frames; ++frame) {
+    device.reset();
+    const auto start = Clock::now();
+
+    for (auto i = frame % 10; i < sprites.size(); i += 10) {
+      sprites[i].transform.translation += glm::vec2{step(random), step(random)};
+    }
+    scene.update(1.0 / 60.0);
+    for (auto &sprite : sprites) {
+      scene.sprites.push_back(&sprite);
+    }
+    if (graphics::SpriteBackend::active != nullptr) {
+      scene.render_sprites_backend();
+    } else {
+      scene.render_sprites();
+    }
+
+    const auto cpu_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    frames.push_back({cpu_ns, scene.sprite_batch.last_stats.draw_calls, scene.sprite_culler.last_stats.multi_draws,
+                      backend_sprites(), device.total_calls()});
+  }
+
+  scene.deinit();
+  rugame::ResourceManager::unload_texture2d_all();
+  if (graphics::SpriteBackend::active == &soft) {
+    graphics::SpriteBackend::active = nullptr;
+    soft.deinit();
+  }
+#if defined(RUBUS_VULKAN)
+  vulkan.deinit();
+#endif
+  rugame::SpriteMaterial::deinit();
+  rugame::Camera2d::deinit();
+  rugame::ResourceManager::meshes.deinit();
+  graphics::ShaderCache::deinit();
+  graphics::Device::set_current(nullptr);
+
+  // the first frame sorts from scratch and uploads the meshes, it is reported but not averaged
+  const auto ms = [](uint64_t ns) { return (double)ns / 1e6; };
+  auto total_ns = uint64_t{};
+  auto min_ns = std::numeric_limits<uint64_t>::max();
+  auto max_ns = uint64_t{};
+  for (auto i = frames.size() > 1 ? size_t{1} : size_t{}; i < frames.size(); ++i) {
+    total_ns += frames[i].cpu_ns;
+    min_ns = std::min(min_ns, frames[i].cpu_ns);
+    max_ns = std::max(max_ns, frames[i].cpu_ns);
+  }
+  const auto averaged = frames.size() > 1 ? frames.size() - 1 : frames.size();
+  const auto &last = frames.back();
+  const auto pass = options.gpu_culling ? ", gpu culled opaque pass" : options.opaque_pass ? ", opaque pass" : "";
+  std::cout << std::format("{} sprites over {}x the view, {} frames at {}x{} on the {} {}{}\n", options.sprites,
+                           options.spread, options.frames, options.width, options.height,
+                           options.backend == "null" ? device.name() : options.backend,
+                           options.backend == "null" ? "device" : "backend", pass);
+  std::cout << std::format("first frame {:.3f} ms, then avg {:.3f} ms, min {:.3f} ms, max {:.3f} ms\n",
+                           ms(frames.front().cpu_ns), ms(total_ns / averaged), ms(min_ns), ms(max_ns));
+  if (options.backend == "null") {
+    std::cout << std::format("{} draw calls, {} indirect multi draws, {} device calls per frame\n", last.draw_calls,
+                             last.multi_draws, last.device_calls);
+  } else {
+    std::cout << std::format("{} sprites drawn by the backend per frame\n", last.backend_sprites);
+  }
+  const auto drawn = last.draw_calls + last.multi_draws + last.backend_sprites;
+  return options.sprites == 0 or drawn > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+// cooks images into gpu ready textures (.rtex) for ResourceManager::load_texture2d_cooked: pre-flipped rgba8 rows,
+// the whole mip chain, the trimmed outline and the palette indices, so loading skips image decoding, mip generation
+// and deriving anything from the texels. --trim is the vertex budget of the outline (8, 0 keeps the full quad).
+//
+//   rubus-cook <output dir> [--base <dir>] [--premultiply] [--trim <vertices>] [--compress <bc7,bc3,etc2>]
+//              <image or directory>...
+//
+// every image is written to the output directory under its path relative to the base directory (the current one)
+// with the extension replaced, assets/bg/plains.png becomes <output dir>/assets/bg/plains.rtex.
+// --compress also writes a block compressed ktx2 per format (assets/bg/plains.bc7.ktx2, ...), loads with
+// TextureOptions::compressed take the first one the context supports. compression is lossy, meant for large images
+// rather than pixel art.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <stb_image.h>
+
+#include <rubus-engine/game/block_compression.hpp>
+#include <rubus-engine/game/cooked_texture.hpp>
+
+namespace {
+
+auto is_image(const std::filesystem::path &path) -> bool {
+  auto extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+  return extension == ".png" or extension == ".jpg" or extension == ".jpeg" or extension == ".tga" or
+         extension == ".bmp";
+}
+
+auto write_file(const std::filesystem::path &target, const std::vector<std::byte> &data) -> bool {
+  auto ec = std::error_code{};
+  std::filesystem::create_directories(target.parent_path(), ec);
+  auto fs = std::ofstream{target, std::ios::binary | std::ios::trunc};
+  if (not fs) {
+    std::cerr << std::format("Error: could not write {}\n", target.string());
+    return false;
+  }
+  fs.write((const char *)data.data(), (std::streamsize)data.size());
+  return (bool)fs;
+}
+
+auto cook(const std::filesystem::path &path, const std::filesystem::path &base, const std::filesystem::path &output,
+          bool premultiply, uint32_t trim_vertices, const std::vector<rugame::TextureCompression> &compressions)
+  -> bool {
+  auto width = 0;
+  auto height = 0;
+  auto channels = 0;
+  auto data = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+  if (data == nullptr) {
+    std::cerr << std::format("Error: failed to load image {}\n", path.string());
+    return false;
+  }
+  const auto target = output / std::filesystem::relative(path, base);
+  auto ok = write_file(std::filesystem::path{target}.replace_extension(".rtex"),
+                       rugame::cook_texture(data, width, height, premultiply, trim_vertices));
+  for (const auto compression : compressions) {
+    const auto extension = std::format(".{}.ktx2", rugame::texture_compression_name(compression));
+    ok = ok and write_file(std::filesystem::path{target}.replace_extension(extension),
+                           rugame::cook_compressed_texture(data, width, height, premultiply, compression));
+  }
+  stbi_image_free(data);
+  return ok;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  auto output = std::filesystem::path{};
+  auto base = std::filesystem::current_path();
+  auto premultiply = false;
+  auto trim_vertices = uint32_t{8};
+  auto compressions = std::vector<rugame::TextureCompression>{};
+  auto inputs = std::vector<std::filesystem::path>{};
+  for (auto i = 1; i < argc; ++i) {
+    const auto arg = std::string_view{argv[i]};
+    if (arg == "--base" and i + 1 < argc) {
+      base = std::filesystem::absolute(argv[++i]);
+    } else if (arg == "--premultiply") {
+      premultiply = true;
+    } else if (arg == "--trim" and i + 1 < argc) {
+      trim_vertices = (uint32_t)std::max(std::atoi(argv[++i]), 0);
+    } else if (arg == "--compress" and i + 1 < argc) {
+      auto names = std::string_view{argv[++i]};
+      while (not names.empty()) {
+        const auto name = names.substr(0, names.find(','));
+        names.remove_prefix(std::min(name.size() + 1, names.size()));
+        const auto compression = rugame::parse_texture_compression(name);
+        if (compression == rugame::TextureCompression::None) {
+          std::cerr << std::format("Error: unknown compression {}\n", name);
+          return EXIT_FAILURE;
+        }
+        compressions.push_back(compression);
+      }
+    } else if (output.empty()) {
+      output = arg;
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+  if (output.empty() or inputs.empty()) {
+    std::cerr << "usage: rubus-cook <output dir> [--base <dir>] [--premultiply] [--trim <vertices>] "
+                 "[--compress <bc7,bc3,etc2>] <image or directory>...\n";
+    return EXIT_FAILURE;
+  }
+
+  auto count = 0;
+  for (const auto &input : inputs) {
+    const auto path = input.is_absolute() ? input : base / input;
+    if (not std::filesystem::is_directory(path)) {
+      if (not cook(path, base, output, premultiply, trim_vertices, compressions)) {
+        return EXIT_FAILURE;
+      }
+      count += 1;
+      continue;
+    }
+    for (const auto &entry : std::filesystem::recursive_directory_iterator{path}) {
+      if (entry.is_regular_file() and is_image(entry.path())) {
+        if (not cook(entry.path(), base, output, premultiply, trim_vertices, compressions)) {
+          return EXIT_FAILURE;
+        }
+        count += 1;
+      }
+    }
+  }
+  std::cout << std::format("Cooked {} textures into {}\n", count, output.string());
+  return EXIT_SUCCESS;
+}
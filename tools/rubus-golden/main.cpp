@@ -0,0 +1,310 @@
+// draws one fixed sprite scene through the gl path (on a headless egl context) and through
+// graphics::SoftSpriteRenderer, and compares the two images. the software renderer follows the gl state of the
+// sprite passes, so besides rounding in the blend they have to agree.
+//
+//   rubus-golden [--size <width>x<height>] [--opaque-pass] [--tolerance <fraction>] [--output <directory>]
+//
+// run it from the source directory, the sprites show the images of assets/. sprites are magnified by whole
+// numbers to even sizes and centered on whole pixels, so both paths sample the base level with nearest filtering
+// and the edges never depend on the rasterization rules. fails when more than `tolerance` of the pixels (0.001) differ by more
+// than one step in a channel. --output writes gl.ppm, soft.ppm and diff.ppm into the directory.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glad/glad.h>
+
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/gl_device.hpp>
+#include <rubus-engine/graphics/shader_cache.hpp>
+#include <rubus-engine/graphics/soft_sprite_renderer.hpp>
+#include <rubus-engine/graphics/sprite_backend.hpp>
+#include <rubus-engine/game/resource.hpp>
+#include <rubus-engine/game/sprite_scene.hpp>
+
+namespace {
+
+struct SpriteImage {
+  const char *path;
+  float scale; // whole multiple of the image size
+};
+
+constexpr auto background_paths = std::array{
+  "assets/bg/plains-sheet1.png",
+  "assets/bg/plains-sheet2.png",
+  "assets/bg/plains-sheet3.png",
+  "assets/bg/plains-sheet4.png",
+};
+
+constexpr auto sprite_images = std::array{
+  SpriteImage{"assets/character/human_warrior.png", 4.f}, SpriteImage{"assets/character/elf_archer.png", 4.f},
+  SpriteImage{"assets/character/elf_mage.png", 4.f},      SpriteImage{"assets/monster/green_dragon.png", 6.f},
+  SpriteImage{"assets/monster/red_dragon.png", 6.f},      SpriteImage{"assets/skill/attack_sword.png", 2.f},
+  SpriteImage{"assets/skill/skill_heal.png", 2.f},        SpriteImage{"assets/skill/skill_meteorite.png", 3.f},
+};
+
+constexpr auto sprite_count = 64;
+
+struct Options {
+  int width = 640;
+  int height = 360;
+  bool opaque_pass = false;
+  double tolerance = 0.001;
+  std::filesystem::path output;
+};
+
+auto parse_options(int argc, char **argv, Options &options) -> bool {
+  for (auto i = 1; i < argc; ++i) {
+    const auto arg = std::string_view{argv[i]};
+    if (arg == "--size" and i + 1 < argc) {
+      const auto size = std::string{argv[++i]};
+      const auto x = size.find('x');
+      if (x == std::string::npos) {
+        std::cerr << std::format("Error: bad size {}\n", size);
+        return false;
+      }
+      // even, so the view center falls on a pixel corner
+      options.width = std::atoi(size.substr(0, x).c_str()) / 2 * 2;
+      options.height = std::atoi(size.substr(x + 1).c_str()) / 2 * 2;
+    } else if (arg == "--opaque-pass") {
+      options.opaque_pass = true;
+    } else if (arg == "--tolerance" and i + 1 < argc) {
+      options.tolerance = std::atof(argv[++i]);
+    } else if (arg == "--output" and i + 1 < argc) {
+      options.output = argv[++i];
+    } else {
+      std::cerr << "usage: rubus-golden [--size <width>x<height>] [--opaque-pass] [--tolerance <fraction>] "
+                   "[--output <directory>]\n";
+      return false;
+    }
+  }
+  return options.width > 0 and options.height > 0;
+}
+
+auto create_context(int width, int height) -> bool {
+  const auto get_platform_display =
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  auto display = get_platform_display != nullptr
+                   ? get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+                   : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display == EGL_NO_DISPLAY or not eglInitialize(display, nullptr, nullptr)) {
+    std::cerr << "Error: no egl display\n";
+    return false;
+  }
+  eglBindAPI(EGL_OPENGL_API);
+
+  // the scene draws into the default framebuffer, a pbuffer stands in for the window
+  const EGLint config_attribs[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_RED_SIZE,     8,
+    EGL_GREEN_SIZE,   8,               EGL_BLUE_SIZE,       8,              EGL_ALPHA_SIZE,   8,
+    EGL_DEPTH_SIZE,   24,              EGL_STENCIL_SIZE,    8,              EGL_NONE,
+  };
+  auto config = EGLConfig{};
+  auto config_count = EGLint{};
+  if (not eglChooseConfig(display, config_attribs, &config, 1, &config_count) or config_count == 0) {
+    std::cerr << "Error: no egl config with an rgba8 pbuffer\n";
+    return false;
+  }
+  const EGLint surface_attribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+  const auto surface = eglCreatePbufferSurface(display, config, surface_attribs);
+
+  const EGLint context_attribs[] = {
+    EGL_CONTEXT_MAJOR_VERSION,
+    4,
+    EGL_CONTEXT_MINOR_VERSION,
+    5,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK,
+    EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_NONE,
+  };
+  const auto context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+  if (surface == EGL_NO_SURFACE or context == EGL_NO_CONTEXT or
+      not eglMakeCurrent(display, surface, surface, context)) {
+    std::cerr << "Error: could not create a headless opengl 4.5 context\n";
+    return false;
+  }
+  if (not gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+    std::cerr << "Error: could not load opengl\n";
+    return false;
+  }
+  return true;
+}
+
+auto load_textures() -> bool {
+  for (const auto path : background_paths) {
+    rugame::ResourceManager::load_texture2d_pixel(path, path);
+    if (not rugame::ResourceManager::texture2d.contains(path)) {
+      return false;
+    }
+  }
+  for (const auto &image : sprite_images) {
+    rugame::ResourceManager::load_texture2d_pixel(image.path, image.path);
+    if (not rugame::ResourceManager::texture2d.contains(image.path)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// the backgrounds fill the view behind, the sprites are scattered in front, every one on its own zorder so the
+// order never depends on how a path keys its textures
+auto make_sprites(const Options &options) -> std::vector<rugame::Sprite> {
+  auto sprites = std::vector<rugame::Sprite>{};
+  sprites.reserve(background_paths.size() + sprite_count);
+  for (auto i = size_t{}; i < background_paths.size(); ++i) {
+    const auto &texture = rugame::ResourceManager::texture2d.at(background_paths[i]);
+    const auto scale = std::max(std::ceil((float)options.width / (float)texture.width),
+                                std::ceil((float)options.height / (float)texture.height));
+    auto &sprite = sprites.emplace_back(glm::vec2{0.5f, 0.5f}, scale * (float)texture.width,
+                                        scale * (float)texture.height, rugame::SpriteMaterial{background_paths[i]});
+    sprite.zorder = -(int32_t)(background_paths.size() - i);
+  }
+
+  auto random = std::mt19937{1234};
+  auto image = std::uniform_int_distribution<size_t>{0, sprite_images.size() - 1};
+  auto x = std::uniform_int_distribution<int>{-options.width / 2, options.width / 2};
+  auto y = std::uniform_int_distribution<int>{-options.height / 2, options.height / 2};
+  for (auto i = 0; i < sprite_count; ++i) {
+    const auto &sprite_image = sprite_images[image(random)];
+    const auto &texture = rugame::ResourceManager::texture2d.at(sprite_image.path);
+    auto &sprite =
+      sprites.emplace_back(glm::vec2{0.5f, 0.5f}, sprite_image.scale * (float)texture.width,
+                           sprite_image.scale * (float)texture.height, rugame::SpriteMaterial{sprite_image.path});
+    sprite.transform = rugame::Affine2d::translate({(float)x(random), (float)y(random)});
+    sprite.zorder = i;
+  }
+  return sprites;
+}
+
+// rgba8 rows from the top
+auto render(const Options &options, bool software) -> std::vector<uint32_t> {
+  auto scene = rugame::SpriteScene{};
+  scene.init(options.width, options.height);
+  scene.opaque_pass = options.opaque_pass;
+  scene.update(0.0);
+
+  auto sprites = make_sprites(options);
+  for (auto &sprite : sprites) {
+    scene.sprites.push_back(&sprite);
+  }
+
+  auto pixels = std::vector<uint32_t>((size_t)options.width * options.height);
+  if (software) {
+    scene.render_sprites_backend();
+    static_cast<graphics::SoftSpriteRenderer *>(graphics::SpriteBackend::active)->read_pixels(pixels);
+  } else {
+    scene.render_sprites();
+    glFinish();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, options.width, options.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    // gl reads from the bottom
+    for (auto row = 0; row < options.height / 2; ++row) {
+      std::swap_ranges(pixels.begin() + (ptrdiff_t)row * options.width,
+                       pixels.begin() + (ptrdiff_t)(row + 1) * options.width,
+                       pixels.begin() + (ptrdiff_t)(options.height - 1 - row) * options.width);
+    }
+  }
+  scene.deinit();
+  return pixels;
+}
+
+auto write_ppm(const std::filesystem::path &path, const std::vector<uint32_t> &pixels, int width, int height)
+  -> void {
+  auto file = std::ofstream{path, std::ios::binary};
+  file << std::format("P6\n{} {}\n255\n", width, height);
+  for (const auto pixel : pixels) {
+    const auto rgb = std::array<char, 3>{(char)(pixel & 0xff), (char)((pixel >> 8) & 0xff),
+                                         (char)((pixel >> 16) & 0xff)};
+    file.write(rgb.data(), rgb.size());
+  }
+}
+
+auto channel_difference(uint32_t a, uint32_t b) -> int {
+  auto difference = 0;
+  for (auto shift = 0; shift < 32; shift += 8) {
+    difference = std::max(difference, std::abs((int)((a >> shift) & 0xff) - (int)((b >> shift) & 0xff)));
+  }
+  return difference;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  auto options = Options{};
+  if (not parse_options(argc, argv, options) or not create_context(options.width, options.height)) {
+    return EXIT_FAILURE;
+  }
+
+  auto device = graphics::GlDevice{};
+  graphics::Device::set_current(&device);
+  graphics::ShaderCache::use_binary_cache = false;
+  std::cout << std::format("Comparing the gl path on {} with the software renderer at {}x{}{}\n",
+                           device.get_string(GL_RENDERER), options.width, options.height,
+                           options.opaque_pass ? ", opaque pass" : "");
+
+  // gl first, the textures go to the atlas and the gl path
+  if (not load_textures()) {
+    return EXIT_FAILURE;
+  }
+  const auto gl_pixels = render(options, false);
+  rugame::ResourceManager::unload_texture2d_all();
+
+  // then the same images as textures of the software renderer
+  auto soft = graphics::SoftSpriteRenderer{};
+  soft.init();
+  graphics::SpriteBackend::active = &soft;
+  if (not load_textures()) {
+    return EXIT_FAILURE;
+  }
+  const auto soft_pixels = render(options, true);
+  rugame::ResourceManager::unload_texture2d_all();
+  graphics::SpriteBackend::active = nullptr;
+  soft.deinit();
+
+  rugame::SpriteMaterial::deinit();
+  rugame::Camera2d::deinit();
+  rugame::ResourceManager::meshes.deinit();
+  graphics::ShaderCache::deinit();
+  graphics::Device::set_current(nullptr);
+
+  auto mismatched = size_t{};
+  auto max_difference = 0;
+  auto diff = std::vector<uint32_t>(gl_pixels.size());
+  for (auto i = size_t{}; i < gl_pixels.size(); ++i) {
+    const auto difference = channel_difference(gl_pixels[i], soft_pixels[i]);
+    max_difference = std::max(max_difference, difference);
+    mismatched += difference > 1 ? 1 : 0;
+    diff[i] = difference > 1 ? 0xff0000ffu : 0xff000000u | (gl_pixels[i] & 0xfefefe) >> 1;
+  }
+
+  if (not options.output.empty()) {
+    std::filesystem::create_directories(options.output);
+    write_ppm(options.output / "gl.ppm", gl_pixels, options.width, options.height);
+    write_ppm(options.output / "soft.ppm", soft_pixels, options.width, options.height);
+    write_ppm(options.output / "diff.ppm", diff, options.width, options.height);
+  }
+
+  const auto fraction = (double)mismatched / (double)gl_pixels.size();
+  std::cout << std::format("{} of {} pixels differ ({:.4f}%), by at most {}\n", mismatched, gl_pixels.size(),
+                           fraction * 100.0, max_difference);
+  if (fraction > options.tolerance) {
+    std::cerr << std::format("Error: the software renderer differs from gl in more than {}% of the pixels\n",
+                             options.tolerance * 100.0);
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+// builds a pack archive for utils::Vfs out of files and directories.
+//
+//   rubus-pack <output> [--base <dir>] [--store] <file or directory>...
+//
+// entries are named by their path relative to the base directory (the current one), the way the engine opens
+// them. --base applies to the inputs after it, so trees from several roots (sources, cooked output) can be merged.
+// files are lz4 compressed unless --store is given, they are already compressed (png, jpg) or they are cooked
+// textures (rtex, ktx2), which are uploaded straight from the mapping.
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <rubus-engine/utils/vfs.hpp>
+
+namespace {
+
+auto store_as_is(const std::filesystem::path &path) -> bool {
+  auto extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower(c); });
+  return extension == ".png" or extension == ".jpg" or extension == ".jpeg" or extension == ".rpak" or
+         extension == ".rtex" or extension == ".ktx2";
+}
+
+auto add_file(utils::PackWriter &writer, const std::filesystem::path &path, const std::filesystem::path &base,
+              bool store) -> bool {
+  auto fs = std::ifstream{path, std::ios::binary};
+  if (not fs) {
+    std::cerr << std::format("Error: could not open {}\n", path.string());
+    return false;
+  }
+  auto data = std::vector<std::byte>(std::filesystem::file_size(path));
+  fs.read((char *)data.data(), (std::streamsize)data.size());
+
+  const auto name = std::filesystem::relative(path, base).generic_string();
+  writer.add(name, std::move(data), not store and not store_as_is(path));
+  return true;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  auto output = std::filesystem::path{};
+  auto base = std::filesystem::current_path();
+  auto store = false;
+  auto inputs = std::vector<std::pair<std::filesystem::path, std::filesystem::path>>{}; // base, input
+  for (auto i = 1; i < argc; ++i) {
+    const auto arg = std::string_view{argv[i]};
+    if (arg == "--base" and i + 1 < argc) {
+      base = std::filesystem::absolute(argv[++i]);
+    } else if (arg == "--store") {
+      store = true;
+    } else if (output.empty()) {
+      output = arg;
+    } else {
+      inputs.push_back({base, arg});
+    }
+  }
+  if (output.empty() or inputs.empty()) {
+    std::cerr << "usage: rubus-pack <output> [--base <dir>] [--store] <file or directory>...\n";
+    return EXIT_FAILURE;
+  }
+
+  auto writer = utils::PackWriter{};
+  for (const auto &[root, input] : inputs) {
+    // relative inputs are found under their base directory
+    const auto path = input.is_absolute() ? input : root / input;
+    if (not std::filesystem::is_directory(path)) {
+      if (not add_file(writer, path, root, store)) {
+        return EXIT_FAILURE;
+      }
+      continue;
+    }
+    for (const auto &entry : std::filesystem::recursive_directory_iterator{path}) {
+      if (entry.is_regular_file() and not add_file(writer, entry.path(), root, store)) {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // sorted so the archive only changes when the files do
+  std::sort(writer.files.begin(), writer.files.end(), [](const auto &a, const auto &b) { return a.name < b.name; });
+  if (not writer.write(output)) {
+    return EXIT_FAILURE;
+  }
+
+  auto size = size_t{};
+  for (const auto &file : writer.files) {
+    size += file.data.size();
+  }
+  std::cout << std::format("Packed {} files, {} bytes into {} ({} bytes)\n", writer.files.size(), size,
+                           output.string(), std::filesystem::file_size(output));
+  return EXIT_SUCCESS;
+}
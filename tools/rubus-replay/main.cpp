@@ -0,0 +1,826 @@
+// replays a device call trace written by graphics::CaptureDevice on a headless egl context and reports how long
+// every call and every frame took.
+//
+//   rubus-replay <trace> [--size <width>x<height>]
+//
+// the window framebuffer of the capture is replaced by an offscreen target of the given size (1920x1080).
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glad/glad.h>
+
+#include <rubus-engine/graphics/device.hpp>
+#include <rubus-engine/graphics/gl_device.hpp>
+#include <rubus-engine/graphics/trace.hpp>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto mapped_write_slot = (size_t)graphics::DeviceCall::Count;
+
+struct CallStats {
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+};
+
+struct FrameStats {
+  uint64_t calls = 0;
+  uint64_t call_ns = 0;   // time spent inside device calls
+  uint64_t finish_ns = 0; // glFinish at the end of the frame, the gpu work still queued
+  uint64_t wall_ns = 0;
+};
+
+struct Replayer {
+  graphics::GlDevice device;
+  int32_t width = 1920;
+  int32_t height = 1080;
+
+  // names of the capture to names of the replay
+  std::unordered_map<uint32_t, uint32_t> buffers;
+  std::unordered_map<uint32_t, uint32_t> textures;
+  std::unordered_map<uint32_t, uint32_t> framebuffers;
+  std::unordered_map<uint32_t, uint32_t> renderbuffers;
+  std::unordered_map<uint32_t, uint32_t> vertex_arrays;
+  std::unordered_map<uint32_t, uint32_t> shaders;
+  std::unordered_map<uint32_t, uint32_t> programs;
+  std::unordered_map<uint32_t, graphics::Fence> fences;
+  std::unordered_map<uint32_t, std::byte *> mapped;
+  // keyed by captured program << 32 | captured location or block index
+  std::unordered_map<uint64_t, int32_t> locations;
+  std::unordered_map<uint64_t, uint32_t> block_indices;
+  uint32_t program = 0; // captured program in use
+
+  uint32_t window_framebuffer = 0;
+  std::array<CallStats, mapped_write_slot + 1> calls = {};
+  std::vector<FrameStats> frames;
+  FrameStats frame;
+  Clock::time_point frame_start;
+
+  auto init() -> void;
+  auto run(graphics::TraceReader &reader) -> bool;
+  auto report() const -> void;
+
+private:
+  auto replay(graphics::TraceReader &reader, uint8_t op) -> bool;
+  auto end_frame() -> void;
+
+  template <typename F>
+  auto timed(size_t slot, F &&fn) -> void {
+    const auto start = Clock::now();
+    fn();
+    const auto ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    auto &stats = calls[slot];
+    stats.count += 1;
+    stats.total_ns += ns;
+    stats.max_ns = std::max(stats.max_ns, ns);
+    frame.calls += 1;
+    frame.call_ns += ns;
+  }
+};
+
+auto lookup(const std::unordered_map<uint32_t, uint32_t> &names, uint32_t name) -> uint32_t {
+  const auto it = names.find(name);
+  return it == names.end() ? 0 : it->second;
+}
+
+auto key(uint32_t program, uint32_t value) -> uint64_t {
+  return (uint64_t)program << 32 | value;
+}
+
+auto Replayer::init() -> void {
+  // stands in for the window of the capture
+  const auto color = device.create_texture();
+  device.texture_storage(color, 1, GL_RGBA8, width, height);
+  const auto depth = device.create_renderbuffer(GL_DEPTH24_STENCIL8, width, height);
+  window_framebuffer = device.create_framebuffer();
+  device.framebuffer_texture(window_framebuffer, GL_COLOR_ATTACHMENT0, color);
+  device.framebuffer_renderbuffer(window_framebuffer, GL_DEPTH_STENCIL_ATTACHMENT, depth);
+  framebuffers[0] = window_framebuffer;
+  device.bind_framebuffer(GL_FRAMEBUFFER, window_framebuffer);
+  frame_start = Clock::now();
+}
+
+auto Replayer::run(graphics::TraceReader &reader) -> bool {
+  if (reader.get<uint32_t>() != graphics::trace_magic) {
+    std::cerr << "Error: not a rubus trace\n";
+    return false;
+  }
+  if (const auto version = reader.get<uint32_t>(); version != graphics::trace_version) {
+    std::cerr << std::format("Error: trace version {} is not supported\n", version);
+    return false;
+  }
+  while (not reader.at_end()) {
+    const auto offset = reader.offset;
+    const auto op = reader.get<uint8_t>();
+    if (not replay(reader, op) or reader.failed) {
+      std::cerr << std::format("Error: bad record {} at offset {}\n", op, offset);
+      return false;
+    }
+  }
+  if (frame.calls > 0) {
+    end_frame();
+  }
+  return true;
+}
+
+auto Replayer::replay(graphics::TraceReader &reader, uint8_t op) -> bool {
+  using graphics::DeviceCall;
+  auto &r = reader;
+  const auto u32 = [&] { return r.get<uint32_t>(); };
+  const auto i32 = [&] { return r.get<int32_t>(); };
+  const auto u64 = [&] { return r.get<uint64_t>(); };
+
+  if (op == graphics::trace_mapped_write) {
+    const auto buffer = u32();
+    const auto offset = u64();
+    const auto bytes = r.get_bytes();
+    const auto it = mapped.find(buffer);
+    if (it != mapped.end()) {
+      timed(mapped_write_slot, [&] { std::memcpy(it->second + offset, bytes.data(), bytes.size()); });
+    }
+    return true;
+  }
+  if (op >= (uint8_t)DeviceCall::Count) {
+    return false;
+  }
+
+  const auto call = (DeviceCall)op;
+  const auto slot = (size_t)op;
+  switch (call) {
+  case DeviceCall::GetInteger: {
+    const auto pname = u32();
+    timed(slot, [&] { device.get_integer(pname); });
+    break;
+  }
+  case DeviceCall::GetString: {
+    const auto name = u32();
+    timed(slot, [&] { device.get_string(name); });
+    break;
+  }
+  case DeviceCall::HasExtension: {
+    const auto extension = r.get_string();
+    timed(slot, [&] { device.has_extension(extension); });
+    break;
+  }
+  case DeviceCall::EnableParallelShaderCompile:
+    timed(slot, [&] { device.enable_parallel_shader_compile(); });
+    break;
+  case DeviceCall::CreateBuffer: {
+    const auto buffer = u32();
+    timed(slot, [&] { buffers[buffer] = device.create_buffer(); });
+    break;
+  }
+  case DeviceCall::DeleteBuffer: {
+    const auto buffer = u32();
+    timed(slot, [&] { device.delete_buffer(lookup(buffers, buffer)); });
+    buffers.erase(buffer);
+    mapped.erase(buffer);
+    break;
+  }
+  case DeviceCall::BindBuffer: {
+    const auto target = u32();
+    const auto buffer = u32();
+    timed(slot, [&] { device.bind_buffer(target, lookup(buffers, buffer)); });
+    break;
+  }
+  case DeviceCall::BindBufferBase: {
+    const auto target = u32();
+    const auto index = u32();
+    const auto buffer = u32();
+    timed(slot, [&] { device.bind_buffer_base(target, index, lookup(buffers, buffer)); });
+    break;
+  }
+  case DeviceCall::BindBufferRange: {
+    const auto target = u32();
+    const auto index = u32();
+    const auto buffer = u32();
+    const auto offset = u64();
+    const auto size = u64();
+    timed(slot, [&] { device.bind_buffer_range(target, index, lookup(buffers, buffer), offset, size); });
+    break;
+  }
+  case DeviceCall::BufferData: {
+    const auto buffer = u32();
+    const auto size = u64();
+    const auto usage = u32();
+    const auto bytes = r.get_bytes();
+    const auto data = bytes.empty() ? nullptr : bytes.data();
+    timed(slot, [&] { device.buffer_data(lookup(buffers, buffer), size, data, usage); });
+    break;
+  }
+  case DeviceCall::BufferSubData: {
+    const auto buffer = u32();
+    const auto offset = u64();
+    const auto bytes = r.get_bytes();
+    timed(slot, [&] { device.buffer_sub_data(lookup(buffers, buffer), offset, bytes.size(), bytes.data()); });
+    break;
+  }
+  case DeviceCall::MapPersistent: {
+    const auto buffer = u32();
+    const auto size = u64();
+    auto memory = (std::byte *)nullptr;
+    timed(slot, [&] { memory = device.map_persistent(lookup(buffers, buffer), size); });
+    if (memory != nullptr) {
+      std::memset(memory, 0, size);
+      mapped[buffer] = memory;
+    }
+    break;
+  }
+  case DeviceCall::UnmapBuffer: {
+    const auto buffer = u32();
+    timed(slot, [&] { device.unmap_buffer(lookup(buffers, buffer)); });
+    mapped.erase(buffer);
+    break;
+  }
+  case DeviceCall::Fence: {
+    const auto fence = u32();
+    timed(slot, [&] { fences[fence] = device.fence(); });
+    break;
+  }
+  case DeviceCall::WaitFence: {
+    const auto fence = u32();
+    const auto timeout = u64();
+    if (const auto it = fences.find(fence); it != fences.end()) {
+      timed(slot, [&] { device.wait_fence(it->second, timeout); });
+    }
+    break;
+  }
+  case DeviceCall::DeleteFence: {
+    const auto fence = u32();
+    if (const auto it = fences.find(fence); it != fences.end()) {
+      timed(slot, [&] { device.delete_fence(it->second); });
+      fences.erase(it);
+    }
+    break;
+  }
+  case DeviceCall::CreateTexture: {
+    const auto texture = u32();
+    timed(slot, [&] { textures[texture] = device.create_texture(); });
+    break;
+  }
+  case DeviceCall::DeleteTexture: {
+    const auto texture = u32();
+    timed(slot, [&] { device.delete_texture(lookup(textures, texture)); });
+    textures.erase(texture);
+    break;
+  }
+  case DeviceCall::BindTexture: {
+    const auto unit = u32();
+    const auto texture = u32();
+    timed(slot, [&] { device.bind_texture(unit, lookup(textures, texture)); });
+    break;
+  }
+  case DeviceCall::TextureParameter: {
+    const auto texture = u32();
+    const auto pname = u32();
+    const auto value = i32();
+    timed(slot, [&] { device.texture_parameter(lookup(textures, texture), pname, value); });
+    break;
+  }
+  case DeviceCall::TextureBorderColor: {
+    const auto texture = u32();
+    auto rgba = std::array<float, 4>{};
+    const auto bytes = r.get_bytes();
+    std::memcpy(rgba.data(), bytes.data(), std::min(bytes.size(), sizeof(rgba)));
+    timed(slot, [&] { device.texture_border_color(lookup(textures, texture), rgba.data()); });
+    break;
+  }
+  case DeviceCall::TextureStorage: {
+    const auto texture = u32();
+    const auto levels = i32();
+    const auto format = u32();
+    const auto w = i32();
+    const auto h = i32();
+    timed(slot, [&] { device.texture_storage(lookup(textures, texture), levels, format, w, h); });
+    break;
+  }
+  case DeviceCall::TextureSubImage: {
+    const auto texture = u32();
+    const auto level = i32();
+    const auto x = i32();
+    const auto y = i32();
+    const auto w = i32();
+    const auto h = i32();
+    const auto format = u32();
+    const auto type = u32();
+    const auto bytes = r.get_bytes();
+    timed(slot, [&] {
+      device.texture_sub_image(lookup(textures, texture), level, x, y, w, h, format, type, bytes.data());
+    });
+    break;
+  }
+  case DeviceCall::CompressedTextureSubImage: {
+    const auto texture = u32();
+    const auto level = i32();
+    const auto x = i32();
+    const auto y = i32();
+    const auto w = i32();
+    const auto h = i32();
+    const auto format = u32();
+    const auto bytes = r.get_bytes();
+    timed(slot, [&] {
+      device.compressed_texture_sub_image(lookup(textures, texture), level, x, y, w, h, format, bytes.size(),
+                                          bytes.data());
+    });
+    break;
+  }
+  case DeviceCall::ClearTexture: {
+    const auto texture = u32();
+    const auto level = i32();
+    const auto format = u32();
+    const auto type = u32();
+    const auto bytes = r.get_bytes();
+    const auto data = bytes.empty() ? nullptr : bytes.data();
+    timed(slot, [&] { device.clear_texture(lookup(textures, texture), level, format, type, data); });
+    break;
+  }
+  case DeviceCall::GenerateMipmap: {
+    const auto texture = u32();
+    timed(slot, [&] { device.generate_mipmap(lookup(textures, texture)); });
+    break;
+  }
+  case DeviceCall::PixelStore: {
+    const auto pname = u32();
+    const auto value = i32();
+    timed(slot, [&] { device.pixel_store(pname, value); });
+    break;
+  }
+  case DeviceCall::CreateFramebuffer: {
+    const auto framebuffer = u32();
+    timed(slot, [&] { framebuffers[framebuffer] = device.create_framebuffer(); });
+    break;
+  }
+  case DeviceCall::DeleteFramebuffer: {
+    const auto framebuffer = u32();
+    timed(slot, [&] { device.delete_framebuffer(lookup(framebuffers, framebuffer)); });
+    framebuffers.erase(framebuffer);
+    break;
+  }
+  case DeviceCall::BindFramebuffer: {
+    const auto target = u32();
+    const auto framebuffer = u32();
+    timed(slot, [&] { device.bind_framebuffer(target, lookup(framebuffers, framebuffer)); });
+    break;
+  }
+  case DeviceCall::FramebufferTexture: {
+    const auto framebuffer = u32();
+    const auto attachment = u32();
+    const auto texture = u32();
+    timed(slot, [&] {
+      device.framebuffer_texture(lookup(framebuffers, framebuffer), attachment, lookup(textures, texture));
+    });
+    break;
+  }
+  case DeviceCall::CreateRenderbuffer: {
+    const auto format = u32();
+    const auto w = i32();
+    const auto h = i32();
+    const auto renderbuffer = u32();
+    timed(slot, [&] { renderbuffers[renderbuffer] = device.create_renderbuffer(format, w, h); });
+    break;
+  }
+  case DeviceCall::DeleteRenderbuffer: {
+    const auto renderbuffer = u32();
+    timed(slot, [&] { device.delete_renderbuffer(lookup(renderbuffers, renderbuffer)); });
+    renderbuffers.erase(renderbuffer);
+    break;
+  }
+  case DeviceCall::FramebufferRenderbuffer: {
+    const auto framebuffer = u32();
+    const auto attachment = u32();
+    const auto renderbuffer = u32();
+    timed(slot, [&] {
+      device.framebuffer_renderbuffer(lookup(framebuffers, framebuffer), attachment,
+                                      lookup(renderbuffers, renderbuffer));
+    });
+    break;
+  }
+  case DeviceCall::FramebufferComplete: {
+    const auto framebuffer = u32();
+    timed(slot, [&] { device.framebuffer_complete(lookup(framebuffers, framebuffer)); });
+    break;
+  }
+  case DeviceCall::BlitFramebuffer: {
+    const auto src = lookup(framebuffers, u32());
+    const auto dst = lookup(framebuffers, u32());
+    auto v = std::array<int32_t, 8>{};
+    for (auto &value : v) {
+      value = i32();
+    }
+    const auto mask = u32();
+    const auto filter = u32();
+    timed(slot, [&] {
+      device.blit_framebuffer(src, dst, v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], mask, filter);
+    });
+    break;
+  }
+  case DeviceCall::CreateVertexArray: {
+    const auto vertex_array = u32();
+    timed(slot, [&] { vertex_arrays[vertex_array] = device.create_vertex_array(); });
+    break;
+  }
+  case DeviceCall::DeleteVertexArray: {
+    const auto vertex_array = u32();
+    timed(slot, [&] { device.delete_vertex_array(lookup(vertex_arrays, vertex_array)); });
+    vertex_arrays.erase(vertex_array);
+    break;
+  }
+  case DeviceCall::BindVertexArray: {
+    const auto vertex_array = u32();
+    timed(slot, [&] { device.bind_vertex_array(lookup(vertex_arrays, vertex_array)); });
+    break;
+  }
+  case DeviceCall::VertexAttrib: {
+    auto attrib = graphics::VertexAttrib{};
+    attrib.index = u32();
+    attrib.size = i32();
+    attrib.type = u32();
+    attrib.normalized = r.get<uint8_t>() != 0;
+    attrib.stride = i32();
+    attrib.offset = u64();
+    attrib.divisor = u32();
+    timed(slot, [&] { device.vertex_attrib(attrib); });
+    break;
+  }
+  case DeviceCall::CreateShader: {
+    const auto type = u32();
+    const auto shader = u32();
+    timed(slot, [&] { shaders[shader] = device.create_shader(type); });
+    break;
+  }
+  case DeviceCall::DeleteShader: {
+    const auto shader = u32();
+    timed(slot, [&] { device.delete_shader(lookup(shaders, shader)); });
+    shaders.erase(shader);
+    break;
+  }
+  case DeviceCall::CompileShader: {
+    const auto shader = u32();
+    const auto source = r.get_string();
+    timed(slot, [&] { device.compile_shader(lookup(shaders, shader), source); });
+    break;
+  }
+  case DeviceCall::ShaderCompiled: {
+    const auto shader = u32();
+    timed(slot, [&] { device.shader_compiled(lookup(shaders, shader)); });
+    break;
+  }
+  case DeviceCall::ShaderInfoLog: {
+    const auto shader = u32();
+    timed(slot, [&] { device.shader_info_log(lookup(shaders, shader)); });
+    break;
+  }
+  case DeviceCall::CreateProgram: {
+    const auto program = u32();
+    timed(slot, [&] { programs[program] = device.create_program(); });
+    break;
+  }
+  case DeviceCall::DeleteProgram: {
+    const auto program = u32();
+    timed(slot, [&] { device.delete_program(lookup(programs, program)); });
+    programs.erase(program);
+    break;
+  }
+  case DeviceCall::ProgramParameter: {
+    const auto program = u32();
+    const auto pname = u32();
+    const auto value = i32();
+    timed(slot, [&] { device.program_parameter(lookup(programs, program), pname, value); });
+    break;
+  }
+  case DeviceCall::AttachShader: {
+    const auto program = u32();
+    const auto shader = u32();
+    timed(slot, [&] { device.attach_shader(lookup(programs, program), lookup(shaders, shader)); });
+    break;
+  }
+  case DeviceCall::DetachShader: {
+    const auto program = u32();
+    const auto shader = u32();
+    timed(slot, [&] { device.detach_shader(lookup(programs, program), lookup(shaders, shader)); });
+    break;
+  }
+  case DeviceCall::LinkProgram: {
+    const auto program = u32();
+    timed(slot, [&] { device.link_program(lookup(programs, program)); });
+    break;
+  }
+  case DeviceCall::ProgramLinked: {
+    const auto program = u32();
+    timed(slot, [&] { device.program_linked(lookup(programs, program)); });
+    break;
+  }
+  case DeviceCall::ProgramInfoLog: {
+    const auto program = u32();
+    timed(slot, [&] { device.program_info_log(lookup(programs, program)); });
+    break;
+  }
+  case DeviceCall::GetProgramBinary: {
+    const auto program = u32();
+    timed(slot, [&] { device.get_program_binary(lookup(programs, program)); });
+    break;
+  }
+  case DeviceCall::ProgramBinary:
+    // never captured
+    return false;
+  case DeviceCall::UseProgram: {
+    program = u32();
+    timed(slot, [&] { device.use_program(lookup(programs, program)); });
+    break;
+  }
+  case DeviceCall::ActiveUniforms: {
+    const auto program = u32();
+    timed(slot, [&] { device.active_uniforms(lookup(programs, program)); });
+    break;
+  }
+  case DeviceCall::UniformLocation: {
+    const auto program = u32();
+    const auto name = std::string{r.get_string()};
+    const auto location = i32();
+    timed(slot, [&] {
+      locations[key(program, (uint32_t)location)] = device.uniform_location(lookup(programs, program), name.c_str());
+    });
+    break;
+  }
+  case DeviceCall::ActiveUniformBlocks: {
+    const auto program = u32();
+    auto captured = std::vector<std::string>(u32());
+    for (auto &block : captured) {
+      block = r.get_string();
+    }
+    auto blocks = std::vector<std::string>{};
+    timed(slot, [&] { blocks = device.active_uniform_blocks(lookup(programs, program)); });
+    for (auto i = uint32_t{}; i < captured.size(); ++i) {
+      const auto it = std::find(blocks.begin(), blocks.end(), captured[i]);
+      if (it != blocks.end()) {
+        block_indices[key(program, i)] = (uint32_t)(it - blocks.begin());
+      }
+    }
+    break;
+  }
+  case DeviceCall::UniformBlockParameter: {
+    const auto program = u32();
+    const auto index = u32();
+    const auto pname = u32();
+    if (const auto it = block_indices.find(key(program, index)); it != block_indices.end()) {
+      timed(slot, [&] { device.uniform_block_parameter(lookup(programs, program), it->second, pname); });
+    }
+    break;
+  }
+  case DeviceCall::UniformBlockBinding: {
+    const auto program = u32();
+    const auto index = u32();
+    const auto binding = u32();
+    if (const auto it = block_indices.find(key(program, index)); it != block_indices.end()) {
+      timed(slot, [&] { device.uniform_block_binding(lookup(programs, program), it->second, binding); });
+    }
+    break;
+  }
+  case DeviceCall::UniformMat4: {
+    const auto location = i32();
+    auto value = std::array<float, 16>{};
+    const auto bytes = r.get_bytes();
+    std::memcpy(value.data(), bytes.data(), std::min(bytes.size(), sizeof(value)));
+    if (const auto it = locations.find(key(program, (uint32_t)location)); it != locations.end()) {
+      timed(slot, [&] { device.uniform_mat4(it->second, value.data()); });
+    }
+    break;
+  }
+  case DeviceCall::UniformUint: {
+    const auto location = i32();
+    const auto value = u32();
+    if (const auto it = locations.find(key(program, (uint32_t)location)); it != locations.end()) {
+      timed(slot, [&] { device.uniform_uint(it->second, value); });
+    }
+    break;
+  }
+  case DeviceCall::Enable: {
+    const auto cap = u32();
+    timed(slot, [&] { device.enable(cap); });
+    break;
+  }
+  case DeviceCall::Disable: {
+    const auto cap = u32();
+    timed(slot, [&] { device.disable(cap); });
+    break;
+  }
+  case DeviceCall::BlendFunc: {
+    const auto src_rgb = u32();
+    const auto dst_rgb = u32();
+    const auto src_alpha = u32();
+    const auto dst_alpha = u32();
+    timed(slot, [&] { device.blend_func(src_rgb, dst_rgb, src_alpha, dst_alpha); });
+    break;
+  }
+  case DeviceCall::DepthMask: {
+    const auto enabled = r.get<uint8_t>() != 0;
+    timed(slot, [&] { device.depth_mask(enabled); });
+    break;
+  }
+  case DeviceCall::DepthFunc: {
+    const auto func = u32();
+    timed(slot, [&] { device.depth_func(func); });
+    break;
+  }
+  case DeviceCall::Viewport: {
+    const auto x = i32();
+    const auto y = i32();
+    const auto w = i32();
+    const auto h = i32();
+    timed(slot, [&] { device.viewport(x, y, w, h); });
+    break;
+  }
+  case DeviceCall::Clear: {
+    auto rgba = std::array<float, 4>{};
+    for (auto &value : rgba) {
+      value = r.get<float>();
+    }
+    const auto mask = u32();
+    timed(slot, [&] { device.clear(rgba[0], rgba[1], rgba[2], rgba[3], mask); });
+    break;
+  }
+  case DeviceCall::DrawElements: {
+    const auto mode = u32();
+    const auto count = i32();
+    const auto type = u32();
+    const auto offset = u64();
+    timed(slot, [&] { device.draw_elements(mode, count, type, offset); });
+    break;
+  }
+  case DeviceCall::DrawElementsInstanced: {
+    const auto mode = u32();
+    const auto count = i32();
+    const auto type = u32();
+    const auto offset = u64();
+    const auto instance_count = i32();
+    const auto base_vertex = i32();
+    const auto base_instance = u32();
+    timed(slot, [&] {
+      device.draw_elements_instanced(mode, count, type, offset, instance_count, base_vertex, base_instance);
+    });
+    break;
+  }
+  case DeviceCall::MultiDrawElementsIndirect: {
+    const auto mode = u32();
+    const auto type = u32();
+    const auto offset = u64();
+    const auto draw_count = i32();
+    timed(slot, [&] { device.multi_draw_elements_indirect(mode, type, offset, draw_count); });
+    break;
+  }
+  case DeviceCall::DispatchCompute: {
+    const auto x = u32();
+    const auto y = u32();
+    const auto z = u32();
+    timed(slot, [&] { device.dispatch_compute(x, y, z); });
+    break;
+  }
+  case DeviceCall::MemoryBarrier: {
+    const auto barriers = u32();
+    timed(slot, [&] { device.memory_barrier(barriers); });
+    break;
+  }
+  case DeviceCall::EndFrame:
+    timed(slot, [&] { device.end_frame(); });
+    end_frame();
+    break;
+  case DeviceCall::Count:
+    return false;
+  }
+  return true;
+}
+
+auto Replayer::end_frame() -> void {
+  const auto start = Clock::now();
+  glFinish();
+  const auto end = Clock::now();
+  frame.finish_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  frame.wall_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - frame_start).count();
+  frames.push_back(frame);
+  frame = {};
+  frame_start = Clock::now();
+}
+
+auto Replayer::report() const -> void {
+  const auto ms = [](uint64_t ns) { return (double)ns / 1e6; };
+  const auto us = [](uint64_t ns) { return (double)ns / 1e3; };
+
+  // frame 0 also holds the startup calls (shaders, textures, buffers)
+  std::cout << std::format("{:>6} {:>8} {:>10} {:>10} {:>10}\n", "frame", "calls", "calls ms", "finish ms",
+                           "wall ms");
+  for (auto i = size_t{}; i < frames.size(); ++i) {
+    const auto &f = frames[i];
+    std::cout << std::format("{:>6} {:>8} {:>10.3f} {:>10.3f} {:>10.3f}\n", i, f.calls, ms(f.call_ns),
+                             ms(f.finish_ns), ms(f.wall_ns));
+  }
+
+  auto order = std::vector<size_t>{};
+  for (auto i = size_t{}; i < calls.size(); ++i) {
+    if (calls[i].count > 0) {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return calls[a].total_ns > calls[b].total_ns; });
+  std::cout << std::format("\n{:<32} {:>8} {:>10} {:>10} {:>10}\n", "call", "count", "total ms", "avg us",
+                           "max us");
+  for (auto i : order) {
+    const auto &c = calls[i];
+    const auto name = i == mapped_write_slot ? std::string_view{"mapped_write"}
+                                             : graphics::device_call_name((graphics::DeviceCall)i);
+    std::cout << std::format("{:<32} {:>8} {:>10.3f} {:>10.2f} {:>10.2f}\n", name, c.count, ms(c.total_ns),
+                             us(c.total_ns / c.count), us(c.max_ns));
+  }
+}
+
+auto create_context() -> bool {
+  const auto get_platform_display =
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  auto display = get_platform_display != nullptr
+                   ? get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+                   : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display == EGL_NO_DISPLAY or not eglInitialize(display, nullptr, nullptr)) {
+    std::cerr << "Error: no egl display\n";
+    return false;
+  }
+  eglBindAPI(EGL_OPENGL_API);
+  const EGLint attribs[] = {
+    EGL_CONTEXT_MAJOR_VERSION,
+    4,
+    EGL_CONTEXT_MINOR_VERSION,
+    5,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK,
+    EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_NONE,
+  };
+  const auto context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attribs);
+  if (context == EGL_NO_CONTEXT or not eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    std::cerr << "Error: could not create a headless opengl 4.5 context\n";
+    return false;
+  }
+  if (not gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+    std::cerr << "Error: could not load opengl\n";
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  auto replayer = Replayer{};
+  auto path = std::filesystem::path{};
+  for (auto i = 1; i < argc; ++i) {
+    const auto arg = std::string_view{argv[i]};
+    if (arg == "--size" and i + 1 < argc) {
+      const auto size = std::string{argv[++i]};
+      const auto x = size.find('x');
+      if (x == std::string::npos) {
+        std::cerr << std::format("Error: bad size {}\n", size);
+        return EXIT_FAILURE;
+      }
+      replayer.width = std::atoi(size.substr(0, x).c_str());
+      replayer.height = std::atoi(size.substr(x + 1).c_str());
+    } else {
+      path = arg;
+    }
+  }
+  if (path.empty()) {
+    std::cerr << "usage: rubus-replay <trace> [--size <width>x<height>]\n";
+    return EXIT_FAILURE;
+  }
+
+  auto file = std::ifstream{path, std::ios::binary};
+  if (not file) {
+    std::cerr << std::format("Error: could not open {}\n", path.string());
+    return EXIT_FAILURE;
+  }
+  auto data = std::vector<std::byte>(std::filesystem::file_size(path));
+  file.read((char *)data.data(), (std::streamsize)data.size());
+
+  if (not create_context()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << std::format("Replaying {} on {}\n", path.string(), replayer.device.get_string(GL_RENDERER));
+  replayer.init();
+
+  auto reader = graphics::TraceReader{.data = data};
+  const auto ok = replayer.run(reader);
+  replayer.report();
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}